@@ -0,0 +1,88 @@
+project "AssetCooker"
+	kind "ConsoleApp"
+	language "C++"
+	cppdialect "C++20"
+	staticruntime "off"
+
+	-- Shares the loaders and encoders with the app so cooked files always match what it reads
+	files
+	{
+		"src/**.h",
+		"src/**.cpp",
+		"%{wks.location}/OpenGLCourse/src/AssetPack.h",
+		"%{wks.location}/OpenGLCourse/src/AssetPack.cpp",
+		"%{wks.location}/OpenGLCourse/src/CompressedImage.h",
+		"%{wks.location}/OpenGLCourse/src/CompressedImage.cpp",
+		"%{wks.location}/OpenGLCourse/src/CookedAssets.h",
+		"%{wks.location}/OpenGLCourse/src/CookedAssets.cpp",
+		"%{wks.location}/OpenGLCourse/src/FrameArena.h",
+		"%{wks.location}/OpenGLCourse/src/FrameArena.cpp",
+		"%{wks.location}/OpenGLCourse/src/JobSystem.h",
+		"%{wks.location}/OpenGLCourse/src/JobSystem.cpp",
+		"%{wks.location}/OpenGLCourse/src/Lz4.h",
+		"%{wks.location}/OpenGLCourse/src/Lz4.cpp",
+		"%{wks.location}/OpenGLCourse/src/MeshFile.h",
+		"%{wks.location}/OpenGLCourse/src/MeshFile.cpp",
+		"%{wks.location}/OpenGLCourse/src/ModelImporter.h",
+		"%{wks.location}/OpenGLCourse/src/ModelImporter.cpp",
+		"%{wks.location}/OpenGLCourse/src/ObjImporter.h",
+		"%{wks.location}/OpenGLCourse/src/ObjImporter.cpp",
+		"%{wks.location}/OpenGLCourse/src/ShaderPreprocessor.h",
+		"%{wks.location}/OpenGLCourse/src/ShaderPreprocessor.cpp",
+		"%{wks.location}/OpenGLCourse/src/TextureCompressor.h",
+		"%{wks.location}/OpenGLCourse/src/TextureCompressor.cpp",
+		"%{wks.location}/OpenGLCourse/src/Utils.h",
+		"%{wks.location}/OpenGLCourse/src/Utils.cpp",
+		"%{wks.location}/OpenGLCourse/vendor/stb_image/**.h",
+		"%{wks.location}/OpenGLCourse/vendor/stb_image/**.cpp"
+	}
+
+	includedirs
+	{
+		"src",
+		"%{wks.location}/OpenGLCourse/src",
+		"%{wks.location}/vendor/Glad/include",
+		"%{wks.location}/vendor/assimp/include",
+		"%{wks.location}/OpenGLCourse/vendor/glm",
+		"%{wks.location}/OpenGLCourse/vendor/stb_image"
+	}
+
+	targetdir ("../bin/" .. outputdir .. "/%{prj.name}")
+	objdir ("../bin-int/" .. outputdir .. "/%{prj.name}")
+
+	-- Cooks the assets of the app when started from the IDE
+	debugdir "%{wks.location}/OpenGLCourse"
+
+	filter "system:windows"
+		systemversion "latest"
+		defines { "APP_PLATFORM_WINDOWS" }
+
+	filter "configurations:Debug"
+		defines { "APP_DEBUG" }
+		runtime "Debug"
+		symbols "On"
+
+		links
+		{
+			"%{wks.location}/vendor/assimp/bin/Debug/assimp-vc142-mtd.lib"
+		}
+
+		postbuildcommands 
+		{
+			'{COPYFILE} "%{wks.location}/vendor/assimp/bin/Debug/assimp-vc142-mtd.dll" "%{cfg.targetdir}"',
+		}
+
+	filter "configurations:Release or Dist"
+		defines { "APP_RELEASE" }
+		runtime "Release"
+		optimize "On"
+
+		links
+		{
+			"%{wks.location}/vendor/assimp/bin/Release/assimp-vc142-mt.lib"
+		}
+
+		postbuildcommands 
+		{
+			'{COPYFILE} "%{wks.location}/vendor/assimp/bin/Release/assimp-vc142-mt.dll" "%{cfg.targetdir}"',
+		}
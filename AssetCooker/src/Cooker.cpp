@@ -0,0 +1,257 @@
+#include "Cooker.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "AssetPack.h"
+#include "CookedAssets.h"
+#include "JobSystem.h"
+#include "MeshFile.h"
+#include "ModelImporter.h"
+#include "ShaderPreprocessor.h"
+#include "TextureCompressor.h"
+#include "Utils.h"
+
+// Skybox faces are loaded as a cubemap rather than through the texture arrays, they stay as they are
+static const char* s_IgnoredDirectories[] = { "cooked", "Skybox" };
+static const char* s_ManifestName = "manifest.txt";
+
+struct CookTask
+{
+	std::filesystem::path Source;
+	std::filesystem::path Output;
+	AssetKind Kind = AssetKind::Other;
+	uint64_t Hash = 0;
+	bool Cooked = false;
+	bool Failed = false;
+};
+
+static bool IsIgnored(const std::filesystem::path& path)
+{
+	for (const auto& part : path)
+	{
+		if (std::find_if(std::begin(s_IgnoredDirectories), std::end(s_IgnoredDirectories), [&part](const char* name) { return part == name; }) != std::end(s_IgnoredDirectories))
+			return true;
+	}
+
+	return false;
+}
+
+// Files a source pulls in when it is loaded, they have to be part of its hash
+static std::vector<std::filesystem::path> FindDependencies(const CookTask& task)
+{
+	std::vector<std::filesystem::path> dependencies;
+
+	if (task.Kind == AssetKind::Shader)
+	{
+		std::string source;
+		ShaderPreprocessor::Process(task.Source, source, &dependencies);
+	}
+	else if (task.Kind == AssetKind::Model && task.Source.extension() == ".obj")
+	{
+		std::istringstream obj(Utils::ReadFileToString(task.Source));
+		std::string line;
+		while (std::getline(obj, line))
+		{
+			if (line.rfind("mtllib ", 0) == 0)
+			{
+				std::string library = line.substr(7);
+				library.erase(library.find_last_not_of(" \t\r") + 1);
+				dependencies.push_back(task.Source.parent_path() / library);
+			}
+		}
+	}
+
+	return dependencies;
+}
+
+static uint64_t HashTask(const CookTask& task)
+{
+	uint64_t hash = Utils::Hash(&Cooker::Version, sizeof(Cooker::Version));
+
+	std::vector<std::filesystem::path> files = FindDependencies(task);
+	files.insert(files.begin(), task.Source);
+	for (const auto& file : files)
+	{
+		const std::string name = file.lexically_normal().generic_string();
+		const std::vector<uint8_t> data = Utils::ReadFileToBytes(file);
+		hash = hash * 31 + Utils::Hash(name.data(), name.size());
+		hash = hash * 31 + Utils::Hash(data.data(), data.size());
+	}
+
+	return hash;
+}
+
+static bool Cook(const CookTask& task)
+{
+	std::error_code error;
+	std::filesystem::create_directories(task.Output.parent_path(), error);
+
+	switch (task.Kind)
+	{
+		case AssetKind::Texture:
+			return TextureCompressor::CompressFile(task.Source, task.Output);
+		case AssetKind::Model:
+		{
+			MeshFile file;
+			return ModelImporter::Import(task.Source, file) && MeshFile::Write(task.Output, file);
+		}
+		case AssetKind::Shader:
+		{
+			std::string source;
+			if (!ShaderPreprocessor::Process(task.Source, source))
+				return false;
+
+			std::ofstream out(task.Output, std::ios::out | std::ios::binary);
+			out << source;
+			return (bool)out;
+		}
+		default:
+			return false;
+	}
+}
+
+static std::unordered_map<std::string, uint64_t> ReadManifest(const std::filesystem::path& path)
+{
+	std::unordered_map<std::string, uint64_t> manifest;
+
+	std::ifstream in(path);
+	std::string line;
+	while (std::getline(in, line))
+	{
+		// <hash in hex> <source path>, a line that does not parse leaves its asset out so it is cooked again
+		const size_t separator = line.find(' ');
+		if (separator == std::string::npos)
+			continue;
+
+		uint64_t hash = 0;
+		const char* end = line.data() + separator;
+		const auto [parsed, error] = std::from_chars(line.data(), end, hash, 16);
+		if (error == std::errc() && parsed == end)
+			manifest[line.substr(separator + 1)] = hash;
+	}
+
+	return manifest;
+}
+
+static void WriteManifest(const std::filesystem::path& path, const std::vector<CookTask>& tasks)
+{
+	// Sorted so the manifest only changes when an asset does
+	std::vector<std::pair<std::string, uint64_t>> entries;
+	for (const CookTask& task : tasks)
+	{
+		if (!task.Failed)
+			entries.emplace_back(task.Source.lexically_normal().generic_string(), task.Hash);
+	}
+
+	std::sort(entries.begin(), entries.end());
+
+	std::ofstream out(path);
+	for (const auto& [source, hash] : entries)
+		out << std::hex << std::setw(16) << std::setfill('0') << hash << ' ' << source << '\n';
+}
+
+// Textures and models, the shaders are still read loose since their includes are resolved at load time
+static uint32_t WritePack(const std::filesystem::path& path, const std::vector<CookTask>& tasks, bool compress)
+{
+	std::vector<AssetPackInput> inputs;
+	for (const CookTask& task : tasks)
+	{
+		if (task.Failed || (task.Kind != AssetKind::Texture && task.Kind != AssetKind::Model))
+			continue;
+
+		AssetPackInput& input = inputs.emplace_back();
+		input.Name = CookedAssets::GetPackName(task.Source);
+		input.Data = Utils::ReadFileToBytes(task.Output);
+		if (input.Data.empty())
+			inputs.pop_back();
+	}
+
+	if (!AssetPack::Write(path, inputs, compress))
+		return 0;
+
+	return (uint32_t)inputs.size();
+}
+
+CookResult Cooker::Run(const CookSettings& settings)
+{
+	std::error_code error;
+	if (!std::filesystem::is_directory(settings.AssetDirectory, error))
+	{
+		std::cerr << "Asset directory '" << settings.AssetDirectory.string() << "' does not exist\n";
+		return { 0, 0, 1 };
+	}
+
+	std::vector<CookTask> tasks;
+	for (const auto& entry : std::filesystem::recursive_directory_iterator(settings.AssetDirectory, error))
+	{
+		if (!entry.is_regular_file() || IsIgnored(entry.path().lexically_relative(settings.AssetDirectory)))
+			continue;
+
+		CookTask task;
+		task.Source = entry.path();
+		task.Kind = CookedAssets::GetKind(task.Source);
+		task.Output = CookedAssets::GetCookedPath(task.Source);
+		if (task.Kind != AssetKind::Other && !task.Output.empty())
+			tasks.push_back(std::move(task));
+	}
+
+	const std::filesystem::path manifestPath = settings.AssetDirectory / "cooked" / s_ManifestName;
+	const std::unordered_map<std::string, uint64_t> manifest = settings.Force ? std::unordered_map<std::string, uint64_t>() : ReadManifest(manifestPath);
+
+	JobCounter counter;
+	JobSystem::ParallelFor((uint32_t)tasks.size(), 1, [&](uint32_t begin, uint32_t end)
+	{
+		for (uint32_t i = begin; i < end; i++)
+		{
+			CookTask& task = tasks[i];
+			task.Hash = HashTask(task);
+
+			std::error_code existsError;
+			const auto previous = manifest.find(task.Source.lexically_normal().generic_string());
+			if (previous != manifest.end() && previous->second == task.Hash && std::filesystem::exists(task.Output, existsError))
+				continue;
+
+			task.Cooked = Cook(task);
+			task.Failed = !task.Cooked;
+		}
+	}, &counter);
+	JobSystem::WaitFor(counter);
+
+	CookResult result;
+	for (const CookTask& task : tasks)
+	{
+		if (task.Failed)
+		{
+			result.Failed++;
+			std::cerr << "Failed to cook '" << task.Source.string() << "'\n";
+		}
+		else if (task.Cooked)
+		{
+			result.Cooked++;
+			std::cout << "Cooked '" << task.Source.string() << "' -> '" << task.Output.string() << "'\n";
+		}
+		else
+		{
+			result.Skipped++;
+		}
+	}
+
+	std::filesystem::create_directories(manifestPath.parent_path(), error);
+	WriteManifest(manifestPath, tasks);
+
+	const std::filesystem::path packPath = manifestPath.parent_path() / CookedAssets::PackFileName;
+	if (result.Cooked > 0 || settings.Force || !std::filesystem::exists(packPath, error))
+		result.Packed = WritePack(packPath, tasks, settings.Compress);
+
+	return result;
+}
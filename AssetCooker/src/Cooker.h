@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+struct CookSettings
+{
+	// The assets folder of the app, outputs go to its cooked subfolder
+	std::filesystem::path AssetDirectory = "assets";
+	// Ignores the manifest and cooks everything again
+	bool Force = false;
+	// LZ4 compresses the blobs of the asset pack that shrink enough
+	bool Compress = false;
+};
+
+struct CookResult
+{
+	uint32_t Cooked = 0;
+	uint32_t Skipped = 0;
+	uint32_t Failed = 0;
+	// Assets in the pack, 0 when it was up to date
+	uint32_t Packed = 0;
+};
+
+// Converts the source assets into the formats the app loads fastest: models into .mesh files,
+// textures into BC compressed DDS files with mips and shaders with their includes expanded.
+// Every output is keyed by a hash of its source and everything the source depends on, so a run
+// only cooks what changed since the last one. Assets are cooked in parallel on the job system.
+// The cooked textures and models are then also written to a single asset pack the app maps at startup.
+class Cooker
+{
+public:
+	Cooker() = delete;
+	~Cooker() = delete;
+
+	static CookResult Run(const CookSettings& settings);
+
+	// Bump whenever an output format or the conversion changes, so every asset is cooked again
+	static constexpr uint32_t Version = 2;
+};
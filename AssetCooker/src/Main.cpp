@@ -0,0 +1,34 @@
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include "Cooker.h"
+#include "JobSystem.h"
+
+// Usage: AssetCooker [asset directory] [--force] [--lz4]
+int main(int argc, char** argv)
+{
+	CookSettings settings;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--force") == 0)
+			settings.Force = true;
+		else if (strcmp(argv[i], "--lz4") == 0)
+			settings.Compress = true;
+		else
+			settings.AssetDirectory = argv[i];
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+
+	JobSystem::Init();
+	const CookResult result = Cooker::Run(settings);
+	JobSystem::Shutdown();
+
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::cout << "Cooked " << result.Cooked << ", up to date " << result.Skipped << ", failed " << result.Failed << " in " << seconds << " s\n";
+	if (result.Packed)
+		std::cout << "Packed " << result.Packed << " assets\n";
+
+	return result.Failed ? 1 : 0;
+}
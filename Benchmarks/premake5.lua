@@ -0,0 +1,105 @@
+project "Benchmarks"
+	kind "ConsoleApp"
+	language "C++"
+	cppdialect "C++20"
+	staticruntime "off"
+
+	-- CPU hot paths of the app, runs without a GPU. The camera reads its input from a replay, which
+	-- still needs the window code to link but never opens a window.
+	files
+	{
+		"src/**.h",
+		"src/**.cpp",
+		"%{wks.location}/OpenGLCourse/src/Camera.h",
+		"%{wks.location}/OpenGLCourse/src/Camera.cpp",
+		"%{wks.location}/OpenGLCourse/src/FrameArena.h",
+		"%{wks.location}/OpenGLCourse/src/FrameArena.cpp",
+		"%{wks.location}/OpenGLCourse/src/Geometry.h",
+		"%{wks.location}/OpenGLCourse/src/Geometry.cpp",
+		"%{wks.location}/OpenGLCourse/src/GlInstrumentation.h",
+		"%{wks.location}/OpenGLCourse/src/GlInstrumentation.cpp",
+		"%{wks.location}/OpenGLCourse/src/Input.h",
+		"%{wks.location}/OpenGLCourse/src/Input.cpp",
+		"%{wks.location}/OpenGLCourse/src/InputRecording.h",
+		"%{wks.location}/OpenGLCourse/src/InputRecording.cpp",
+		"%{wks.location}/OpenGLCourse/src/JobSystem.h",
+		"%{wks.location}/OpenGLCourse/src/JobSystem.cpp",
+		"%{wks.location}/OpenGLCourse/src/Lights.h",
+		"%{wks.location}/OpenGLCourse/src/Log.h",
+		"%{wks.location}/OpenGLCourse/src/Log.cpp",
+		"%{wks.location}/OpenGLCourse/src/MeshFile.h",
+		"%{wks.location}/OpenGLCourse/src/MeshFile.cpp",
+		"%{wks.location}/OpenGLCourse/src/ModelImporter.h",
+		"%{wks.location}/OpenGLCourse/src/ModelImporter.cpp",
+		"%{wks.location}/OpenGLCourse/src/ObjImporter.h",
+		"%{wks.location}/OpenGLCourse/src/ObjImporter.cpp",
+		"%{wks.location}/OpenGLCourse/src/OpenGLContext.h",
+		"%{wks.location}/OpenGLCourse/src/OpenGLContext.cpp",
+		"%{wks.location}/OpenGLCourse/src/UniformLocations.h",
+		"%{wks.location}/OpenGLCourse/src/Utils.h",
+		"%{wks.location}/OpenGLCourse/src/Utils.cpp",
+		"%{wks.location}/OpenGLCourse/src/Window.h",
+		"%{wks.location}/OpenGLCourse/src/Window.cpp"
+	}
+
+	includedirs
+	{
+		"src",
+		"%{wks.location}/OpenGLCourse/src",
+		"%{wks.location}/vendor/GLFW/include",
+		"%{wks.location}/vendor/Glad/include",
+		"%{wks.location}/vendor/assimp/include",
+		"%{wks.location}/OpenGLCourse/vendor/glm"
+	}
+
+	defines
+	{
+		"GLFW_INCLUDE_NONE"
+	}
+
+	links
+	{
+		"GLFW",
+		"Glad",
+		"opengl32.lib"
+	}
+
+	targetdir ("../bin/" .. outputdir .. "/%{prj.name}")
+	objdir ("../bin-int/" .. outputdir .. "/%{prj.name}")
+
+	-- Started from the IDE the results land next to the project file
+	debugargs { "--json", "benchmarks.json" }
+
+	filter "system:windows"
+		systemversion "latest"
+		defines { "APP_PLATFORM_WINDOWS" }
+
+	filter "configurations:Debug"
+		defines { "APP_DEBUG" }
+		runtime "Debug"
+		symbols "On"
+
+		links
+		{
+			"%{wks.location}/vendor/assimp/bin/Debug/assimp-vc142-mtd.lib"
+		}
+
+		postbuildcommands 
+		{
+			'{COPYFILE} "%{wks.location}/vendor/assimp/bin/Debug/assimp-vc142-mtd.dll" "%{cfg.targetdir}"',
+		}
+
+	filter "configurations:Release or Dist"
+		defines { "APP_RELEASE" }
+		runtime "Release"
+		optimize "On"
+
+		links
+		{
+			"%{wks.location}/vendor/assimp/bin/Release/assimp-vc142-mt.lib"
+		}
+
+		postbuildcommands 
+		{
+			'{COPYFILE} "%{wks.location}/vendor/assimp/bin/Release/assimp-vc142-mt.dll" "%{cfg.targetdir}"',
+		}
@@ -0,0 +1,210 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+struct RegisteredBenchmark
+{
+	std::string Name;
+	BenchmarkFunction Function = nullptr;
+	std::vector<int64_t> Ranges;
+};
+
+struct BenchmarkResult
+{
+	std::string Name;
+	uint64_t Iterations = 0;
+	// Per iteration
+	double RealNs = 0.0;
+	double CpuNs = 0.0;
+	double ItemsPerSecond = 0.0;
+	double BytesPerSecond = 0.0;
+	std::string Error;
+};
+
+// Runs shorter than this are too noisy to extrapolate the iteration count from
+static constexpr double s_MinExtrapolationSeconds = 0.01;
+// Aim past the minimum time, so the final run does not fall just short of it
+static constexpr double s_Overshoot = 1.4;
+static constexpr double s_MaxGrowth = 10.0;
+
+static std::vector<RegisteredBenchmark> s_Benchmarks;
+
+static std::string EscapeJson(const std::string& text)
+{
+	std::string result;
+	for (const char c : text)
+	{
+		if (c == '"' || c == '\\')
+			result += '\\';
+		result += c;
+	}
+
+	return result;
+}
+
+static std::string GetDate()
+{
+	const std::time_t now = std::time(nullptr);
+	char text[32] = {};
+	std::strftime(text, sizeof(text), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+	return text;
+}
+
+// Grows the iteration count until a run takes at least the minimum time, like Google Benchmark
+static BenchmarkResult RunBenchmark(const std::string& name, BenchmarkFunction function, int64_t range, const BenchmarkSettings& settings)
+{
+	BenchmarkResult result;
+	result.Name = name;
+
+	uint64_t iterations = 1;
+	while (true)
+	{
+		BenchmarkState state(range, iterations);
+		function(state);
+
+		if (!state.GetError().empty())
+		{
+			result.Error = state.GetError();
+			return result;
+		}
+
+		const double seconds = state.GetRealSeconds();
+		if (seconds >= settings.MinSeconds || iterations >= settings.MaxIterations)
+		{
+			const double count = (double)iterations;
+			result.Iterations = iterations;
+			result.RealNs = seconds * 1e9 / count;
+			result.CpuNs = state.GetCpuSeconds() * 1e9 / count;
+			if (seconds > 0.0)
+			{
+				result.ItemsPerSecond = (double)state.GetItemsPerIteration() * count / seconds;
+				result.BytesPerSecond = (double)state.GetBytesPerIteration() * count / seconds;
+			}
+			return result;
+		}
+
+		const double growth = seconds < s_MinExtrapolationSeconds ? s_MaxGrowth : std::min(settings.MinSeconds * s_Overshoot / seconds, s_MaxGrowth);
+		iterations = std::min(std::max((uint64_t)((double)iterations * growth), iterations + 1), settings.MaxIterations);
+	}
+}
+
+static void PrintResult(const BenchmarkResult& result)
+{
+	if (!result.Error.empty())
+	{
+		printf("%-48s ERROR: %s\n", result.Name.c_str(), result.Error.c_str());
+		return;
+	}
+
+	printf("%-48s %14.0f ns %14.0f ns %12llu", result.Name.c_str(), result.RealNs, result.CpuNs, (unsigned long long)result.Iterations);
+	if (result.ItemsPerSecond > 0.0)
+		printf("  %10.3f M items/s", result.ItemsPerSecond / 1e6);
+	if (result.BytesPerSecond > 0.0)
+		printf("  %10.3f MB/s", result.BytesPerSecond / (1024.0 * 1024.0));
+	printf("\n");
+}
+
+static bool WriteJson(const std::string& path, const char* executable, const std::vector<BenchmarkResult>& results)
+{
+	std::ofstream out(path, std::ios::out | std::ios::trunc);
+	if (!out)
+	{
+		std::cerr << "Could not open benchmark output '" << path << "'\n";
+		return false;
+	}
+
+#ifdef APP_DEBUG
+	const char* buildType = "debug";
+#else
+	const char* buildType = "release";
+#endif
+
+	out << "{\n";
+	out << "  \"context\": {\n";
+	out << "    \"date\": \"" << GetDate() << "\",\n";
+	out << "    \"executable\": \"" << EscapeJson(executable) << "\",\n";
+	out << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n";
+	out << "    \"library_build_type\": \"" << buildType << "\"\n";
+	out << "  },\n";
+	out << "  \"benchmarks\": [";
+
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const BenchmarkResult& result = results[i];
+		out << (i == 0 ? "\n" : ",\n") << "    {\n";
+		out << "      \"name\": \"" << EscapeJson(result.Name) << "\",\n";
+		out << "      \"run_name\": \"" << EscapeJson(result.Name) << "\",\n";
+		out << "      \"run_type\": \"iteration\",\n";
+		if (!result.Error.empty())
+		{
+			out << "      \"error_occurred\": true,\n";
+			out << "      \"error_message\": \"" << EscapeJson(result.Error) << "\"\n";
+			out << "    }";
+			continue;
+		}
+
+		out << "      \"iterations\": " << result.Iterations << ",\n";
+		out << "      \"real_time\": " << result.RealNs << ",\n";
+		out << "      \"cpu_time\": " << result.CpuNs << ",\n";
+		out << "      \"time_unit\": \"ns\"";
+		if (result.ItemsPerSecond > 0.0)
+			out << ",\n      \"items_per_second\": " << result.ItemsPerSecond;
+		if (result.BytesPerSecond > 0.0)
+			out << ",\n      \"bytes_per_second\": " << result.BytesPerSecond;
+		out << "\n    }";
+	}
+
+	out << "\n  ]\n}\n";
+	return true;
+}
+
+void Benchmarks::Register(const std::string& name, BenchmarkFunction function, const std::vector<int64_t>& ranges)
+{
+	s_Benchmarks.push_back({ name, function, ranges });
+}
+
+std::vector<int64_t> Benchmarks::Range(int64_t first, int64_t last, int64_t multiplier)
+{
+	std::vector<int64_t> ranges;
+	for (int64_t range = first; range < last; range *= multiplier)
+		ranges.push_back(range);
+	ranges.push_back(last);
+	return ranges;
+}
+
+uint32_t Benchmarks::Run(const BenchmarkSettings& settings, const char* executable)
+{
+	printf("%-48s %17s %17s %12s\n", "Benchmark", "Time", "CPU", "Iterations");
+
+	std::vector<BenchmarkResult> results;
+	uint32_t failed = 0;
+	for (const RegisteredBenchmark& benchmark : s_Benchmarks)
+	{
+		const bool hasRange = !benchmark.Ranges.empty();
+		const std::vector<int64_t> ranges = hasRange ? benchmark.Ranges : std::vector<int64_t>{ 0 };
+		for (const int64_t range : ranges)
+		{
+			const std::string name = hasRange ? benchmark.Name + "/" + std::to_string(range) : benchmark.Name;
+			if (!settings.Filter.empty() && name.find(settings.Filter) == std::string::npos)
+				continue;
+
+			BenchmarkResult& result = results.emplace_back(RunBenchmark(name, benchmark.Function, range, settings));
+			PrintResult(result);
+			if (!result.Error.empty())
+				failed++;
+		}
+	}
+
+	if (!settings.JsonPath.empty() && WriteJson(settings.JsonPath, executable, results))
+		std::cout << "Wrote " << results.size() << " results to '" << settings.JsonPath << "'\n";
+
+	return failed;
+}
+
+void Benchmarks::Escape(const volatile void*)
+{
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+
+// Timed loop of one run. Everything a benchmark does before the first KeepRunning is setup and not
+// timed, the loop body runs exactly GetIterations times:
+//
+//	while (state.KeepRunning())
+//		DoNotOptimize(Work(input));
+class BenchmarkState
+{
+public:
+	BenchmarkState(int64_t range, uint64_t iterations)
+		: m_Range(range), m_Iterations(iterations) {}
+
+	bool KeepRunning()
+	{
+		if (m_Done == 0)
+		{
+			m_StartCpu = std::clock();
+			m_Start = std::chrono::steady_clock::now();
+		}
+
+		if (m_Done++ < m_Iterations)
+			return true;
+
+		m_RealSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_Start).count();
+		m_CpuSeconds = (double)(std::clock() - m_StartCpu) / CLOCKS_PER_SEC;
+		return false;
+	}
+
+	// The input size the benchmark was registered with, 0 without one
+	int64_t GetRange() const { return m_Range; }
+	uint64_t GetIterations() const { return m_Iterations; }
+
+	// Work done by one iteration, reported per second
+	void SetItemsPerIteration(uint64_t items) { m_ItemsPerIteration = items; }
+	void SetBytesPerIteration(uint64_t bytes) { m_BytesPerIteration = bytes; }
+	// Reported instead of the timings, for a benchmark that can not run
+	void SkipWithError(const std::string& error) { m_Error = error; m_Iterations = 0; }
+
+	double GetRealSeconds() const { return m_RealSeconds; }
+	// Process CPU time, the idle job system workers add nothing to it. MSVC's clock is wall time.
+	double GetCpuSeconds() const { return m_CpuSeconds; }
+	uint64_t GetItemsPerIteration() const { return m_ItemsPerIteration; }
+	uint64_t GetBytesPerIteration() const { return m_BytesPerIteration; }
+	const std::string& GetError() const { return m_Error; }
+
+private:
+	int64_t m_Range = 0;
+	uint64_t m_Iterations = 0;
+	uint64_t m_Done = 0;
+
+	std::chrono::steady_clock::time_point m_Start;
+	std::clock_t m_StartCpu = 0;
+	double m_RealSeconds = 0.0;
+	double m_CpuSeconds = 0.0;
+
+	uint64_t m_ItemsPerIteration = 0;
+	uint64_t m_BytesPerIteration = 0;
+	std::string m_Error;
+};
+
+using BenchmarkFunction = void(*)(BenchmarkState& state);
+
+struct BenchmarkSettings
+{
+	// Google Benchmark's JSON format, so its compare tooling reads the results
+	std::string JsonPath;
+	// Only benchmarks whose name contains it
+	std::string Filter;
+	// Iterations grow until a run takes at least this long
+	double MinSeconds = 0.5;
+	// Whatever the time, for quick runs under a debugger
+	uint64_t MaxIterations = 1000000000;
+};
+
+// Registry and runner for the microbenchmarks, modeled on Google Benchmark. Each benchmark runs once
+// per range it was registered with and is reported as "Name/range".
+class Benchmarks
+{
+public:
+	Benchmarks() = delete;
+	~Benchmarks() = delete;
+
+	static void Register(const std::string& name, BenchmarkFunction function, const std::vector<int64_t>& ranges = {});
+	// Powers of multiplier from first to last, last always included
+	static std::vector<int64_t> Range(int64_t first, int64_t last, int64_t multiplier = 10);
+
+	// Returns the number of benchmarks that failed
+	static uint32_t Run(const BenchmarkSettings& settings, const char* executable);
+
+	// Somewhere the compiler can not see through, so a result passed to DoNotOptimize counts as used
+	static void Escape(const volatile void* pointer);
+};
+
+template<typename T>
+inline void DoNotOptimize(const T& value)
+{
+	Benchmarks::Escape(&value);
+	std::atomic_signal_fence(std::memory_order_seq_cst);
+}
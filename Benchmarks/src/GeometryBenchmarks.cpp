@@ -0,0 +1,108 @@
+#include "Suites.h"
+
+#include <cstring>
+#include <filesystem>
+#include <span>
+
+#include <assimp/mesh.h>
+
+#include "Benchmark.h"
+#include "Geometry.h"
+#include "MeshFile.h"
+#include "ModelImporter.h"
+#include "SyntheticMesh.h"
+#include "Utils.h"
+
+static void BenchmarkAverageNormals(BenchmarkState& state)
+{
+	SyntheticMesh mesh = SyntheticMesh::CreateGrid((uint64_t)state.GetRange());
+	state.SetItemsPerIteration(mesh.GetVertexCount());
+
+	// Later iterations start from the normals of the previous one, which is the same amount of work
+	while (state.KeepRunning())
+	{
+		CalculateAverageNormals(mesh.Vertices.data(), (uint32_t)mesh.Vertices.size(), SyntheticMesh::Stride, mesh.Indices.data(), (uint32_t)mesh.Indices.size(), SyntheticMesh::NormalOffset);
+		DoNotOptimize(mesh.Vertices.data());
+	}
+}
+
+// What Assimp hands the importer, separate position, texture coordinate and normal arrays
+static void FillAssimpMesh(const SyntheticMesh& source, aiMesh& mesh)
+{
+	const uint32_t vertexCount = (uint32_t)source.GetVertexCount();
+	mesh.mNumVertices = vertexCount;
+	mesh.mVertices = new aiVector3D[vertexCount];
+	mesh.mNormals = new aiVector3D[vertexCount];
+	mesh.mTextureCoords[0] = new aiVector3D[vertexCount];
+	mesh.mNumUVComponents[0] = 2;
+	for (uint32_t i = 0; i < vertexCount; i++)
+	{
+		const float* vertex = &source.Vertices[(size_t)i * SyntheticMesh::Stride];
+		mesh.mVertices[i] = aiVector3D(vertex[0], vertex[1], vertex[2]);
+		mesh.mTextureCoords[0][i] = aiVector3D(vertex[3], vertex[4], 0.0f);
+		mesh.mNormals[i] = aiVector3D(0.0f, -1.0f, 0.0f);
+	}
+
+	mesh.mNumFaces = (uint32_t)(source.Indices.size() / 3);
+	mesh.mFaces = new aiFace[mesh.mNumFaces];
+	for (uint32_t i = 0; i < mesh.mNumFaces; i++)
+	{
+		mesh.mFaces[i].mNumIndices = 3;
+		mesh.mFaces[i].mIndices = new unsigned int[3];
+		memcpy(mesh.mFaces[i].mIndices, &source.Indices[(size_t)i * 3], 3 * sizeof(uint32_t));
+	}
+}
+
+// The vertex repacking of imported models, which Model::LoadMesh did before models were cooked
+static void BenchmarkImportMesh(BenchmarkState& state)
+{
+	const SyntheticMesh source = SyntheticMesh::CreateGrid((uint64_t)state.GetRange());
+	aiMesh mesh;
+	FillAssimpMesh(source, mesh);
+	state.SetItemsPerIteration(mesh.mNumVertices);
+
+	while (state.KeepRunning())
+	{
+		MeshFile file;
+		ModelImporter::ImportMesh(&mesh, file);
+		DoNotOptimize(file.Submeshes[0].Vertices.data());
+	}
+}
+
+// Loading a cooked mesh once its file is in memory. The view points into the data, so this should stay
+// flat across vertex counts.
+static void BenchmarkParseMeshFile(BenchmarkState& state)
+{
+	const std::filesystem::path path = std::filesystem::temp_directory_path() / "OpenGLCourseBenchmark.mesh";
+
+	MeshFile file;
+	MeshFileSubmesh& submesh = file.Submeshes.emplace_back();
+	SyntheticMesh mesh = SyntheticMesh::CreateGrid((uint64_t)state.GetRange());
+	submesh.Vertices = std::move(mesh.Vertices);
+	submesh.Indices = std::move(mesh.Indices);
+	file.Textures.push_back("textures/plain.png");
+
+	if (!MeshFile::Write(path, file))
+	{
+		state.SkipWithError("Could not write " + path.string());
+		return;
+	}
+
+	const std::vector<uint8_t> data = Utils::ReadFileToBytes(path);
+	std::filesystem::remove(path);
+
+	while (state.KeepRunning())
+	{
+		MeshFileView view;
+		MeshFile::Parse(std::as_bytes(std::span(data)), path.string(), view);
+		DoNotOptimize(view.Submeshes.data());
+	}
+}
+
+void RegisterGeometryBenchmarks()
+{
+	const std::vector<int64_t> vertexCounts = Benchmarks::Range(1000, 10000000);
+	Benchmarks::Register("CalculateAverageNormals", BenchmarkAverageNormals, vertexCounts);
+	Benchmarks::Register("ModelImporter::ImportMesh", BenchmarkImportMesh, vertexCounts);
+	Benchmarks::Register("MeshFile::Parse", BenchmarkParseMeshFile, vertexCounts);
+}
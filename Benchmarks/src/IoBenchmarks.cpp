@@ -0,0 +1,97 @@
+#include "Suites.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Benchmark.h"
+#include "FrameArena.h"
+#include "UniformLocations.h"
+#include "Utils.h"
+
+static void BenchmarkReadFileToString(BenchmarkState& state)
+{
+	const std::filesystem::path path = std::filesystem::temp_directory_path() / "OpenGLCourseBenchmark.glsl";
+	{
+		// Shader sized files at the small end, far beyond them at the large one
+		const std::string line = "uniform vec3 u_Color; // padding the synthetic source\n";
+		std::ofstream out(path, std::ios::out | std::ios::binary | std::ios::trunc);
+		for (int64_t written = 0; written < state.GetRange(); written += (int64_t)line.size())
+			out.write(line.data(), std::min<int64_t>((int64_t)line.size(), state.GetRange() - written));
+
+		if (!out)
+		{
+			state.SkipWithError("Could not write " + path.string());
+			return;
+		}
+	}
+
+	state.SetBytesPerIteration((uint64_t)state.GetRange());
+	while (state.KeepRunning())
+		DoNotOptimize(Utils::ReadFileToString(path));
+
+	std::filesystem::remove(path);
+}
+
+// Names like the main shader's: plain uniforms, then elements of light struct arrays and sampler arrays
+static std::vector<std::string> MakeUniformNames(int64_t count)
+{
+	std::vector<std::string> names = { "u_TransformIndex", "u_FaceMask", "u_DrawData", "u_ViewProjection", "u_EyePosition" };
+	for (int64_t i = 0; (int64_t)names.size() < count; i++)
+	{
+		names.push_back("u_PointLights[" + std::to_string(i) + "].Color");
+		names.push_back("u_PointLights[" + std::to_string(i) + "].Position");
+		names.push_back("u_OmniShadowMaps[" + std::to_string(i) + "].ShadowMap");
+		names.push_back("u_OmniShadowMaps[" + std::to_string(i) + "].FarPlane");
+	}
+
+	names.resize((size_t)count);
+	return names;
+}
+
+// The table Shader fills after linking and looks every name up in when uploading, per name
+static void BenchmarkUniformLookup(BenchmarkState& state)
+{
+	const std::vector<std::string> names = MakeUniformNames(state.GetRange());
+	UniformLocations uniforms;
+	for (size_t i = 0; i < names.size(); i++)
+		uniforms.Add(names[i], (int32_t)i);
+
+	state.SetItemsPerIteration(names.size());
+	while (state.KeepRunning())
+	{
+		for (const std::string& name : names)
+			DoNotOptimize(uniforms.Find(name.c_str()));
+	}
+}
+
+// The omni shadow map names are built every frame before they are looked up
+static void BenchmarkFormattedUniformLookup(BenchmarkState& state)
+{
+	const int64_t count = state.GetRange();
+	const std::vector<std::string> names = MakeUniformNames(count * 4 + 5);
+	UniformLocations uniforms;
+	for (size_t i = 0; i < names.size(); i++)
+		uniforms.Add(names[i], (int32_t)i);
+
+	FrameArena& arena = FrameArena::Get();
+	state.SetItemsPerIteration((uint64_t)count * 2);
+	while (state.KeepRunning())
+	{
+		for (int64_t i = 0; i < count; i++)
+		{
+			DoNotOptimize(uniforms.Find(arena.Format("u_OmniShadowMaps[{}].ShadowMap", i)));
+			DoNotOptimize(uniforms.Find(arena.Format("u_OmniShadowMaps[{}].FarPlane", i)));
+		}
+		arena.Reset();
+	}
+}
+
+void RegisterIoBenchmarks()
+{
+	Benchmarks::Register("Utils::ReadFileToString", BenchmarkReadFileToString, Benchmarks::Range(1000, 10000000));
+	Benchmarks::Register("Shader::UniformLookup", BenchmarkUniformLookup, Benchmarks::Range(8, 512, 4));
+	Benchmarks::Register("Shader::FormattedUniformLookup", BenchmarkFormattedUniformLookup, Benchmarks::Range(1, 100));
+}
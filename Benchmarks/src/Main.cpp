@@ -0,0 +1,30 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "Benchmark.h"
+#include "Suites.h"
+
+// Usage: Benchmarks [--json <file>] [--filter <text>] [--min-time <seconds>]
+// Needs no GPU and no window, the results go to the console and optionally to a JSON file
+int main(int argc, char** argv)
+{
+	BenchmarkSettings settings;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+			settings.JsonPath = argv[++i];
+		else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+			settings.Filter = argv[++i];
+		else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+			settings.MinSeconds = atof(argv[++i]);
+		else
+			std::cerr << "Unknown argument '" << argv[i] << "'\n";
+	}
+
+	RegisterGeometryBenchmarks();
+	RegisterSceneBenchmarks();
+	RegisterIoBenchmarks();
+
+	return Benchmarks::Run(settings, argv[0]) ? 1 : 0;
+}
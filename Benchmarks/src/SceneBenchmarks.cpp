@@ -0,0 +1,119 @@
+#include "Suites.h"
+
+#include <cmath>
+#include <filesystem>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Benchmark.h"
+#include "Camera.h"
+#include "Input.h"
+#include "InputRecording.h"
+#include "Lights.h"
+
+// The projections Main uses for the shadow maps
+static const glm::mat4 s_DirectionalProjection = glm::ortho(-20.0f, 20.0f, -20.0f, 20.0f, 0.1f, 100.0f);
+static const glm::mat4 s_OmniProjection = glm::perspective(glm::radians(90.0f), 1.0f, 0.01f, 100.0f);
+
+static constexpr float s_Timestep = 1.0f / 60.0f;
+
+static void BenchmarkDirectionalLightTransform(BenchmarkState& state)
+{
+	std::vector<DirectionalLight> lights((size_t)state.GetRange());
+	for (size_t i = 0; i < lights.size(); i++)
+		lights[i].Direction = glm::normalize(glm::vec3(std::sin((float)i), -1.0f, std::cos((float)i)));
+	state.SetItemsPerIteration(lights.size());
+
+	while (state.KeepRunning())
+	{
+		for (const DirectionalLight& light : lights)
+			DoNotOptimize(CalculateLightTransform(light, s_DirectionalProjection));
+	}
+}
+
+static void BenchmarkPointLightTransform(BenchmarkState& state)
+{
+	std::vector<PointLight> lights((size_t)state.GetRange());
+	for (size_t i = 0; i < lights.size(); i++)
+		lights[i].Position = glm::vec3(std::sin((float)i) * 10.0f, 2.0f, std::cos((float)i) * 10.0f);
+	state.SetItemsPerIteration(lights.size());
+
+	while (state.KeepRunning())
+	{
+		for (const PointLight& light : lights)
+			DoNotOptimize(CalculateLightTransform(light, s_OmniProjection));
+	}
+}
+
+static Camera CreateCamera()
+{
+	CameraSpecification spec;
+	spec.Position = glm::vec3(0.0f, 0.0f, 5.0f);
+	spec.WorldUp = glm::vec3(0.0f, 1.0f, 0.0f);
+	spec.Yaw = -60.0f;
+	spec.Pitch = 0.0f;
+	spec.Speed = 5.0f;
+	spec.TurnSpeed = 10.0f;
+	return Camera(spec);
+}
+
+// Input comes from a replay, so no window is needed: moving diagonally and turning on every frame,
+// the most work a frame can give the camera
+static void BenchmarkCameraUpdate(BenchmarkState& state)
+{
+	const std::filesystem::path path = std::filesystem::temp_directory_path() / "OpenGLCourseBenchmark.irec";
+	const uint32_t frames = (uint32_t)state.GetRange();
+
+	InputRecordWriter writer;
+	if (!writer.Open(path))
+	{
+		state.SkipWithError("Could not write " + path.string());
+		return;
+	}
+
+	InputState input;
+	input.Keys[W] = true;
+	input.Keys[D] = true;
+	for (uint32_t i = 0; i < frames; i++)
+	{
+		input.MousePosition = glm::vec2((float)i, std::sin((float)i * 0.01f) * 100.0f);
+		writer.Write((float)i * s_Timestep, input);
+	}
+	writer.Close((float)frames * s_Timestep);
+	state.SetItemsPerIteration(frames);
+
+	// Restarting the replay reads the recording, which is small next to the frames it feeds
+	while (state.KeepRunning())
+	{
+		Input::StartReplay(path, s_Timestep);
+		Camera camera = CreateCamera();
+		for (uint32_t i = 0; i < frames; i++)
+		{
+			camera.OnUpdate(Input::Update(s_Timestep));
+			DoNotOptimize(camera.CalculateViewMatrix());
+		}
+	}
+
+	Input::Stop();
+	std::filesystem::remove(path);
+}
+
+static void BenchmarkCameraViewMatrix(BenchmarkState& state)
+{
+	const Camera camera = CreateCamera();
+	state.SetItemsPerIteration(1);
+
+	while (state.KeepRunning())
+		DoNotOptimize(camera.CalculateViewMatrix());
+}
+
+void RegisterSceneBenchmarks()
+{
+	const std::vector<int64_t> lightCounts = Benchmarks::Range(1, 1000);
+	Benchmarks::Register("CalculateLightTransform/Directional", BenchmarkDirectionalLightTransform, lightCounts);
+	Benchmarks::Register("CalculateLightTransform/Point", BenchmarkPointLightTransform, lightCounts);
+	Benchmarks::Register("Camera::OnUpdate", BenchmarkCameraUpdate, Benchmarks::Range(1000, 100000));
+	Benchmarks::Register("Camera::CalculateViewMatrix", BenchmarkCameraViewMatrix);
+}
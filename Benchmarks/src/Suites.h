@@ -0,0 +1,8 @@
+#pragma once
+
+// Mesh processing, per vertex on synthetic grids of 1k to 10M vertices
+void RegisterGeometryBenchmarks();
+// Light transforms and the camera, per light and per frame
+void RegisterSceneBenchmarks();
+// File reads and shader uniform lookups
+void RegisterIoBenchmarks();
@@ -0,0 +1,36 @@
+#include "SyntheticMesh.h"
+
+#include <algorithm>
+#include <cmath>
+
+SyntheticMesh SyntheticMesh::CreateGrid(uint64_t vertexCount)
+{
+	const uint32_t width = std::max((uint32_t)std::ceil(std::sqrt((double)vertexCount)), 2u);
+	const uint32_t height = std::max((uint32_t)((vertexCount + width - 1) / width), 2u);
+
+	SyntheticMesh mesh;
+	mesh.Vertices.reserve((size_t)width * height * Stride);
+	for (uint32_t y = 0; y < height; y++)
+	{
+		for (uint32_t x = 0; x < width; x++)
+		{
+			const float u = (float)x / (float)(width - 1);
+			const float v = (float)y / (float)(height - 1);
+			// Uneven enough that neighbouring triangles have different normals
+			const float elevation = std::sin(u * 40.0f) * std::cos(v * 30.0f) * 0.1f;
+			mesh.Vertices.insert(mesh.Vertices.end(), { u * 2.0f - 1.0f, elevation, v * 2.0f - 1.0f, u, v, 0.0f, 0.0f, 0.0f });
+		}
+	}
+
+	mesh.Indices.reserve((size_t)(width - 1) * (height - 1) * 6);
+	for (uint32_t y = 0; y + 1 < height; y++)
+	{
+		for (uint32_t x = 0; x + 1 < width; x++)
+		{
+			const uint32_t corner = y * width + x;
+			mesh.Indices.insert(mesh.Indices.end(), { corner, corner + width, corner + 1, corner + 1, corner + width, corner + width + 1 });
+		}
+	}
+
+	return mesh;
+}
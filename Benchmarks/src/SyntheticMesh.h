@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// A square grid on a wavy surface, in the interleaved layout of the engine's meshes with the normals
+// left at zero. At least the requested vertex count, two triangles per grid cell.
+struct SyntheticMesh
+{
+	static constexpr uint32_t Stride = 8;
+	static constexpr uint32_t NormalOffset = 5;
+
+	std::vector<float> Vertices;
+	std::vector<uint32_t> Indices;
+
+	uint64_t GetVertexCount() const { return Vertices.size() / Stride; }
+
+	static SyntheticMesh CreateGrid(uint64_t vertexCount);
+};
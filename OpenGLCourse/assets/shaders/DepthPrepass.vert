@@ -0,0 +1,19 @@
+#version 450 core
+
+layout (location = 0) in vec3 a_Position;
+
+#include "Transforms.glsl"
+
+uniform mat4 u_View;
+uniform mat4 u_Projection;
+
+// Computed exactly like VertexShader.glsl, so the main pass lands on the same depth
+invariant gl_Position;
+
+void main()
+{
+	mat4 model = u_Transforms[u_TransformIndex].Model;
+	vec4 worldPosition = model * vec4(a_Position, 1.0f);
+
+	gl_Position = u_Projection * u_View * worldPosition;
+}
\ No newline at end of file
@@ -2,10 +2,11 @@
 
 layout (location = 0) in vec3 a_Position;
 
-uniform mat4 u_Model;
+#include "Transforms.glsl"
+
 uniform mat4 u_LightSpaceTransform;
 
 void main()
 {
-	gl_Position = u_LightSpaceTransform * u_Model * vec4(a_Position, 1.0f);
+	gl_Position = u_LightSpaceTransform * u_Transforms[u_TransformIndex].Model * vec4(a_Position, 1.0f);
 }
\ No newline at end of file
@@ -8,133 +8,80 @@ layout (location = 2) in vec3 v_Normal;
 layout (location = 3) in vec3 v_FragPos;
 layout (location = 4) in vec4 v_DirectionalLightSpacePos;
 
-const int MAX_POINT_LIGHTS = 3;
-const int MAX_SPOT_LIGHTS = 3;
+#include "Lighting.glsl"
 
-struct LightBase
-{
-	vec3 Color;
-	float AmbientIntensity;
-	float DiffuseIntensity;
-};
+const int MAX_TEXTURE_ARRAYS = 7;
 
-struct DirectionalLight
+struct Material
 {
-	LightBase Base;
-	vec3 Direction;
+	float SpecularIntensity;
+	float Shininess;
+	vec2 Padding;
 };
 
-struct PointLight
+layout (std430, binding = 0) readonly buffer MaterialData
 {
-	LightBase Base;
-	vec3 Position;
-	float Constant;
-	float Linear;
-	float Exponent;
+	Material u_Materials[];
 };
 
-struct SpotLight
-{
-	PointLight Base;
-	vec3 Direction;
-	float Edge;
-};
+// x: material index, y: texture array, z: layer in that array, w: finest mip level streamed in so far
+uniform ivec4 u_DrawData;
 
-struct OmniShadowMap
-{
-	samplerCube ShadowMap;
-	float FarPlane;
-};
+uniform sampler2DArray u_TextureArrays[MAX_TEXTURE_ARRAYS];
 
-layout (std140, binding = 0) uniform DirectionalLightData
-{
-	DirectionalLight u_DirectionalLight;
-};
+// Set when ShadowMask.frag already evaluated the shadows of this frame at half resolution
+uniform bool u_ShadowMaskEnabled;
+uniform sampler2D u_ShadowMask[2];
+uniform ivec2 u_ShadowMaskSize;
 
-layout (std140, binding = 1) uniform PointLightData
-{
-	PointLight u_PointLights[MAX_POINT_LIGHTS];
-};
+// Upsampled shadow mask of this fragment, the channels are laid out as in ShadowMask.frag
+vec4 g_ShadowMask[2];
 
-layout (std140, binding = 2) uniform SpotLightData
+// Joint bilateral upsample, the four nearest mask texels weighted by distance and by how close the
+// surface they saw is to this one, so shadows do not bleed across depth edges
+void UpsampleShadowMask()
 {
-	SpotLight u_SpotLights[MAX_SPOT_LIGHTS];
-};
+	// Mask texel t was evaluated at scene pixel 2t
+	vec2 position = (gl_FragCoord.xy - 0.5f) * 0.5f;
+	ivec2 base = ivec2(floor(position));
+	vec2 fraction = position - vec2(base);
+	float distance = length(u_EyePosition - v_FragPos);
 
-layout (std140, binding = 3) uniform Material
-{
-	float SpecularIntensity;
-	float Shininess;
-} u_Material;
-
-uniform sampler2D u_Texture;
-uniform sampler2D u_DirectionalShadowMap;
-uniform OmniShadowMap u_OmniShadowMaps[MAX_POINT_LIGHTS + MAX_SPOT_LIGHTS];
-
-uniform vec3 u_EyePosition;
-uniform int u_PointLightCount;
-uniform int u_SpotLightCount;
-
-vec3 gridSamplingDisk[20] = vec3[]
-(
-   vec3(1, 1,  1), vec3( 1, -1,  1), vec3(-1, -1,  1), vec3(-1, 1,  1), 
-   vec3(1, 1, -1), vec3( 1, -1, -1), vec3(-1, -1, -1), vec3(-1, 1, -1),
-   vec3(1, 1,  0), vec3( 1, -1,  0), vec3(-1, -1,  0), vec3(-1, 1,  0),
-   vec3(1, 0,  1), vec3(-1,  0,  1), vec3( 1,  0, -1), vec3(-1, 0, -1),
-   vec3(0, 1,  1), vec3( 0, -1,  1), vec3( 0, -1, -1), vec3( 0, 1, -1)
-);
-
-float CalculateDirectionalShadowFactor(DirectionalLight light)
-{
-	vec3 projCoords = v_DirectionalLightSpacePos.xyz / v_DirectionalLightSpacePos.w;
-	projCoords = (projCoords * 0.5f) + 0.5f;
-
-	if (projCoords.z > 1.0f)
-		return 0.0f;
-
-	float currentDepth = projCoords.z;
-
-	vec3 normal = normalize(v_Normal);
-	vec3 lightDir = normalize(light.Direction);
-	float bias = max(0.05f * (1 - dot(normal, lightDir)), 0.0005f);
-
-	float shadow = 0.0f;
-	vec2 texelSize = 1.0f / textureSize(u_DirectionalShadowMap, 0);
-	for (int x = -1; x <= 1; x++)
+	vec4 maskA = vec4(0.0f);
+	vec4 maskB = vec4(0.0f);
+	float totalWeight = 0.0f;
+	for (int i = 0; i < 4; i++)
 	{
-		for (int y = -1; y <= 1; y++)
-		{
-			float pcfDepth = texture(u_DirectionalShadowMap, projCoords.xy + vec2(x,y) * texelSize).r;
-			shadow += currentDepth - bias > pcfDepth ? 1.0f : 0.0f;
-		}
+		ivec2 offset = ivec2(i & 1, i >> 1);
+		ivec2 texel = clamp(base + offset, ivec2(0), u_ShadowMaskSize - 1);
+		vec4 a = texelFetch(u_ShadowMask[0], texel, 0);
+		vec4 b = texelFetch(u_ShadowMask[1], texel, 0);
+
+		vec2 bilinear = mix(1.0f - fraction, fraction, vec2(offset));
+		float weight = bilinear.x * bilinear.y / (0.001f + abs(b.w - distance) / distance);
+		maskA += a * weight;
+		maskB += b * weight;
+		totalWeight += weight;
 	}
 
-	shadow /= 9.0f;
-	return shadow;
+	g_ShadowMask[0] = maskA / max(totalWeight, 1e-6f);
+	g_ShadowMask[1] = maskB / max(totalWeight, 1e-6f);
 }
 
-float CaculateOmniShadowFactor(PointLight light, int shadowIndex)
+float GetDirectionalShadowFactor()
 {
-	vec3 fragToLight = v_FragPos - light.Position;
-	float currentDepth = length(fragToLight);
-
-	float shadow = 0.0f;
-	float bias = 0.05f;
-	int samples = 20;
+	if (u_ShadowMaskEnabled)
+		return g_ShadowMask[0].x;
 
-	float viewDistance = length(u_EyePosition - v_FragPos);
-	float diskRadius = (1.0f + (viewDistance / u_OmniShadowMaps[shadowIndex].FarPlane)) / 25.0f;
+	return CalculateDirectionalShadowFactor(u_DirectionalLight, v_DirectionalLightSpacePos, normalize(v_Normal));
+}
 
-	for (int i = 0; i < samples; i++)
-	{
-		float closestDepth = texture(u_OmniShadowMaps[shadowIndex].ShadowMap, fragToLight + gridSamplingDisk[i] * diskRadius).r;
-		closestDepth *= u_OmniShadowMaps[shadowIndex].FarPlane;
-		if (currentDepth - bias > closestDepth)
-			shadow += 1.0f;
-	}
+float GetOmniShadowFactor(PointLight light, int shadowIndex)
+{
+	if (u_ShadowMaskEnabled)
+		return g_ShadowMask[(shadowIndex + 1) / 4][(shadowIndex + 1) % 4];
 
-	shadow /= float(samples);
-	return shadow;
+	return CaculateOmniShadowFactor(light, shadowIndex, v_FragPos);
 }
 
 vec4 CalculateLightByDirection(LightBase light, vec3 direction, float shadowFactor)
@@ -154,8 +101,9 @@ vec4 CalculateLightByDirection(LightBase light, vec3 direction, float shadowFact
 
 		if (specularFactor > 0.0f)
 		{
-			specularFactor = pow(specularFactor, u_Material.Shininess);
-			specularColor = vec4(light.Color * u_Material.SpecularIntensity * specularFactor, 1.0f);
+			Material material = u_Materials[u_DrawData.x];
+			specularFactor = pow(specularFactor, material.Shininess);
+			specularColor = vec4(light.Color * material.SpecularIntensity * specularFactor, 1.0f);
 		}
 	}
 
@@ -164,7 +112,7 @@ vec4 CalculateLightByDirection(LightBase light, vec3 direction, float shadowFact
 
 vec4 CalculateDirectionalLight()
 {
-	float shadowFactor = CalculateDirectionalShadowFactor(u_DirectionalLight);
+	float shadowFactor = GetDirectionalShadowFactor();
 	return CalculateLightByDirection(u_DirectionalLight.Base, u_DirectionalLight.Direction, shadowFactor);
 }
 
@@ -174,7 +122,7 @@ vec4 CalculatePointLight(PointLight light, int shadowIndex)
 	float distance = length(direction);
 	direction = normalize(direction);
 
-	float shadowFactor = CaculateOmniShadowFactor(light, shadowIndex);
+	float shadowFactor = GetOmniShadowFactor(light, shadowIndex);
 	vec4 color = CalculateLightByDirection(light.Base, direction, shadowFactor);
 
 	// Ax^2 + Bx + C
@@ -219,8 +167,13 @@ vec4 CalculateSpotLights()
 
 void main()
 {
+	if (u_ShadowMaskEnabled)
+		UpsampleShadowMask();
+
 	vec4 finalColor = CalculateDirectionalLight();
 	finalColor += CalculatePointLights();
 	finalColor += CalculateSpotLights();
-	o_Color = texture(u_Texture, v_TexCoords) * finalColor;
+	// Levels finer than the resident one hold no data yet
+	float lod = max(textureQueryLod(u_TextureArrays[u_DrawData.y], v_TexCoords).y, float(u_DrawData.w));
+	o_Color = textureLod(u_TextureArrays[u_DrawData.y], vec3(v_TexCoords, u_DrawData.z), lod) * finalColor;
 }
\ No newline at end of file
@@ -0,0 +1,128 @@
+// Lights and their shadows, shared by the main pass and the shadow mask
+
+const int MAX_POINT_LIGHTS = 3;
+const int MAX_SPOT_LIGHTS = 3;
+
+struct LightBase
+{
+	vec3 Color;
+	float AmbientIntensity;
+	float DiffuseIntensity;
+};
+
+struct DirectionalLight
+{
+	LightBase Base;
+	vec3 Direction;
+};
+
+struct PointLight
+{
+	LightBase Base;
+	vec3 Position;
+	float Constant;
+	float Linear;
+	float Exponent;
+};
+
+struct SpotLight
+{
+	PointLight Base;
+	vec3 Direction;
+	float Edge;
+};
+
+struct OmniShadowMap
+{
+	samplerCube ShadowMap;
+	float FarPlane;
+};
+
+layout (std140, binding = 0) uniform DirectionalLightData
+{
+	DirectionalLight u_DirectionalLight;
+};
+
+layout (std140, binding = 1) uniform PointLightData
+{
+	PointLight u_PointLights[MAX_POINT_LIGHTS];
+};
+
+layout (std140, binding = 2) uniform SpotLightData
+{
+	SpotLight u_SpotLights[MAX_SPOT_LIGHTS];
+};
+
+uniform sampler2D u_DirectionalShadowMap;
+uniform OmniShadowMap u_OmniShadowMaps[MAX_POINT_LIGHTS + MAX_SPOT_LIGHTS];
+
+uniform vec3 u_EyePosition;
+uniform int u_PointLightCount;
+uniform int u_SpotLightCount;
+
+vec3 gridSamplingDisk[20] = vec3[]
+(
+   vec3(1, 1,  1), vec3( 1, -1,  1), vec3(-1, -1,  1), vec3(-1, 1,  1), 
+   vec3(1, 1, -1), vec3( 1, -1, -1), vec3(-1, -1, -1), vec3(-1, 1, -1),
+   vec3(1, 1,  0), vec3( 1, -1,  0), vec3(-1, -1,  0), vec3(-1, 1,  0),
+   vec3(1, 0,  1), vec3(-1,  0,  1), vec3( 1,  0, -1), vec3(-1, 0, -1),
+   vec3(0, 1,  1), vec3( 0, -1,  1), vec3( 0, -1, -1), vec3( 0, 1, -1)
+);
+
+float CalculateDirectionalShadowFactor(DirectionalLight light, vec4 lightSpacePos, vec3 normal)
+{
+	vec3 projCoords = lightSpacePos.xyz / lightSpacePos.w;
+	projCoords = (projCoords * 0.5f) + 0.5f;
+
+	if (projCoords.z > 1.0f)
+		return 0.0f;
+
+	float currentDepth = projCoords.z;
+
+	vec3 lightDir = normalize(light.Direction);
+	float bias = max(0.05f * (1 - dot(normal, lightDir)), 0.0005f);
+
+	float shadow = 0.0f;
+	vec2 texelSize = 1.0f / textureSize(u_DirectionalShadowMap, 0);
+	for (int x = -1; x <= 1; x++)
+	{
+		for (int y = -1; y <= 1; y++)
+		{
+			float pcfDepth = texture(u_DirectionalShadowMap, projCoords.xy + vec2(x,y) * texelSize).r;
+			shadow += currentDepth - bias > pcfDepth ? 1.0f : 0.0f;
+		}
+	}
+
+	shadow /= 9.0f;
+	return shadow;
+}
+
+float CaculateOmniShadowFactor(PointLight light, int shadowIndex, vec3 fragPos)
+{
+	vec3 fragToLight = fragPos - light.Position;
+	float currentDepth = length(fragToLight);
+
+	float shadow = 0.0f;
+	float bias = 0.05f;
+	int samples = 20;
+
+	float viewDistance = length(u_EyePosition - fragPos);
+	float diskRadius = (1.0f + (viewDistance / u_OmniShadowMaps[shadowIndex].FarPlane)) / 25.0f;
+
+	for (int i = 0; i < samples; i++)
+	{
+		float closestDepth = texture(u_OmniShadowMaps[shadowIndex].ShadowMap, fragToLight + gridSamplingDisk[i] * diskRadius).r;
+		closestDepth *= u_OmniShadowMaps[shadowIndex].FarPlane;
+		if (currentDepth - bias > closestDepth)
+			shadow += 1.0f;
+	}
+
+	shadow /= float(samples);
+	return shadow;
+}
+
+// Point lights first, then the spot lights, the same order as the omni shadow maps
+PointLight GetShadowedLight(int shadowIndex)
+{
+	return shadowIndex < u_PointLightCount ? u_PointLights[shadowIndex] : u_SpotLights[shadowIndex - u_PointLightCount].Base;
+}
\ No newline at end of file
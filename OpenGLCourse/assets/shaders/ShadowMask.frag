@@ -0,0 +1,47 @@
+#version 450 core
+
+#include "Lighting.glsl"
+
+// x: directional light, yzw: omni shadow maps 0 to 2
+layout (location = 0) out vec4 o_MaskA;
+// xyz: omni shadow maps 3 to 5, w: distance to the eye
+layout (location = 1) out vec4 o_MaskB;
+
+uniform sampler2D u_SceneDepth;
+uniform ivec2 u_SceneSize;
+uniform mat4 u_InverseViewProjection;
+uniform mat4 u_LightSpaceTransform;
+
+// Larger than any surface distance, the upsample gives sky texels no weight next to geometry
+const float SKY_DISTANCE = 60000.0f;
+
+void main()
+{
+	// Every mask texel stands for the top left scene pixel of the 2x2 it covers, the upsample relies on that
+	ivec2 pixel = min(ivec2(gl_FragCoord.xy) * 2, u_SceneSize - 1);
+	float depth = texelFetch(u_SceneDepth, pixel, 0).r;
+
+	vec2 ndc = (vec2(pixel) + 0.5f) / vec2(u_SceneSize) * 2.0f - 1.0f;
+	vec4 world = u_InverseViewProjection * vec4(ndc, depth * 2.0f - 1.0f, 1.0f);
+	vec3 fragPos = world.xyz / world.w;
+
+	// Derivatives before any branch, they are undefined in divergent control flow
+	vec3 normal = normalize(cross(dFdx(fragPos), dFdy(fragPos)));
+	if (dot(normal, u_EyePosition - fragPos) < 0.0f)
+		normal = -normal;
+
+	if (depth >= 1.0f)
+	{
+		o_MaskA = vec4(0.0f);
+		o_MaskB = vec4(0.0f, 0.0f, 0.0f, SKY_DISTANCE);
+		return;
+	}
+
+	float shadows[MAX_POINT_LIGHTS + MAX_SPOT_LIGHTS] = float[](0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+	for (int i = 0; i < u_PointLightCount + u_SpotLightCount; i++)
+		shadows[i] = CaculateOmniShadowFactor(GetShadowedLight(i), i, fragPos);
+
+	float directional = CalculateDirectionalShadowFactor(u_DirectionalLight, u_LightSpaceTransform * vec4(fragPos, 1.0f), normal);
+	o_MaskA = vec4(directional, shadows[0], shadows[1], shadows[2]);
+	o_MaskB = vec4(shadows[3], shadows[4], shadows[5], length(u_EyePosition - fragPos));
+}
\ No newline at end of file
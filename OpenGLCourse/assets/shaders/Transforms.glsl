@@ -0,0 +1,14 @@
+// The transform storage buffer every vertex shader indexes, see ObjectTransform in TransformHierarchy.h
+
+struct ObjectTransform
+{
+	mat4 Model;
+	mat4 Normal;
+};
+
+layout (std430, binding = 1) readonly buffer TransformData
+{
+	ObjectTransform u_Transforms[];
+};
+
+uniform int u_TransformIndex;
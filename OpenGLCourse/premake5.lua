@@ -29,6 +29,11 @@ project "OpenGLCourse"
 		"GLFW_INCLUDE_NONE"
 	}
 
+	filter "options:gl-instrumentation"
+		defines { "GL_INSTRUMENTATION" }
+
+	filter {}
+
 	links
 	{
 		"GLFW",
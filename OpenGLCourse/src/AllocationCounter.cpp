@@ -0,0 +1,81 @@
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static thread_local uint64_t t_Count = 0;
+static thread_local bool t_Ignored = false;
+static std::atomic<uint64_t> s_TotalCount = 0;
+
+static void Count()
+{
+	t_Count++;
+	if (!t_Ignored)
+		s_TotalCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t AllocationCounter::GetThreadCount()
+{
+	return t_Count;
+}
+
+uint64_t AllocationCounter::GetTotalCount()
+{
+	return s_TotalCount.load(std::memory_order_relaxed);
+}
+
+void AllocationCounter::IgnoreThread()
+{
+	t_Ignored = true;
+}
+
+// The array and nothrow forms call these, only the aligned ones need their own
+void* operator new(size_t size)
+{
+	Count();
+	if (void* pointer = std::malloc(size ? size : 1))
+		return pointer;
+
+	throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	Count();
+	const size_t align = (size_t)alignment;
+	size = size ? size : 1;
+#ifdef _WIN32
+	void* pointer = _aligned_malloc(size, align);
+#else
+	void* pointer = std::aligned_alloc(align, (size + align - 1) / align * align);
+#endif
+	if (pointer)
+		return pointer;
+
+	throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept
+{
+#ifdef _WIN32
+	_aligned_free(pointer);
+#else
+	std::free(pointer);
+#endif
+}
+
+void operator delete(void* pointer, size_t, std::align_val_t alignment) noexcept
+{
+	operator delete(pointer, alignment);
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+
+// Counts calls to the global operator new, which this module replaces. The bench takes the total
+// count of every thread around its steady-state frames to check that they do not allocate.
+class AllocationCounter
+{
+public:
+	AllocationCounter() = delete;
+	~AllocationCounter() = delete;
+
+	// Allocations made by the calling thread so far
+	static uint64_t GetThreadCount();
+	// Allocations made by all threads so far, except the ignored ones
+	static uint64_t GetTotalCount();
+	// Leaves the allocations of the calling thread out of the total, for background threads whose
+	// work is not part of any frame
+	static void IgnoreThread();
+};
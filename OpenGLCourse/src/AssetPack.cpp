@@ -0,0 +1,269 @@
+#include "AssetPack.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <Windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+#include "Lz4.h"
+#include "Utils.h"
+
+static constexpr uint32_t s_Magic = 0x504C474F; // "OGLP"
+
+struct AssetPackHeader
+{
+	uint32_t Magic = s_Magic;
+	uint32_t Version = AssetPack::Version;
+	uint32_t EntryCount = 0;
+	uint32_t Padding = 0;
+	uint64_t IndexOffset = 0;
+	uint64_t NamesOffset = 0;
+	uint64_t NamesSize = 0;
+};
+
+struct AssetPackEntry
+{
+	uint64_t NameHash = 0;
+	uint64_t ContentHash = 0;
+	uint64_t Offset = 0;
+	uint64_t Size = 0;
+	// Equal to Size when the blob is stored as is
+	uint64_t StoredSize = 0;
+	uint32_t NameOffset = 0;
+	uint32_t NameLength = 0;
+};
+
+static uint64_t HashName(std::string_view name)
+{
+	return Utils::Hash(name.data(), name.size());
+}
+
+AssetPack::~AssetPack()
+{
+	Close();
+}
+
+bool AssetPack::Open(const std::filesystem::path& path)
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize;
+	HANDLE mapping = GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0 ? CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+	const void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	if (!view)
+	{
+		if (mapping)
+			CloseHandle(mapping);
+
+		CloseHandle(file);
+		std::cerr << "Could not map asset pack '" << path.string() << "'\n";
+		return false;
+	}
+
+	m_FileHandle = file;
+	m_MappingHandle = mapping;
+	m_Size = (size_t)fileSize.QuadPart;
+#else
+	const int file = open(path.c_str(), O_RDONLY);
+	if (file < 0)
+		return false;
+
+	struct stat status;
+	void* view = fstat(file, &status) == 0 && status.st_size > 0 ? mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0) : MAP_FAILED;
+	// The mapping keeps the file alive on its own
+	close(file);
+	if (view == MAP_FAILED)
+	{
+		std::cerr << "Could not map asset pack '" << path.string() << "'\n";
+		return false;
+	}
+
+	m_Size = (size_t)status.st_size;
+#endif
+
+	m_Data = static_cast<const std::byte*>(view);
+
+	AssetPackHeader header;
+	if (m_Size >= sizeof(header))
+		std::memcpy(&header, m_Data, sizeof(header));
+
+	const bool valid = m_Size >= sizeof(header) && header.Magic == s_Magic && header.Version == Version
+		&& header.IndexOffset % alignof(AssetPackEntry) == 0 && header.IndexOffset + (uint64_t)header.EntryCount * sizeof(AssetPackEntry) <= m_Size
+		&& header.NamesOffset + header.NamesSize <= m_Size;
+	if (!valid)
+	{
+		std::cerr << "'" << path.string() << "' is not a version " << Version << " asset pack\n";
+		Close();
+		return false;
+	}
+
+	m_Entries = reinterpret_cast<const AssetPackEntry*>(m_Data + header.IndexOffset);
+	m_EntryCount = header.EntryCount;
+	m_Names = reinterpret_cast<const char*>(m_Data + header.NamesOffset);
+
+	for (uint32_t i = 0; i < m_EntryCount; i++)
+	{
+		const AssetPackEntry& entry = m_Entries[i];
+		if (entry.Offset + entry.StoredSize > m_Size || (uint64_t)entry.NameOffset + entry.NameLength > header.NamesSize || entry.StoredSize > entry.Size)
+		{
+			std::cerr << "Asset pack '" << path.string() << "' is truncated\n";
+			Close();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void AssetPack::Close()
+{
+	std::scoped_lock lock(m_Mutex);
+	m_Decompressed.clear();
+
+	if (m_Data)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(m_Data);
+		CloseHandle(m_MappingHandle);
+		CloseHandle(m_FileHandle);
+		m_MappingHandle = nullptr;
+		m_FileHandle = nullptr;
+#else
+		munmap(const_cast<std::byte*>(m_Data), m_Size);
+#endif
+	}
+
+	m_Data = nullptr;
+	m_Size = 0;
+	m_Entries = nullptr;
+	m_EntryCount = 0;
+	m_Names = nullptr;
+}
+
+AssetPackBlob AssetPack::Find(std::string_view name) const
+{
+	if (!m_Data)
+		return {};
+
+	const uint64_t hash = HashName(name);
+	const AssetPackEntry* end = m_Entries + m_EntryCount;
+	const AssetPackEntry* entry = std::lower_bound(m_Entries, end, hash, [](const AssetPackEntry& e, uint64_t h) { return e.NameHash < h; });
+
+	for (; entry != end && entry->NameHash == hash; entry++)
+	{
+		if (std::string_view(m_Names + entry->NameOffset, entry->NameLength) != name)
+			continue;
+
+		AssetPackBlob blob;
+		blob.ContentHash = entry->ContentHash;
+		if (entry->StoredSize == entry->Size)
+		{
+			blob.Data = std::span<const std::byte>(m_Data + entry->Offset, entry->Size);
+			return blob;
+		}
+
+		std::scoped_lock lock(m_Mutex);
+		const uint32_t index = (uint32_t)(entry - m_Entries);
+		auto it = m_Decompressed.find(index);
+		if (it == m_Decompressed.end())
+		{
+			std::vector<std::byte> data(entry->Size);
+			const auto* source = reinterpret_cast<const uint8_t*>(m_Data + entry->Offset);
+			if (!Lz4::Decompress(source, entry->StoredSize, reinterpret_cast<uint8_t*>(data.data()), data.size()))
+			{
+				std::cerr << "Asset '" << name << "' in the pack is corrupt\n";
+				return {};
+			}
+
+			it = m_Decompressed.emplace(index, std::move(data)).first;
+		}
+
+		blob.Data = it->second;
+		return blob;
+	}
+
+	return {};
+}
+
+bool AssetPack::Write(const std::filesystem::path& path, const std::vector<AssetPackInput>& inputs, bool compress)
+{
+	std::ofstream out(path, std::ios::out | std::ios::binary);
+	if (!out)
+	{
+		std::cerr << "Could not open '" << path.string() << "' for writing\n";
+		return false;
+	}
+
+	uint64_t offset = 0;
+	auto write = [&](const void* data, size_t size)
+	{
+		out.write(static_cast<const char*>(data), (std::streamsize)size);
+		offset += size;
+	};
+	auto align = [&](uint64_t alignment)
+	{
+		static constexpr char zeros[Alignment] = {};
+		write(zeros, (size_t)((alignment - offset % alignment) % alignment));
+	};
+
+	// The header is written again once the offsets are known
+	AssetPackHeader header;
+	write(&header, sizeof(header));
+
+	std::vector<AssetPackEntry> entries;
+	std::string names;
+	for (const AssetPackInput& input : inputs)
+	{
+		AssetPackEntry entry;
+		entry.NameHash = HashName(input.Name);
+		entry.ContentHash = Utils::Hash(input.Data.data(), input.Data.size());
+		entry.Size = input.Data.size();
+		entry.NameOffset = (uint32_t)names.size();
+		entry.NameLength = (uint32_t)input.Name.size();
+		names += input.Name;
+
+		std::vector<uint8_t> compressed;
+		if (compress)
+			compressed = Lz4::Compress(input.Data.data(), input.Data.size());
+
+		const bool useCompressed = compress && compressed.size() <= input.Data.size() - input.Data.size() / 8;
+		const std::vector<uint8_t>& stored = useCompressed ? compressed : input.Data;
+
+		align(Alignment);
+		entry.Offset = offset;
+		entry.StoredSize = stored.size();
+		write(stored.data(), stored.size());
+		entries.push_back(entry);
+	}
+
+	std::sort(entries.begin(), entries.end(), [](const AssetPackEntry& a, const AssetPackEntry& b) { return a.NameHash < b.NameHash; });
+
+	align(alignof(AssetPackEntry));
+	header.EntryCount = (uint32_t)entries.size();
+	header.IndexOffset = offset;
+	write(entries.data(), entries.size() * sizeof(AssetPackEntry));
+
+	header.NamesOffset = offset;
+	header.NamesSize = names.size();
+	write(names.data(), names.size());
+
+	out.seekp(0);
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	return (bool)out;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct AssetPackInput
+{
+	std::string Name;
+	std::vector<uint8_t> Data;
+};
+
+struct AssetPackBlob
+{
+	std::span<const std::byte> Data;
+	// Utils::Hash of the uncompressed data, computed when the pack was written
+	uint64_t ContentHash = 0;
+
+	explicit operator bool() const { return !Data.empty(); }
+};
+
+struct AssetPackEntry;
+
+// Every cooked asset in one file that is mapped once. Blobs start on Alignment byte boundaries and
+// the index is sorted by a hash of the names, so a lookup is a binary search and the result a view
+// straight into the mapping, ready to hand to GL without a copy. Blobs can be LZ4 compressed, those
+// are decompressed on their first lookup and kept for as long as the pack is open.
+class AssetPack
+{
+public:
+	AssetPack() = default;
+	AssetPack(const AssetPack&) = delete;
+	~AssetPack();
+
+	bool Open(const std::filesystem::path& path);
+	void Close();
+	bool IsOpen() const { return m_Data != nullptr; }
+
+	// Empty when the pack does not have it, otherwise valid until Close
+	AssetPackBlob Find(std::string_view name) const;
+	uint32_t GetEntryCount() const { return m_EntryCount; }
+
+	// Blobs are only stored compressed when that saves at least an eighth of their size
+	static bool Write(const std::filesystem::path& path, const std::vector<AssetPackInput>& inputs, bool compress);
+
+	static constexpr uint32_t Version = 1;
+	// A cache line, and more than any vertex, index or texture block format needs
+	static constexpr uint64_t Alignment = 64;
+
+private:
+	const std::byte* m_Data = nullptr;
+	size_t m_Size = 0;
+	const AssetPackEntry* m_Entries = nullptr;
+	uint32_t m_EntryCount = 0;
+	const char* m_Names = nullptr;
+
+#ifdef _WIN32
+	void* m_FileHandle = nullptr;
+	void* m_MappingHandle = nullptr;
+#endif
+
+	// Compressed blobs by index, once they have been looked up
+	mutable std::mutex m_Mutex;
+	mutable std::unordered_map<uint32_t, std::vector<std::byte>> m_Decompressed;
+};
@@ -0,0 +1,107 @@
+#include "AssetPackBenchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "AssetPack.h"
+#include "Utils.h"
+
+static constexpr uint32_t s_AssetCount = 4096;
+static constexpr uint32_t s_MinAssetSize = 256;
+static constexpr uint32_t s_MaxAssetSize = 16 * 1024;
+static constexpr uint32_t s_Iterations = 5;
+
+static double MeasureMs(const auto& function)
+{
+	const auto start = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < s_Iterations; i++)
+		function();
+
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / s_Iterations;
+}
+
+void RunAssetPackBenchmark()
+{
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "OpenGLCourseAssetPackBenchmark";
+	std::error_code error;
+	std::filesystem::remove_all(directory, error);
+	std::filesystem::create_directories(directory / "loose", error);
+
+	// Somewhat compressible, like vertex data and small textures
+	std::mt19937 random(42);
+	std::vector<AssetPackInput> inputs(s_AssetCount);
+	for (uint32_t i = 0; i < s_AssetCount; i++)
+	{
+		AssetPackInput& input = inputs[i];
+		input.Name = "textures/asset_" + std::to_string(i) + ".dds";
+		input.Data.resize(s_MinAssetSize + random() % (s_MaxAssetSize - s_MinAssetSize));
+		for (size_t j = 0; j < input.Data.size(); j++)
+			input.Data[j] = (uint8_t)(j % 64 < 48 ? j / 64 : random());
+
+		std::ofstream out(directory / "loose" / ("asset_" + std::to_string(i) + ".dds"), std::ios::out | std::ios::binary);
+		out.write(reinterpret_cast<const char*>(input.Data.data()), (std::streamsize)input.Data.size());
+	}
+
+	AssetPack::Write(directory / "assets.pack", inputs, false);
+	AssetPack::Write(directory / "compressed.pack", inputs, true);
+
+	// Random order, so neither side gets to read sequentially
+	std::vector<uint32_t> order(s_AssetCount);
+	for (uint32_t i = 0; i < s_AssetCount; i++)
+		order[i] = i;
+	std::shuffle(order.begin(), order.end(), random);
+
+	// Every variant hashes what it got, which touches every byte and keeps the reads from being optimized out
+	uint64_t looseHash = 0, packHash = 0, compressedHash = 0;
+	const double looseMs = MeasureMs([&]
+	{
+		for (const uint32_t i : order)
+		{
+			const std::vector<uint8_t> data = Utils::ReadFileToBytes(directory / "loose" / ("asset_" + std::to_string(i) + ".dds"));
+			looseHash += Utils::Hash(data.data(), data.size());
+		}
+	});
+
+	// Opening is part of it, the app maps the pack once at startup
+	const double packMs = MeasureMs([&]
+	{
+		AssetPack pack;
+		pack.Open(directory / "assets.pack");
+		for (const uint32_t i : order)
+		{
+			const AssetPackBlob blob = pack.Find(inputs[i].Name);
+			packHash += Utils::Hash(blob.Data.data(), blob.Data.size());
+		}
+	});
+
+	const double compressedMs = MeasureMs([&]
+	{
+		AssetPack pack;
+		pack.Open(directory / "compressed.pack");
+		for (const uint32_t i : order)
+		{
+			const AssetPackBlob blob = pack.Find(inputs[i].Name);
+			compressedHash += Utils::Hash(blob.Data.data(), blob.Data.size());
+		}
+	});
+
+	uint64_t looseBytes = 0;
+	for (const AssetPackInput& input : inputs)
+		looseBytes += input.Data.size();
+
+	std::cout << "Asset pack benchmark (" << s_AssetCount << " assets, " << (double)looseBytes / (1024.0 * 1024.0) << " MB)\n";
+	std::cout << "\tLoose files: " << looseMs << " ms, " << looseMs * 1000.0 / s_AssetCount << " us per lookup\n";
+	std::cout << "\tMapped pack: " << packMs << " ms, " << packMs * 1000.0 / s_AssetCount << " us per lookup (x" << looseMs / packMs << ")\n";
+	std::cout << "\tMapped pack with LZ4: " << compressedMs << " ms, " << compressedMs * 1000.0 / s_AssetCount << " us per lookup (x" << looseMs / compressedMs << "), "
+		<< (double)std::filesystem::file_size(directory / "compressed.pack", error) / (1024.0 * 1024.0) << " MB on disk\n";
+
+	if (looseHash != packHash || looseHash != compressedHash)
+		std::cerr << "\tThe pack returned different data than the loose files\n";
+
+	std::filesystem::remove_all(directory, error);
+}
@@ -0,0 +1,4 @@
+#pragma once
+
+// Times thousands of small asset lookups from a mapped asset pack against reading the same files loose
+void RunAssetPackBenchmark();
@@ -0,0 +1,326 @@
+#include "AssetRegistry.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <unordered_map>
+
+#include "AssetPack.h"
+#include "CookedAssets.h"
+#include "Model.h"
+#include "Profiler.h"
+#include "Shader.h"
+#include "Utils.h"
+
+struct AssetStats
+{
+	uint32_t Requests = 0;
+	uint32_t PathHits = 0;
+	uint32_t ContentHits = 0;
+	// What entries that are already gone had saved
+	uint64_t ReleasedBytesSaved = 0;
+	double ReleasedMsSaved = 0.0;
+};
+
+// Recursive because loading a model loads its textures
+static std::recursive_mutex s_Mutex;
+static std::unordered_map<std::string, AssetEntry*> s_ByPath;
+static std::unordered_map<uint64_t, AssetEntry*> s_ByContent;
+static AssetStats s_Stats;
+static AssetPack s_Pack;
+
+static std::string NormalizePath(AssetType type, const std::filesystem::path& path)
+{
+	std::string normalized = path.lexically_normal().generic_string();
+#ifdef _WIN32
+	// Windows paths are case insensitive, the model files mix ENGINE.TGA and engine.tga freely
+	std::transform(normalized.begin(), normalized.end(), normalized.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+#endif
+	return std::to_string((int)type) + ':' + normalized;
+}
+
+static uint64_t ContentKey(AssetType type, uint64_t hash)
+{
+	return hash ^ ((uint64_t)type * 0x9E3779B97F4A7C15ull);
+}
+
+static uint64_t GetGpuBytes(const AssetEntry& entry)
+{
+	switch (entry.Type)
+	{
+		case AssetType::Texture: return TextureArrayManager::GetLayerBytes(entry.Texture);
+		case AssetType::Model: return static_cast<const Model*>(entry.Asset)->GetBufferBytes();
+		default: return 0;
+	}
+}
+
+static double GetLoadMs(const AssetEntry& entry)
+{
+	// Texture decoding is deferred to TextureArrayManager::Build, loading them only read the file
+	if (entry.Type == AssetType::Texture)
+		return entry.LoadMs + TextureArrayManager::GetDecodeMs(entry.Texture);
+
+	return entry.LoadMs;
+}
+
+// Looks the asset up by path first and by content second, which also remembers the new path
+static AssetEntry* FindExisting(const std::string& key, uint64_t contentKey)
+{
+	if (const auto it = s_ByContent.find(contentKey); it != s_ByContent.end())
+	{
+		AssetEntry* entry = it->second;
+		entry->Keys.push_back(key);
+		entry->Requests++;
+		s_ByPath[key] = entry;
+		s_Stats.ContentHits++;
+		return entry;
+	}
+
+	return nullptr;
+}
+
+static AssetEntry* FindByPath(const std::string& key)
+{
+	s_Stats.Requests++;
+
+	if (const auto it = s_ByPath.find(key); it != s_ByPath.end())
+	{
+		it->second->Requests++;
+		s_Stats.PathHits++;
+		return it->second;
+	}
+
+	return nullptr;
+}
+
+static AssetEntry* Insert(AssetType type, const std::string& key, uint64_t contentKey, void* asset, double loadMs)
+{
+	AssetEntry* entry = new AssetEntry();
+	entry->Type = type;
+	entry->Keys.push_back(key);
+	entry->ContentHash = contentKey;
+	entry->Requests = 1;
+	entry->LoadMs = loadMs;
+	entry->Asset = asset;
+
+	s_ByPath[key] = entry;
+	s_ByContent[contentKey] = entry;
+	return entry;
+}
+
+static AssetPackBlob FindInPack(const std::filesystem::path& path)
+{
+	if (!s_Pack.IsOpen())
+		return {};
+
+	const std::string name = CookedAssets::GetPackName(path);
+	return name.empty() ? AssetPackBlob() : s_Pack.Find(name);
+}
+
+static double MillisecondsSince(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+TextureHandle AssetRegistry::LoadTexture(const std::filesystem::path& path)
+{
+	ProfileScope scope("Load texture");
+	std::scoped_lock lock(s_Mutex);
+
+	const std::string key = NormalizePath(AssetType::Texture, path);
+	if (AssetEntry* entry = FindByPath(key))
+		return TextureHandle(entry);
+
+	const auto start = std::chrono::steady_clock::now();
+	const AssetPackBlob packed = FindInPack(path);
+	const std::filesystem::path file = packed ? path : CookedAssets::Resolve(path);
+	std::vector<uint8_t> data = packed ? std::vector<uint8_t>() : Utils::ReadFileToBytes(file);
+	if (!packed && data.empty())
+	{
+		std::cerr << "Failed to load texture: '" << path.string() << "'\n";
+		return {};
+	}
+
+	const uint64_t contentKey = ContentKey(AssetType::Texture, packed ? packed.ContentHash : Utils::Hash(data.data(), data.size()));
+	if (AssetEntry* entry = FindExisting(key, contentKey))
+		return TextureHandle(entry);
+
+	const TextureSlot slot = packed
+		? TextureArrayManager::Request(file.string(), packed.Data)
+		: TextureArrayManager::Request(file.string(), std::move(data));
+	if (!slot.IsValid())
+		return {};
+
+	AssetEntry* entry = Insert(AssetType::Texture, key, contentKey, nullptr, MillisecondsSince(start));
+	entry->Texture = slot;
+	entry->Asset = &entry->Texture;
+	return TextureHandle(entry);
+}
+
+ModelHandle AssetRegistry::LoadModel(const std::filesystem::path& path)
+{
+	ProfileScope scope("Load model");
+	std::scoped_lock lock(s_Mutex);
+
+	const std::string key = NormalizePath(AssetType::Model, path);
+	if (AssetEntry* entry = FindByPath(key))
+		return ModelHandle(entry);
+
+	const auto start = std::chrono::steady_clock::now();
+	const AssetPackBlob packed = FindInPack(path);
+	const std::filesystem::path file = packed ? path : CookedAssets::Resolve(path);
+	uint64_t contentHash = packed.ContentHash;
+	if (!packed)
+	{
+		const std::vector<uint8_t> data = Utils::ReadFileToBytes(file);
+		if (data.empty())
+		{
+			std::cerr << "Failed to load model: '" << path.string() << "'\n";
+			return {};
+		}
+		contentHash = Utils::Hash(data.data(), data.size());
+	}
+
+	const uint64_t contentKey = ContentKey(AssetType::Model, contentHash);
+	if (AssetEntry* entry = FindExisting(key, contentKey))
+		return ModelHandle(entry);
+
+	Model* model = new Model(file.string(), packed.Data);
+	return ModelHandle(Insert(AssetType::Model, key, contentKey, model, MillisecondsSince(start)));
+}
+
+ShaderHandle AssetRegistry::LoadShader(const std::filesystem::path& vertexPath)
+{
+	return LoadShader(vertexPath, {}, {});
+}
+
+ShaderHandle AssetRegistry::LoadShader(const std::filesystem::path& vertexPath, const std::filesystem::path& fragmentPath)
+{
+	return LoadShader(vertexPath, {}, fragmentPath);
+}
+
+ShaderHandle AssetRegistry::LoadShader(const std::filesystem::path& vertexPath, const std::filesystem::path& geometryPath, const std::filesystem::path& fragmentPath)
+{
+	ProfileScope scope("Load shader");
+	std::scoped_lock lock(s_Mutex);
+
+	const std::filesystem::path stages[] = { vertexPath, geometryPath, fragmentPath };
+	const std::filesystem::path files[] = {
+		CookedAssets::Resolve(vertexPath),
+		geometryPath.empty() ? geometryPath : CookedAssets::Resolve(geometryPath),
+		fragmentPath.empty() ? fragmentPath : CookedAssets::Resolve(fragmentPath)
+	};
+
+	std::string key;
+	for (const auto& stage : stages)
+		key += NormalizePath(AssetType::Shader, stage) + '|';
+
+	if (AssetEntry* entry = FindByPath(key))
+		return ShaderHandle(entry);
+
+	// A program is only the same program when every stage matches
+	const auto start = std::chrono::steady_clock::now();
+	uint64_t hash = 0;
+	for (size_t i = 0; i < std::size(files); i++)
+	{
+		if (files[i].empty())
+		{
+			hash = hash * 31 + Utils::Hash(nullptr, 0);
+			continue;
+		}
+
+		const std::vector<uint8_t> data = Utils::ReadFileToBytes(files[i]);
+		if (data.empty())
+		{
+			std::cerr << "Failed to load shader: '" << stages[i].string() << "'\n";
+			return {};
+		}
+		hash = hash * 31 + Utils::Hash(data.data(), data.size());
+	}
+
+	const uint64_t contentKey = ContentKey(AssetType::Shader, hash);
+	if (AssetEntry* entry = FindExisting(key, contentKey))
+		return ShaderHandle(entry);
+
+	Shader* shader = new Shader();
+	if (!geometryPath.empty())
+		shader->CreateFromFile(files[0], files[1], files[2]);
+	else if (!fragmentPath.empty())
+		shader->CreateFromFile(files[0], files[2]);
+	else
+		shader->CreateFromFile(files[0]);
+
+	return ShaderHandle(Insert(AssetType::Shader, key, contentKey, shader, MillisecondsSince(start)));
+}
+
+void AssetRegistry::Release(AssetEntry* entry)
+{
+	std::scoped_lock lock(s_Mutex);
+
+	if (entry->RefCount.fetch_sub(1, std::memory_order_acq_rel) != 1)
+		return;
+
+	s_Stats.ReleasedBytesSaved += GetGpuBytes(*entry) * (entry->Requests - 1);
+	s_Stats.ReleasedMsSaved += GetLoadMs(*entry) * (entry->Requests - 1);
+
+	for (const std::string& key : entry->Keys)
+		s_ByPath.erase(key);
+	s_ByContent.erase(entry->ContentHash);
+
+	switch (entry->Type)
+	{
+		case AssetType::Texture:
+			TextureArrayManager::Release(entry->Texture);
+			break;
+		case AssetType::Model:
+			delete static_cast<Model*>(entry->Asset);
+			break;
+		case AssetType::Shader:
+			delete static_cast<Shader*>(entry->Asset);
+			break;
+	}
+
+	delete entry;
+}
+
+void AssetRegistry::PrintReport()
+{
+	std::scoped_lock lock(s_Mutex);
+
+	uint64_t bytesSaved = s_Stats.ReleasedBytesSaved;
+	double msSaved = s_Stats.ReleasedMsSaved;
+	for (const auto& [contentKey, entry] : s_ByContent)
+	{
+		bytesSaved += GetGpuBytes(*entry) * (entry->Requests - 1);
+		msSaved += GetLoadMs(*entry) * (entry->Requests - 1);
+	}
+
+	std::cout << "Asset registry: " << s_Stats.Requests << " requests, " << s_ByContent.size() << " unique assets, "
+		<< s_Stats.PathHits << " path hits, " << s_Stats.ContentHits << " content hits\n";
+	std::cout << "\tGPU memory saved: " << (double)bytesSaved / (1024.0 * 1024.0) << " MB\n";
+	std::cout << "\tLoad and decode time saved: " << msSaved << " ms\n";
+}
+
+void AssetRegistry::Shutdown()
+{
+	std::scoped_lock lock(s_Mutex);
+
+	for (const auto& [contentKey, entry] : s_ByContent)
+		std::cerr << "Asset '" << entry->Keys.front() << "' still has " << entry->RefCount.load() << " handle(s) at shutdown\n";
+
+	s_Pack.Close();
+}
+
+bool AssetRegistry::MountPack(const std::filesystem::path& path)
+{
+	std::scoped_lock lock(s_Mutex);
+
+	std::error_code error;
+	if (!std::filesystem::exists(path, error) || !s_Pack.Open(path))
+		return false;
+
+	std::cout << "Mounted asset pack '" << path.string() << "' with " << s_Pack.GetEntryCount() << " assets\n";
+	return true;
+}
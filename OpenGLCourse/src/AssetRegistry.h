@@ -0,0 +1,133 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "TextureArrayManager.h"
+
+class Model;
+class Shader;
+
+enum class AssetType : uint8_t
+{
+	Texture = 0,
+	Model = 1,
+	Shader = 2
+};
+
+struct AssetEntry
+{
+	AssetType Type = AssetType::Texture;
+	// Every normalized path that turned out to be this asset
+	std::vector<std::string> Keys;
+	uint64_t ContentHash = 0;
+	std::atomic<uint32_t> RefCount = 0;
+	uint32_t Requests = 0;
+	double LoadMs = 0.0;
+
+	void* Asset = nullptr;
+	// Textures live in the texture arrays, Asset points here for them
+	TextureSlot Texture;
+};
+
+template<typename T>
+class AssetHandle;
+
+using TextureHandle = AssetHandle<TextureSlot>;
+using ModelHandle = AssetHandle<Model>;
+using ShaderHandle = AssetHandle<Shader>;
+
+// Interns assets by normalized path and by a hash of the file contents, so the same file is only ever
+// decoded and uploaded once no matter how it is spelled or how many copies of it exist on disk.
+// The GPU resources of an asset are freed as soon as its last handle goes away. Paths name the source
+// asset, the cooked version is loaded instead whenever the asset cooker has produced one. With an asset
+// pack mounted, whatever it holds is used straight out of the mapping before anything on disk.
+class AssetRegistry
+{
+public:
+	AssetRegistry() = delete;
+	~AssetRegistry() = delete;
+
+	// Maps the pack until Shutdown, false when there is none
+	static bool MountPack(const std::filesystem::path& path);
+
+	// Empty handle when the file can not be read or decoded. Texture data is uploaded by TextureArrayManager::Build.
+	static TextureHandle LoadTexture(const std::filesystem::path& path);
+	static ModelHandle LoadModel(const std::filesystem::path& path);
+	static ShaderHandle LoadShader(const std::filesystem::path& vertexPath);
+	static ShaderHandle LoadShader(const std::filesystem::path& vertexPath, const std::filesystem::path& fragmentPath);
+	static ShaderHandle LoadShader(const std::filesystem::path& vertexPath, const std::filesystem::path& geometryPath, const std::filesystem::path& fragmentPath);
+
+	// Requests served from the registry and the memory and load time they did not have to pay for
+	static void PrintReport();
+	// Complains about every asset that still has handles, they should all be gone by now, and unmaps the pack
+	static void Shutdown();
+
+private:
+	template<typename T>
+	friend class AssetHandle;
+
+	static void Release(AssetEntry* entry);
+};
+
+template<typename T>
+class AssetHandle
+{
+public:
+	AssetHandle() = default;
+	AssetHandle(const AssetHandle& other) : m_Entry(other.m_Entry) { Acquire(); }
+	AssetHandle(AssetHandle&& other) noexcept : m_Entry(other.m_Entry) { other.m_Entry = nullptr; }
+	~AssetHandle() { Reset(); }
+
+	AssetHandle& operator=(const AssetHandle& other)
+	{
+		if (m_Entry != other.m_Entry)
+		{
+			Reset();
+			m_Entry = other.m_Entry;
+			Acquire();
+		}
+		return *this;
+	}
+
+	AssetHandle& operator=(AssetHandle&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Reset();
+			m_Entry = other.m_Entry;
+			other.m_Entry = nullptr;
+		}
+		return *this;
+	}
+
+	T* Get() const { return m_Entry ? static_cast<T*>(m_Entry->Asset) : nullptr; }
+	T* operator->() const { return Get(); }
+	T& operator*() const { return *Get(); }
+	explicit operator bool() const { return m_Entry != nullptr; }
+
+	void Reset()
+	{
+		if (m_Entry)
+			AssetRegistry::Release(m_Entry);
+		m_Entry = nullptr;
+	}
+
+private:
+	friend class AssetRegistry;
+
+	explicit AssetHandle(AssetEntry* entry)
+		: m_Entry(entry) { Acquire(); }
+
+	void Acquire()
+	{
+		if (m_Entry)
+			m_Entry->RefCount.fetch_add(1, std::memory_order_relaxed);
+	}
+
+private:
+	AssetEntry* m_Entry = nullptr;
+};
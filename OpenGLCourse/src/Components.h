@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Lights.h"
+#include "TextureArrayManager.h"
+
+class Mesh;
+class Model;
+
+// Node in the TransformHierarchy, the hierarchy owns the actual matrices
+struct TransformComponent
+{
+	uint32_t Node = 0;
+};
+
+struct RenderableComponent
+{
+	// Exactly one of these is set
+	const ::Mesh* Mesh = nullptr;
+	const ::Model* Model = nullptr;
+
+	TextureSlot Texture;
+	uint8_t MaterialId = 0;
+};
+
+// Renderables without it are skipped by every shadow pass
+struct ShadowCasterComponent
+{
+};
+
+struct PointLightComponent
+{
+	PointLight Light;
+	// Id of the light in the renderer's omni shadow pool
+	uint32_t ShadowMap = 0;
+};
+
+struct SpotLightComponent
+{
+	SpotLight Light;
+	uint32_t ShadowMap = 0;
+};
+
+// Keeps a light just below the camera, pointing where it looks
+struct CameraAttachmentComponent
+{
+	float HeightOffset = 0.0f;
+};
+
+// Spins the transform node around the world Y axis, by the simulated time so replays see the same angles
+struct SpinComponent
+{
+	float DegreesPerSecond = 0.0f;
+	float Angle = 0.0f;
+};
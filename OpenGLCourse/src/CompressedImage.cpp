@@ -0,0 +1,231 @@
+#include "CompressedImage.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <iostream>
+
+#include <glad/glad.h>
+
+// S3TC is on every desktop driver but is still an extension, so glad does not define it
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+static constexpr uint8_t s_Ktx2Identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+static constexpr uint32_t s_DdsMagic = 0x20534444; // "DDS "
+static constexpr uint32_t s_DdsHeaderSize = 4 + 124;
+static constexpr uint32_t s_DdsDx10HeaderSize = 20;
+
+static constexpr uint32_t MakeFourCC(char a, char b, char c, char d)
+{
+	return (uint32_t)(uint8_t)a | ((uint32_t)(uint8_t)b << 8) | ((uint32_t)(uint8_t)c << 16) | ((uint32_t)(uint8_t)d << 24);
+}
+
+template<typename T>
+static T ReadAt(const uint8_t* data, size_t offset)
+{
+	T value;
+	std::memcpy(&value, data + offset, sizeof(T));
+	return value;
+}
+
+// sRGB variants are read as their linear counterpart, the renderer samples every texture as linear
+static BlockFormat FromDxgiFormat(uint32_t format)
+{
+	switch (format)
+	{
+		case 71: case 72: return BlockFormat::BC1;
+		case 77: case 78: return BlockFormat::BC3;
+		case 83: return BlockFormat::BC5;
+		case 98: case 99: return BlockFormat::BC7;
+		default: return BlockFormat::None;
+	}
+}
+
+static BlockFormat FromVkFormat(uint32_t format)
+{
+	switch (format)
+	{
+		case 131: case 132: case 133: case 134: return BlockFormat::BC1;
+		case 137: case 138: return BlockFormat::BC3;
+		case 141: return BlockFormat::BC5;
+		case 145: case 146: return BlockFormat::BC7;
+		default: return BlockFormat::None;
+	}
+}
+
+static bool ParseDds(const uint8_t* data, size_t size, CompressedImage& image)
+{
+	if (size < s_DdsHeaderSize)
+	{
+		std::cerr << "DDS file is truncated\n";
+		return false;
+	}
+
+	image.Height = ReadAt<uint32_t>(data, 12);
+	image.Width = ReadAt<uint32_t>(data, 16);
+	const uint32_t mipCount = std::max(ReadAt<uint32_t>(data, 28), 1u);
+	const uint32_t fourCC = ReadAt<uint32_t>(data, 84);
+
+	size_t offset = s_DdsHeaderSize;
+	switch (fourCC)
+	{
+		case MakeFourCC('D', 'X', 'T', '1'): image.Format = BlockFormat::BC1; break;
+		case MakeFourCC('D', 'X', 'T', '5'): image.Format = BlockFormat::BC3; break;
+		case MakeFourCC('A', 'T', 'I', '2'):
+		case MakeFourCC('B', 'C', '5', 'U'): image.Format = BlockFormat::BC5; break;
+		case MakeFourCC('D', 'X', '1', '0'):
+			if (size < s_DdsHeaderSize + s_DdsDx10HeaderSize)
+			{
+				std::cerr << "DDS file is truncated\n";
+				return false;
+			}
+			image.Format = FromDxgiFormat(ReadAt<uint32_t>(data, s_DdsHeaderSize));
+			offset += s_DdsDx10HeaderSize;
+			break;
+		default: image.Format = BlockFormat::None; break;
+	}
+
+	if (image.Format == BlockFormat::None)
+	{
+		std::cerr << "DDS file holds a format other than BC1, BC3, BC5 or BC7\n";
+		return false;
+	}
+
+	// Levels are stored back to back, largest first
+	image.Levels.clear();
+	for (uint32_t level = 0; level < mipCount; level++)
+	{
+		CompressedLevel& mip = image.Levels.emplace_back();
+		mip.Width = std::max(image.Width >> level, 1u);
+		mip.Height = std::max(image.Height >> level, 1u);
+		mip.Offset = offset;
+		mip.Size = CompressedImage::GetLevelSize(image.Format, mip.Width, mip.Height);
+		offset += mip.Size;
+	}
+
+	return true;
+}
+
+static bool ParseKtx2(const uint8_t* data, size_t size, CompressedImage& image)
+{
+	constexpr size_t levelIndexOffset = 80;
+	if (size < levelIndexOffset)
+	{
+		std::cerr << "KTX2 file is truncated\n";
+		return false;
+	}
+
+	image.Format = FromVkFormat(ReadAt<uint32_t>(data, 12));
+	image.Width = ReadAt<uint32_t>(data, 20);
+	image.Height = ReadAt<uint32_t>(data, 24);
+	const uint32_t depth = ReadAt<uint32_t>(data, 28);
+	const uint32_t layerCount = ReadAt<uint32_t>(data, 32);
+	const uint32_t faceCount = ReadAt<uint32_t>(data, 36);
+	// Zero asks the loader to generate the mips, which compressed data can not do
+	const uint32_t levelCount = std::max(ReadAt<uint32_t>(data, 40), 1u);
+	const uint32_t supercompression = ReadAt<uint32_t>(data, 44);
+
+	if (image.Format == BlockFormat::None)
+	{
+		std::cerr << "KTX2 file holds a format other than BC1, BC3, BC5 or BC7\n";
+		return false;
+	}
+
+	if (supercompression != 0 || depth > 1 || layerCount > 1 || faceCount != 1)
+	{
+		std::cerr << "Only plain 2D KTX2 files without supercompression are supported\n";
+		return false;
+	}
+
+	if (size < levelIndexOffset + (size_t)levelCount * 24)
+	{
+		std::cerr << "KTX2 file is truncated\n";
+		return false;
+	}
+
+	image.Levels.clear();
+	for (uint32_t level = 0; level < levelCount; level++)
+	{
+		CompressedLevel& mip = image.Levels.emplace_back();
+		mip.Width = std::max(image.Width >> level, 1u);
+		mip.Height = std::max(image.Height >> level, 1u);
+		mip.Offset = (size_t)ReadAt<uint64_t>(data, levelIndexOffset + level * 24);
+		mip.Size = (size_t)ReadAt<uint64_t>(data, levelIndexOffset + level * 24 + 8);
+	}
+
+	return true;
+}
+
+bool CompressedImage::IsContainer(const uint8_t* data, size_t size)
+{
+	if (size >= sizeof(s_Ktx2Identifier) && std::memcmp(data, s_Ktx2Identifier, sizeof(s_Ktx2Identifier)) == 0)
+		return true;
+
+	return size >= 4 && ReadAt<uint32_t>(data, 0) == s_DdsMagic;
+}
+
+bool CompressedImage::Parse(const uint8_t* data, size_t size, CompressedImage& image)
+{
+	bool parsed = false;
+	if (size >= sizeof(s_Ktx2Identifier) && std::memcmp(data, s_Ktx2Identifier, sizeof(s_Ktx2Identifier)) == 0)
+		parsed = ParseKtx2(data, size, image);
+	else if (size >= 4 && ReadAt<uint32_t>(data, 0) == s_DdsMagic)
+		parsed = ParseDds(data, size, image);
+
+	if (!parsed)
+		return false;
+
+	for (const CompressedLevel& level : image.Levels)
+	{
+		if (level.Offset + level.Size > size || level.Size < GetLevelSize(image.Format, level.Width, level.Height))
+		{
+			std::cerr << "Compressed texture level " << (&level - image.Levels.data()) << " is outside of the file\n";
+			return false;
+		}
+	}
+
+	return true;
+}
+
+uint32_t CompressedImage::GetBlockBytes(BlockFormat format)
+{
+	switch (format)
+	{
+		case BlockFormat::BC1: return 8;
+		case BlockFormat::BC3:
+		case BlockFormat::BC5:
+		case BlockFormat::BC7: return 16;
+		default: return 0;
+	}
+}
+
+uint32_t CompressedImage::GetGLFormat(BlockFormat format)
+{
+	switch (format)
+	{
+		case BlockFormat::BC1: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+		case BlockFormat::BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		case BlockFormat::BC5: return GL_COMPRESSED_RG_RGTC2;
+		case BlockFormat::BC7: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+		default: return GL_RGBA8;
+	}
+}
+
+size_t CompressedImage::GetLevelSize(BlockFormat format, uint32_t width, uint32_t height)
+{
+	if (format == BlockFormat::None)
+		return (size_t)width * height * 4;
+
+	// Levels below 4x4 still take a whole block
+	return (size_t)((width + 3) / 4) * ((height + 3) / 4) * GetBlockBytes(format);
+}
+
+uint32_t CompressedImage::GetFullLevelCount(uint32_t width, uint32_t height)
+{
+	return (uint32_t)std::bit_width(std::max(width, height));
+}
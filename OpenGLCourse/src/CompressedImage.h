@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum class BlockFormat : uint8_t
+{
+	None = 0,
+	// RGB with 1 bit alpha, 8 bytes per 4x4 block
+	BC1 = 1,
+	// BC1 color plus interpolated alpha, 16 bytes per block
+	BC3 = 2,
+	// Two interpolated channels, for normal maps, 16 bytes per block
+	BC5 = 3,
+	// High quality RGBA, 16 bytes per block
+	BC7 = 4
+};
+
+struct CompressedLevel
+{
+	uint32_t Width = 0, Height = 0;
+	// Into the container the image was parsed from
+	size_t Offset = 0;
+	size_t Size = 0;
+};
+
+// A block compressed image with its mip chain, level 0 first. The level data stays in the container
+// bytes, parsing only records where every level is.
+struct CompressedImage
+{
+	BlockFormat Format = BlockFormat::None;
+	uint32_t Width = 0, Height = 0;
+	std::vector<CompressedLevel> Levels;
+
+	// Recognizes DDS (legacy FourCC and DX10 headers) and KTX2 without supercompression
+	static bool IsContainer(const uint8_t* data, size_t size);
+	// Prints why when the container is broken or holds a format we do not support
+	static bool Parse(const uint8_t* data, size_t size, CompressedImage& image);
+
+	static uint32_t GetBlockBytes(BlockFormat format);
+	static uint32_t GetGLFormat(BlockFormat format);
+	static size_t GetLevelSize(BlockFormat format, uint32_t width, uint32_t height);
+	static uint32_t GetFullLevelCount(uint32_t width, uint32_t height);
+};
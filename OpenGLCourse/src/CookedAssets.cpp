@@ -0,0 +1,85 @@
+#include "CookedAssets.h"
+
+#include <algorithm>
+#include <cctype>
+#include <string>
+
+#include "MeshFile.h"
+
+static std::string GetLowerExtension(const std::filesystem::path& path)
+{
+	std::string extension = path.extension().string();
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+	return extension;
+}
+
+AssetKind CookedAssets::GetKind(const std::filesystem::path& source)
+{
+	const std::string extension = GetLowerExtension(source);
+
+	if (extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".tga" || extension == ".bmp")
+		return AssetKind::Texture;
+	if (extension == ".obj" || extension == ".fbx" || extension == ".dae" || extension == ".3ds")
+		return AssetKind::Model;
+	if (extension == ".glsl" || extension == ".vert" || extension == ".geom" || extension == ".frag")
+		return AssetKind::Shader;
+
+	return AssetKind::Other;
+}
+
+// Everything after the assets folder is kept, so ./assets and ../OpenGLCourse/assets both work
+static bool SplitAssetPath(const std::filesystem::path& source, std::filesystem::path& root, std::filesystem::path& relative)
+{
+	bool inAssets = false;
+	for (const auto& part : source.lexically_normal())
+	{
+		if (inAssets)
+			relative /= part;
+		else if (part == "assets")
+			inAssets = true;
+		else
+			root /= part;
+	}
+
+	return inAssets && !relative.empty();
+}
+
+std::filesystem::path CookedAssets::GetCookedPath(const std::filesystem::path& source)
+{
+	std::filesystem::path root, relative;
+	if (!SplitAssetPath(source, root, relative))
+		return {};
+
+	std::filesystem::path cooked = root / "assets" / "cooked" / relative;
+	switch (GetKind(source))
+	{
+		case AssetKind::Texture: cooked.replace_extension(".dds"); break;
+		case AssetKind::Model: cooked.replace_extension(MeshFile::Extension); break;
+		default: break;
+	}
+
+	return cooked;
+}
+
+std::filesystem::path CookedAssets::Resolve(const std::filesystem::path& source)
+{
+	const std::filesystem::path cooked = GetCookedPath(source);
+
+	std::error_code error;
+	if (!cooked.empty() && std::filesystem::exists(cooked, error))
+		return cooked;
+
+	return source;
+}
+
+std::string CookedAssets::GetPackName(const std::filesystem::path& source)
+{
+	std::filesystem::path root, relative;
+	if (!SplitAssetPath(source, root, relative))
+		return {};
+
+	// The model files mix ENGINE.TGA and engine.tga freely
+	std::string name = relative.generic_string();
+	std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+	return name;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+
+enum class AssetKind
+{
+	Other = 0,
+	Texture,
+	Model,
+	Shader
+};
+
+// Where the asset cooker writes its outputs: the source tree mirrored under assets/cooked,
+// with textures turned into .dds and models into .mesh files
+class CookedAssets
+{
+public:
+	CookedAssets() = delete;
+	~CookedAssets() = delete;
+
+	static AssetKind GetKind(const std::filesystem::path& source);
+	// assets/models/x-wing.obj -> assets/cooked/models/x-wing.mesh, empty for paths outside of assets
+	static std::filesystem::path GetCookedPath(const std::filesystem::path& source);
+	// The cooked file when there is one, the source otherwise
+	static std::filesystem::path Resolve(const std::filesystem::path& source);
+
+	// Name of the cooked source in the asset pack: its path below the assets folder in lower case,
+	// empty for paths outside of assets
+	static std::string GetPackName(const std::filesystem::path& source);
+
+	// Written next to the cooked files, holding all of them
+	static constexpr const char* PackFileName = "assets.pack";
+};
@@ -0,0 +1,201 @@
+#include "DrawListBuilder.h"
+
+#include <algorithm>
+
+#include "Components.h"
+#include "JobSystem.h"
+#include "Mesh.h"
+#include "Model.h"
+
+static constexpr uint32_t s_CameraBit = 0;
+static constexpr uint32_t s_DirectionalLightBit = 1;
+static constexpr uint32_t s_FirstOmniBit = 2;
+
+static constexpr uint32_t s_CullGrainSize = 1024;
+
+Frustum Frustum::FromMatrix(const glm::mat4& viewProjection)
+{
+	// Gribb-Hartmann, rows of the matrix combined into the clip planes
+	const glm::mat4 m = glm::transpose(viewProjection);
+
+	Frustum frustum;
+	frustum.Planes[0] = m[3] + m[0];
+	frustum.Planes[1] = m[3] - m[0];
+	frustum.Planes[2] = m[3] + m[1];
+	frustum.Planes[3] = m[3] - m[1];
+	frustum.Planes[4] = m[3] + m[2];
+	frustum.Planes[5] = m[3] - m[2];
+
+	for (glm::vec4& plane : frustum.Planes)
+		plane /= glm::length(glm::vec3(plane));
+
+	return frustum;
+}
+
+bool Frustum::Intersects(const glm::vec4& sphere) const
+{
+	for (const glm::vec4& plane : Planes)
+	{
+		if (glm::dot(glm::vec3(plane), glm::vec3(sphere)) + plane.w < -sphere.w)
+			return false;
+	}
+
+	return true;
+}
+
+void DrawListBuilder::Build(FramePacket& packet, const World& world, const TransformHierarchy& transforms, const glm::mat4& omniLightProjection)
+{
+	CopyTransformUpload(packet, transforms);
+	GatherDrawItems(packet, world, transforms);
+	CalculateVisibility(packet, omniLightProjection);
+	CompactViews(packet);
+}
+
+void DrawListBuilder::CopyTransformUpload(FramePacket& packet, const TransformHierarchy& transforms) const
+{
+	const auto& source = transforms.GetTransforms();
+
+	packet.TransformCount = transforms.GetCount();
+	packet.TransformUploadOffset = transforms.GetUpdatedBegin();
+	packet.TransformUpload.assign(source.begin() + transforms.GetUpdatedBegin(), source.begin() + transforms.GetUpdatedEnd());
+}
+
+void DrawListBuilder::GatherDrawItems(FramePacket& packet, const World& world, const TransformHierarchy& transforms)
+{
+	world.QueryChunks<TransformComponent, RenderableComponent>(m_Chunks);
+
+	// Every chunk writes its own slice of the draw list
+	m_ChunkOffsets.resize(m_Chunks.size());
+	uint32_t itemCount = 0;
+	for (size_t i = 0; i < m_Chunks.size(); i++)
+	{
+		m_ChunkOffsets[i] = itemCount;
+		itemCount += m_Chunks[i].GetCount();
+	}
+
+	packet.DrawList.resize(itemCount);
+
+	// Size of one world unit at a distance of one, in pixels
+	const float pixelsPerUnit = packet.Projection[1][1] * 0.5f * (float)packet.ViewportHeight;
+
+	JobCounter counter;
+	JobSystem::ParallelFor((uint32_t)m_Chunks.size(), 1, [&](uint32_t begin, uint32_t end)
+	{
+		for (uint32_t chunk = begin; chunk < end; chunk++)
+		{
+			const ChunkView& view = m_Chunks[chunk];
+			const TransformComponent* transformComponents = view.Get<TransformComponent>();
+			const RenderableComponent* renderables = view.Get<RenderableComponent>();
+			const bool castsShadows = view.Has<ShadowCasterComponent>();
+
+			for (uint32_t row = 0; row < view.GetCount(); row++)
+			{
+				const RenderableComponent& renderable = renderables[row];
+				const uint32_t node = transformComponents[row].Node;
+				const glm::mat4& transform = transforms.GetWorldMatrix(node);
+
+				DrawItem& item = packet.DrawList[m_ChunkOffsets[chunk] + row];
+				item.Mesh = renderable.Mesh;
+				item.Model = renderable.Model;
+				item.Texture = renderable.Texture;
+				item.MaterialId = renderable.MaterialId;
+				item.TransformIndex = node;
+				item.CastsShadows = castsShadows;
+
+				const glm::vec4& localSphere = renderable.Model ? renderable.Model->GetBoundingSphere() : renderable.Mesh->GetBoundingSphere();
+				const float maxScale = glm::max(glm::length(glm::vec3(transform[0])), glm::max(glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2]))));
+				item.BoundingSphere = glm::vec4(glm::vec3(transform * glm::vec4(glm::vec3(localSphere), 1.0f)), localSphere.w * maxScale);
+
+				const float distance = glm::max(glm::length(glm::vec3(item.BoundingSphere) - packet.EyePosition), item.BoundingSphere.w);
+				item.ScreenSize = 2.0f * item.BoundingSphere.w * pixelsPerUnit / distance;
+			}
+		}
+	}, &counter);
+	JobSystem::WaitFor(counter);
+}
+
+void DrawListBuilder::CalculateVisibility(const FramePacket& packet, const glm::mat4& omniLightProjection)
+{
+	const size_t omniLightCount = std::min<size_t>(packet.PointLights.size() + packet.SpotLights.size(), MaxOmniLights);
+
+	m_Frustums.clear();
+	m_Frustums.push_back(Frustum::FromMatrix(packet.Projection * packet.View));
+	m_Frustums.push_back(Frustum::FromMatrix(packet.DirectionalLightTransform));
+
+	for (size_t light = 0; light < omniLightCount; light++)
+	{
+		const PointLight& pointLight = light < packet.PointLights.size()
+			? packet.PointLights[light]
+			: packet.SpotLights[light - packet.PointLights.size()];
+
+		for (const glm::mat4& faceTransform : CalculateLightTransform(pointLight, omniLightProjection))
+			m_Frustums.push_back(Frustum::FromMatrix(faceTransform));
+	}
+
+	m_VisibilityMasks.resize(packet.DrawList.size());
+
+	JobCounter counter;
+	JobSystem::ParallelFor((uint32_t)packet.DrawList.size(), s_CullGrainSize, [&](uint32_t begin, uint32_t end)
+	{
+		for (uint32_t i = begin; i < end; i++)
+		{
+			const glm::vec4& sphere = packet.DrawList[i].BoundingSphere;
+			// Only the camera looks at objects that do not cast shadows
+			const size_t frustumCount = packet.DrawList[i].CastsShadows ? m_Frustums.size() : 1;
+
+			uint64_t mask = 0;
+			for (size_t frustum = 0; frustum < frustumCount; frustum++)
+			{
+				if (m_Frustums[frustum].Intersects(sphere))
+					mask |= 1ull << frustum;
+			}
+
+			m_VisibilityMasks[i] = mask;
+		}
+	}, &counter);
+	JobSystem::WaitFor(counter);
+}
+
+void DrawListBuilder::CompactViews(FramePacket& packet) const
+{
+	const size_t omniLightCount = std::min<size_t>(packet.PointLights.size() + packet.SpotLights.size(), MaxOmniLights);
+	packet.OmniLightViews.resize(omniLightCount);
+
+	auto compact = [this](ViewDrawList& view, uint32_t bit)
+	{
+		view.Items.clear();
+		view.FaceMasks.clear();
+		for (uint32_t i = 0; i < (uint32_t)m_VisibilityMasks.size(); i++)
+		{
+			if (m_VisibilityMasks[i] & (1ull << bit))
+				view.Items.push_back(i);
+		}
+	};
+
+	JobCounter counter;
+	JobSystem::Run([&] { compact(packet.CameraView, s_CameraBit); }, &counter);
+	JobSystem::Run([&] { compact(packet.DirectionalLightView, s_DirectionalLightBit); }, &counter);
+
+	for (size_t light = 0; light < omniLightCount; light++)
+	{
+		JobSystem::Run([this, &packet, light]
+		{
+			ViewDrawList& view = packet.OmniLightViews[light];
+			view.Items.clear();
+			view.FaceMasks.clear();
+
+			const uint32_t shift = s_FirstOmniBit + (uint32_t)light * 6;
+			for (uint32_t i = 0; i < (uint32_t)m_VisibilityMasks.size(); i++)
+			{
+				const uint8_t faces = (uint8_t)((m_VisibilityMasks[i] >> shift) & 0x3F);
+				if (faces)
+				{
+					view.Items.push_back(i);
+					view.FaceMasks.push_back(faces);
+				}
+			}
+		}, &counter);
+	}
+
+	JobSystem::WaitFor(counter);
+}
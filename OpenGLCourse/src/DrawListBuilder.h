@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "FramePacket.h"
+#include "TransformHierarchy.h"
+#include "World.h"
+
+struct Frustum
+{
+	glm::vec4 Planes[6];
+
+	static Frustum FromMatrix(const glm::mat4& viewProjection);
+	bool Intersects(const glm::vec4& sphere) const;
+};
+
+// Turns the renderable entities into the draw list and per view culled lists of a frame packet.
+// World bounds are computed once on the job system and every view is culled and compacted
+// concurrently, so the render thread only has to submit.
+class DrawListBuilder
+{
+public:
+	DrawListBuilder() = default;
+	~DrawListBuilder() = default;
+
+	// The packet camera, viewport, light and directional light transform have to be filled in already
+	// and the hierarchy updated for this frame
+	void Build(FramePacket& packet, const World& world, const TransformHierarchy& transforms, const glm::mat4& omniLightProjection);
+
+	// 2 bits for the camera and directional light plus 6 cube faces per omni light
+	static constexpr uint32_t MaxOmniLights = 10;
+
+private:
+	void CopyTransformUpload(FramePacket& packet, const TransformHierarchy& transforms) const;
+	void GatherDrawItems(FramePacket& packet, const World& world, const TransformHierarchy& transforms);
+	void CalculateVisibility(const FramePacket& packet, const glm::mat4& omniLightProjection);
+	void CompactViews(FramePacket& packet) const;
+
+private:
+	std::vector<ChunkView> m_Chunks;
+	std::vector<uint32_t> m_ChunkOffsets;
+	std::vector<Frustum> m_Frustums;
+	std::vector<uint64_t> m_VisibilityMasks;
+};
@@ -0,0 +1,188 @@
+#include "DynamicResolution.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "OpenGLContext.h"
+#include "RenderTarget.h"
+
+// Aim a bit below the target, so noise in the measurements does not push frames over it
+static constexpr float s_Headroom = 0.9f;
+// Smoothing of the measured GPU time, the weight of the newest measurement
+static constexpr float s_MeasurementWeight = 0.25f;
+// Over budget the scale drops quickly, under budget it recovers slowly, which keeps it from oscillating
+static constexpr float s_DecreaseRate = 0.5f;
+static constexpr float s_IncreaseRate = 0.1f;
+
+static DynamicResolutionSettings s_Settings;
+static std::unique_ptr<RenderTarget> s_Target;
+static uint32_t s_Width = 0, s_Height = 0;
+
+static float s_Scale = 1.0f;
+static std::atomic<float> s_AppliedScale = 1.0f;
+static float s_SmoothedMs = 0.0f;
+
+static uint32_t s_Queries[DynamicResolution::TimerQueryCount] = {};
+static uint64_t s_QueryFrames[DynamicResolution::TimerQueryCount] = {};
+static uint32_t s_QueryHead = 0;
+static uint32_t s_QueriesInFlight = 0;
+static bool s_Timing = false;
+
+static std::vector<ResolutionDecision> s_Decisions;
+static uint64_t s_DecisionCount = 0;
+static uint64_t s_MeasuredFrames = 0;
+static double s_TotalGpuMs = 0.0;
+static uint64_t s_Frames = 0;
+static double s_TotalScale = 0.0;
+static float s_LowestScale = 1.0f;
+
+static float Quantize(float scale)
+{
+	return std::clamp(std::round(scale / DynamicResolution::ScaleStep) * DynamicResolution::ScaleStep, s_Settings.MinScale, s_Settings.MaxScale);
+}
+
+static void UpdateScale(uint64_t frame, float gpuMs)
+{
+	s_SmoothedMs = s_SmoothedMs == 0.0f ? gpuMs : s_SmoothedMs + (gpuMs - s_SmoothedMs) * s_MeasurementWeight;
+
+	// GPU time grows roughly with the pixel count, which is the square of the scale
+	const float desired = s_Scale * std::sqrt(s_Settings.TargetMs * s_Headroom / std::max(s_SmoothedMs, 0.01f));
+	const float rate = desired < s_Scale ? s_DecreaseRate : s_IncreaseRate;
+	s_Scale = std::clamp(s_Scale + (desired - s_Scale) * rate, s_Settings.MinScale, s_Settings.MaxScale);
+
+	const float oldScale = s_AppliedScale.load(std::memory_order_relaxed);
+	const float newScale = Quantize(s_Scale);
+	if (newScale != oldScale)
+	{
+		s_AppliedScale.store(newScale, std::memory_order_relaxed);
+		if (s_Decisions.size() < DynamicResolution::MaxLoggedDecisions)
+			s_Decisions.push_back({ frame, gpuMs, oldScale, newScale });
+		s_DecisionCount++;
+	}
+
+	s_MeasuredFrames++;
+	s_TotalGpuMs += gpuMs;
+}
+
+void DynamicResolution::Init(uint32_t width, uint32_t height, const DynamicResolutionSettings& settings)
+{
+	s_Settings = settings;
+	s_Settings.MinScale = std::max(s_Settings.MinScale, ScaleStep);
+	s_Settings.MaxScale = std::max(s_Settings.MaxScale, s_Settings.MinScale);
+	s_Width = width;
+	s_Height = height;
+
+	s_Scale = std::clamp(1.0f, s_Settings.MinScale, s_Settings.MaxScale);
+	s_AppliedScale = Quantize(s_Scale);
+	s_LowestScale = s_AppliedScale;
+
+	const uint32_t targetWidth = (uint32_t)std::ceil((float)width * s_Settings.MaxScale);
+	const uint32_t targetHeight = (uint32_t)std::ceil((float)height * s_Settings.MaxScale);
+	s_Target = std::make_unique<RenderTarget>(targetWidth, targetHeight, GL_RGBA8, GL_DEPTH_COMPONENT24);
+
+	glCreateQueries(GL_TIME_ELAPSED, TimerQueryCount, s_Queries);
+	s_Decisions.reserve(MaxLoggedDecisions);
+}
+
+void DynamicResolution::Shutdown()
+{
+	glDeleteQueries(TimerQueryCount, s_Queries);
+	s_QueriesInFlight = 0;
+	s_Target.reset();
+}
+
+void DynamicResolution::BeginFrame(uint64_t frameIndex)
+{
+	// Oldest first, the first one still running ends the search so nothing ever waits on the GPU
+	while (s_QueriesInFlight > 0)
+	{
+		const uint32_t oldest = (s_QueryHead + TimerQueryCount - s_QueriesInFlight) % TimerQueryCount;
+		int32_t available = 0;
+		glGetQueryObjectiv(s_Queries[oldest], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available)
+			break;
+
+		uint64_t nanoseconds = 0;
+		glGetQueryObjectui64v(s_Queries[oldest], GL_QUERY_RESULT, &nanoseconds);
+		UpdateScale(s_QueryFrames[oldest], (float)((double)nanoseconds / 1e6));
+		s_QueriesInFlight--;
+	}
+
+	const float scale = s_AppliedScale.load(std::memory_order_relaxed);
+	s_Frames++;
+	s_TotalScale += scale;
+	s_LowestScale = std::min(s_LowestScale, scale);
+
+	// With every query still in flight this frame goes unmeasured
+	s_Timing = s_QueriesInFlight < TimerQueryCount;
+	if (s_Timing)
+	{
+		s_QueryFrames[s_QueryHead] = frameIndex;
+		glBeginQuery(GL_TIME_ELAPSED, s_Queries[s_QueryHead]);
+	}
+}
+
+void DynamicResolution::EndFrame()
+{
+	if (!s_Timing)
+		return;
+
+	glEndQuery(GL_TIME_ELAPSED);
+	s_QueryHead = (s_QueryHead + 1) % TimerQueryCount;
+	s_QueriesInFlight++;
+	s_Timing = false;
+}
+
+void DynamicResolution::BeginScene()
+{
+	s_Target->BeginWrite();
+	OpenGLContext::SetViewport(GetRenderWidth(), GetRenderHeight());
+}
+
+void DynamicResolution::EndScene()
+{
+	s_Target->BlitToBackbuffer(GetRenderWidth(), GetRenderHeight(), s_Width, s_Height);
+}
+
+float DynamicResolution::GetScale()
+{
+	return s_AppliedScale.load(std::memory_order_relaxed);
+}
+
+uint32_t DynamicResolution::GetRenderWidth()
+{
+	return std::max((uint32_t)std::lround((float)s_Width * GetScale()), 1u);
+}
+
+uint32_t DynamicResolution::GetRenderHeight()
+{
+	return std::max((uint32_t)std::lround((float)s_Height * GetScale()), 1u);
+}
+
+const RenderTarget& DynamicResolution::GetTarget()
+{
+	return *s_Target;
+}
+
+void DynamicResolution::PrintReport()
+{
+	const double frames = (double)std::max<uint64_t>(s_MeasuredFrames, 1);
+	std::cout << "Dynamic resolution: target " << s_Settings.TargetMs << " ms, scale " << s_Settings.MinScale << " to " << s_Settings.MaxScale << '\n';
+	std::cout << "\tAverage GPU frame time: " << s_TotalGpuMs / frames << " ms over " << s_MeasuredFrames << " measured frames\n";
+	std::cout << "\tAverage scale: " << s_TotalScale / (double)std::max<uint64_t>(s_Frames, 1) << ", lowest " << s_LowestScale
+		<< ", final " << GetScale() << " (" << GetRenderWidth() << "x" << GetRenderHeight() << ")\n";
+
+	std::cout << "\t" << s_DecisionCount << " scale changes";
+	if (s_DecisionCount > s_Decisions.size())
+		std::cout << ", the first " << s_Decisions.size() << " of them";
+	std::cout << '\n';
+
+	for (const ResolutionDecision& decision : s_Decisions)
+		std::cout << "\t\tFrame " << decision.Frame << ": " << decision.GpuMs << " ms on the GPU, scale " << decision.OldScale << " -> " << decision.NewScale << '\n';
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+
+class RenderTarget;
+
+struct DynamicResolutionSettings
+{
+	// GPU time of a whole frame the controller steers towards
+	float TargetMs = 16.0f;
+	float MinScale = 0.5f;
+	// Above 1 renders more pixels than the backbuffer has
+	float MaxScale = 1.0f;
+};
+
+struct ResolutionDecision
+{
+	uint64_t Frame = 0;
+	float GpuMs = 0.0f;
+	float OldScale = 0.0f;
+	float NewScale = 0.0f;
+};
+
+// Renders the main pass into an offscreen target at a scale of the backbuffer size and stretches it
+// onto the backbuffer afterwards. GPU timer queries measure every frame, their results come back a
+// few frames later and move the scale towards the target frame time. The target is allocated once
+// for the maximum scale, lower scales only use its top left corner.
+class DynamicResolution
+{
+public:
+	DynamicResolution() = delete;
+	~DynamicResolution() = delete;
+
+	static void Init(uint32_t width, uint32_t height, const DynamicResolutionSettings& settings);
+	static void Shutdown();
+
+	// Render thread. Feeds finished timer queries to the controller and starts timing the frame.
+	static void BeginFrame(uint64_t frameIndex);
+	static void EndFrame();
+
+	// Binds the target with the viewport at the current scale
+	static void BeginScene();
+	// Upscales what BeginScene rendered to the backbuffer
+	static void EndScene();
+
+	// Any thread, the scale the render thread uses for the frames it starts now
+	static float GetScale();
+	static uint32_t GetRenderWidth();
+	static uint32_t GetRenderHeight();
+	// Render thread, only the top left render width x height of it holds the current frame
+	static const RenderTarget& GetTarget();
+
+	static void PrintReport();
+
+	static constexpr uint32_t TimerQueryCount = 4;
+	// The scale only moves in steps, so the resolution does not change on every frame
+	static constexpr float ScaleStep = 0.05f;
+	static constexpr uint32_t MaxLoggedDecisions = 256;
+};
@@ -0,0 +1,111 @@
+#include "EcsBenchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "JobSystem.h"
+#include "World.h"
+
+static constexpr uint32_t s_EntityCounts[] = { 10000, 1000000 };
+static constexpr uint32_t s_Iterations = 10;
+static constexpr float s_DeltaTime = 1.0f / 60.0f;
+
+struct PositionComponent
+{
+	glm::vec3 Value{ 0.0f };
+};
+
+struct VelocityComponent
+{
+	glm::vec3 Value{ 0.0f };
+};
+
+// Only on some entities, so the query has to walk more than one archetype
+struct HealthComponent
+{
+	float Value = 100.0f;
+};
+
+// What the scene looked like before: every object its own heap allocation, reached through a pointer
+struct HeapObject
+{
+	glm::vec3 Position{ 0.0f };
+	glm::vec3 Velocity{ 0.0f };
+	float Health = 100.0f;
+	char Unrelated[64] = {};
+};
+
+static double MeasureMs(const auto& function)
+{
+	const auto start = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < s_Iterations; i++)
+		function();
+
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / s_Iterations;
+}
+
+void RunEcsBenchmark()
+{
+	JobSystem::Init();
+
+	std::cout << "ECS benchmark (position += velocity * dt, " << JobSystem::GetWorkerCount() << " workers)\n";
+
+	for (const uint32_t entityCount : s_EntityCounts)
+	{
+		World world;
+		std::vector<std::unique_ptr<HeapObject>> objects;
+		objects.reserve(entityCount);
+
+		for (uint32_t i = 0; i < entityCount; i++)
+		{
+			const glm::vec3 velocity((float)(i % 7), 1.0f, (float)(i % 3));
+			const Entity entity = world.Create(PositionComponent(), VelocityComponent{ velocity });
+			if (i % 4 == 0)
+				world.Add<HealthComponent>(entity);
+
+			auto& object = objects.emplace_back(std::make_unique<HeapObject>());
+			object->Velocity = velocity;
+		}
+
+		// Objects created over time end up scattered, the shuffle stands in for that
+		std::shuffle(objects.begin(), objects.end(), std::mt19937(1234));
+
+		const double pointerMs = MeasureMs([&]
+		{
+			for (const auto& object : objects)
+				object->Position += object->Velocity * s_DeltaTime;
+		});
+
+		const double eachMs = MeasureMs([&]
+		{
+			world.Each<PositionComponent, VelocityComponent>([](Entity, PositionComponent& position, const VelocityComponent& velocity)
+			{
+				position.Value += velocity.Value * s_DeltaTime;
+			});
+		});
+
+		const double parallelMs = MeasureMs([&]
+		{
+			world.ParallelEach<PositionComponent, VelocityComponent>([](Entity, PositionComponent& position, const VelocityComponent& velocity)
+			{
+				position.Value += velocity.Value * s_DeltaTime;
+			});
+		});
+
+		auto nsPerEntity = [entityCount](double ms) { return ms * 1000000.0 / entityCount; };
+
+		std::cout << "\t" << entityCount << " entities in " << world.GetArchetypeCount() - 1 << " archetypes:\n";
+		std::cout << "\t\tPointer per object: " << pointerMs << " ms (" << nsPerEntity(pointerMs) << " ns per entity)\n";
+		std::cout << "\t\tEach: " << eachMs << " ms (" << nsPerEntity(eachMs) << " ns per entity)\n";
+		std::cout << "\t\tParallelEach: " << parallelMs << " ms (" << nsPerEntity(parallelMs) << " ns per entity)\n";
+	}
+
+	JobSystem::Shutdown();
+}
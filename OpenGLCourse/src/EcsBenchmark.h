@@ -0,0 +1,4 @@
+#pragma once
+
+// Compares archetype iteration against the pointer per object layout the scene used to have
+void RunEcsBenchmark();
@@ -0,0 +1,88 @@
+#include "FrameArena.h"
+
+#include <algorithm>
+#include <new>
+
+static thread_local FrameArena t_Arena;
+
+static std::byte* AllocateBlock(size_t size)
+{
+	return static_cast<std::byte*>(::operator new(size, std::align_val_t(alignof(std::max_align_t))));
+}
+
+static void FreeBlock(std::byte* data)
+{
+	::operator delete(data, std::align_val_t(alignof(std::max_align_t)));
+}
+
+FrameArena::~FrameArena()
+{
+	for (const Block& block : m_Blocks)
+		FreeBlock(block.Data);
+}
+
+void* FrameArena::Allocate(size_t size, size_t alignment)
+{
+	while (m_Block < m_Blocks.size())
+	{
+		const Block& block = m_Blocks[m_Block];
+		const size_t offset = (m_Offset + alignment - 1) & ~(alignment - 1);
+		if (offset + size <= block.Size)
+		{
+			m_UsedBytes += offset + size - m_Offset;
+			m_PeakBytes = std::max(m_PeakBytes, m_UsedBytes);
+			m_Offset = offset + size;
+			return block.Data + offset;
+		}
+
+		// Blocks after the current one are only there after a Rewind, they are reused as they come
+		m_UsedBytes += block.Size - m_Offset;
+		m_Block++;
+		m_Offset = 0;
+	}
+
+	const size_t blockSize = std::max(BlockSize, size + alignment);
+	m_Blocks.push_back({ AllocateBlock(blockSize), blockSize });
+	m_Block = m_Blocks.size() - 1;
+	m_Offset = 0;
+	return Allocate(size, alignment);
+}
+
+void FrameArena::Reset()
+{
+	if (m_Blocks.size() > 1)
+	{
+		const size_t size = std::max(BlockSize, m_PeakBytes);
+		for (const Block& block : m_Blocks)
+			FreeBlock(block.Data);
+
+		m_Blocks.clear();
+		m_Blocks.push_back({ AllocateBlock(size), size });
+	}
+
+	m_Block = 0;
+	m_Offset = 0;
+	m_UsedBytes = 0;
+	m_PeakBytes = 0;
+}
+
+void FrameArena::Rewind(const Marker& marker)
+{
+	m_Block = marker.Block;
+	m_Offset = marker.Offset;
+	m_UsedBytes = marker.UsedBytes;
+}
+
+size_t FrameArena::GetCapacity() const
+{
+	size_t capacity = 0;
+	for (const Block& block : m_Blocks)
+		capacity += block.Size;
+
+	return capacity;
+}
+
+FrameArena& FrameArena::Get()
+{
+	return t_Arena;
+}
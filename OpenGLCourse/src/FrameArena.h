@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <string_view>
+#include <vector>
+
+// Bump allocator for data that only lives until the end of a frame. Every thread has its own, so
+// allocating never locks, and every thread resets its own: the simulation and render threads at the
+// end of their frames, the job system after each job. Blocks are kept across resets, once the
+// busiest frame has been seen nothing touches the heap anymore.
+class FrameArena
+{
+public:
+	FrameArena() = default;
+	~FrameArena();
+
+	FrameArena(const FrameArena&) = delete;
+	FrameArena& operator=(const FrameArena&) = delete;
+
+	struct Marker
+	{
+		size_t Block = 0;
+		size_t Offset = 0;
+		size_t UsedBytes = 0;
+	};
+
+	void* Allocate(size_t size, size_t alignment);
+
+	// Frees everything allocated since the last Reset. A frame that needed more than one block
+	// leaves a single block big enough for all of it behind.
+	void Reset();
+
+	// Frees everything allocated after the marker was taken, for scopes nested in a frame
+	Marker GetMarker() const { return { m_Block, m_Offset, m_UsedBytes }; }
+	void Rewind(const Marker& marker);
+
+	// Null terminated, for GL calls that want names built at runtime
+	template<typename... Args>
+	const char* Format(std::format_string<Args...> format, Args&&... args)
+	{
+		const size_t size = std::formatted_size(format, std::forward<Args>(args)...);
+		char* text = static_cast<char*>(Allocate(size + 1, 1));
+		*std::format_to_n(text, size, format, std::forward<Args>(args)...).out = '\0';
+		return text;
+	}
+
+	size_t GetCapacity() const;
+
+	// The arena of the calling thread
+	static FrameArena& Get();
+
+	static constexpr size_t BlockSize = 64 * 1024;
+
+private:
+	struct Block
+	{
+		std::byte* Data = nullptr;
+		size_t Size = 0;
+	};
+
+	std::vector<Block> m_Blocks;
+	size_t m_Block = 0;
+	size_t m_Offset = 0;
+	// Including what alignment and the ends of full blocks wasted, the peak is what Reset makes room for
+	size_t m_UsedBytes = 0;
+	size_t m_PeakBytes = 0;
+};
+
+// Allocates from the arena of the thread that created it, freeing is left to the arena. Containers
+// using it must not outlive the frame, nor be grown from a job.
+template<typename T>
+class FrameAllocator
+{
+public:
+	using value_type = T;
+
+	FrameAllocator() noexcept : m_Arena(&FrameArena::Get()) {}
+	explicit FrameAllocator(FrameArena& arena) noexcept : m_Arena(&arena) {}
+
+	template<typename U>
+	FrameAllocator(const FrameAllocator<U>& other) noexcept : m_Arena(other.m_Arena) {}
+
+	T* allocate(size_t count) { return static_cast<T*>(m_Arena->Allocate(sizeof(T) * count, alignof(T))); }
+	void deallocate(T*, size_t) noexcept {}
+
+	template<typename U>
+	bool operator==(const FrameAllocator<U>& other) const noexcept { return m_Arena == other.m_Arena; }
+
+private:
+	FrameArena* m_Arena;
+
+	template<typename U>
+	friend class FrameAllocator;
+};
+
+template<typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
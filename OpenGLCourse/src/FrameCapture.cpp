@@ -0,0 +1,408 @@
+#include "FrameCapture.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <glad/glad.h>
+#include <stb_image.h>
+
+#include "AllocationCounter.h"
+#include "GpuResources.h"
+#include "PngEncoder.h"
+#include "RenderStateCache.h"
+
+// Squared YIQ difference between black and white, the largest there is
+static constexpr float s_MaxYiqDelta = 35215.0f;
+// Shutdown gives up on a read the GPU has not finished by then
+static constexpr uint64_t s_ShutdownTimeoutNs = 1000000000;
+
+struct Readback
+{
+	GpuBufferHandle Buffer;
+	const uint8_t* Mapped = nullptr;
+	GLsync Fence = nullptr;
+	uint64_t Frame = 0;
+	uint32_t Width = 0, Height = 0;
+};
+
+// Copied out of the ring, bottom row first like GL reads them
+struct CapturedImage
+{
+	std::vector<uint8_t> Pixels;
+	uint64_t Frame = 0;
+	uint32_t Width = 0, Height = 0;
+};
+
+static FrameCaptureSettings s_Settings;
+static bool s_Enabled = false;
+static bool s_Comparing = false;
+static uint32_t s_MaxWidth = 0, s_MaxHeight = 0;
+
+// Render thread only
+static Readback s_Ring[FrameCapture::RingSize];
+static uint32_t s_RingHead = 0;
+static uint32_t s_InFlight = 0;
+
+// Images are reused, once each has been filled the render thread allocates nothing anymore
+static CapturedImage s_Images[FrameCapture::MaxQueued];
+
+static std::mutex s_Mutex;
+static std::condition_variable s_WorkReady;
+static std::condition_variable s_ImageFreed;
+// Indices into s_Images, the queue oldest first
+static std::vector<uint32_t> s_FreeImages;
+static std::vector<uint32_t> s_Queue;
+static bool s_Stopping = false;
+static std::thread s_Worker;
+static FrameCaptureStats s_Stats;
+
+static std::filesystem::path GetFramePath(const std::filesystem::path& directory, uint64_t frame, const char* suffix)
+{
+	return directory / std::format("frame_{:06}{}.png", frame, suffix);
+}
+
+// Squared distance in YIQ, weighted the way the eye weighs brightness against hue
+static float GetYiqDelta(const uint8_t* a, const uint8_t* b)
+{
+	const float red = (float)a[0] - (float)b[0];
+	const float green = (float)a[1] - (float)b[1];
+	const float blue = (float)a[2] - (float)b[2];
+	const float y = red * 0.29889531f + green * 0.58662247f + blue * 0.11448223f;
+	const float i = red * 0.59597799f - green * 0.27417610f - blue * 0.32180189f;
+	const float q = red * 0.21147017f - green * 0.52261711f + blue * 0.31114694f;
+	return 0.5053f * y * y + 0.299f * i * i + 0.1957f * q * q;
+}
+
+// Changed pixels in red over a faded copy of the golden image
+static std::vector<uint8_t> CreateDiffImage(const uint8_t* pixels, const uint8_t* golden, uint32_t width, uint32_t height, float threshold)
+{
+	std::vector<uint8_t> diff((size_t)width * height * 4);
+	for (size_t i = 0; i < (size_t)width * height; i++)
+	{
+		const uint8_t* actual = pixels + i * 4;
+		const uint8_t* expected = golden + i * 4;
+		uint8_t* out = &diff[i * 4];
+		if (GetYiqDelta(actual, expected) > threshold)
+		{
+			out[0] = 255; out[1] = 0; out[2] = 0;
+		}
+		else
+		{
+			const float luma = expected[0] * 0.29889531f + expected[1] * 0.58662247f + expected[2] * 0.11448223f;
+			out[0] = out[1] = out[2] = (uint8_t)(255.0f - (255.0f - luma) * 0.1f);
+		}
+		out[3] = 255;
+	}
+
+	return diff;
+}
+
+// Worker thread, pixels are top down
+static void CompareWithGolden(const CapturedImage& image, const uint8_t* pixels)
+{
+	const std::filesystem::path goldenPath = GetFramePath(s_Settings.GoldenDirectory, image.Frame, "");
+	// Next to the written frames, or next to the golden images when there are none
+	const std::filesystem::path& failureDirectory = s_Settings.OutputDirectory.empty() ? s_Settings.GoldenDirectory : s_Settings.OutputDirectory;
+	const size_t stride = (size_t)image.Width * 4;
+
+	int width = 0, height = 0, channels = 0;
+	stbi_uc* golden = stbi_load(goldenPath.string().c_str(), &width, &height, &channels, 4);
+	if (!golden)
+	{
+		std::cerr << "Frame " << image.Frame << " has no golden image '" << goldenPath.string() << "'\n";
+		if (s_Settings.OutputDirectory.empty())
+			PngEncoder::Write(GetFramePath(failureDirectory, image.Frame, "_actual"), pixels, image.Width, image.Height, stride);
+
+		std::lock_guard lock(s_Mutex);
+		s_Stats.MissingGolden++;
+		return;
+	}
+
+	const float threshold = s_MaxYiqDelta * s_Settings.Tolerance * s_Settings.Tolerance;
+	const uint64_t pixelCount = (uint64_t)image.Width * image.Height;
+	const bool sameSize = (uint32_t)width == image.Width && (uint32_t)height == image.Height;
+	uint64_t changed = pixelCount;
+	if (sameSize)
+	{
+		changed = 0;
+		for (uint64_t i = 0; i < pixelCount; i++)
+			changed += GetYiqDelta(pixels + i * 4, golden + i * 4) > threshold;
+	}
+
+	const double share = pixelCount ? (double)changed / (double)pixelCount : 0.0;
+	const bool mismatch = share > s_Settings.MaxChangedPixels;
+	if (mismatch)
+	{
+		if (sameSize)
+			std::cerr << "Frame " << image.Frame << " differs from '" << goldenPath.string() << "' in " << share * 100.0 << "% of its pixels\n";
+		else
+			std::cerr << "Frame " << image.Frame << " is " << image.Width << "x" << image.Height << ", '" << goldenPath.string() << "' is " << width << "x" << height << '\n';
+
+		if (s_Settings.OutputDirectory.empty())
+			PngEncoder::Write(GetFramePath(failureDirectory, image.Frame, "_actual"), pixels, image.Width, image.Height, stride);
+		if (sameSize)
+		{
+			const std::vector<uint8_t> diff = CreateDiffImage(pixels, golden, image.Width, image.Height, threshold);
+			PngEncoder::Write(GetFramePath(failureDirectory, image.Frame, "_diff"), diff.data(), image.Width, image.Height, stride);
+		}
+	}
+
+	stbi_image_free(golden);
+
+	std::lock_guard lock(s_Mutex);
+	s_Stats.Compared++;
+	s_Stats.Mismatched += mismatch;
+	s_Stats.WorstChangedPixels = std::max(s_Stats.WorstChangedPixels, share);
+}
+
+static void ProcessImage(const CapturedImage& image, std::vector<uint8_t>& flipped)
+{
+	const size_t stride = (size_t)image.Width * 4;
+	flipped.resize(stride * image.Height);
+	for (uint32_t y = 0; y < image.Height; y++)
+		memcpy(&flipped[y * stride], &image.Pixels[(size_t)(image.Height - 1 - y) * stride], stride);
+
+	if (!s_Settings.OutputDirectory.empty() && PngEncoder::Write(GetFramePath(s_Settings.OutputDirectory, image.Frame, ""), flipped.data(), image.Width, image.Height, stride))
+	{
+		std::lock_guard lock(s_Mutex);
+		s_Stats.Written++;
+	}
+
+	if (s_Comparing)
+		CompareWithGolden(image, flipped.data());
+}
+
+static void WorkerLoop()
+{
+	// Encoding and comparing images allocates, but only while capturing, which is not part of the frame
+	AllocationCounter::IgnoreThread();
+	std::vector<uint8_t> flipped;
+
+	std::unique_lock lock(s_Mutex);
+	while (true)
+	{
+		s_WorkReady.wait(lock, []() { return s_Stopping || !s_Queue.empty(); });
+		// Everything queued is finished before stopping
+		if (s_Queue.empty())
+			return;
+
+		const uint32_t index = s_Queue.front();
+		s_Queue.erase(s_Queue.begin());
+		lock.unlock();
+
+		ProcessImage(s_Images[index], flipped);
+
+		lock.lock();
+		s_FreeImages.push_back(index);
+		s_ImageFreed.notify_one();
+	}
+}
+
+// Copies a finished read out of the ring and queues it for the worker
+static void HandOver(const Readback& readback)
+{
+	std::unique_lock lock(s_Mutex);
+	if (s_FreeImages.empty())
+	{
+		if (!s_Comparing)
+		{
+			s_Stats.Dropped++;
+			return;
+		}
+
+		s_ImageFreed.wait(lock, []() { return !s_FreeImages.empty(); });
+	}
+
+	const uint32_t index = s_FreeImages.back();
+	s_FreeImages.pop_back();
+	lock.unlock();
+
+	CapturedImage& image = s_Images[index];
+	image.Frame = readback.Frame;
+	image.Width = readback.Width;
+	image.Height = readback.Height;
+	image.Pixels.resize((size_t)readback.Width * readback.Height * 4);
+	memcpy(image.Pixels.data(), readback.Mapped, image.Pixels.size());
+
+	lock.lock();
+	s_Queue.push_back(index);
+	s_Stats.Captured++;
+	s_WorkReady.notify_one();
+}
+
+// False while the oldest read is still running after the timeout
+static bool RetireOldest(uint64_t timeoutNs)
+{
+	Readback& readback = s_Ring[(s_RingHead + FrameCapture::RingSize - s_InFlight) % FrameCapture::RingSize];
+	const GLenum status = glClientWaitSync(readback.Fence, timeoutNs ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, timeoutNs);
+	if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+		return false;
+
+	glDeleteSync(readback.Fence);
+	readback.Fence = nullptr;
+	s_InFlight--;
+	HandOver(readback);
+	return true;
+}
+
+void FrameCapture::Init(const FrameCaptureSettings& settings, uint32_t maxWidth, uint32_t maxHeight)
+{
+	s_Settings = settings;
+	s_Settings.Interval = std::max(s_Settings.Interval, 1u);
+	s_Comparing = !s_Settings.GoldenDirectory.empty();
+	s_MaxWidth = maxWidth;
+	s_MaxHeight = maxHeight;
+	s_Stats = FrameCaptureStats();
+
+	std::error_code error;
+	if (!s_Settings.OutputDirectory.empty() && !std::filesystem::create_directories(s_Settings.OutputDirectory, error) && error)
+		std::cerr << "Could not create capture directory '" << s_Settings.OutputDirectory.string() << "': " << error.message() << '\n';
+
+	constexpr GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	const uint64_t bytes = (uint64_t)maxWidth * maxHeight * 4;
+	for (Readback& readback : s_Ring)
+	{
+		readback.Buffer = GpuResources::CreateBuffer({ bytes, flags }, nullptr, GpuMemoryCategory::Buffers);
+		readback.Mapped = static_cast<const uint8_t*>(glMapNamedBufferRange(GpuResources::GetId(readback.Buffer), 0, (GLsizeiptr)bytes, flags));
+	}
+
+	s_FreeImages.clear();
+	for (uint32_t i = 0; i < MaxQueued; i++)
+		s_FreeImages.push_back(MaxQueued - 1 - i);
+	s_Queue.clear();
+	s_Queue.reserve(MaxQueued);
+
+	s_Stopping = false;
+	s_Worker = std::thread(WorkerLoop);
+	s_Enabled = true;
+}
+
+void FrameCapture::Shutdown()
+{
+	if (!s_Enabled)
+		return;
+
+	while (s_InFlight > 0)
+	{
+		if (!RetireOldest(s_ShutdownTimeoutNs))
+		{
+			std::cerr << "Gave up on " << s_InFlight << " frame captures the GPU did not finish\n";
+			break;
+		}
+	}
+
+	{
+		std::lock_guard lock(s_Mutex);
+		s_Stopping = true;
+	}
+	s_WorkReady.notify_one();
+	s_Worker.join();
+
+	for (Readback& readback : s_Ring)
+	{
+		if (readback.Fence)
+			glDeleteSync(readback.Fence);
+		readback.Fence = nullptr;
+
+		// A buffer is only recycled unmapped
+		if (readback.Mapped)
+			glUnmapNamedBuffer(GpuResources::GetId(readback.Buffer));
+		readback.Mapped = nullptr;
+		GpuResources::Destroy(readback.Buffer);
+	}
+
+	for (CapturedImage& image : s_Images)
+		image.Pixels = std::vector<uint8_t>();
+
+	s_InFlight = 0;
+	s_Enabled = false;
+}
+
+bool FrameCapture::IsEnabled()
+{
+	return s_Enabled;
+}
+
+void FrameCapture::Capture(uint64_t frameIndex, uint32_t framebufferId, uint32_t width, uint32_t height)
+{
+	if (!s_Enabled)
+		return;
+
+	const auto start = std::chrono::steady_clock::now();
+
+	// Oldest first, the first one still running ends the search
+	while (s_InFlight > 0 && RetireOldest(0))
+		;
+
+	bool dropped = false;
+	if (frameIndex % s_Settings.Interval == 0)
+	{
+		if (s_InFlight == RingSize)
+		{
+			// The GPU is more than the whole ring behind, only a comparison waits for it
+			if (s_Comparing)
+				RetireOldest(UINT64_MAX);
+			else
+				dropped = true;
+		}
+
+		if (!dropped)
+		{
+			Readback& readback = s_Ring[s_RingHead];
+			readback.Frame = frameIndex;
+			readback.Width = std::min(width, s_MaxWidth);
+			readback.Height = std::min(height, s_MaxHeight);
+
+			// Into the buffer instead of client memory, so the call returns without waiting for the frame
+			RenderStateCache::BindFramebuffer(framebufferId);
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, GpuResources::GetId(readback.Buffer));
+			glReadPixels(0, 0, (int)readback.Width, (int)readback.Height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+			readback.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+			s_RingHead = (s_RingHead + 1) % RingSize;
+			s_InFlight++;
+		}
+	}
+
+	const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	std::lock_guard lock(s_Mutex);
+	s_Stats.Dropped += dropped;
+	s_Stats.RenderThreadMs += ms;
+}
+
+FrameCaptureStats FrameCapture::GetStats()
+{
+	std::lock_guard lock(s_Mutex);
+	return s_Stats;
+}
+
+uint64_t FrameCapture::GetFailedCount()
+{
+	std::lock_guard lock(s_Mutex);
+	return s_Stats.Mismatched + s_Stats.MissingGolden;
+}
+
+void FrameCapture::PrintReport()
+{
+	const FrameCaptureStats stats = GetStats();
+	const uint64_t due = std::max<uint64_t>(stats.Captured + stats.Dropped, 1);
+	std::cout << "Frame capture: " << stats.Captured << " frames captured, " << stats.Dropped << " dropped, "
+		<< stats.RenderThreadMs / (double)due << " ms per capture on the render thread\n";
+
+	if (!s_Settings.OutputDirectory.empty())
+		std::cout << "\tWritten: " << stats.Written << " images to '" << s_Settings.OutputDirectory.string() << "'\n";
+
+	if (!s_Settings.GoldenDirectory.empty())
+	{
+		std::cout << "\tGolden images: " << stats.Compared << " compared, " << stats.Mismatched << " differ, " << stats.MissingGolden << " missing, worst "
+			<< stats.WorstChangedPixels * 100.0 << "% of pixels changed (tolerance " << s_Settings.Tolerance << ", " << s_Settings.MaxChangedPixels * 100.0 << "% allowed)\n";
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+struct FrameCaptureSettings
+{
+	// Every captured frame is written there as frame_<index>.png, nothing is written when empty
+	std::filesystem::path OutputDirectory;
+	// Every captured frame is compared against frame_<index>.png there, nothing is compared when empty
+	std::filesystem::path GoldenDirectory;
+	// Captures every nth frame, starting with the first
+	uint32_t Interval = 1;
+	// Perceptual difference from 0 to 1 above which a pixel counts as changed
+	float Tolerance = 0.1f;
+	// Share of changed pixels a frame may have and still match its golden image
+	float MaxChangedPixels = 0.001f;
+};
+
+struct FrameCaptureStats
+{
+	uint64_t Captured = 0;
+	// Ring or worker full, never happens while comparing
+	uint64_t Dropped = 0;
+	uint64_t Written = 0;
+	uint64_t Compared = 0;
+	uint64_t Mismatched = 0;
+	uint64_t MissingGolden = 0;
+	// Largest share of changed pixels of any compared frame
+	double WorstChangedPixels = 0.0;
+	// Spent on the render thread, reading back and handing frames over
+	double RenderThreadMs = 0.0;
+};
+
+// Gets rendered frames out of the GPU without stalling it. A capture only queues a copy of the
+// framebuffer into one of a ring of persistently mapped pixel pack buffers and fences it; a few
+// frames later, once the fence has signalled, the pixels are copied out and handed to a worker
+// thread that writes them as PNGs or compares them against golden images.
+//
+// Capturing only drops frames when the ring or the worker falls behind, so frame times stay the
+// same under load. Comparing never drops one, a regression run waits instead.
+class FrameCapture
+{
+public:
+	FrameCapture() = delete;
+	~FrameCapture() = delete;
+
+	// Needs the context, frames can be up to maxWidth x maxHeight
+	static void Init(const FrameCaptureSettings& settings, uint32_t maxWidth, uint32_t maxHeight);
+	// Waits for every capture still in flight and for the worker to finish them. Needs the context.
+	static void Shutdown();
+	static bool IsEnabled();
+
+	// Render thread, once a frame after it is drawn. Picks up the reads that have finished and reads the
+	// top left width x height of the framebuffer, 0 for the default one, if the frame is due.
+	static void Capture(uint64_t frameIndex, uint32_t framebufferId, uint32_t width, uint32_t height);
+
+	// Complete after Shutdown
+	static FrameCaptureStats GetStats();
+	// Mismatched and missing golden images
+	static uint64_t GetFailedCount();
+	static void PrintReport();
+
+	static constexpr uint32_t RingSize = 3;
+	// Frames copied out of the ring that the worker has not finished yet
+	static constexpr uint32_t MaxQueued = 8;
+};
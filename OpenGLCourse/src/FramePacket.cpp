@@ -0,0 +1,55 @@
+#include "FramePacket.h"
+
+FramePacket* FramePacketQueue::BeginWrite()
+{
+	std::unique_lock lock(m_Mutex);
+	m_Condition.wait(lock, [this] { return m_Closed || m_Published + (m_Reading ? 1 : 0) < Capacity; });
+
+	if (m_Closed)
+		return nullptr;
+
+	// The slot being read (if any) sits at the read index, published packets follow it
+	const size_t writeIndex = (m_ReadIndex + (m_Reading ? 1 : 0) + m_Published) % Capacity;
+	return &m_Slots[writeIndex];
+}
+
+void FramePacketQueue::EndWrite()
+{
+	{
+		std::lock_guard lock(m_Mutex);
+		m_Published++;
+	}
+	m_Condition.notify_all();
+}
+
+const FramePacket* FramePacketQueue::BeginRead()
+{
+	std::unique_lock lock(m_Mutex);
+	m_Condition.wait(lock, [this] { return m_Closed || m_Published > 0; });
+
+	if (m_Published == 0)
+		return nullptr;
+
+	m_Published--;
+	m_Reading = true;
+	return &m_Slots[m_ReadIndex];
+}
+
+void FramePacketQueue::EndRead()
+{
+	{
+		std::lock_guard lock(m_Mutex);
+		m_Reading = false;
+		m_ReadIndex = (m_ReadIndex + 1) % Capacity;
+	}
+	m_Condition.notify_all();
+}
+
+void FramePacketQueue::Close()
+{
+	{
+		std::lock_guard lock(m_Mutex);
+		m_Closed = true;
+	}
+	m_Condition.notify_all();
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Lights.h"
+#include "TextureArrayManager.h"
+#include "TransformHierarchy.h"
+
+class Mesh;
+class Model;
+
+struct DrawItem
+{
+	// Exactly one of these is set
+	const ::Mesh* Mesh = nullptr;
+	const ::Model* Model = nullptr;
+
+	TextureSlot Texture;
+	uint8_t MaterialId = 0;
+	// Node in the transform hierarchy, also the element of the transform buffer the shaders read
+	uint32_t TransformIndex = 0;
+	bool CastsShadows = true;
+	// World space, xyz is the center and w the radius
+	glm::vec4 BoundingSphere{ 0.0f };
+	// Projected diameter in pixels for the camera, drives which texture mips get streamed in
+	float ScreenSize = 0.0f;
+};
+
+// Indices into FramePacket::DrawList of the items one view can see
+struct ViewDrawList
+{
+	std::vector<uint32_t> Items;
+	// Only filled for omni shadow views, one bit per cube face the item touches
+	std::vector<uint8_t> FaceMasks;
+};
+
+// Everything the render thread needs to draw one frame. It is written by the simulation
+// thread and never touched again until the render thread hands it back.
+struct FramePacket
+{
+	uint64_t FrameIndex = 0;
+	std::chrono::steady_clock::time_point SimulationStart;
+
+	glm::mat4 View{ 1.0f };
+	glm::mat4 Projection{ 1.0f };
+	uint32_t ViewportHeight = 1;
+	glm::vec3 EyePosition{ 0.0f };
+	glm::mat4 DirectionalLightTransform{ 1.0f };
+
+	std::vector<PointLight> PointLights;
+	std::vector<SpotLight> SpotLights;
+	// Omni shadow map of every light, point lights first then spot lights
+	std::vector<uint32_t> OmniShadowMaps;
+
+	std::vector<DrawItem> DrawList;
+
+	// The nodes that changed this frame, applied in order on top of the GPU copy of the hierarchy
+	uint32_t TransformCount = 0;
+	uint32_t TransformUploadOffset = 0;
+	std::vector<ObjectTransform> TransformUpload;
+
+	ViewDrawList CameraView;
+	ViewDrawList DirectionalLightView;
+	// Point lights first, then spot lights
+	std::vector<ViewDrawList> OmniLightViews;
+};
+
+// Bounded single producer / single consumer queue of frame packets. The slots are reused every
+// frame so the packet vectors keep their capacity. With two slots the simulation of frame N + 1
+// overlaps the submission of frame N and can never run further ahead than that.
+class FramePacketQueue
+{
+public:
+	static constexpr size_t Capacity = 2;
+
+	// Blocks until a slot is free, returns nullptr once the queue is closed
+	FramePacket* BeginWrite();
+	void EndWrite();
+
+	// Blocks until a packet is published, returns nullptr once the queue is closed and drained
+	const FramePacket* BeginRead();
+	void EndRead();
+
+	void Close();
+
+private:
+	std::array<FramePacket, Capacity> m_Slots;
+	size_t m_ReadIndex = 0;
+	size_t m_Published = 0;
+	bool m_Reading = false;
+	bool m_Closed = false;
+
+	std::mutex m_Mutex;
+	std::condition_variable m_Condition;
+};
@@ -0,0 +1,29 @@
+#include "Geometry.h"
+
+#include <glm/glm.hpp>
+
+void CalculateAverageNormals(float* vertices, uint32_t verticesCount, uint32_t stride, const uint32_t* indices, uint32_t indicesCount, uint32_t normalsOffset)
+{
+	for (size_t i = 0; i < indicesCount; i += 3)
+	{
+		size_t in0 = (size_t)indices[i] * stride;
+		size_t in1 = (size_t)indices[i + 1] * stride;
+		size_t in2 = (size_t)indices[i + 2] * stride;
+		glm::vec3 v1(vertices[in1] - vertices[in0], vertices[in1 + 1] - vertices[in0 + 1], vertices[in1 + 2] - vertices[in0 + 2]);
+		glm::vec3 v2(vertices[in2] - vertices[in0], vertices[in2 + 1] - vertices[in0 + 1], vertices[in2 + 2] - vertices[in0 + 2]);
+		const glm::vec3 normal = glm::normalize(glm::cross(v1, v2));
+
+		in0 += normalsOffset; in1 += normalsOffset; in2 += normalsOffset;
+		vertices[in0] += normal.x; vertices[in0 + 1] += normal.y; vertices[in0 + 2] += normal.z;
+		vertices[in1] += normal.x; vertices[in1 + 1] += normal.y; vertices[in1 + 2] += normal.z;
+		vertices[in2] += normal.x; vertices[in2 + 1] += normal.y; vertices[in2 + 2] += normal.z;
+	}
+
+	for (size_t i = 0; i < verticesCount / stride; i++)
+	{
+		const size_t offset = i * stride + normalsOffset;
+		// Nx - Ny - Nz
+		const glm::vec3 vec = glm::normalize(glm::vec3(vertices[offset], vertices[offset + 1], vertices[offset + 2]));
+		vertices[offset] = vec.x; vertices[offset + 1] = vec.y; vertices[offset + 2] = vec.z;
+	}
+}
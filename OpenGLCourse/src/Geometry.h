@@ -0,0 +1,8 @@
+#pragma once
+
+#include <cstdint>
+
+// Smooth normals for interleaved vertices: every vertex gets the normalized sum of the normals of the
+// triangles using it. The vertex count is in floats, the stride and normal offset in floats per vertex
+// and the position has to be the first three floats.
+void CalculateAverageNormals(float* vertices, uint32_t verticesCount, uint32_t stride, const uint32_t* indices, uint32_t indicesCount, uint32_t normalsOffset);
@@ -0,0 +1,417 @@
+#include "GlInstrumentation.h"
+
+#ifdef GL_INSTRUMENTATION
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <type_traits>
+
+#include <glad/glad.h>
+
+#include "RenderStateCache.h"
+
+// Every entry point the renderer calls, one that is missing here still works but goes uncounted
+#define GL_INSTRUMENTED_FUNCTIONS(X) \
+	X(AttachShader) \
+	X(BeginQuery) \
+	X(BindBuffer) \
+	X(BindBufferBase) \
+	X(BindFramebuffer) \
+	X(BindTextureUnit) \
+	X(BindVertexArray) \
+	X(BlitNamedFramebuffer) \
+	X(CheckNamedFramebufferStatus) \
+	X(Clear) \
+	X(ClearColor) \
+	X(ClientWaitSync) \
+	X(CompileShader) \
+	X(CompressedTextureSubImage2D) \
+	X(CompressedTextureSubImage3D) \
+	X(CopyImageSubData) \
+	X(CopyNamedBufferSubData) \
+	X(CreateBuffers) \
+	X(CreateFramebuffers) \
+	X(CreateProgram) \
+	X(CreateQueries) \
+	X(CreateShader) \
+	X(CreateTextures) \
+	X(CreateVertexArrays) \
+	X(DebugMessageCallback) \
+	X(DebugMessageControl) \
+	X(DeleteBuffers) \
+	X(DeleteFramebuffers) \
+	X(DeleteProgram) \
+	X(DeleteQueries) \
+	X(DeleteShader) \
+	X(DeleteSync) \
+	X(DeleteTextures) \
+	X(DeleteVertexArrays) \
+	X(DepthFunc) \
+	X(DepthMask) \
+	X(DetachShader) \
+	X(DrawArrays) \
+	X(DrawElements) \
+	X(Enable) \
+	X(EnableVertexArrayAttrib) \
+	X(EndQuery) \
+	X(FenceSync) \
+	X(GenerateTextureMipmap) \
+	X(GetActiveUniform) \
+	X(GetInteger64v) \
+	X(GetProgramiv) \
+	X(GetQueryObjectiv) \
+	X(GetQueryObjectui64v) \
+	X(GetShaderInfoLog) \
+	X(GetShaderiv) \
+	X(GetString) \
+	X(GetUniformLocation) \
+	X(LinkProgram) \
+	X(MapNamedBufferRange) \
+	X(NamedBufferStorage) \
+	X(NamedBufferSubData) \
+	X(NamedFramebufferDrawBuffer) \
+	X(NamedFramebufferDrawBuffers) \
+	X(NamedFramebufferReadBuffer) \
+	X(NamedFramebufferTexture) \
+	X(QueryCounter) \
+	X(ReadPixels) \
+	X(ShaderSource) \
+	X(TextureParameterfv) \
+	X(TextureParameteri) \
+	X(TextureStorage2D) \
+	X(TextureStorage3D) \
+	X(TextureSubImage2D) \
+	X(TextureSubImage3D) \
+	X(Uniform1f) \
+	X(Uniform1i) \
+	X(Uniform2i) \
+	X(Uniform3f) \
+	X(Uniform3i) \
+	X(Uniform4i) \
+	X(UniformMatrix4fv) \
+	X(UnmapNamedBuffer) \
+	X(UseProgram) \
+	X(ValidateProgram) \
+	X(VertexArrayAttribBinding) \
+	X(VertexArrayAttribFormat) \
+	X(VertexArrayElementBuffer) \
+	X(VertexArrayVertexBuffer) \
+	X(Viewport)
+
+enum class GlFunction : uint16_t
+{
+#define X(name) name,
+	GL_INSTRUMENTED_FUNCTIONS(X)
+#undef X
+	Count
+};
+
+static constexpr const char* s_FunctionNames[] = {
+#define X(name) "gl" #name,
+	GL_INSTRUMENTED_FUNCTIONS(X)
+#undef X
+};
+
+static constexpr size_t s_FunctionCount = (size_t)GlFunction::Count;
+
+struct GlCounters
+{
+	uint64_t Calls[s_FunctionCount] = {};
+	uint64_t UploadBytes = 0;
+	uint64_t Triangles = 0;
+};
+
+struct GlPass
+{
+	const char* Name = nullptr;
+	int32_t Index = -1;
+	GlCounters Frame;
+	GlCounters Total;
+};
+
+// Pass 0 collects whatever runs outside of a scope
+static GlPass s_Passes[GlInstrumentation::MaxPasses] = { { "Outside passes" } };
+static uint32_t s_PassCount = 1;
+static uint32_t s_PassStack[GlInstrumentation::MaxPassDepth] = {};
+static uint32_t s_PassDepth = 0;
+static uint64_t s_Frames = 0;
+static uint64_t s_CacheMismatches = 0;
+
+static GlCounters& GetCounters()
+{
+	return s_Passes[s_PassDepth == 0 ? 0 : s_PassStack[s_PassDepth - 1]].Frame;
+}
+
+static uint64_t Sum(const GlCounters& counters)
+{
+	uint64_t calls = 0;
+	for (const uint64_t count : counters.Calls)
+		calls += count;
+	return calls;
+}
+
+static uint64_t GetDrawCalls(const GlCounters& counters)
+{
+	return counters.Calls[(size_t)GlFunction::DrawArrays] + counters.Calls[(size_t)GlFunction::DrawElements];
+}
+
+// The binds RenderStateCache shadows, anything else binds directly
+static uint64_t GetCachedBinds(const GlCounters& counters)
+{
+	return counters.Calls[(size_t)GlFunction::UseProgram] + counters.Calls[(size_t)GlFunction::BindVertexArray]
+		+ counters.Calls[(size_t)GlFunction::BindTextureUnit] + counters.Calls[(size_t)GlFunction::BindFramebuffer];
+}
+
+static uint64_t GetUniformUploads(const GlCounters& counters)
+{
+	uint64_t uploads = 0;
+	for (const GlFunction function : { GlFunction::Uniform1f, GlFunction::Uniform1i, GlFunction::Uniform2i, GlFunction::Uniform3f,
+		GlFunction::Uniform3i, GlFunction::Uniform4i, GlFunction::UniformMatrix4fv })
+		uploads += counters.Calls[(size_t)function];
+	return uploads;
+}
+
+static void AddPrimitives(GLenum mode, GLsizei count)
+{
+	switch (mode)
+	{
+		case GL_TRIANGLES: GetCounters().Triangles += (uint64_t)count / 3; return;
+		case GL_TRIANGLE_STRIP:
+		case GL_TRIANGLE_FAN: GetCounters().Triangles += (uint64_t)std::max(count - 2, 0); return;
+	}
+}
+
+static uint64_t GetPixelBytes(GLenum format, GLenum type)
+{
+	uint64_t components = 4;
+	switch (format)
+	{
+		case GL_RED: components = 1; break;
+		case GL_RG: components = 2; break;
+		case GL_RGB:
+		case GL_BGR: components = 3; break;
+	}
+
+	switch (type)
+	{
+		case GL_UNSIGNED_SHORT:
+		case GL_SHORT:
+		case GL_HALF_FLOAT: return components * 2;
+		case GL_UNSIGNED_INT:
+		case GL_INT:
+		case GL_FLOAT: return components * 4;
+	}
+
+	return components;
+}
+
+// Hooks only count calls, these overloads pick out the calls that carry sizes
+template<GlFunction Function>
+using GlTag = std::integral_constant<GlFunction, Function>;
+
+template<GlFunction Function, typename... Args>
+static void Observe(GlTag<Function>, Args...)
+{
+}
+
+static void Observe(GlTag<GlFunction::DrawArrays>, GLenum mode, GLint, GLsizei count)
+{
+	AddPrimitives(mode, count);
+}
+
+static void Observe(GlTag<GlFunction::DrawElements>, GLenum mode, GLsizei count, GLenum, const void*)
+{
+	AddPrimitives(mode, count);
+}
+
+static void Observe(GlTag<GlFunction::NamedBufferStorage>, GLuint, GLsizeiptr size, const void* data, GLbitfield)
+{
+	if (data)
+		GetCounters().UploadBytes += (uint64_t)size;
+}
+
+static void Observe(GlTag<GlFunction::NamedBufferSubData>, GLuint, GLintptr, GLsizeiptr size, const void*)
+{
+	GetCounters().UploadBytes += (uint64_t)size;
+}
+
+static void Observe(GlTag<GlFunction::TextureSubImage2D>, GLuint, GLint, GLint, GLint, GLsizei width, GLsizei height, GLenum format, GLenum type, const void*)
+{
+	GetCounters().UploadBytes += (uint64_t)width * (uint64_t)height * GetPixelBytes(format, type);
+}
+
+static void Observe(GlTag<GlFunction::TextureSubImage3D>, GLuint, GLint, GLint, GLint, GLint, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const void*)
+{
+	GetCounters().UploadBytes += (uint64_t)width * (uint64_t)height * (uint64_t)depth * GetPixelBytes(format, type);
+}
+
+static void Observe(GlTag<GlFunction::CompressedTextureSubImage2D>, GLuint, GLint, GLint, GLint, GLsizei, GLsizei, GLenum, GLsizei size, const void*)
+{
+	GetCounters().UploadBytes += (uint64_t)size;
+}
+
+static void Observe(GlTag<GlFunction::CompressedTextureSubImage3D>, GLuint, GLint, GLint, GLint, GLint, GLsizei, GLsizei, GLsizei, GLenum, GLsizei size, const void*)
+{
+	GetCounters().UploadBytes += (uint64_t)size;
+}
+
+template<auto& Slot, GlFunction Function, typename Pointer>
+struct GlHook;
+
+// Keeps the original pointer of one entry point and takes its place
+template<auto& Slot, GlFunction Function, typename Result, typename... Args>
+struct GlHook<Slot, Function, Result (APIENTRY*)(Args...)>
+{
+	inline static Result (APIENTRY* Original)(Args...) = nullptr;
+
+	static Result APIENTRY Call(Args... args)
+	{
+		GetCounters().Calls[(size_t)Function]++;
+		Observe(GlTag<Function>(), args...);
+		return Original(args...);
+	}
+
+	static void Install()
+	{
+		// Entry points the driver does not have stay null
+		if (Slot && Slot != &Call)
+		{
+			Original = Slot;
+			Slot = &Call;
+		}
+	}
+};
+
+void GlInstrumentation::Install()
+{
+#define X(name) GlHook<glad_gl##name, GlFunction::name, decltype(glad_gl##name)>::Install();
+	GL_INSTRUMENTED_FUNCTIONS(X)
+#undef X
+}
+
+void GlInstrumentation::BeginFrame()
+{
+	for (uint32_t i = 0; i < s_PassCount; i++)
+		s_Passes[i].Frame = GlCounters();
+}
+
+void GlInstrumentation::EndFrame(const RenderStats& cacheStats)
+{
+	GlCounters frame;
+	for (uint32_t i = 0; i < s_PassCount; i++)
+	{
+		GlPass& pass = s_Passes[i];
+		for (size_t function = 0; function < s_FunctionCount; function++)
+		{
+			pass.Total.Calls[function] += pass.Frame.Calls[function];
+			frame.Calls[function] += pass.Frame.Calls[function];
+		}
+
+		pass.Total.UploadBytes += pass.Frame.UploadBytes;
+		pass.Total.Triangles += pass.Frame.Triangles;
+		pass.Frame = GlCounters();
+	}
+
+	if (GetDrawCalls(frame) != cacheStats.DrawCalls || GetCachedBinds(frame) != cacheStats.StateChangesIssued)
+	{
+		if (s_CacheMismatches++ == 0)
+			std::cerr << "Frame " << s_Frames << " issued " << GetDrawCalls(frame) << " draws and " << GetCachedBinds(frame) << " binds, the RenderStateCache saw "
+				<< cacheStats.DrawCalls << " and " << cacheStats.StateChangesIssued << '\n';
+	}
+
+	s_Frames++;
+}
+
+void GlInstrumentation::PushPass(const char* name, int32_t index)
+{
+	uint32_t pass = 0;
+	for (uint32_t i = 1; i < s_PassCount && pass == 0; i++)
+	{
+		if (s_Passes[i].Index == index && (s_Passes[i].Name == name || strcmp(s_Passes[i].Name, name) == 0))
+			pass = i;
+	}
+
+	// Past the limit a pass is counted with the one around it
+	if (pass == 0 && s_PassCount < MaxPasses)
+	{
+		pass = s_PassCount++;
+		s_Passes[pass].Name = name;
+		s_Passes[pass].Index = index;
+	}
+	else if (pass == 0)
+	{
+		pass = s_PassDepth == 0 ? 0 : s_PassStack[s_PassDepth - 1];
+	}
+
+	if (s_PassDepth < MaxPassDepth)
+		s_PassStack[s_PassDepth] = pass;
+	s_PassDepth++;
+}
+
+void GlInstrumentation::PopPass()
+{
+	if (s_PassDepth > 0)
+		s_PassDepth--;
+}
+
+static GlCounters GetTotal()
+{
+	GlCounters total;
+	for (uint32_t i = 0; i < s_PassCount; i++)
+	{
+		for (size_t function = 0; function < s_FunctionCount; function++)
+			total.Calls[function] += s_Passes[i].Total.Calls[function];
+		total.UploadBytes += s_Passes[i].Total.UploadBytes;
+		total.Triangles += s_Passes[i].Total.Triangles;
+	}
+
+	return total;
+}
+
+static double PerFrame(uint64_t count)
+{
+	return s_Frames == 0 ? 0.0 : (double)count / (double)s_Frames;
+}
+
+uint64_t GlInstrumentation::GetCacheMismatches()
+{
+	return s_CacheMismatches;
+}
+
+void GlInstrumentation::PrintReport()
+{
+	std::cout << "GL calls per frame over " << s_Frames << " frames:\n";
+	for (uint32_t i = 0; i < s_PassCount; i++)
+	{
+		const GlCounters& counters = s_Passes[i].Total;
+		if (Sum(counters) == 0)
+			continue;
+
+		std::cout << '\t' << s_Passes[i].Name;
+		if (s_Passes[i].Index >= 0)
+			std::cout << ' ' << s_Passes[i].Index;
+		std::cout << ": " << PerFrame(Sum(counters)) << " calls, " << PerFrame(GetDrawCalls(counters)) << " draws, " << PerFrame(counters.Triangles) << " triangles, "
+			<< PerFrame(GetCachedBinds(counters)) << " binds, " << PerFrame(GetUniformUploads(counters)) << " uniform uploads, "
+			<< PerFrame(counters.UploadBytes) / 1024.0 << " KB uploaded\n";
+	}
+
+	const GlCounters total = GetTotal();
+	uint32_t order[s_FunctionCount];
+	for (uint32_t i = 0; i < s_FunctionCount; i++)
+		order[i] = i;
+	std::sort(order, order + s_FunctionCount, [&](uint32_t a, uint32_t b) { return total.Calls[a] > total.Calls[b]; });
+
+	std::cout << "\tBy entry point:";
+	for (const uint32_t function : order)
+	{
+		if (total.Calls[function] > 0)
+			std::cout << "\n\t\t" << s_FunctionNames[function] << ": " << PerFrame(total.Calls[function]);
+	}
+	std::cout << '\n';
+
+	if (s_CacheMismatches > 0)
+		std::cout << '\t' << s_CacheMismatches << " frames issued draws or binds past the RenderStateCache\n";
+}
+
+#endif
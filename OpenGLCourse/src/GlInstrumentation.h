@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+
+struct RenderStats;
+
+// Optional layer between the renderer and the driver. Install swaps the glad function pointers of every
+// entry point the renderer uses for wrappers that count the calls, the bytes handed to buffer and texture
+// uploads and the triangles drawn, attributed to the innermost GpuProfileScope that is open. Built with
+// GL_INSTRUMENTATION defined (premake --gl-instrumentation), otherwise every function here is empty.
+class GlInstrumentation
+{
+public:
+	GlInstrumentation() = delete;
+	~GlInstrumentation() = delete;
+
+#ifdef GL_INSTRUMENTATION
+	static constexpr bool Enabled = true;
+
+	// Right after glad loaded the entry points
+	static void Install();
+
+	// Render thread. Counts between frames, like loading, are dropped by BeginFrame.
+	static void BeginFrame();
+	// Checks the frame against what the RenderStateCache recorded, every draw and cached bind has to go through it
+	static void EndFrame(const RenderStats& cacheStats);
+
+	// Names have to outlive the layer, like the profiler scopes they come from
+	static void PushPass(const char* name, int32_t index);
+	static void PopPass();
+
+	// Frames in which GL saw different draws or binds than the RenderStateCache
+	static uint64_t GetCacheMismatches();
+
+	static void PrintReport();
+#else
+	static constexpr bool Enabled = false;
+
+	static void Install() {}
+	static void BeginFrame() {}
+	static void EndFrame(const RenderStats&) {}
+	static void PushPass(const char*, int32_t) {}
+	static void PopPass() {}
+	static uint64_t GetCacheMismatches() { return 0; }
+	static void PrintReport() {}
+#endif
+
+	static constexpr uint32_t MaxPasses = 32;
+	static constexpr uint32_t MaxPassDepth = 16;
+};
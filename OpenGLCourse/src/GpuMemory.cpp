@@ -0,0 +1,173 @@
+#include "GpuMemory.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <vector>
+
+#include "FrameArena.h"
+#include "Log.h"
+
+static constexpr size_t s_CategoryCount = (size_t)GpuMemoryCategory::Count;
+
+static std::atomic<uint64_t> s_Usage[s_CategoryCount];
+static std::atomic<uint64_t> s_PeakUsage[s_CategoryCount];
+static uint64_t s_Budget = 0;
+static uint64_t s_Frame = 0;
+static bool s_OverBudgetReported = false;
+
+static std::vector<GpuEvictable*> s_Resources;
+static GpuMemoryStats s_Stats;
+
+static double ToMegabytes(uint64_t bytes)
+{
+	return (double)bytes / (1024.0 * 1024.0);
+}
+
+// Evicts idle resources, least recently used first, until bytes more fit in the budget
+static bool MakeRoom(uint64_t bytes, const GpuEvictable* requester)
+{
+	if (s_Budget == 0 || GpuMemory::GetTotalUsage() + bytes <= s_Budget)
+		return true;
+
+	FrameVector<GpuEvictable*> candidates;
+	for (GpuEvictable* resource : s_Resources)
+	{
+		if (resource != requester && resource->GetLastUsedFrame() + GpuMemory::MinIdleFrames <= s_Frame)
+			candidates.push_back(resource);
+	}
+
+	std::sort(candidates.begin(), candidates.end(), [](const GpuEvictable* a, const GpuEvictable* b) { return a->GetLastUsedFrame() < b->GetLastUsedFrame(); });
+
+	for (GpuEvictable* resource : candidates)
+	{
+		while (GpuMemory::GetTotalUsage() + bytes > s_Budget && resource->Evict())
+			s_Stats.Evictions++;
+
+		if (GpuMemory::GetTotalUsage() + bytes <= s_Budget)
+			return true;
+	}
+
+	return false;
+}
+
+void GpuMemory::Allocate(GpuMemoryCategory category, uint64_t bytes)
+{
+	const size_t index = (size_t)category;
+	const uint64_t usage = s_Usage[index].fetch_add(bytes, std::memory_order_relaxed) + bytes;
+
+	uint64_t peak = s_PeakUsage[index].load(std::memory_order_relaxed);
+	while (usage > peak && !s_PeakUsage[index].compare_exchange_weak(peak, usage, std::memory_order_relaxed)) {}
+}
+
+void GpuMemory::Free(GpuMemoryCategory category, uint64_t bytes)
+{
+	s_Usage[(size_t)category].fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+void GpuMemory::Register(GpuEvictable* resource)
+{
+	s_Resources.push_back(resource);
+}
+
+void GpuMemory::Unregister(GpuEvictable* resource)
+{
+	s_Resources.erase(std::remove(s_Resources.begin(), s_Resources.end(), resource), s_Resources.end());
+}
+
+void GpuMemory::SetBudget(uint64_t bytes)
+{
+	s_Budget = bytes;
+}
+
+uint64_t GpuMemory::GetBudget()
+{
+	return s_Budget;
+}
+
+uint64_t GpuMemory::GetFrame()
+{
+	return s_Frame;
+}
+
+void GpuMemory::EndFrame()
+{
+	// Resources the frame could not draw properly come back first, eviction then only finds idle ones
+	for (GpuEvictable* resource : s_Resources)
+	{
+		const uint64_t bytes = resource->GetRestoreBytes();
+		if (bytes == 0)
+			continue;
+
+		if (MakeRoom(bytes, resource) || resource->IsRestoreRequired())
+		{
+			resource->Restore();
+			s_Stats.Restores++;
+		}
+		else
+		{
+			s_Stats.RestoresDeferred++;
+		}
+	}
+
+	const bool withinBudget = MakeRoom(0, nullptr);
+	if (!withinBudget && !s_OverBudgetReported)
+		Log::Warning("GPU memory use of {} MB is over the budget of {} MB and everything left is in use", ToMegabytes(GetTotalUsage()), ToMegabytes(s_Budget));
+
+	s_OverBudgetReported = !withinBudget;
+	s_Frame++;
+}
+
+uint64_t GpuMemory::GetUsage(GpuMemoryCategory category)
+{
+	return s_Usage[(size_t)category].load(std::memory_order_relaxed);
+}
+
+uint64_t GpuMemory::GetPeakUsage(GpuMemoryCategory category)
+{
+	return s_PeakUsage[(size_t)category].load(std::memory_order_relaxed);
+}
+
+uint64_t GpuMemory::GetTotalUsage()
+{
+	uint64_t total = 0;
+	for (size_t i = 0; i < s_CategoryCount; i++)
+		total += s_Usage[i].load(std::memory_order_relaxed);
+
+	return total;
+}
+
+const GpuMemoryStats& GpuMemory::GetStats()
+{
+	return s_Stats;
+}
+
+void GpuMemory::PrintReport()
+{
+	std::cout << "GPU memory: " << ToMegabytes(GetTotalUsage()) << " MB";
+	if (s_Budget > 0)
+		std::cout << " of a " << ToMegabytes(s_Budget) << " MB budget\n";
+	else
+		std::cout << ", no budget\n";
+
+	for (size_t i = 0; i < s_CategoryCount; i++)
+	{
+		const GpuMemoryCategory category = (GpuMemoryCategory)i;
+		std::cout << '\t' << GetCategoryName(category) << ": " << ToMegabytes(GetUsage(category)) << " MB, peak " << ToMegabytes(GetPeakUsage(category)) << " MB\n";
+	}
+
+	std::cout << '\t' << s_Stats.Evictions << " evictions, " << s_Stats.Restores << " restores, " << s_Stats.RestoresDeferred << " deferred for lack of budget\n";
+}
+
+const char* GpuMemory::GetCategoryName(GpuMemoryCategory category)
+{
+	switch (category)
+	{
+		case GpuMemoryCategory::Textures: return "Textures";
+		case GpuMemoryCategory::Meshes: return "Meshes";
+		case GpuMemoryCategory::ShadowMaps: return "Shadow maps";
+		case GpuMemoryCategory::RenderTargets: return "Render targets";
+		case GpuMemoryCategory::Buffers: return "Buffers";
+		default: return "Unknown";
+	}
+}
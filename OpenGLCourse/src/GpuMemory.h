@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+
+enum class GpuMemoryCategory : uint8_t
+{
+	Textures,
+	Meshes,
+	ShadowMaps,
+	RenderTargets,
+	Buffers,
+	Count
+};
+
+// Something that can give part of its GPU memory back and recreate it once it is needed again
+class GpuEvictable
+{
+public:
+	virtual ~GpuEvictable() = default;
+
+	// Last frame a draw needed all of it, see GpuMemory::GetFrame
+	virtual uint64_t GetLastUsedFrame() const = 0;
+	// Drops the least important part that is left, false once there is nothing left to drop
+	virtual bool Evict() = 0;
+
+	// Bytes the next Restore allocates, 0 while nothing has to come back
+	virtual uint64_t GetRestoreBytes() const = 0;
+	// Whether drawing is wrong rather than only blurrier until Restore runs
+	virtual bool IsRestoreRequired() const = 0;
+	virtual void Restore() = 0;
+};
+
+struct GpuMemoryStats
+{
+	uint64_t Evictions = 0;
+	uint64_t Restores = 0;
+	// Optional restores that were put off because the budget was taken by resources in use
+	uint64_t RestoresDeferred = 0;
+};
+
+// Accounts every GL allocation by category and keeps the total within a budget. Resources register their
+// sizes as they create and delete GL objects, the evictable ones are dropped least recently used first
+// once the budget runs out and come back when a draw needs them again.
+class GpuMemory
+{
+public:
+	GpuMemory() = delete;
+	~GpuMemory() = delete;
+
+	static void Allocate(GpuMemoryCategory category, uint64_t bytes);
+	static void Free(GpuMemoryCategory category, uint64_t bytes);
+
+	static void Register(GpuEvictable* resource);
+	static void Unregister(GpuEvictable* resource);
+
+	// 0 turns eviction off
+	static void SetBudget(uint64_t bytes);
+	static uint64_t GetBudget();
+
+	// Render thread only, like the resources it evicts
+	static uint64_t GetFrame();
+	// Restores what the frame needed and evicts down to the budget, then starts the next frame
+	static void EndFrame();
+
+	static uint64_t GetUsage(GpuMemoryCategory category);
+	static uint64_t GetPeakUsage(GpuMemoryCategory category);
+	static uint64_t GetTotalUsage();
+	static const GpuMemoryStats& GetStats();
+	static void PrintReport();
+
+	static const char* GetCategoryName(GpuMemoryCategory category);
+
+	// Resources used this recently are never evicted, so whatever is on screen does not thrash
+	static constexpr uint64_t MinIdleFrames = 120;
+};
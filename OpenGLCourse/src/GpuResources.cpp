@@ -0,0 +1,366 @@
+#include "GpuResources.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "RenderStateCache.h"
+
+static constexpr size_t s_TypeCount = (size_t)GpuResourceType::Count;
+
+struct GpuObject
+{
+	GpuResourceType Type = GpuResourceType::Buffer;
+	uint32_t Id = 0;
+	GpuMemoryCategory Category = GpuMemoryCategory::Buffers;
+	uint64_t Bytes = 0;
+	GpuBufferDesc Buffer;
+	GpuTextureDesc Texture;
+};
+
+struct GpuSlot
+{
+	GpuObject Object;
+	uint32_t Generation = 1;
+	bool Alive = false;
+};
+
+struct GpuPool
+{
+	std::vector<GpuSlot> Slots;
+	std::vector<uint32_t> FreeSlots;
+};
+
+struct RetiredObject
+{
+	GpuObject Object;
+	// Frame it was destroyed in, or put in the bin for the recycled ones
+	uint64_t Frame = 0;
+};
+
+struct FrameFence
+{
+	uint64_t Frame = 0;
+	GLsync Fence = nullptr;
+};
+
+static GpuPool s_Pools[s_TypeCount];
+// Both in the order they came in, so the front is always the oldest
+static std::vector<RetiredObject> s_Pending;
+static std::vector<RetiredObject> s_Recycled;
+static std::vector<FrameFence> s_Fences;
+static uint64_t s_Frame = 0;
+static bool s_DestroyedThisFrame = false;
+
+static void DeleteObject(const GpuObject& object)
+{
+	switch (object.Type)
+	{
+		case GpuResourceType::Buffer: glDeleteBuffers(1, &object.Id); break;
+		case GpuResourceType::Texture: glDeleteTextures(1, &object.Id); break;
+		case GpuResourceType::Framebuffer: glDeleteFramebuffers(1, &object.Id); break;
+		case GpuResourceType::VertexArray: glDeleteVertexArrays(1, &object.Id); break;
+		case GpuResourceType::Program: glDeleteProgram(object.Id); break;
+		default: break;
+	}
+}
+
+// Vertex arrays and programs carry too much state to hand out again as if they were new
+static bool IsRecyclable(GpuResourceType type)
+{
+	return type == GpuResourceType::Buffer || type == GpuResourceType::Texture || type == GpuResourceType::Framebuffer;
+}
+
+static void ResetFramebuffer(uint32_t framebuffer)
+{
+	// Attachments would keep their textures alive after those are deleted
+	glNamedFramebufferTexture(framebuffer, GL_DEPTH_STENCIL_ATTACHMENT, 0, 0);
+	for (uint32_t i = 0; i < 8; i++)
+		glNamedFramebufferTexture(framebuffer, GL_COLOR_ATTACHMENT0 + i, 0, 0);
+
+	glNamedFramebufferDrawBuffer(framebuffer, GL_COLOR_ATTACHMENT0);
+	glNamedFramebufferReadBuffer(framebuffer, GL_COLOR_ATTACHMENT0);
+}
+
+static void ResetTexture(uint32_t texture)
+{
+	constexpr float borderColor[] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
+	glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTextureParameteri(texture, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTextureParameteri(texture, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTextureParameteri(texture, GL_TEXTURE_WRAP_R, GL_REPEAT);
+	glTextureParameteri(texture, GL_TEXTURE_BASE_LEVEL, 0);
+	glTextureParameteri(texture, GL_TEXTURE_MAX_LEVEL, 1000);
+	glTextureParameteri(texture, GL_TEXTURE_COMPARE_MODE, GL_NONE);
+	glTextureParameterfv(texture, GL_TEXTURE_BORDER_COLOR, borderColor);
+}
+
+template<GpuResourceType Type>
+static GpuHandle<Type> AddToPool(const GpuObject& object)
+{
+	GpuPool& pool = s_Pools[(size_t)Type];
+
+	uint32_t slot;
+	if (!pool.FreeSlots.empty())
+	{
+		slot = pool.FreeSlots.back();
+		pool.FreeSlots.pop_back();
+	}
+	else
+	{
+		slot = (uint32_t)pool.Slots.size();
+		pool.Slots.emplace_back();
+	}
+
+	GpuSlot& entry = pool.Slots[slot];
+	entry.Object = object;
+	entry.Alive = true;
+
+	GpuMemory::Allocate(object.Category, object.Bytes);
+	return { slot + 1, entry.Generation };
+}
+
+// The oldest object in the bin that matches, erased from it
+template<typename Predicate>
+static bool TakeRecycled(GpuResourceType type, Predicate matches, GpuObject& object)
+{
+	auto it = std::find_if(s_Recycled.begin(), s_Recycled.end(), [&](const RetiredObject& r) { return r.Object.Type == type && matches(r.Object); });
+	if (it == s_Recycled.end())
+		return false;
+
+	object = it->Object;
+	s_Recycled.erase(it);
+	return true;
+}
+
+GpuBufferHandle GpuResources::CreateBuffer(const GpuBufferDesc& desc, const void* data, GpuMemoryCategory category)
+{
+	GpuObject object;
+	const bool canRefill = !data || (desc.Flags & GL_DYNAMIC_STORAGE_BIT);
+	if (canRefill && TakeRecycled(GpuResourceType::Buffer, [&](const GpuObject& o) { return o.Buffer == desc; }, object))
+	{
+		if (data)
+			glNamedBufferSubData(object.Id, 0, (GLsizeiptr)desc.Size, data);
+
+		s_Stats.Recycled++;
+	}
+	else
+	{
+		object.Type = GpuResourceType::Buffer;
+		object.Buffer = desc;
+		glCreateBuffers(1, &object.Id);
+		glNamedBufferStorage(object.Id, (GLsizeiptr)desc.Size, data, desc.Flags);
+		s_Stats.Created++;
+	}
+
+	object.Category = category;
+	object.Bytes = desc.Size;
+	return AddToPool<GpuResourceType::Buffer>(object);
+}
+
+GpuTextureHandle GpuResources::CreateTexture(const GpuTextureDesc& desc, uint64_t bytes, GpuMemoryCategory category)
+{
+	GpuObject object;
+	if (TakeRecycled(GpuResourceType::Texture, [&](const GpuObject& o) { return o.Texture == desc; }, object))
+	{
+		ResetTexture(object.Id);
+		s_Stats.Recycled++;
+	}
+	else
+	{
+		object.Type = GpuResourceType::Texture;
+		object.Texture = desc;
+		glCreateTextures(desc.Target, 1, &object.Id);
+		if (desc.Depth > 0)
+			glTextureStorage3D(object.Id, (int)desc.Levels, desc.Format, (int)desc.Width, (int)desc.Height, (int)desc.Depth);
+		else
+			glTextureStorage2D(object.Id, (int)desc.Levels, desc.Format, (int)desc.Width, (int)desc.Height);
+
+		s_Stats.Created++;
+	}
+
+	object.Category = category;
+	object.Bytes = bytes;
+	return AddToPool<GpuResourceType::Texture>(object);
+}
+
+GpuFramebufferHandle GpuResources::CreateFramebuffer()
+{
+	GpuObject object;
+	if (TakeRecycled(GpuResourceType::Framebuffer, [](const GpuObject&) { return true; }, object))
+	{
+		s_Stats.Recycled++;
+	}
+	else
+	{
+		object.Type = GpuResourceType::Framebuffer;
+		glCreateFramebuffers(1, &object.Id);
+		s_Stats.Created++;
+	}
+
+	return AddToPool<GpuResourceType::Framebuffer>(object);
+}
+
+GpuVertexArrayHandle GpuResources::CreateVertexArray()
+{
+	GpuObject object;
+	object.Type = GpuResourceType::VertexArray;
+	glCreateVertexArrays(1, &object.Id);
+	s_Stats.Created++;
+	return AddToPool<GpuResourceType::VertexArray>(object);
+}
+
+GpuProgramHandle GpuResources::CreateProgram()
+{
+	GpuObject object;
+	object.Type = GpuResourceType::Program;
+	object.Id = glCreateProgram();
+	s_Stats.Created++;
+	return AddToPool<GpuResourceType::Program>(object);
+}
+
+void GpuResources::DestroySlot(GpuResourceType type, uint32_t index, uint32_t generation)
+{
+	GpuPool& pool = s_Pools[(size_t)type];
+	if (index == 0 || index > pool.Slots.size())
+		return;
+
+	GpuSlot& slot = pool.Slots[index - 1];
+	if (!slot.Alive || slot.Generation != generation)
+		return;
+
+	// The budget only sees what is in use, eviction has to make room the moment it destroys something
+	GpuMemory::Free(slot.Object.Category, slot.Object.Bytes);
+
+	s_Pending.push_back({ slot.Object, s_Frame });
+	s_DestroyedThisFrame = true;
+
+	slot.Alive = false;
+	slot.Generation = std::max(slot.Generation + 1, 1u);
+	pool.FreeSlots.push_back(index - 1);
+}
+
+uint32_t GpuResources::GetSlotId(GpuResourceType type, uint32_t index, uint32_t generation)
+{
+	const GpuPool& pool = s_Pools[(size_t)type];
+	if (index == 0 || index > pool.Slots.size())
+		return 0;
+
+	const GpuSlot& slot = pool.Slots[index - 1];
+	return slot.Alive && slot.Generation == generation ? slot.Object.Id : 0;
+}
+
+void GpuResources::EndFrame()
+{
+	if (s_DestroyedThisFrame)
+	{
+		s_Fences.push_back({ s_Frame, glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0) });
+		s_DestroyedThisFrame = false;
+	}
+
+	// Fences signal in order, the first one that has not stops the search
+	size_t signalled = 0;
+	uint64_t completedFrame = 0;
+	while (signalled < s_Fences.size())
+	{
+		const GLenum status = glClientWaitSync(s_Fences[signalled].Fence, 0, 0);
+		if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+			break;
+
+		glDeleteSync(s_Fences[signalled].Fence);
+		completedFrame = s_Fences[signalled].Frame;
+		signalled++;
+	}
+
+	s_Fences.erase(s_Fences.begin(), s_Fences.begin() + (std::ptrdiff_t)signalled);
+
+	bool deleted = false;
+	size_t retired = 0;
+	if (signalled > 0)
+	{
+		for (; retired < s_Pending.size() && s_Pending[retired].Frame <= completedFrame; retired++)
+		{
+			const GpuObject& object = s_Pending[retired].Object;
+			if (IsRecyclable(object.Type))
+			{
+				if (object.Type == GpuResourceType::Framebuffer)
+					ResetFramebuffer(object.Id);
+
+				s_Recycled.push_back({ object, s_Frame });
+			}
+			else
+			{
+				DeleteObject(object);
+				s_Stats.Deleted++;
+				deleted = true;
+			}
+		}
+	}
+
+	s_Pending.erase(s_Pending.begin(), s_Pending.begin() + (std::ptrdiff_t)retired);
+
+	size_t expired = 0;
+	while (expired < s_Recycled.size() && (s_Recycled[expired].Frame + RecycleFrames <= s_Frame || s_Recycled.size() - expired > MaxRecycled))
+	{
+		DeleteObject(s_Recycled[expired].Object);
+		s_Stats.Deleted++;
+		deleted = true;
+		expired++;
+	}
+
+	s_Recycled.erase(s_Recycled.begin(), s_Recycled.begin() + (std::ptrdiff_t)expired);
+
+	// Names of deleted objects come back with the next create, the cache would skip binding them
+	if (deleted)
+		RenderStateCache::Invalidate();
+
+	s_Frame++;
+}
+
+void GpuResources::Shutdown()
+{
+	for (FrameFence& fence : s_Fences)
+		glDeleteSync(fence.Fence);
+
+	for (GpuPool& pool : s_Pools)
+	{
+		for (uint32_t i = 0; i < (uint32_t)pool.Slots.size(); i++)
+		{
+			GpuSlot& slot = pool.Slots[i];
+			if (!slot.Alive)
+				continue;
+
+			GpuMemory::Free(slot.Object.Category, slot.Object.Bytes);
+			DeleteObject(slot.Object);
+			s_Stats.Deleted++;
+			slot.Alive = false;
+			slot.Generation = std::max(slot.Generation + 1, 1u);
+			pool.FreeSlots.push_back(i);
+		}
+	}
+
+	for (const RetiredObject& retired : s_Pending)
+		DeleteObject(retired.Object);
+	for (const RetiredObject& retired : s_Recycled)
+		DeleteObject(retired.Object);
+
+	s_Stats.Deleted += s_Pending.size() + s_Recycled.size();
+	s_Fences.clear();
+	s_Pending.clear();
+	s_Recycled.clear();
+	s_DestroyedThisFrame = false;
+	RenderStateCache::Invalidate();
+}
+
+uint32_t GpuResources::GetPendingCount()
+{
+	return (uint32_t)s_Pending.size();
+}
+
+uint32_t GpuResources::GetRecycledCount()
+{
+	return (uint32_t)s_Recycled.size();
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+
+#include "GpuMemory.h"
+
+enum class GpuResourceType : uint8_t
+{
+	Buffer,
+	Texture,
+	Framebuffer,
+	VertexArray,
+	Program,
+	Count
+};
+
+// Refers to a pooled GL object. Destroying it bumps the generation of its slot, so copies that are
+// still around resolve to 0 instead of whatever object gets the slot next.
+template<GpuResourceType Type>
+struct GpuHandle
+{
+	// Slot + 1, 0 is the null handle
+	uint32_t Index = 0;
+	uint32_t Generation = 0;
+
+	explicit operator bool() const { return Index != 0; }
+	bool operator==(const GpuHandle&) const = default;
+};
+
+using GpuBufferHandle = GpuHandle<GpuResourceType::Buffer>;
+using GpuTextureHandle = GpuHandle<GpuResourceType::Texture>;
+using GpuFramebufferHandle = GpuHandle<GpuResourceType::Framebuffer>;
+using GpuVertexArrayHandle = GpuHandle<GpuResourceType::VertexArray>;
+using GpuProgramHandle = GpuHandle<GpuResourceType::Program>;
+
+struct GpuBufferDesc
+{
+	uint64_t Size = 0;
+	// glNamedBufferStorage flags, without GL_DYNAMIC_STORAGE_BIT a buffer is only recycled for creates without data
+	uint32_t Flags = 0;
+
+	bool operator==(const GpuBufferDesc&) const = default;
+};
+
+struct GpuTextureDesc
+{
+	uint32_t Target = 0;
+	uint32_t Format = 0;
+	uint32_t Width = 0, Height = 0;
+	// Layers of an array, 0 for everything else
+	uint32_t Depth = 0;
+	uint32_t Levels = 1;
+
+	bool operator==(const GpuTextureDesc&) const = default;
+};
+
+struct GpuResourceStats
+{
+	uint64_t Created = 0;
+	uint64_t Recycled = 0;
+	uint64_t Deleted = 0;
+};
+
+// Owns every GL buffer, texture, framebuffer, vertex array and program. Objects live in pooled slots
+// behind generational handles. Destroying one only queues it: it stays alive until the fence of the
+// frame that destroyed it has signalled, so a delete never waits on or breaks a frame still in flight.
+// Retired buffers, textures and framebuffers go to a recycle bin that creates with the same description
+// take from before asking the driver for a new one. Render thread only, or while it is not running.
+class GpuResources
+{
+public:
+	GpuResources() = delete;
+	~GpuResources() = delete;
+
+	// Storage is immutable, data may be null
+	static GpuBufferHandle CreateBuffer(const GpuBufferDesc& desc, const void* data, GpuMemoryCategory category);
+	// Storage only, the parameters are back at the GL defaults. Bytes is what GpuMemory accounts for it.
+	static GpuTextureHandle CreateTexture(const GpuTextureDesc& desc, uint64_t bytes, GpuMemoryCategory category);
+	// Without attachments, draw and read buffer are GL_COLOR_ATTACHMENT0
+	static GpuFramebufferHandle CreateFramebuffer();
+	static GpuVertexArrayHandle CreateVertexArray();
+	static GpuProgramHandle CreateProgram();
+
+	// Resets the handle, stale and null handles are ignored
+	template<GpuResourceType Type>
+	static void Destroy(GpuHandle<Type>& handle)
+	{
+		DestroySlot(Type, handle.Index, handle.Generation);
+		handle = {};
+	}
+
+	// 0 for null and stale handles
+	template<GpuResourceType Type>
+	static uint32_t GetId(GpuHandle<Type> handle) { return GetSlotId(Type, handle.Index, handle.Generation); }
+
+	// Fences what was destroyed this frame and retires what the GPU is done with
+	static void EndFrame();
+	// Deletes every object right away, handles that are still held go stale. Needs the context.
+	static void Shutdown();
+
+	static const GpuResourceStats& GetStats() { return s_Stats; }
+	// Objects waiting on a fence
+	static uint32_t GetPendingCount();
+	static uint32_t GetRecycledCount();
+
+	// Frames a retired object waits in the bin before it is deleted for real
+	static constexpr uint64_t RecycleFrames = 120;
+	static constexpr uint32_t MaxRecycled = 64;
+
+private:
+	static void DestroySlot(GpuResourceType type, uint32_t index, uint32_t generation);
+	static uint32_t GetSlotId(GpuResourceType type, uint32_t index, uint32_t generation);
+
+private:
+	inline static GpuResourceStats s_Stats;
+};
@@ -1,29 +1,126 @@
 #include "Input.h"
 
+#include <iostream>
+#include <memory>
+
 #include <GLFW/glfw3.h>
 
 static Window* s_CurrentWindow;
 
+static InputState s_State;
+static std::unique_ptr<InputRecordWriter> s_Recording;
+static std::unique_ptr<InputRecordReader> s_Replay;
+static float s_ReplayTimestep = 0.0f;
+// Start of the frame Update snapshots next, in recording or replay time
+static float s_Time = 0.0f;
+static uint64_t s_Frames = 0;
+
+static void PollWindow(GLFWwindow* window, InputState& state)
+{
+	for (uint32_t key = InputState::FirstKey; key < InputState::KeyCount; key++)
+		state.Keys[key] = glfwGetKey(window, (int)key) == GLFW_PRESS;
+
+	state.MouseButtons = 0;
+	for (uint32_t button = 0; button < InputState::MouseButtonCount; button++)
+	{
+		if (glfwGetMouseButton(window, (int)button) == GLFW_PRESS)
+			state.MouseButtons |= (uint8_t)(1 << button);
+	}
+
+	double x, y;
+	glfwGetCursorPos(window, &x, &y);
+	state.MousePosition = { (float)x, (float)y };
+}
+
 void Input::SetContext(Window* currentWindow)
 {
 	s_CurrentWindow = currentWindow;
 }
 
+float Input::Update(float wallDeltaTime)
+{
+	s_Frames++;
+	if (s_Replay)
+	{
+		s_Replay->Advance(s_Time, s_State);
+		s_Time += s_ReplayTimestep;
+		return s_ReplayTimestep;
+	}
+
+	PollWindow(s_CurrentWindow->m_Window, s_State);
+	if (s_Recording)
+		s_Recording->Write(s_Time, s_State);
+
+	s_Time += wallDeltaTime;
+	return wallDeltaTime;
+}
+
+bool Input::StartRecording(const std::filesystem::path& path)
+{
+	Stop();
+	auto recording = std::make_unique<InputRecordWriter>();
+	if (!recording->Open(path))
+		return false;
+
+	s_Recording = std::move(recording);
+	s_Time = 0.0f;
+	s_Frames = 0;
+	return true;
+}
+
+bool Input::StartReplay(const std::filesystem::path& path, float timestep)
+{
+	Stop();
+	auto replay = std::make_unique<InputRecordReader>();
+	if (!replay->Open(path))
+		return false;
+
+	s_Replay = std::move(replay);
+	s_ReplayTimestep = timestep;
+	s_State = InputState();
+	s_Time = 0.0f;
+	s_Frames = 0;
+	return true;
+}
+
+void Input::Stop()
+{
+	if (s_Recording)
+	{
+		s_Recording->Close(s_Time);
+		std::cout << "Recorded " << s_Frames << " frames of input in " << s_Recording->GetEventCount() << " events\n";
+	}
+
+	s_Recording.reset();
+	s_Replay.reset();
+}
+
+bool Input::IsReplaying()
+{
+	return s_Replay != nullptr;
+}
+
+bool Input::IsReplayFinished()
+{
+	return s_Replay && s_Time > s_Replay->GetDuration();
+}
+
+uint64_t Input::GetFrameCount()
+{
+	return s_Frames;
+}
+
 bool Input::IsKeyPressed(KeyCode key)
 {
-	int32_t state = glfwGetKey(s_CurrentWindow->m_Window, key);
-	return state == GLFW_PRESS;
+	return key < InputState::KeyCount && s_State.Keys[key];
 }
 
 bool Input::IsMouseButtonPressed(MouseCode button)
 {
-	int32_t state = glfwGetMouseButton(s_CurrentWindow->m_Window, button);
-	return state == GLFW_PRESS;
+	return button < InputState::MouseButtonCount && (s_State.MouseButtons & (1 << button));
 }
 
 glm::vec2 Input::GetMousePosition()
 {
-	double x, y;
-	glfwGetCursorPos(s_CurrentWindow->m_Window, &x, &y);
-	return { (float)x, (float)y };
+	return s_State.MousePosition;
 }
@@ -1,9 +1,15 @@
 #pragma once
 
+#include <filesystem>
+
 #include "Window.h"
+#include "InputRecording.h"
 #include "KeyCodes.h"
 #include "MouseCodes.h"
 
+// Input of the current frame. Update takes a snapshot once a frame, from the window or from a
+// recording being replayed, and everything else reads that snapshot, so a replay feeds the
+// simulation exactly what the recorded session saw.
 class Input
 {
 public:
@@ -11,8 +17,23 @@ public:
 	~Input() = delete;
 
 	static void SetContext(Window* currentWindow);
+
+	// Main thread, once a frame before anything reads input. Returns the time step the frame simulates,
+	// the wall clock one except in replays, which step by their fixed timestep.
+	static float Update(float wallDeltaTime);
+
+	// Writes the snapshot of every frame from here on until Stop
+	static bool StartRecording(const std::filesystem::path& path);
+	// The window is not polled at all during a replay
+	static bool StartReplay(const std::filesystem::path& path, float timestep);
+	static void Stop();
+
+	static bool IsReplaying();
+	// Once the next frame would start past the end of the recording
+	static bool IsReplayFinished();
+	static uint64_t GetFrameCount();
+
 	static bool IsKeyPressed(KeyCode key);
 	static bool IsMouseButtonPressed(MouseCode button);
 	static glm::vec2 GetMousePosition();
 };
-
@@ -0,0 +1,178 @@
+#include "InputRecording.h"
+
+#include <cstring>
+#include <iostream>
+
+#include "Utils.h"
+
+static constexpr char s_Magic[4] = { 'I', 'R', 'E', 'C' };
+static constexpr uint32_t s_Version = 1;
+// Magic, version and duration
+static constexpr size_t s_HeaderSize = 12;
+static constexpr size_t s_DurationOffset = 8;
+
+enum InputEventFlags : uint8_t
+{
+	KeysChanged = 1 << 0,
+	MouseMoved = 1 << 1,
+	MouseButtonsChanged = 1 << 2
+};
+
+template<typename T>
+static void WriteValue(std::ofstream& file, const T& value)
+{
+	file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+InputRecordWriter::~InputRecordWriter()
+{
+	if (IsOpen())
+		Close(m_LastTime);
+}
+
+bool InputRecordWriter::Open(const std::filesystem::path& path)
+{
+	m_File.open(path, std::ios::binary | std::ios::trunc);
+	if (!m_File)
+	{
+		std::cerr << "Failed to create input recording '" << path.string() << "'\n";
+		return false;
+	}
+
+	m_File.write(s_Magic, sizeof(s_Magic));
+	WriteValue(m_File, s_Version);
+	WriteValue(m_File, 0.0f);
+	m_HasLast = false;
+	m_EventCount = 0;
+	return true;
+}
+
+void InputRecordWriter::Write(float time, const InputState& state)
+{
+	m_LastTime = time;
+
+	uint16_t toggled[InputState::KeyCount];
+	uint16_t toggledCount = 0;
+	for (uint32_t key = InputState::FirstKey; key < InputState::KeyCount; key++)
+	{
+		if (!m_HasLast ? state.Keys[key] : state.Keys[key] != m_Last.Keys[key])
+			toggled[toggledCount++] = (uint16_t)key;
+	}
+
+	uint8_t flags = 0;
+	if (toggledCount > 0)
+		flags |= KeysChanged;
+	if (!m_HasLast || state.MousePosition != m_Last.MousePosition)
+		flags |= MouseMoved;
+	if (!m_HasLast || state.MouseButtons != m_Last.MouseButtons)
+		flags |= MouseButtonsChanged;
+
+	m_Last = state;
+	m_HasLast = true;
+	if (flags == 0)
+		return;
+
+	WriteValue(m_File, time);
+	WriteValue(m_File, flags);
+	if (flags & KeysChanged)
+	{
+		WriteValue(m_File, toggledCount);
+		m_File.write(reinterpret_cast<const char*>(toggled), sizeof(uint16_t) * toggledCount);
+	}
+	if (flags & MouseMoved)
+	{
+		WriteValue(m_File, state.MousePosition.x);
+		WriteValue(m_File, state.MousePosition.y);
+	}
+	if (flags & MouseButtonsChanged)
+		WriteValue(m_File, state.MouseButtons);
+
+	m_EventCount++;
+}
+
+void InputRecordWriter::Close(float duration)
+{
+	m_File.seekp(s_DurationOffset);
+	WriteValue(m_File, duration);
+	m_File.close();
+}
+
+bool InputRecordReader::Open(const std::filesystem::path& path)
+{
+	m_Data = Utils::ReadFileToBytes(path);
+	m_Offset = s_HeaderSize;
+
+	uint32_t version = 0;
+	if (m_Data.size() >= s_HeaderSize)
+		memcpy(&version, m_Data.data() + sizeof(s_Magic), sizeof(version));
+
+	if (m_Data.size() < s_HeaderSize || memcmp(m_Data.data(), s_Magic, sizeof(s_Magic)) != 0 || version != s_Version)
+	{
+		std::cerr << "'" << path.string() << "' is not an input recording of version " << s_Version << "\n";
+		m_Data.clear();
+		return false;
+	}
+
+	memcpy(&m_Duration, m_Data.data() + s_DurationOffset, sizeof(m_Duration));
+	return true;
+}
+
+void InputRecordReader::Advance(float time, InputState& state)
+{
+	while (m_Offset + sizeof(float) <= m_Data.size())
+	{
+		float eventTime = 0.0f;
+		memcpy(&eventTime, m_Data.data() + m_Offset, sizeof(eventTime));
+		if (eventTime > time)
+			return;
+
+		if (!ReadEvent(state))
+		{
+			std::cerr << "Input recording is truncated, ignoring the rest of it\n";
+			m_Offset = m_Data.size();
+			return;
+		}
+	}
+}
+
+bool InputRecordReader::ReadEvent(InputState& state)
+{
+	size_t offset = m_Offset + sizeof(float);
+	auto read = [&](void* value, size_t size)
+	{
+		if (offset + size > m_Data.size())
+			return false;
+		memcpy(value, m_Data.data() + offset, size);
+		offset += size;
+		return true;
+	};
+
+	uint8_t flags = 0;
+	if (!read(&flags, sizeof(flags)))
+		return false;
+
+	if (flags & KeysChanged)
+	{
+		uint16_t count = 0;
+		if (!read(&count, sizeof(count)))
+			return false;
+
+		for (uint16_t i = 0; i < count; i++)
+		{
+			uint16_t key = 0;
+			if (!read(&key, sizeof(key)))
+				return false;
+			if (key < InputState::KeyCount)
+				state.Keys.flip(key);
+		}
+	}
+
+	if ((flags & MouseMoved) && (!read(&state.MousePosition.x, sizeof(float)) || !read(&state.MousePosition.y, sizeof(float))))
+		return false;
+
+	if ((flags & MouseButtonsChanged) && !read(&state.MouseButtons, sizeof(state.MouseButtons)))
+		return false;
+
+	m_Offset = offset;
+	return true;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <bitset>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include <glm/vec2.hpp>
+
+#include "KeyCodes.h"
+#include "MouseCodes.h"
+
+// Everything Input reports for one frame
+struct InputState
+{
+	// Space is the first key GLFW reports, Menu the last
+	static constexpr KeyCode FirstKey = Space;
+	static constexpr uint32_t KeyCount = Menu + 1;
+	static constexpr uint32_t MouseButtonCount = ButtonLast + 1;
+
+	std::bitset<KeyCount> Keys;
+	uint8_t MouseButtons = 0;
+	glm::vec2 MousePosition{ 0.0f };
+};
+
+// An input recording is a header followed by one event for every frame in which the input changed:
+// its time, which parts changed and only those, keys as the list of codes that toggled.
+// The duration in the header is patched in when the recording is closed.
+class InputRecordWriter
+{
+public:
+	InputRecordWriter() = default;
+	~InputRecordWriter();
+
+	bool Open(const std::filesystem::path& path);
+	// Time in seconds since the start, only writes anything when the state differs from the last one
+	void Write(float time, const InputState& state);
+	void Close(float duration);
+
+	bool IsOpen() const { return m_File.is_open(); }
+	uint64_t GetEventCount() const { return m_EventCount; }
+
+private:
+	std::ofstream m_File;
+	InputState m_Last;
+	bool m_HasLast = false;
+	uint64_t m_EventCount = 0;
+	float m_LastTime = 0.0f;
+};
+
+class InputRecordReader
+{
+public:
+	InputRecordReader() = default;
+	~InputRecordReader() = default;
+
+	bool Open(const std::filesystem::path& path);
+	// Applies every event up to and including time to state, times have to increase from call to call
+	void Advance(float time, InputState& state);
+
+	float GetDuration() const { return m_Duration; }
+
+private:
+	bool ReadEvent(InputState& state);
+
+	std::vector<uint8_t> m_Data;
+	size_t m_Offset = 0;
+	float m_Duration = 0.0f;
+};
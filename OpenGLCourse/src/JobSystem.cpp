@@ -0,0 +1,315 @@
+#include "JobSystem.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+#include "FrameArena.h"
+
+struct JobThreadContext
+{
+	WorkStealingDeque Deque;
+	Job Jobs[JobSystem::JobRingSize];
+	uint32_t NextJob = 0;
+	uint32_t RandomState = 0;
+};
+
+static std::vector<std::unique_ptr<JobThreadContext>> s_Contexts;
+static std::vector<std::thread> s_Workers;
+static std::atomic<uint32_t> s_NextExternalContext = 0;
+
+static std::atomic<bool> s_Running = false;
+static std::atomic<int32_t> s_QueuedJobs = 0;
+static std::atomic<uint32_t> s_SleepingWorkers = 0;
+static std::mutex s_SleepMutex;
+static std::condition_variable s_SleepCondition;
+
+static thread_local JobThreadContext* t_Context = nullptr;
+
+bool WorkStealingDeque::Push(Job* job)
+{
+	const int64_t bottom = m_Bottom.load(std::memory_order_relaxed);
+	const int64_t top = m_Top.load(std::memory_order_acquire);
+
+	if (bottom - top >= Capacity)
+		return false;
+
+	m_Buffer[bottom & (Capacity - 1)].store(job, std::memory_order_relaxed);
+	m_Bottom.store(bottom + 1, std::memory_order_seq_cst);
+	return true;
+}
+
+Job* WorkStealingDeque::Pop()
+{
+	const int64_t bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+	m_Bottom.store(bottom, std::memory_order_seq_cst);
+	int64_t top = m_Top.load(std::memory_order_seq_cst);
+
+	if (top > bottom)
+	{
+		// Empty, restore the bottom
+		m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	Job* job = m_Buffer[bottom & (Capacity - 1)].load(std::memory_order_relaxed);
+	if (top == bottom)
+	{
+		// Last entry, race any thief for it
+		if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			job = nullptr;
+
+		m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+	}
+
+	return job;
+}
+
+Job* WorkStealingDeque::Steal()
+{
+	int64_t top = m_Top.load(std::memory_order_seq_cst);
+	const int64_t bottom = m_Bottom.load(std::memory_order_seq_cst);
+
+	if (top >= bottom)
+		return nullptr;
+
+	Job* job = m_Buffer[top & (Capacity - 1)].load(std::memory_order_relaxed);
+	if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		return nullptr;
+
+	return job;
+}
+
+void JobSystem::Init(uint32_t workerCount, uint32_t maxExternalThreads)
+{
+	if (s_Initialized)
+		return;
+
+	if (workerCount == AutoWorkerCount)
+	{
+		const uint32_t hardwareThreads = std::thread::hardware_concurrency();
+		workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+	}
+
+	s_WorkerCount = workerCount;
+
+	// Slot 0 is the calling thread, then the workers, then room for threads that register later
+	const uint32_t contextCount = 1 + workerCount + maxExternalThreads;
+	s_Contexts.reserve(contextCount);
+	for (uint32_t i = 0; i < contextCount; i++)
+	{
+		auto& context = s_Contexts.emplace_back(std::make_unique<JobThreadContext>());
+		context->RandomState = 0x9E3779B9u * (i + 1);
+	}
+
+	s_NextExternalContext = 1 + workerCount;
+	t_Context = s_Contexts[0].get();
+
+	s_Running = true;
+	s_Initialized = true;
+
+	s_Workers.reserve(workerCount);
+	for (uint32_t i = 0; i < workerCount; i++)
+		s_Workers.emplace_back(&JobSystem::WorkerLoop, i + 1);
+}
+
+void JobSystem::Shutdown()
+{
+	if (!s_Initialized)
+		return;
+
+	{
+		std::lock_guard lock(s_SleepMutex);
+		s_Running = false;
+	}
+	s_SleepCondition.notify_all();
+
+	for (auto& worker : s_Workers)
+		worker.join();
+
+	s_Workers.clear();
+	s_Contexts.clear();
+	s_QueuedJobs = 0;
+	t_Context = nullptr;
+	s_WorkerCount = 0;
+	s_Initialized = false;
+}
+
+void JobSystem::RegisterThread()
+{
+	if (t_Context)
+		return;
+
+	const uint32_t index = s_NextExternalContext.fetch_add(1);
+	if (index >= s_Contexts.size())
+	{
+		std::cerr << "JobSystem: too many threads registered, increase maxExternalThreads.\n";
+		std::abort();
+	}
+
+	t_Context = s_Contexts[index].get();
+}
+
+void JobSystem::WaitFor(const JobCounter& counter)
+{
+	while (!counter.IsDone())
+	{
+		if (!TryRunOne())
+			std::this_thread::yield();
+	}
+}
+
+Job* JobSystem::AllocateJob()
+{
+	if (!t_Context)
+		RegisterThread();
+
+	uint32_t skipped = 0;
+	while (true)
+	{
+		// Jobs run while waiting may allocate from the ring too, so the next slot is read again every time
+		Job* job = &t_Context->Jobs[t_Context->NextJob];
+		if (!job->InUse.load(std::memory_order_acquire))
+		{
+			job->InUse.store(true, std::memory_order_relaxed);
+			t_Context->NextJob = (t_Context->NextJob + 1) & (JobRingSize - 1);
+			return job;
+		}
+
+		// The ring went all the way around and the oldest job is still queued, run jobs until it is done
+		if (TryRunOne())
+			continue;
+
+		// Nothing left to run, so the job is running on another thread, held back by RunAfter or waiting
+		// further up this thread's stack. Any free slot does.
+		t_Context->NextJob = (t_Context->NextJob + 1) & (JobRingSize - 1);
+		if (++skipped % JobRingSize == 0)
+			std::this_thread::yield();
+	}
+}
+
+void JobSystem::Submit(Job* job)
+{
+	if (!t_Context->Deque.Push(job))
+	{
+		// The deque is full, so doing the work here is as good as queueing it
+		Execute(job);
+		return;
+	}
+
+	s_QueuedJobs.fetch_add(1);
+	if (s_SleepingWorkers.load() > 0)
+		s_SleepCondition.notify_one();
+}
+
+void JobSystem::SubmitAfter(JobCounter& dependency, Job* job)
+{
+	{
+		std::lock_guard lock(dependency.m_ContinuationMutex);
+		if (dependency.m_Pending.load() != 0)
+		{
+			dependency.m_Continuations.push_back(job);
+			return;
+		}
+	}
+
+	Submit(job);
+}
+
+void JobSystem::Execute(Job* job)
+{
+	JobCounter* counter = job->Counter;
+
+	// Whatever a job takes from the frame arena is gone when it finishes, so jobs run inside WaitFor
+	// leave the frame of the waiting thread as it was
+	FrameArena& arena = FrameArena::Get();
+	const FrameArena::Marker marker = arena.GetMarker();
+	job->Function(*job);
+	arena.Rewind(marker);
+
+	// Nothing touches the job after this, its thread may reuse the slot right away
+	job->InUse.store(false, std::memory_order_release);
+
+	if (!counter)
+		return;
+
+	// A waiter may destroy the counter as soon as it is done, so the last access has to be the release below
+	counter->m_Releasing.fetch_add(1);
+
+	if (counter->m_Pending.fetch_sub(1) == 1)
+	{
+		std::vector<Job*> continuations;
+		{
+			std::lock_guard lock(counter->m_ContinuationMutex);
+			continuations.swap(counter->m_Continuations);
+		}
+
+		for (Job* continuation : continuations)
+			Submit(continuation);
+	}
+
+	counter->m_Releasing.fetch_sub(1);
+}
+
+bool JobSystem::TryRunOne()
+{
+	JobThreadContext* context = t_Context;
+	if (!context)
+		return false;
+
+	Job* job = context->Deque.Pop();
+
+	if (!job)
+	{
+		// xorshift, only used to spread the thieves over the victims
+		uint32_t& state = context->RandomState;
+		state ^= state << 13; state ^= state >> 17; state ^= state << 5;
+
+		const size_t contextCount = s_Contexts.size();
+		const size_t start = state % contextCount;
+		for (size_t i = 0; i < contextCount && !job; i++)
+		{
+			JobThreadContext* victim = s_Contexts[(start + i) % contextCount].get();
+			if (victim != context)
+				job = victim->Deque.Steal();
+		}
+	}
+
+	if (!job)
+		return false;
+
+	s_QueuedJobs.fetch_sub(1);
+	Execute(job);
+	return true;
+}
+
+void JobSystem::WorkerLoop(uint32_t index)
+{
+	t_Context = s_Contexts[index].get();
+	uint32_t idleSpins = 0;
+
+	while (s_Running.load(std::memory_order_relaxed))
+	{
+		if (TryRunOne())
+		{
+			idleSpins = 0;
+			continue;
+		}
+
+		if (++idleSpins < 64)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		// The timeout covers a push that lands between the check and the wait
+		std::unique_lock lock(s_SleepMutex);
+		s_SleepingWorkers.fetch_add(1);
+		s_SleepCondition.wait_for(lock, std::chrono::milliseconds(1), [] { return s_QueuedJobs.load() > 0 || !s_Running; });
+		s_SleepingWorkers.fetch_sub(1);
+	}
+
+	t_Context = nullptr;
+}
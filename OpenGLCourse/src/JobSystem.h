@@ -0,0 +1,150 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+struct Job;
+
+// Counts the jobs that still have to finish. Jobs queued with RunAfter are held back here
+// and only pushed once the count drops to zero.
+class JobCounter
+{
+public:
+	JobCounter() = default;
+	JobCounter(const JobCounter&) = delete;
+	JobCounter& operator=(const JobCounter&) = delete;
+
+	// m_Releasing keeps the counter alive while the last job is still queueing the continuations
+	bool IsDone() const { return m_Pending.load() == 0 && m_Releasing.load() == 0; }
+
+private:
+	std::atomic<uint32_t> m_Pending = 0;
+	std::atomic<uint32_t> m_Releasing = 0;
+
+	std::mutex m_ContinuationMutex;
+	std::vector<Job*> m_Continuations;
+
+	friend class JobSystem;
+};
+
+struct Job
+{
+	static constexpr size_t PayloadSize = 64;
+
+	void (*Function)(Job& job) = nullptr;
+	JobCounter* Counter = nullptr;
+	// Set from allocation until the job has run, its ring slot is not handed out again before that
+	std::atomic<bool> InUse = false;
+	alignas(std::max_align_t) unsigned char Payload[PayloadSize];
+};
+
+// Fixed size Chase-Lev deque. The owning thread pushes and pops at the bottom, every other thread steals from the top.
+class WorkStealingDeque
+{
+public:
+	static constexpr int64_t Capacity = 4096;
+
+	bool Push(Job* job);
+	Job* Pop();
+	Job* Steal();
+
+private:
+	alignas(64) std::atomic<int64_t> m_Top = 0;
+	alignas(64) std::atomic<int64_t> m_Bottom = 0;
+	std::atomic<Job*> m_Buffer[Capacity] = {};
+};
+
+// Work stealing job system. Every worker and every registered thread owns a deque; idle threads steal
+// from random victims. Jobs are allocated from a per-thread ring of JobRingSize entries; a thread with that
+// many jobs in flight runs queued jobs itself until a slot is free again.
+class JobSystem
+{
+public:
+	JobSystem() = delete;
+	~JobSystem() = delete;
+
+	static constexpr uint32_t AutoWorkerCount = UINT32_MAX;
+
+	// AutoWorkerCount picks one worker per hardware thread minus the calling one.
+	// The calling thread becomes a job thread too and can help in WaitFor.
+	static void Init(uint32_t workerCount = AutoWorkerCount, uint32_t maxExternalThreads = 4);
+	static void Shutdown();
+
+	// Lets another thread (e.g. the render thread) submit jobs and help in WaitFor
+	static void RegisterThread();
+
+	static bool IsInitialized() { return s_Initialized; }
+	static uint32_t GetWorkerCount() { return s_WorkerCount; }
+
+	template<typename F>
+	static void Run(F&& function, JobCounter* counter = nullptr)
+	{
+		Submit(CreateJob(std::forward<F>(function), counter));
+	}
+
+	// Held back until dependency reaches zero, then queued like any other job
+	template<typename F>
+	static void RunAfter(JobCounter& dependency, F&& function, JobCounter* counter = nullptr)
+	{
+		SubmitAfter(dependency, CreateJob(std::forward<F>(function), counter));
+	}
+
+	// Calls function(begin, end) over [0, count) split into ranges of at most grainSize.
+	// Every job gets its own copy of function, callers usually pass a temporary that is gone by the time they wait.
+	template<typename F>
+	static void ParallelFor(uint32_t count, uint32_t grainSize, const F& function, JobCounter* counter)
+	{
+		grainSize = grainSize ? grainSize : 1;
+		for (uint32_t begin = 0; begin < count; begin += grainSize)
+		{
+			const uint32_t end = count - begin > grainSize ? begin + grainSize : count;
+			Run([function, begin, end]() { function(begin, end); }, counter);
+		}
+	}
+
+	// Runs other jobs on the calling thread until the counter reaches zero
+	static void WaitFor(const JobCounter& counter);
+
+	static constexpr uint32_t JobRingSize = 4096;
+
+private:
+	template<typename F>
+	static Job* CreateJob(F&& function, JobCounter* counter)
+	{
+		using Functor = std::decay_t<F>;
+		static_assert(sizeof(Functor) <= Job::PayloadSize, "Job captures too much state, capture a pointer instead.");
+		static_assert(alignof(Functor) <= alignof(std::max_align_t));
+
+		Job* job = AllocateJob();
+		job->Counter = counter;
+		job->Function = [](Job& self)
+		{
+			Functor* functor = std::launder(reinterpret_cast<Functor*>(self.Payload));
+			(*functor)();
+			functor->~Functor();
+		};
+		new (job->Payload) Functor(std::forward<F>(function));
+
+		if (counter)
+			counter->m_Pending.fetch_add(1, std::memory_order_relaxed);
+
+		return job;
+	}
+
+	static Job* AllocateJob();
+	static void Submit(Job* job);
+	static void SubmitAfter(JobCounter& dependency, Job* job);
+	static void Execute(Job* job);
+	static bool TryRunOne();
+	static void WorkerLoop(uint32_t index);
+
+private:
+	inline static bool s_Initialized = false;
+	inline static uint32_t s_WorkerCount = 0;
+};
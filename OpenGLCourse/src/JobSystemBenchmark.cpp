@@ -0,0 +1,74 @@
+#include "JobSystemBenchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "JobSystem.h"
+
+static constexpr uint32_t s_TransformCount = 1 << 20;
+static constexpr uint32_t s_EmptyJobCount = 1 << 16;
+static constexpr uint32_t s_Iterations = 10;
+
+static double MeasureMs(const auto& function)
+{
+	const auto start = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < s_Iterations; i++)
+		function();
+
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / s_Iterations;
+}
+
+void RunJobSystemBenchmark()
+{
+	std::vector<glm::mat4> locals(s_TransformCount);
+	std::vector<glm::mat4> worlds(s_TransformCount);
+	for (uint32_t i = 0; i < s_TransformCount; i++)
+		locals[i] = glm::translate(glm::mat4(1.0f), glm::vec3((float)i, 0.0f, 0.0f));
+
+	const glm::mat4 parent = glm::rotate(glm::mat4(1.0f), 0.5f, glm::vec3(0.0f, 1.0f, 0.0f));
+
+	// Roughly what a transform update or culling job does per element
+	auto transformRange = [&](uint32_t begin, uint32_t end)
+	{
+		for (uint32_t i = begin; i < end; i++)
+			worlds[i] = parent * locals[i] * glm::inverse(locals[i]);
+	};
+
+	const double serialMs = MeasureMs([&] { transformRange(0, s_TransformCount); });
+	std::cout << "Job system benchmark (" << s_TransformCount << " transforms, " << s_EmptyJobCount << " empty jobs)\n";
+	std::cout << "\tSerial: " << serialMs << " ms\n";
+
+	const uint32_t hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+	for (uint32_t threads = 1; threads <= hardwareThreads; threads++)
+	{
+		// The calling thread helps in WaitFor, so it counts as one of the threads
+		JobSystem::Init(threads - 1);
+
+		const double parallelForMs = MeasureMs([&]
+		{
+			JobCounter counter;
+			JobSystem::ParallelFor(s_TransformCount, 1024, transformRange, &counter);
+			JobSystem::WaitFor(counter);
+		});
+
+		// Scheduling overhead with no work at all, more jobs than the ring holds so allocation waits on it too
+		const double emptyJobsMs = MeasureMs([&]
+		{
+			JobCounter counter;
+			for (uint32_t i = 0; i < s_EmptyJobCount; i++)
+				JobSystem::Run([] {}, &counter);
+			JobSystem::WaitFor(counter);
+		});
+
+		JobSystem::Shutdown();
+
+		std::cout << "\t" << threads << " thread(s): ParallelFor " << parallelForMs << " ms (x" << serialMs / parallelForMs << ")"
+			<< ", " << (emptyJobsMs * 1000000.0) / s_EmptyJobCount << " ns per empty job\n";
+	}
+}
@@ -0,0 +1,4 @@
+#pragma once
+
+// Measures how the job system scales from one worker up to every hardware thread
+void RunJobSystemBenchmark();
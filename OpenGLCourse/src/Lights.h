@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
@@ -47,21 +49,20 @@ inline glm::mat4 CalculateLightTransform(const DirectionalLight& light, const gl
 	return lightProjection * glm::lookAt(-light.Direction, glm::vec3(0), glm::vec3(0, 1, 0));
 }
 
-inline std::vector<glm::mat4> CalculateLightTransform(const PointLight& light, const glm::mat4& lightProjection)
+// One per cube face, in the order of the cube map layers
+inline std::array<glm::mat4, 6> CalculateLightTransform(const PointLight& light, const glm::mat4& lightProjection)
 {
-	std::vector<glm::mat4> lightMatrices;
-
-	// +X -X
-	lightMatrices.push_back(lightProjection * glm::lookAt(light.Position, light.Position + glm::vec3(1, 0, 0), glm::vec3(0, -1, 0)));
-	lightMatrices.push_back(lightProjection * glm::lookAt(light.Position, light.Position + glm::vec3(-1, 0, 0), glm::vec3(0, -1, 0)));
-
-	// +Y -Y
-	lightMatrices.push_back(lightProjection * glm::lookAt(light.Position, light.Position + glm::vec3(0, 1, 0), glm::vec3(0, 0, 1)));
-	lightMatrices.push_back(lightProjection * glm::lookAt(light.Position, light.Position + glm::vec3(0, -1, 0), glm::vec3(0, 0, -1)));
+	return {
+		// +X -X
+		lightProjection * glm::lookAt(light.Position, light.Position + glm::vec3(1, 0, 0), glm::vec3(0, -1, 0)),
+		lightProjection * glm::lookAt(light.Position, light.Position + glm::vec3(-1, 0, 0), glm::vec3(0, -1, 0)),
 
-	// +Z -Z
-	lightMatrices.push_back(lightProjection * glm::lookAt(light.Position, light.Position + glm::vec3(0, 0, 1), glm::vec3(0, -1, 0)));
-	lightMatrices.push_back(lightProjection * glm::lookAt(light.Position, light.Position + glm::vec3(0, 0, -1), glm::vec3(0, -1, 0)));
+		// +Y -Y
+		lightProjection * glm::lookAt(light.Position, light.Position + glm::vec3(0, 1, 0), glm::vec3(0, 0, 1)),
+		lightProjection * glm::lookAt(light.Position, light.Position + glm::vec3(0, -1, 0), glm::vec3(0, 0, -1)),
 
-	return lightMatrices;
+		// +Z -Z
+		lightProjection * glm::lookAt(light.Position, light.Position + glm::vec3(0, 0, 1), glm::vec3(0, -1, 0)),
+		lightProjection * glm::lookAt(light.Position, light.Position + glm::vec3(0, 0, -1), glm::vec3(0, -1, 0))
+	};
 }
\ No newline at end of file
@@ -0,0 +1,276 @@
+#include "Log.h"
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <unordered_map>
+
+static_assert((Log::RingSize & (Log::RingSize - 1)) == 0, "The ring size has to be a power of two");
+
+// One entry of the ring. A slot is free for the producer whose position equals its sequence and
+// filled for the consumer once the sequence is one past that, as in Vyukov's bounded queue.
+struct LogSlot
+{
+	std::atomic<uint64_t> Sequence = 0;
+	LogLevel Level = LogLevel::Info;
+	uint16_t Size = 0;
+	LogFormatFunction Function = nullptr;
+	std::string_view Format;
+	std::byte Payload[Log::PayloadSize];
+};
+
+struct RepeatedMessage
+{
+	std::chrono::steady_clock::time_point WindowStart;
+	uint32_t Count = 0;
+	uint32_t Suppressed = 0;
+};
+
+// Repeats are counted per message, the table is cleared when this many different ones piled up
+static constexpr size_t s_MaxTrackedMessages = 4096;
+static constexpr std::chrono::seconds s_RepeatWindow(1);
+
+static LogSlot s_Ring[Log::RingSize];
+alignas(64) static std::atomic<uint64_t> s_EnqueuePosition = 0;
+// Log thread only
+alignas(64) static uint64_t s_DequeuePosition = 0;
+// Bumped by producers that find the log thread asleep, it waits on this while the ring is empty
+alignas(64) static std::atomic<uint32_t> s_Wake = 0;
+// Producers only pay for the wake up, a system call, while this is set
+static std::atomic<bool> s_Sleeping = false;
+// Every message before this position has been written
+static std::atomic<uint64_t> s_Written = 0;
+
+static std::atomic<bool> s_Running = false;
+static std::atomic<bool> s_Stopping = false;
+static std::thread s_Thread;
+
+static std::atomic<uint64_t> s_Dropped = 0;
+static std::atomic<uint64_t> s_Suppressed = 0;
+static std::atomic<uint64_t> s_MessagesWritten = 0;
+
+// Log thread only
+static std::unordered_map<std::string, RepeatedMessage> s_Repeats;
+
+// Stops the thread on an early return from main, before the statics above are destroyed
+static struct LogShutdownGuard
+{
+	~LogShutdownGuard() { Log::Shutdown(); }
+} s_ShutdownGuard;
+
+static std::ostream& GetStream(LogLevel level)
+{
+	return level >= LogLevel::Warning ? std::cerr : std::cout;
+}
+
+static void ReportSuppressed(LogLevel level, const std::string& message, uint32_t suppressed)
+{
+	GetStream(level) << "(" << suppressed << " more of: " << message << ")\n";
+}
+
+// Log thread
+static void WriteMessage(LogLevel level, const std::string& message)
+{
+	const auto now = std::chrono::steady_clock::now();
+	RepeatedMessage& repeat = s_Repeats[message];
+	if (now - repeat.WindowStart >= s_RepeatWindow)
+	{
+		if (repeat.Suppressed > 0)
+			ReportSuppressed(level, message, repeat.Suppressed);
+
+		repeat.WindowStart = now;
+		repeat.Count = 0;
+		repeat.Suppressed = 0;
+	}
+
+	if (repeat.Count++ >= Log::MaxRepeatsPerSecond)
+	{
+		repeat.Suppressed++;
+		s_Suppressed.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	// The trailing newline of messages that bring their own, like driver messages, is not doubled
+	std::ostream& stream = GetStream(level);
+	stream << message;
+	if (message.empty() || message.back() != '\n')
+		stream << '\n';
+	s_MessagesWritten.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void ReportAllSuppressed()
+{
+	for (const auto& [message, repeat] : s_Repeats)
+	{
+		if (repeat.Suppressed > 0)
+			ReportSuppressed(LogLevel::Warning, message, repeat.Suppressed);
+	}
+
+	s_Repeats.clear();
+}
+
+// Sequentially consistent for the check before sleeping, see LogThread
+static bool HasNext()
+{
+	return s_Ring[s_DequeuePosition & (Log::RingSize - 1)].Sequence.load(std::memory_order_seq_cst) == s_DequeuePosition + 1;
+}
+
+static bool WriteNext(std::string& message)
+{
+	if (!HasNext())
+		return false;
+
+	LogSlot& slot = s_Ring[s_DequeuePosition & (Log::RingSize - 1)];
+
+	message.clear();
+	slot.Function(slot.Format, slot.Payload, message);
+	const LogLevel level = slot.Level;
+
+	// Free for the producer one lap ahead
+	slot.Sequence.store(s_DequeuePosition + Log::RingSize, std::memory_order_release);
+	s_DequeuePosition++;
+
+	WriteMessage(level, message);
+	return true;
+}
+
+static void LogThread()
+{
+	std::string message;
+	while (true)
+	{
+		const uint32_t wake = s_Wake.load(std::memory_order_acquire);
+
+		bool wrote = false;
+		while (WriteNext(message))
+			wrote = true;
+
+		if (wrote)
+		{
+			std::cout.flush();
+			s_Written.store(s_DequeuePosition, std::memory_order_release);
+			s_Written.notify_all();
+		}
+
+		if (s_Repeats.size() > s_MaxTrackedMessages)
+			ReportAllSuppressed();
+
+		// Everything enqueued before the stop has been written by now
+		if (s_Stopping.load(std::memory_order_acquire))
+			break;
+
+		if (wrote)
+			continue;
+
+		// Both sides store before they load, sequentially consistent: either a producer sees the flag
+		// and wakes the thread up, or the message it published before looking is found here
+		s_Sleeping.store(true, std::memory_order_seq_cst);
+		if (!HasNext())
+			s_Wake.wait(wake, std::memory_order_acquire);
+		s_Sleeping.store(false, std::memory_order_relaxed);
+	}
+
+	ReportAllSuppressed();
+}
+
+void Log::Init(LogLevel level)
+{
+	SetLevel(level);
+	for (uint32_t i = 0; i < RingSize; i++)
+		s_Ring[i].Sequence.store(i, std::memory_order_relaxed);
+
+	s_EnqueuePosition = 0;
+	s_DequeuePosition = 0;
+	s_Written = 0;
+	s_Stopping = false;
+	s_Running = true;
+	s_Thread = std::thread(LogThread);
+}
+
+void Log::Shutdown()
+{
+	if (!s_Running.exchange(false))
+		return;
+
+	// Producers that already passed the running check may still publish, the thread drains once more
+	Flush();
+	s_Stopping.store(true, std::memory_order_release);
+	s_Wake.fetch_add(1, std::memory_order_release);
+	s_Wake.notify_one();
+	s_Thread.join();
+}
+
+void Log::Flush()
+{
+	const uint64_t target = s_EnqueuePosition.load(std::memory_order_acquire);
+	uint64_t written = s_Written.load(std::memory_order_acquire);
+	while (s_Thread.joinable() && written < target)
+	{
+		s_Written.wait(written, std::memory_order_acquire);
+		written = s_Written.load(std::memory_order_acquire);
+	}
+}
+
+void Log::Enqueue(LogLevel level, LogFormatFunction function, std::string_view format, const std::byte* payload, size_t size)
+{
+	if (!s_Running.load(std::memory_order_acquire))
+	{
+		std::string message;
+		function(format, payload, message);
+		GetStream(level) << message << (message.empty() || message.back() != '\n' ? "\n" : "");
+		return;
+	}
+
+	uint64_t position = s_EnqueuePosition.load(std::memory_order_relaxed);
+	LogSlot* slot = nullptr;
+	while (true)
+	{
+		slot = &s_Ring[position & (RingSize - 1)];
+		const int64_t difference = (int64_t)slot->Sequence.load(std::memory_order_acquire) - (int64_t)position;
+		if (difference == 0)
+		{
+			if (s_EnqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (difference < 0)
+		{
+			// The log thread is a whole ring behind
+			s_Dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		else
+		{
+			position = s_EnqueuePosition.load(std::memory_order_relaxed);
+		}
+	}
+
+	slot->Level = level;
+	slot->Size = (uint16_t)size;
+	slot->Function = function;
+	slot->Format = format;
+	memcpy(slot->Payload, payload, size);
+	slot->Sequence.store(position + 1, std::memory_order_seq_cst);
+
+	// While the log thread is draining it finds the message on its own
+	if (s_Sleeping.load(std::memory_order_seq_cst))
+	{
+		s_Wake.fetch_add(1, std::memory_order_release);
+		s_Wake.notify_one();
+	}
+}
+
+LogStats Log::GetStats()
+{
+	LogStats stats;
+	stats.Written = s_MessagesWritten.load(std::memory_order_relaxed);
+	stats.Dropped = s_Dropped.load(std::memory_order_relaxed);
+	stats.Suppressed = s_Suppressed.load(std::memory_order_relaxed);
+	return stats;
+}
+
+void Log::PrintReport()
+{
+	Flush();
+	const LogStats stats = GetStats();
+	std::cout << "Log: " << stats.Written << " messages written, " << stats.Dropped << " dropped with the ring full, " << stats.Suppressed << " repeats suppressed\n";
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+enum class LogLevel : uint8_t
+{
+	Debug,
+	Info,
+	Warning,
+	Error
+};
+
+// How an argument waits in the ring until the log thread formats it. Strings are copied, so the caller
+// may free them right after logging, everything else is copied by value.
+template<typename T>
+struct LogArgument
+{
+	static_assert(std::is_trivially_copyable_v<T>, "Log arguments have to be strings or trivially copyable");
+	using Formatted = T;
+	static constexpr size_t MinSize = sizeof(T);
+
+	static void Write(std::byte*& cursor, const std::byte*, const T& value)
+	{
+		memcpy(cursor, &value, sizeof(T));
+		cursor += sizeof(T);
+	}
+
+	static T Read(const std::byte*& cursor)
+	{
+		T value;
+		memcpy(&value, cursor, sizeof(T));
+		cursor += sizeof(T);
+		return value;
+	}
+};
+
+struct LogStringArgument
+{
+	using Formatted = std::string_view;
+	static constexpr size_t MinSize = sizeof(uint16_t);
+
+	// Cut short to what is left before end
+	static void Write(std::byte*& cursor, const std::byte* end, std::string_view value)
+	{
+		const uint16_t length = (uint16_t)std::min<size_t>(value.size(), (size_t)(end - cursor) - sizeof(uint16_t));
+		memcpy(cursor, &length, sizeof(length));
+		memcpy(cursor + sizeof(length), value.data(), length);
+		cursor += sizeof(length) + length;
+	}
+
+	static std::string_view Read(const std::byte*& cursor)
+	{
+		uint16_t length;
+		memcpy(&length, cursor, sizeof(length));
+		const std::string_view value(reinterpret_cast<const char*>(cursor + sizeof(length)), length);
+		cursor += sizeof(length) + length;
+		return value;
+	}
+};
+
+template<> struct LogArgument<const char*> : LogStringArgument {};
+template<> struct LogArgument<char*> : LogStringArgument {};
+template<> struct LogArgument<std::string> : LogStringArgument {};
+template<> struct LogArgument<std::string_view> : LogStringArgument {};
+
+template<typename T>
+using LogFormatted = typename LogArgument<std::decay_t<T>>::Formatted;
+
+// A format string literal, checked at compile time against the arguments as the log thread formats them
+template<typename... Args>
+struct LogFormat
+{
+	template<size_t N>
+	consteval LogFormat(const char (&text)[N])
+		: Text(text, N - 1)
+	{
+		[[maybe_unused]] const std::format_string<Args...> check(text);
+	}
+
+	std::string_view Text;
+};
+
+using LogFormatFunction = void(*)(std::string_view format, const std::byte* payload, std::string& out);
+
+struct LogStats
+{
+	uint64_t Written = 0;
+	// The ring was full, logging never waits
+	uint64_t Dropped = 0;
+	// Over the repeat limit of their message
+	uint64_t Suppressed = 0;
+};
+
+// Logging that costs the calling thread a copy of its arguments into a lock free ring. A background
+// thread formats the messages and writes them to std::cout, warnings and errors to std::cerr. Any
+// thread may log, the GL driver's own threads included. Messages below the level are skipped before
+// anything is copied, and a message that repeats more than MaxRepeatsPerSecond times a second is
+// only counted until the second is over. Before Init and after Shutdown messages are written right
+// away on the calling thread.
+class Log
+{
+public:
+	Log() = delete;
+	~Log() = delete;
+
+	static void Init(LogLevel level);
+	// Writes everything still queued
+	static void Shutdown();
+	// Waits until everything logged so far is written, before printing to the streams directly
+	static void Flush();
+
+	static void SetLevel(LogLevel level) { s_Level.store(level, std::memory_order_relaxed); }
+	static bool IsEnabled(LogLevel level) { return level >= s_Level.load(std::memory_order_relaxed); }
+
+	template<typename... Args>
+	static void Write(LogLevel level, LogFormat<LogFormatted<Args>...> format, Args&&... args)
+	{
+		static_assert((LogArgument<std::decay_t<Args>>::MinSize + ... + 0) <= PayloadSize, "Too many log arguments");
+		if (!IsEnabled(level))
+			return;
+
+		std::byte payload[PayloadSize];
+		std::byte* cursor = payload;
+		// Each string leaves room for the arguments after it
+		size_t reserved = (LogArgument<std::decay_t<Args>>::MinSize + ... + 0);
+		((reserved -= LogArgument<std::decay_t<Args>>::MinSize, LogArgument<std::decay_t<Args>>::Write(cursor, payload + PayloadSize - reserved, args)), ...);
+		Enqueue(level, &FormatPayload<LogFormatted<Args>...>, format.Text, payload, (size_t)(cursor - payload));
+	}
+
+	template<typename... Args>
+	static void Debug(LogFormat<LogFormatted<Args>...> format, Args&&... args) { Write(LogLevel::Debug, format, std::forward<Args>(args)...); }
+	template<typename... Args>
+	static void Info(LogFormat<LogFormatted<Args>...> format, Args&&... args) { Write(LogLevel::Info, format, std::forward<Args>(args)...); }
+	template<typename... Args>
+	static void Warning(LogFormat<LogFormatted<Args>...> format, Args&&... args) { Write(LogLevel::Warning, format, std::forward<Args>(args)...); }
+	template<typename... Args>
+	static void Error(LogFormat<LogFormatted<Args>...> format, Args&&... args) { Write(LogLevel::Error, format, std::forward<Args>(args)...); }
+
+	static LogStats GetStats();
+	static void PrintReport();
+
+	static constexpr size_t PayloadSize = 480;
+	static constexpr uint32_t RingSize = 1024;
+	static constexpr uint32_t MaxRepeatsPerSecond = 10;
+
+private:
+	template<typename... Formatted>
+	static void FormatPayload(std::string_view format, const std::byte* payload, std::string& out)
+	{
+		const std::byte* cursor = payload;
+		// Braced initialization reads the arguments in order
+		const std::tuple<Formatted...> values{ LogArgument<Formatted>::Read(cursor)... };
+		std::apply([&](const auto&... value) { std::vformat_to(std::back_inserter(out), format, std::make_format_args(value...)); }, values);
+	}
+
+	static void Enqueue(LogLevel level, LogFormatFunction function, std::string_view format, const std::byte* payload, size_t size);
+
+private:
+	inline static std::atomic<LogLevel> s_Level = LogLevel::Info;
+};
@@ -0,0 +1,169 @@
+#include "Lz4.h"
+
+#include <algorithm>
+#include <cstring>
+
+static constexpr size_t s_MinMatch = 4;
+// The format wants the last 5 bytes as literals and no match starting in the last 12
+static constexpr size_t s_LastLiterals = 5;
+static constexpr size_t s_MatchStartLimit = 12;
+static constexpr size_t s_MaxOffset = 65535;
+static constexpr uint32_t s_HashBits = 16;
+
+static uint32_t Read32(const uint8_t* data)
+{
+	uint32_t value;
+	std::memcpy(&value, data, sizeof(value));
+	return value;
+}
+
+static void WriteLength(std::vector<uint8_t>& out, size_t length)
+{
+	while (length >= 255)
+	{
+		out.push_back(255);
+		length -= 255;
+	}
+
+	out.push_back((uint8_t)length);
+}
+
+static void WriteSequence(std::vector<uint8_t>& out, const uint8_t* literals, size_t literalCount, size_t offset, size_t matchLength)
+{
+	const size_t matchCode = matchLength - s_MinMatch;
+	out.push_back((uint8_t)((std::min<size_t>(literalCount, 15) << 4) | std::min<size_t>(matchCode, 15)));
+	if (literalCount >= 15)
+		WriteLength(out, literalCount - 15);
+
+	out.insert(out.end(), literals, literals + literalCount);
+	out.push_back((uint8_t)(offset & 0xFF));
+	out.push_back((uint8_t)(offset >> 8));
+
+	if (matchCode >= 15)
+		WriteLength(out, matchCode - 15);
+}
+
+static void WriteLastLiterals(std::vector<uint8_t>& out, const uint8_t* literals, size_t literalCount)
+{
+	out.push_back((uint8_t)(std::min<size_t>(literalCount, 15) << 4));
+	if (literalCount >= 15)
+		WriteLength(out, literalCount - 15);
+
+	out.insert(out.end(), literals, literals + literalCount);
+}
+
+std::vector<uint8_t> Lz4::Compress(const uint8_t* source, size_t size)
+{
+	std::vector<uint8_t> out;
+	out.reserve(GetMaxCompressedSize(size));
+
+	size_t anchor = 0;
+	if (size > s_MatchStartLimit)
+	{
+		// Last position each 4 byte sequence was seen at, offset by one so 0 means never
+		std::vector<uint32_t> table((size_t)1 << s_HashBits, 0);
+		const size_t matchStartEnd = size - s_MatchStartLimit;
+		const size_t matchEnd = size - s_LastLiterals;
+
+		size_t position = 0;
+		while (position < matchStartEnd)
+		{
+			const uint32_t sequence = Read32(source + position);
+			const uint32_t hash = (sequence * 2654435761u) >> (32 - s_HashBits);
+			const size_t candidate = table[hash];
+			table[hash] = (uint32_t)position + 1;
+
+			if (candidate == 0 || position - (candidate - 1) > s_MaxOffset || Read32(source + candidate - 1) != sequence)
+			{
+				position++;
+				continue;
+			}
+
+			const size_t match = candidate - 1;
+			size_t length = s_MinMatch;
+			while (position + length < matchEnd && source[match + length] == source[position + length])
+				length++;
+
+			WriteSequence(out, source + anchor, position - anchor, position - match, length);
+			position += length;
+			anchor = position;
+		}
+	}
+
+	WriteLastLiterals(out, source + anchor, size - anchor);
+	return out;
+}
+
+bool Lz4::Decompress(const uint8_t* source, size_t size, uint8_t* destination, size_t destinationSize)
+{
+	const uint8_t* in = source;
+	const uint8_t* inEnd = source + size;
+	uint8_t* out = destination;
+	uint8_t* outEnd = destination + destinationSize;
+
+	auto readLength = [&](size_t& length)
+	{
+		uint8_t byte;
+		do
+		{
+			if (in == inEnd)
+				return false;
+
+			byte = *in++;
+			length += byte;
+		} while (byte == 255);
+
+		return true;
+	};
+
+	while (in < inEnd)
+	{
+		const uint8_t token = *in++;
+
+		size_t literalCount = token >> 4;
+		if (literalCount == 15 && !readLength(literalCount))
+			return false;
+
+		if (literalCount > (size_t)(inEnd - in) || literalCount > (size_t)(outEnd - out))
+			return false;
+
+		std::memcpy(out, in, literalCount);
+		in += literalCount;
+		out += literalCount;
+
+		// The last sequence has no match
+		if (in == inEnd)
+			break;
+
+		if (inEnd - in < 2)
+			return false;
+
+		const size_t offset = (size_t)in[0] | ((size_t)in[1] << 8);
+		in += 2;
+		if (offset == 0 || offset > (size_t)(out - destination))
+			return false;
+
+		size_t matchLength = token & 15;
+		if (matchLength == 15 && !readLength(matchLength))
+			return false;
+
+		matchLength += s_MinMatch;
+		if (matchLength > (size_t)(outEnd - out))
+			return false;
+
+		// Matches may overlap what they write, a run of one byte is a match with offset 1
+		const uint8_t* match = out - offset;
+		if (offset >= matchLength)
+		{
+			std::memcpy(out, match, matchLength);
+			out += matchLength;
+		}
+		else
+		{
+			for (size_t i = 0; i < matchLength; i++)
+				*out++ = match[i];
+		}
+	}
+
+	return out == outEnd;
+}
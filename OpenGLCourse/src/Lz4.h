@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// LZ4 block format, without the frame around it. The compressor is the plain greedy one: much
+// weaker than lz4hc, but it only runs in the asset cooker and decoding is what has to be fast.
+class Lz4
+{
+public:
+	Lz4() = delete;
+	~Lz4() = delete;
+
+	static std::vector<uint8_t> Compress(const uint8_t* source, size_t size);
+	// False when the block is corrupt or does not decode to exactly destinationSize bytes
+	static bool Decompress(const uint8_t* source, size_t size, uint8_t* destination, size_t destinationSize);
+
+	static size_t GetMaxCompressedSize(size_t size) { return size + size / 255 + 16; }
+};
@@ -1,22 +1,57 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
 #include <iostream>
+#include <string>
 #include <vector>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include "AllocationCounter.h"
+#include "AssetPackBenchmark.h"
+#include "AssetRegistry.h"
 #include "Camera.h"
+#include "Components.h"
+#include "CookedAssets.h"
+#include "DrawListBuilder.h"
+#include "DynamicResolution.h"
+#include "EcsBenchmark.h"
+#include "FrameArena.h"
+#include "FrameCapture.h"
+#include "FramePacket.h"
+#include "Geometry.h"
+#include "GpuMemory.h"
+#include "GlInstrumentation.h"
+#include "GpuResources.h"
 #include "Lights.h"
 #include "Input.h"
+#include "JobSystem.h"
+#include "JobSystemBenchmark.h"
+#include "Log.h"
 #include "Material.h"
 #include "Mesh.h"
 #include "Model.h"
-#include "OmniShadowMap.h"
+#include "ObjImporterBenchmark.h"
+#include "OmniShadowPool.h"
+#include "Profiler.h"
+#include "RenderQueue.h"
+#include "RenderStateCache.h"
+#include "RenderTarget.h"
+#include "RenderThread.h"
 #include "Shader.h"
 #include "ShadowMap.h"
+#include "ShadowMask.h"
 #include "Skybox.h"
-#include "Texture2D.h"
+#include "StorageBuffer.h"
+#include "TextureArrayManager.h"
+#include "TransformHierarchy.h"
 #include "UniformBuffer.h"
 #include "Window.h"
+#include "World.h"
 
 #include "OpenGLContext.h"
 
@@ -28,13 +63,37 @@
 #define DIRECTIONAL_LIGHT_BINDING 0
 #define POINT_LIGHT_ARRAY_BINDING 1
 #define SPOT_LIGHT_ARRAY_BINDING 2
-#define MATERIAL_BINDING 3
+
+#define MATERIAL_BUFFER_BINDING 0
+#define TRANSFORM_BUFFER_BINDING 1
+
+// Every texture array stays bound from here on for the whole frame
+#define TEXTURE_ARRAY_FIRST_UNIT 16
+// Bytes of texture data streamed in per frame at most
+#define TEXTURE_STREAM_BUDGET (4 * 1024 * 1024)
+// GPU memory the resources may take before the least recently used ones are evicted, --gpu-budget overrides it
+#define GPU_MEMORY_BUDGET_MB 512
+// Frames before this one may still grow containers and arenas, later ones should not allocate at all
+#define ALLOCATION_WARMUP_FRAMES 60
+// GPU frame time dynamic resolution aims for and the limits of its scale, --target-ms, --min-scale and --max-scale override them
+#define DYNAMIC_RESOLUTION_TARGET_MS 16.0f
+#define DYNAMIC_RESOLUTION_MIN_SCALE 0.5f
+#define DYNAMIC_RESOLUTION_MAX_SCALE 1.0f
+// Evaluates shadows into a half resolution screen space mask after a depth prepass instead of per fragment, --shadow-mask turns it on
+#define SHADOW_MASK_ENABLED false
+// The two mask textures, and the scene depth while the mask is drawn
+#define SHADOW_MASK_FIRST_UNIT 9
+#define SCENE_DEPTH_UNIT 11
+// Simulated time of every replayed frame, so replays do not depend on how fast they run
+#define REPLAY_TIMESTEP (1.0f / 60.0f)
 
 #define MAX_POINT_LIGHTS 3
 
+#define SHADOW_FAR_PLANE 100.0f
+
 Window* g_Window;
 
-std::vector<Texture2D> g_Textures;
+std::vector<TextureHandle> g_Textures;
 std::vector<Material> g_Materials;
 std::vector<Mesh> g_Meshes;
 
@@ -45,56 +104,42 @@ std::vector<Mesh> g_Meshes;
 #define SHINY_MATERIAL 0
 #define DULL_MATERIAL 1
 
-Shader g_Shader;
-Shader g_DirectionalShadowShader;
-Shader g_OmniDirectionalShadowShader;
+ShaderHandle g_Shader;
+ShaderHandle g_DirectionalShadowShader;
+ShaderHandle g_OmniDirectionalShadowShader;
+ShaderHandle g_DepthPrepassShader;
+ShaderHandle g_ShadowMaskShader;
 
-UniformBuffer* g_MaterialUB;
+StorageBuffer* g_MaterialSB;
+StorageBuffer* g_TransformSB;
+UniformBuffer* g_PointLightUB;
 UniformBuffer* g_SpotLightUB;
 
-Model* g_xWingModel;
-Model* g_BlackHawkModel;
+RenderQueue g_RenderQueue;
+
+ModelHandle g_xWingModel;
+ModelHandle g_BlackHawkModel;
 
-std::vector<PointLight> g_PointLights;
-std::vector<OmniShadowMap> g_PointLightOmniShadowMaps;
+OmniShadowPool g_OmniShadowPool;
 
-std::vector<SpotLight> g_SpotLights;
-std::vector<OmniShadowMap> g_SpotLightOmniShadowMaps;
+World g_World;
+TransformHierarchy g_Transforms;
+DrawListBuilder g_DrawListBuilder;
 
 #define ASPECT_RATIO ((float)WINDOW_WIDTH / (float)WINDOW_HEIGHT)
-static glm::mat4 g_CameraProjection = glm::perspective(glm::radians(60.0f), ASPECT_RATIO, 0.1f, 100.0f);
+#define CAMERA_FAR_PLANE 100.0f
+static glm::mat4 g_CameraProjection = glm::perspective(glm::radians(60.0f), ASPECT_RATIO, 0.1f, CAMERA_FAR_PLANE);
+static glm::mat4 g_OmniLightProjection = glm::perspective(glm::radians(90.0f), 1.0f, 0.01f, SHADOW_FAR_PLANE);
+static glm::mat4 g_DirectionalLightTransform;
+// Set before the render thread starts
+static bool g_ShadowMaskEnabled = SHADOW_MASK_ENABLED;
+static bool g_CaptureSceneTarget = false;
 
 constexpr float ToRadians(const float& value)
 {
 	return value * 3.14159265f / 180.0f;
 }
 
-static void CalculateAverageNormals(float* vertices, uint32_t verticesCount, uint32_t stride, uint32_t* indices, uint32_t indicesCount, uint32_t normalsOffset)
-{
-	for (size_t i = 0; i < indicesCount; i += 3)
-	{
-		uint32_t in0 = indices[i] * stride;
-		uint32_t in1 = indices[i + 1] * stride;
-		uint32_t in2 = indices[i + 2] * stride;
-		glm::vec3 v1(vertices[in1] - vertices[in0], vertices[in1 + 1] - vertices[in0 + 1], vertices[in1 + 2] - vertices[in0 + 2]);
-		glm::vec3 v2(vertices[in2] - vertices[in0], vertices[in2 + 1] - vertices[in0 + 1], vertices[in2 + 2] - vertices[in0 + 2]);
-		const glm::vec3 normal = glm::normalize(glm::cross(v1, v2));
-
-		in0 += normalsOffset; in1 += normalsOffset; in2 += normalsOffset;
-		vertices[in0] += normal.x; vertices[in0 + 1] += normal.y; vertices[in0 + 2] += normal.z;
-		vertices[in1] += normal.x; vertices[in1 + 1] += normal.y; vertices[in1 + 2] += normal.z;
-		vertices[in2] += normal.x; vertices[in2 + 1] += normal.y; vertices[in2 + 2] += normal.z;
-	}
-
-	for (size_t i = 0; i < verticesCount / stride; i++)
-	{
-		const uint32_t offset = i * stride * normalsOffset;
-		// Nx - Ny - Nz
-		const glm::vec3 vec = glm::normalize(glm::vec3(vertices[offset], vertices[offset + 1], vertices[offset + 2]));
-		vertices[offset] = vec.x; vertices[offset + 1] = vec.y; vertices[offset + 2] = vec.z;
-	}
-}
-
 static Mesh CreatePyramid()
 {
 	// X-Y-Z	U-V		Nx-Ny-Nz
@@ -134,165 +179,596 @@ static Mesh CreatePlane()
 	return { vertices, indices, std::size(vertices), std::size(indices) };
 }
 
-static void RenderScene(const Shader& shader)
+// The pose used to advance 0.7 degrees once a frame, this keeps that speed at 60 frames a second
+#define BLACK_HAWK_DEGREES_PER_SECOND 42.0f
+
+static void CreateSceneObjects(uint32_t syntheticObjectCount)
 {
-	glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -2.5f));
-	shader.UploadUniformMat4("u_Model", model);
-	g_Textures[BRICK_TEXTURE].Bind();
-	g_MaterialUB->SetData(&g_Materials[SHINY_MATERIAL]);
-	g_Meshes[0].RenderMesh();
-
-	model = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 4.0f, -2.5f));
-	shader.UploadUniformMat4("u_Model", model);
-	g_Textures[DIRT_TEXTURE].Bind();
-	g_MaterialUB->SetData(&g_Materials[DULL_MATERIAL]);
-	g_Meshes[0].RenderMesh();
-
-	model = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -2.0f, 0.0f));
-	shader.UploadUniformMat4("u_Model", model);
-	g_Textures[DIRT_TEXTURE].Bind();
-	g_MaterialUB->SetData(&g_Materials[SHINY_MATERIAL]);
-	g_Meshes[1].RenderMesh();
-
-	model = glm::translate(glm::mat4(1.0f), glm::vec3(-7.0f, 0.0f, 10.0f))
-		* glm::scale(glm::mat4(1.0f), glm::vec3(0.006f, 0.006f, 0.006f));
-	shader.UploadUniformMat4("u_Model", model);
-	g_MaterialUB->SetData(&g_Materials[SHINY_MATERIAL]);
-	g_xWingModel->Render();
-
-	static float blackHawkAngle = 0.0f;
-	blackHawkAngle += 0.1f;
-	if (blackHawkAngle > 360.0f)
-		blackHawkAngle = 0.1f;
-
-	model = glm::rotate(glm::mat4(1.0f), -ToRadians(blackHawkAngle), glm::vec3(0.0f, 1.0f, 0.0f))
-		* glm::translate(glm::mat4(1.0f), glm::vec3(-3.0f, 2.0f, 0.0f))
-		* glm::rotate(glm::mat4(1.0f), -ToRadians(20.0f), glm::vec3(0.0f, 0.0f, 1.0f))
-		* glm::rotate(glm::mat4(1.0f), -ToRadians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f))
-		* glm::scale(glm::mat4(1.0f), glm::vec3(0.1f, 0.1f, 0.1f));
-	shader.UploadUniformMat4("u_Model", model);
-	g_MaterialUB->SetData(&g_Materials[SHINY_MATERIAL]);
-	g_BlackHawkModel->Render();
+	auto addMesh = [](uint32_t mesh, uint32_t texture, uint8_t material, uint32_t transform)
+	{
+		RenderableComponent renderable;
+		renderable.Mesh = &g_Meshes[mesh];
+		renderable.Texture = *g_Textures[texture];
+		renderable.MaterialId = material;
+		return g_World.Create(TransformComponent{ transform }, renderable, ShadowCasterComponent());
+	};
+	auto addModel = [](const Model* model, uint8_t material, uint32_t transform)
+	{
+		RenderableComponent renderable;
+		renderable.Model = model;
+		renderable.MaterialId = material;
+		return g_World.Create(TransformComponent{ transform }, renderable, ShadowCasterComponent());
+	};
+
+	addMesh(0, BRICK_TEXTURE, SHINY_MATERIAL, g_Transforms.Create(TransformHierarchy::NoParent, glm::vec3(0.0f, 0.0f, -2.5f)));
+	addMesh(0, DIRT_TEXTURE, DULL_MATERIAL, g_Transforms.Create(TransformHierarchy::NoParent, glm::vec3(0.0f, 4.0f, -2.5f)));
+
+	// Nothing is below the floor, so it only receives shadows
+	const Entity floor = addMesh(1, DIRT_TEXTURE, SHINY_MATERIAL, g_Transforms.Create(TransformHierarchy::NoParent, glm::vec3(0.0f, -2.0f, 0.0f)));
+	g_World.Remove<ShadowCasterComponent>(floor);
+
+	const glm::quat identity(1.0f, 0.0f, 0.0f, 0.0f);
+	addModel(g_xWingModel.Get(), SHINY_MATERIAL, g_Transforms.Create(TransformHierarchy::NoParent, glm::vec3(-7.0f, 0.0f, 10.0f), identity, glm::vec3(0.006f)));
+
+	// The helicopter hangs off a pivot at the origin, spinning the pivot flies it in a circle
+	const uint32_t blackHawkPivot = g_Transforms.Create();
+	g_World.Create(TransformComponent{ blackHawkPivot }, SpinComponent{ -BLACK_HAWK_DEGREES_PER_SECOND });
+	const glm::quat blackHawkRotation = glm::angleAxis(-ToRadians(20.0f), glm::vec3(0.0f, 0.0f, 1.0f)) * glm::angleAxis(-ToRadians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+	addModel(g_BlackHawkModel.Get(), SHINY_MATERIAL, g_Transforms.Create(blackHawkPivot, glm::vec3(-3.0f, 2.0f, 0.0f), blackHawkRotation, glm::vec3(0.1f)));
+
+	// Stress scene for the bench mode: small pyramids on a square grid around the origin
+	const uint32_t gridSize = (uint32_t)glm::ceil(glm::sqrt((float)syntheticObjectCount));
+	const float spacing = 2.0f;
+	for (uint32_t i = 0; i < syntheticObjectCount; i++)
+	{
+		const float x = ((float)(i % gridSize) - (float)gridSize * 0.5f) * spacing;
+		const float z = ((float)(i / gridSize) - (float)gridSize * 0.5f) * spacing;
+		const uint32_t transform = g_Transforms.Create(TransformHierarchy::NoParent, glm::vec3(x, -1.5f, z), identity, glm::vec3(0.25f));
+		addMesh(0, i % 2 ? DIRT_TEXTURE : BRICK_TEXTURE, i % 2 ? DULL_MATERIAL : SHINY_MATERIAL, transform);
+	}
 }
 
-static void DirectionalShadowMapPass(const ShadowMap& shadowMap)
+static void SimulateScene(FramePacket& packet, const Camera& camera, float deltaTime)
 {
+	packet.View = camera.CalculateViewMatrix();
+	packet.Projection = g_CameraProjection;
+	// Texture streaming only needs the mips the scaled resolution can show
+	packet.ViewportHeight = DynamicResolution::GetRenderHeight();
+	packet.EyePosition = camera.GetPosition();
+	packet.DirectionalLightTransform = g_DirectionalLightTransform;
+
+	g_World.Each<SpotLightComponent, CameraAttachmentComponent>([&](Entity, SpotLightComponent& spotLight, const CameraAttachmentComponent& attachment)
+	{
+		spotLight.Light.Position = camera.GetPosition() + glm::vec3(0.0f, attachment.HeightOffset, 0.0f);
+		spotLight.Light.Direction = camera.GetDirection();
+	});
+
+	g_World.Each<TransformComponent, SpinComponent>([&](Entity, const TransformComponent& transform, SpinComponent& spin)
+	{
+		spin.Angle = fmodf(spin.Angle + spin.DegreesPerSecond * deltaTime, 360.0f);
+		g_Transforms.SetRotation(transform.Node, glm::angleAxis(ToRadians(spin.Angle), glm::vec3(0.0f, 1.0f, 0.0f)));
+	});
+
+	packet.PointLights.clear();
+	packet.SpotLights.clear();
+	FrameVector<uint32_t> shadowLights;
+
+	g_World.Each<PointLightComponent>([&](Entity, const PointLightComponent& pointLight)
+	{
+		packet.PointLights.push_back(pointLight.Light);
+		shadowLights.push_back(pointLight.ShadowMap);
+	});
+
+	g_World.Each<SpotLightComponent>([&](Entity, const SpotLightComponent& spotLight)
+	{
+		packet.SpotLights.push_back(spotLight.Light);
+		shadowLights.push_back(spotLight.ShadowMap);
+	});
+
+	g_OmniShadowPool.Assign(packet, shadowLights, SHADOW_FAR_PLANE);
+
+	{
+		ProfileScope scope("Transform update");
+		g_Transforms.Update();
+	}
+
+	ProfileScope scope("Draw list build");
+	g_DrawListBuilder.Build(packet, g_World, g_Transforms, g_OmniLightProjection);
+}
+
+static void RenderScene(const FramePacket& packet, const ViewDrawList& view, const Shader& shader)
+{
+	for (size_t i = 0; i < view.Items.size(); i++)
+	{
+		const DrawItem& item = packet.DrawList[view.Items[i]];
+		const uint8_t faceMask = view.FaceMasks.empty() ? RenderQueue::AllFaces : view.FaceMasks[i];
+
+		const glm::vec3 position(item.BoundingSphere);
+
+		if (item.Model)
+			item.Model->Submit(g_RenderQueue, shader, item.TransformIndex, position, item.MaterialId, faceMask);
+		else
+			g_RenderQueue.Submit(shader, *item.Mesh, item.Texture, item.MaterialId, item.TransformIndex, position, faceMask);
+	}
+
+	g_RenderQueue.Flush();
+}
+
+// Asks for the texture levels the visible objects need, they are uploaded at the end of the frame
+static void RequestTextureResidency(const FramePacket& packet)
+{
+	for (const uint32_t index : packet.CameraView.Items)
+	{
+		const DrawItem& item = packet.DrawList[index];
+		if (item.Model)
+			item.Model->RequestTextureResidency(item.ScreenSize);
+		else
+			TextureArrayManager::RequestLevel(item.Texture, item.ScreenSize);
+	}
+}
+
+static void DirectionalShadowMapPass(const FramePacket& packet, const ShadowMap& shadowMap)
+{
+	GpuProfileScope scope("Directional shadow pass");
 	OpenGLContext::SetViewport(shadowMap.GetWidth(), shadowMap.GetHeight());
 
 	shadowMap.BeginWrite();
 	OpenGLContext::ClearDepthOnly();
 
-	g_DirectionalShadowShader.Bind();
-	g_DirectionalShadowShader.Validate();
-	RenderScene(g_DirectionalShadowShader);
+	g_DirectionalShadowShader->Bind();
+	g_DirectionalShadowShader->Validate();
+	g_RenderQueue.Begin(RenderPassType::DirectionalShadow, glm::vec3(0.0f), SHADOW_FAR_PLANE);
+	RenderScene(packet, packet.DirectionalLightView, *g_DirectionalShadowShader);
 	shadowMap.EndWrite();
 }
 
-static void OmniShadowMapPass(const PointLight& light, const OmniShadowMap& shadowMap)
+static void OmniShadowMapPass(const FramePacket& packet, const ViewDrawList& view, const PointLight& light, const OmniShadowMap& shadowMap, int32_t lightIndex)
 {
+	GpuProfileScope scope("Omni shadow pass", lightIndex);
 	OpenGLContext::SetViewport(shadowMap.GetWidth(), shadowMap.GetHeight());
 
 	shadowMap.BeginWrite();
 	OpenGLContext::ClearDepthOnly();
 
-	g_OmniDirectionalShadowShader.Bind();
-	g_OmniDirectionalShadowShader.UploadUniformFloat3("u_LightPos", light.Position);
-	g_OmniDirectionalShadowShader.UploadUniformFloat("u_FarPlane", 100.0f);
+	g_OmniDirectionalShadowShader->Bind();
+	g_OmniDirectionalShadowShader->UploadUniformFloat3("u_LightPos", light.Position);
+	g_OmniDirectionalShadowShader->UploadUniformFloat("u_FarPlane", SHADOW_FAR_PLANE);
 
-	static glm::mat4 lightProjection = glm::perspective(glm::radians(90.0f), 1.0f, 0.01f, 100.0f);
-	std::vector<glm::mat4> lightMatrices = CalculateLightTransform(light, lightProjection);
+	const std::array<glm::mat4, 6> lightMatrices = CalculateLightTransform(light, g_OmniLightProjection);
+	g_OmniDirectionalShadowShader->UploadUniformMat4Array("u_LightMatrices", lightMatrices.data(), (uint32_t)lightMatrices.size());
 
-	g_OmniDirectionalShadowShader.UploadUniformMat4("u_LightMatrices[0]", lightMatrices[0]);
-	g_OmniDirectionalShadowShader.UploadUniformMat4("u_LightMatrices[1]", lightMatrices[1]);
-	g_OmniDirectionalShadowShader.UploadUniformMat4("u_LightMatrices[2]", lightMatrices[2]);
-	g_OmniDirectionalShadowShader.UploadUniformMat4("u_LightMatrices[3]", lightMatrices[3]);
-	g_OmniDirectionalShadowShader.UploadUniformMat4("u_LightMatrices[4]", lightMatrices[4]);
-	g_OmniDirectionalShadowShader.UploadUniformMat4("u_LightMatrices[5]", lightMatrices[5]);
-
-	g_OmniDirectionalShadowShader.Validate();
-	RenderScene(g_OmniDirectionalShadowShader);
+	g_OmniDirectionalShadowShader->Validate();
+	g_RenderQueue.Begin(RenderPassType::OmniShadow, light.Position, SHADOW_FAR_PLANE);
+	RenderScene(packet, view, *g_OmniDirectionalShadowShader);
 	shadowMap.EndWrite();
 }
 
-static void RenderPass(const Camera& camera, const ShadowMap& shadowMap, const Skybox& skybox)
+// Binds the shadow maps and uploads what Lighting.glsl needs to sample them
+static void BindShadows(const FramePacket& packet, const ShadowMap& shadowMap, const Shader& shader)
+{
+	shader.Bind();
+	shader.UploadUniformFloat3("u_EyePosition", packet.EyePosition);
+
+	shadowMap.Read(2);
+	shader.UploadUniformInt("u_DirectionalShadowMap", 2);
+
+	for (size_t i = 0; i < packet.OmniShadowMaps.size(); i++)
+	{
+		const int textureUnit = 3;
+		g_OmniShadowPool.GetMap(packet.OmniShadowMaps[i]).Read(textureUnit + i);
+		shader.UploadUniformInt(FrameArena::Get().Format("u_OmniShadowMaps[{}].ShadowMap", i), textureUnit + i);
+		shader.UploadUniformFloat(FrameArena::Get().Format("u_OmniShadowMaps[{}].FarPlane", i), SHADOW_FAR_PLANE);
+	}
+
+	shader.UploadUniformInt("u_PointLightCount", (int)packet.PointLights.size());
+	shader.UploadUniformInt("u_SpotLightCount", (int)packet.SpotLights.size());
+}
+
+// Fills the depth of the scene target, the shadow mask reads it and the main pass only shades the visible surfaces
+static void DepthPrepass(const FramePacket& packet)
+{
+	GpuProfileScope scope("Depth prepass");
+	g_DepthPrepassShader->Bind();
+	g_DepthPrepassShader->UploadUniformMat4("u_View", packet.View);
+	g_DepthPrepassShader->Validate();
+	g_RenderQueue.Begin(RenderPassType::DepthPrepass, packet.EyePosition, CAMERA_FAR_PLANE);
+	RenderScene(packet, packet.CameraView, *g_DepthPrepassShader);
+}
+
+static void ShadowMaskPass(const FramePacket& packet, const ShadowMap& shadowMap)
+{
+	GpuProfileScope scope("Shadow mask");
+	BindShadows(packet, shadowMap, *g_ShadowMaskShader);
+	ShadowMask::Render(*g_ShadowMaskShader, DynamicResolution::GetTarget(), DynamicResolution::GetRenderWidth(), DynamicResolution::GetRenderHeight(),
+		SCENE_DEPTH_UNIT, packet.Projection * packet.View);
+}
+
+static void RenderPass(const FramePacket& packet, const ShadowMap& shadowMap, const Skybox& skybox)
 {
-	OpenGLContext::SetViewport(WINDOW_WIDTH, WINDOW_HEIGHT);
+	if (!packet.PointLights.empty())
+		g_PointLightUB->SetData(packet.PointLights.data());
+
+	if (!packet.SpotLights.empty())
+		g_SpotLightUB->SetData(packet.SpotLights.data());
+
+	DynamicResolution::BeginScene();
 	OpenGLContext::Clear();
 
-	skybox.Draw(camera.CalculateViewMatrix(), g_CameraProjection);
+	if (g_ShadowMaskEnabled)
+	{
+		DepthPrepass(packet);
+		ShadowMaskPass(packet, shadowMap);
+		// Back to the scene target, keeping the depth of the prepass
+		DynamicResolution::BeginScene();
+		OpenGLContext::SetDepthLessEqual(true);
+	}
 
-	g_Shader.Bind();
-	g_Shader.UploadUniformFloat3("u_EyePosition", camera.GetPosition());
-	g_Shader.UploadUniformMat4("u_View", camera.CalculateViewMatrix());
+	{
+		GpuProfileScope scope("Skybox");
+		skybox.Draw(packet.View, packet.Projection);
+	}
 
-	shadowMap.Read(2);
-	g_Shader.UploadUniformInt("u_Texture", 1);
-	g_Shader.UploadUniformInt("u_DirectionalShadowMap", 2);
+	{
+		GpuProfileScope scope("Main pass");
+		BindShadows(packet, shadowMap, *g_Shader);
+		g_Shader->UploadUniformMat4("u_View", packet.View);
+		TextureArrayManager::Bind(TEXTURE_ARRAY_FIRST_UNIT);
+
+		g_Shader->UploadUniformInt("u_ShadowMaskEnabled", g_ShadowMaskEnabled);
+		if (g_ShadowMaskEnabled)
+			ShadowMask::Read(*g_Shader, SHADOW_MASK_FIRST_UNIT);
+
+		g_Shader->Validate();
+		g_RenderQueue.Begin(RenderPassType::Main, packet.EyePosition, CAMERA_FAR_PLANE);
+		RenderScene(packet, packet.CameraView, *g_Shader);
+	}
+
+	if (g_ShadowMaskEnabled)
+		OpenGLContext::SetDepthLessEqual(false);
+
+	GpuProfileScope scope("Upscale");
+	DynamicResolution::EndScene();
+}
+
+static void UploadTransforms(const FramePacket& packet)
+{
+	GpuProfileScope scope("Transform upload");
+	const size_t requiredSize = sizeof(ObjectTransform) * packet.TransformCount;
+	if (g_TransformSB->GetSize() < requiredSize)
+		g_TransformSB->Resize(requiredSize);
+
+	// Only the range of nodes that changed since the previous packet, in one call
+	if (!packet.TransformUpload.empty())
+		g_TransformSB->SetData(packet.TransformUpload.data(), sizeof(ObjectTransform) * packet.TransformUpload.size(), sizeof(ObjectTransform) * packet.TransformUploadOffset);
+}
+
+static void RenderFrame(const FramePacket& packet, const ShadowMap& shadowMap, const Skybox& skybox)
+{
+	Profiler::BeginFrame(packet.FrameIndex);
+	DynamicResolution::BeginFrame(packet.FrameIndex);
 
-	for (size_t i = 0; i < g_PointLights.size(); i++)
 	{
-		const int textureUnit = 3;
-		g_PointLightOmniShadowMaps[i].Read(textureUnit + i);
-		std::string uniformName = std::format("u_OmniShadowMaps[{}]", i);
-		g_Shader.UploadUniformInt(uniformName + std::string(".ShadowMap"), textureUnit + i);
-		g_Shader.UploadUniformFloat(uniformName + std::string(".FarPlane"), 100.0f);
+		GpuProfileScope scope("Render frame");
+		UploadTransforms(packet);
+		DirectionalShadowMapPass(packet, shadowMap);
+		// Lights past DrawListBuilder::MaxOmniLights have no draw list and cast no shadow
+		const size_t omniLightCount = std::min(packet.OmniLightViews.size(), packet.OmniShadowMaps.size());
+		for (size_t i = 0; i < packet.PointLights.size() && i < omniLightCount; i++)
+			OmniShadowMapPass(packet, packet.OmniLightViews[i], packet.PointLights[i], g_OmniShadowPool.GetMap(packet.OmniShadowMaps[i]), (int32_t)i);
+		for (size_t i = 0; i < packet.SpotLights.size() && packet.PointLights.size() + i < omniLightCount; i++)
+		{
+			const size_t light = packet.PointLights.size() + i;
+			OmniShadowMapPass(packet, packet.OmniLightViews[light], packet.SpotLights[i], g_OmniShadowPool.GetMap(packet.OmniShadowMaps[light]), (int32_t)light);
+		}
+		RenderPass(packet, shadowMap, skybox);
 	}
 
-	for (size_t i = 0; i < g_SpotLights.size(); i++)
+	DynamicResolution::EndFrame();
+
+	if (FrameCapture::IsEnabled())
 	{
-		const int textureUnit = 3 + g_PointLights.size();
-		g_SpotLightOmniShadowMaps[i].Read(textureUnit + i);
-		std::string uniformName = std::format("u_OmniShadowMaps[{}]", i + g_PointLights.size());
-		g_Shader.UploadUniformInt(uniformName + std::string(".ShadowMap"), textureUnit + i);
-		g_Shader.UploadUniformFloat(uniformName + std::string(".FarPlane"), 100.0f);
+		GpuProfileScope scope("Frame capture");
+		// A hidden window does not have to own its pixels, headless runs capture the scene before it is upscaled
+		if (g_CaptureSceneTarget)
+			FrameCapture::Capture(packet.FrameIndex, DynamicResolution::GetTarget().GetFramebufferId(), DynamicResolution::GetRenderWidth(), DynamicResolution::GetRenderHeight());
+		else
+			FrameCapture::Capture(packet.FrameIndex, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
 	}
 
-	if (!g_SpotLights.empty())
 	{
-		glm::vec3 lowerLight = camera.GetPosition();
-		lowerLight.y -= 0.3f;
-		g_SpotLights[0].Position = lowerLight;
-		g_SpotLights[0].Direction = camera.GetDirection();
-		g_SpotLightUB->SetData(g_SpotLights.data());
+		GpuProfileScope scope("Texture streaming");
+		RequestTextureResidency(packet);
+		// Before streaming, so texture arrays grow or shrink first and the uploads land in the final ones
+		GpuMemory::EndFrame();
+		TextureArrayManager::Stream(TEXTURE_STREAM_BUDGET);
 	}
-	g_Shader.Validate();
-	RenderScene(g_Shader);
+
+	Profiler::EndFrame();
+	// Last, so whatever this frame destroyed is behind its fence
+	GpuResources::EndFrame();
+}
+
+// Heap allocations of the frames after ALLOCATION_WARMUP_FRAMES, which should all stay at zero
+struct SteadyStateAllocations
+{
+	uint64_t Frames = 0;
+	// Every thread from the first steady-state frame until the last frame is rendered, job workers included
+	uint64_t TotalBefore = 0;
+	uint64_t Total = 0;
+	// Share of the total made directly on the simulation and render threads
+	uint64_t Simulation = 0;
+	std::atomic<uint64_t> Render = 0;
+};
+
+struct BenchSettings
+{
+	bool Enabled = false;
+	bool JobSystem = false;
+	bool Ecs = false;
+	bool AssetPack = false;
+	bool Obj = false;
+	bool ShadowMask = SHADOW_MASK_ENABLED;
+	// Chrome trace of the last profiled events written at exit, none when empty
+	std::string TracePath;
+	// Input recording written while running or replayed instead of polling the window, none when empty
+	std::string RecordPath;
+	std::string ReplayPath;
+	bool Headless = false;
+	// Frames read back and written as images or compared against golden images, off without a directory
+	FrameCaptureSettings Capture;
+	uint32_t FrameCount = 1000;
+	uint32_t SyntheticObjects = 0;
+#ifdef APP_DEBUG
+	LogLevel MinLogLevel = LogLevel::Debug;
+#else
+	LogLevel MinLogLevel = LogLevel::Info;
+#endif
+	// Driver notifications are logged too, compare bench frame times with and without to see what logging costs
+	bool GlNotifications = false;
+	// 0 turns eviction off
+	uint32_t GpuBudgetMB = GPU_MEMORY_BUDGET_MB;
+	DynamicResolutionSettings Resolution = { DYNAMIC_RESOLUTION_TARGET_MS, DYNAMIC_RESOLUTION_MIN_SCALE, DYNAMIC_RESOLUTION_MAX_SCALE };
+};
+
+static LogLevel ParseLogLevel(const char* name)
+{
+	if (strcmp(name, "debug") == 0)
+		return LogLevel::Debug;
+	if (strcmp(name, "warning") == 0)
+		return LogLevel::Warning;
+	if (strcmp(name, "error") == 0)
+		return LogLevel::Error;
+	return LogLevel::Info;
+}
+
+static BenchSettings ParseBenchSettings(int argc, char** argv)
+{
+	BenchSettings settings;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--bench") == 0)
+		{
+			settings.Enabled = true;
+			if (i + 1 < argc && argv[i + 1][0] != '-')
+				settings.FrameCount = (uint32_t)std::stoul(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--bench-jobs") == 0)
+		{
+			settings.JobSystem = true;
+		}
+		else if (strcmp(argv[i], "--bench-ecs") == 0)
+		{
+			settings.Ecs = true;
+		}
+		else if (strcmp(argv[i], "--bench-pack") == 0)
+		{
+			settings.AssetPack = true;
+		}
+		else if (strcmp(argv[i], "--bench-obj") == 0)
+		{
+			settings.Obj = true;
+		}
+		else if (strcmp(argv[i], "--shadow-mask") == 0)
+		{
+			settings.ShadowMask = true;
+		}
+		else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+		{
+			settings.RecordPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+		{
+			settings.ReplayPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--headless") == 0)
+		{
+			settings.Headless = true;
+		}
+		else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc)
+		{
+			settings.Capture.OutputDirectory = argv[++i];
+		}
+		else if (strcmp(argv[i], "--capture-interval") == 0 && i + 1 < argc)
+		{
+			settings.Capture.Interval = (uint32_t)std::stoul(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--golden") == 0 && i + 1 < argc)
+		{
+			settings.Capture.GoldenDirectory = argv[++i];
+		}
+		else if (strcmp(argv[i], "--golden-tolerance") == 0 && i + 1 < argc)
+		{
+			settings.Capture.Tolerance = std::stof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--log-level") == 0 && i + 1 < argc)
+		{
+			settings.MinLogLevel = ParseLogLevel(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--gl-notifications") == 0)
+		{
+			settings.GlNotifications = true;
+		}
+		else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+		{
+			settings.TracePath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--objects") == 0 && i + 1 < argc)
+		{
+			settings.SyntheticObjects = (uint32_t)std::stoul(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--gpu-budget") == 0 && i + 1 < argc)
+		{
+			settings.GpuBudgetMB = (uint32_t)std::stoul(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--target-ms") == 0 && i + 1 < argc)
+		{
+			settings.Resolution.TargetMs = std::stof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--min-scale") == 0 && i + 1 < argc)
+		{
+			settings.Resolution.MinScale = std::stof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--max-scale") == 0 && i + 1 < argc)
+		{
+			settings.Resolution.MaxScale = std::stof(argv[++i]);
+		}
+	}
+
+	return settings;
+}
+
+static void PrintBenchReport(const RenderThreadStats& frameStats, const RenderStats& totals, double simulationMs, const SteadyStateAllocations& allocations)
+{
+	const uint64_t frames = std::max<uint64_t>(frameStats.FramesPresented, 1);
+	const double presentSpan = std::chrono::duration<double, std::milli>(frameStats.LastPresent - frameStats.FirstPresent).count();
+	const double frameTime = frames > 1 ? presentSpan / (double)(frames - 1) : 0.0;
+
+	std::cout << "Bench results (" << frameStats.FramesPresented << " frames):\n";
+	std::cout << "\tAverage frame time: " << frameTime << " ms\n";
+	std::cout << "\tThroughput: " << (frameTime > 0.0 ? 1000.0 / frameTime : 0.0) << " fps\n";
+	std::cout << "\tAverage latency: " << frameStats.TotalLatencyMs / (double)frames << " ms\n";
+	std::cout << "\tMax latency: " << frameStats.MaxLatencyMs << " ms\n";
+	std::cout << "\tSimulation and draw list generation: " << simulationMs / (double)frames << " ms per frame (" << g_World.Count<RenderableComponent>() << " objects, "
+		<< JobSystem::GetWorkerCount() << " workers)\n";
+	std::cout << "\tDraw calls per frame: " << totals.DrawCalls / frames << "\n";
+	std::cout << "\tState changes issued per frame: " << totals.StateChangesIssued / frames << "\n";
+	std::cout << "\tState changes skipped per frame: " << totals.StateChangesSkipped / frames << "\n";
+
+	const TextureStreamStats& streamStats = TextureArrayManager::GetStreamStats();
+	std::cout << "\tTexture data streamed: " << (double)streamStats.BytesStreamed / (1024.0 * 1024.0) << " MB in " << streamStats.LevelsStreamed << " levels, "
+		<< streamStats.PendingLevels << " levels still pending\n";
+
+	std::cout << "\tHeap allocations in " << allocations.Frames << " steady-state frames: " << allocations.Total << " on all threads, " << allocations.Simulation
+		<< " of them on the simulation thread and " << allocations.Render << " on the render thread\n";
+	if (allocations.Total > 0)
+		std::cerr << "Steady-state frames allocated on the heap " << allocations.Total << " times\n";
+
+	GpuMemory::PrintReport();
+
+	const GpuResourceStats& resourceStats = GpuResources::GetStats();
+	std::cout << "\tGPU objects: " << resourceStats.Created << " created, " << resourceStats.Recycled << " recycled, " << resourceStats.Deleted << " deleted, "
+		<< GpuResources::GetPendingCount() << " waiting on fences, " << GpuResources::GetRecycledCount() << " in the recycle bin\n";
+
+	DynamicResolution::PrintReport();
+	Profiler::PrintReport();
+	GlInstrumentation::PrintReport();
+	if (GlInstrumentation::GetCacheMismatches() > 0)
+		std::cerr << GlInstrumentation::GetCacheMismatches() << " frames issued GL draws or binds past the RenderStateCache\n";
+	Log::PrintReport();
+	g_OmniShadowPool.PrintReport();
+	// Run once with and once without --shadow-mask to compare, --min-scale 1 keeps the resolution the same for both
+	std::cout << "Shadows: " << (g_ShadowMaskEnabled ? "half resolution screen space mask after a depth prepass" : "filtered per fragment in the main pass") << '\n';
 }
 
-int main()
+int main(int argc, char** argv)
 {
+	const BenchSettings bench = ParseBenchSettings(argc, argv);
+	Profiler::Init();
+	Profiler::SetThreadName("Main");
+
+	if (bench.JobSystem)
+	{
+		RunJobSystemBenchmark();
+		return 0;
+	}
+
+	if (bench.Ecs)
+	{
+		RunEcsBenchmark();
+		return 0;
+	}
+
+	if (bench.AssetPack)
+	{
+		RunAssetPackBenchmark();
+		return 0;
+	}
+
+	if (bench.Obj)
+	{
+		return RunObjImporterBenchmark() ? 0 : 1;
+	}
+
+	Log::Init(bench.MinLogLevel);
+
 	WindowProps props;
 	props.Title = "OpenGLApp";
 	props.Width = WINDOW_WIDTH;
 	props.Height = WINDOW_HEIGHT;
+	props.VSync = !bench.Enabled && !bench.Headless;
+	props.Visible = !bench.Headless;
 
 	g_Window = new Window(props);
 
 	if (!g_Window->Init())
 		return -1;
+	if (bench.GlNotifications)
+		OpenGLContext::SetDebugNotifications(true);
 
 	Input::SetContext(g_Window);
-
-	g_Textures.emplace_back("./assets/textures/brick.png");
-	g_Textures.emplace_back("./assets/textures/dirt.png");
-	g_Textures.emplace_back("./assets/textures/plain.png");
+	if (!bench.ReplayPath.empty() && !Input::StartReplay(bench.ReplayPath, REPLAY_TIMESTEP))
+		return -1;
+	if (!bench.RecordPath.empty() && !Input::StartRecording(bench.RecordPath))
+		return -1;
+	Profiler::InitGpu();
+	JobSystem::Init();
+	GpuMemory::SetBudget((uint64_t)bench.GpuBudgetMB * 1024 * 1024);
+	// Written by the asset cooker, without it everything is read loose
+	AssetRegistry::MountPack(std::filesystem::path("./assets/cooked") / CookedAssets::PackFileName);
+
+	g_Textures.push_back(AssetRegistry::LoadTexture("./assets/textures/brick.png"));
+	g_Textures.push_back(AssetRegistry::LoadTexture("./assets/textures/dirt.png"));
+	g_Textures.push_back(AssetRegistry::LoadTexture("./assets/textures/plain.png"));
 	
 	g_Materials.emplace_back(4.0f, 256.0f);
 	g_Materials.emplace_back(0.3f, 4.0f);
 
-	g_MaterialUB = new UniformBuffer(sizeof(Material), MATERIAL_BINDING);
+	// Indexed by the material id of each draw, uploaded once instead of once per draw
+	g_MaterialSB = new StorageBuffer(sizeof(Material) * g_Materials.size(), MATERIAL_BUFFER_BINDING);
+	g_MaterialSB->SetData(g_Materials.data(), sizeof(Material) * g_Materials.size());
 
-	g_xWingModel = new Model("./assets/models/x-wing.obj");
-	g_BlackHawkModel = new Model("./assets/models/uh60.obj");
+	g_xWingModel = AssetRegistry::LoadModel("./assets/models/x-wing.obj");
+	g_BlackHawkModel = AssetRegistry::LoadModel("./assets/models/uh60.obj");
+
+	TextureArrayManager::Build();
+	AssetRegistry::PrintReport();
 
 	g_Meshes.emplace_back(CreatePyramid());
 	g_Meshes.emplace_back(CreatePlane());
 
-	g_Shader.CreateFromFile("./assets/shaders/VertexShader.glsl", "./assets/shaders/FragmentShader.glsl");
-	g_Shader.Bind();
+	CreateSceneObjects(bench.SyntheticObjects);
+	g_TransformSB = new StorageBuffer(sizeof(ObjectTransform) * g_Transforms.GetCount(), TRANSFORM_BUFFER_BINDING);
+
+	g_Shader = AssetRegistry::LoadShader("./assets/shaders/VertexShader.glsl", "./assets/shaders/FragmentShader.glsl");
+	g_Shader->Bind();
+
+	for (uint32_t i = 0; i < TextureArrayManager::MaxArrays; i++)
+		g_Shader->UploadUniformInt(FrameArena::Get().Format("u_TextureArrays[{}]", i), TEXTURE_ARRAY_FIRST_UNIT + i);
 
-	g_DirectionalShadowShader.CreateFromFile("./assets/shaders/DirectionalShadowMap.vert");
-	g_OmniDirectionalShadowShader.CreateFromFile("./assets/shaders/OmniShadowMap.vert", "./assets/shaders/OmniShadowMap.geom", "./assets/shaders/OmniShadowMap.frag");
+	g_DirectionalShadowShader = AssetRegistry::LoadShader("./assets/shaders/DirectionalShadowMap.vert");
+	g_OmniDirectionalShadowShader = AssetRegistry::LoadShader("./assets/shaders/OmniShadowMap.vert", "./assets/shaders/OmniShadowMap.geom", "./assets/shaders/OmniShadowMap.frag");
+	g_DepthPrepassShader = AssetRegistry::LoadShader("./assets/shaders/DepthPrepass.vert");
+	g_ShadowMaskShader = AssetRegistry::LoadShader("./assets/shaders/ShadowMask.vert", "./assets/shaders/ShadowMask.frag");
 
 	DirectionalLight dirLight;
 	dirLight.Color = glm::vec3(1.0f, 0.9f, 0.3f);
@@ -305,7 +781,7 @@ int main()
 	dirLightUB.SetData(&dirLight);
 
 
-	PointLight& pointLight1 = g_PointLights.emplace_back();
+	PointLight pointLight1;
 	pointLight1.Color = glm::vec3(0.0f, 1.0f, 0.0f);
 	pointLight1.Position = glm::vec3(-2.0f, 2.0f, 0.0f);
 	pointLight1.AmbientIntensity = 0.0f;
@@ -313,9 +789,9 @@ int main()
 	pointLight1.Constant = 0.3f;
 	pointLight1.Linear = 0.2f;
 	pointLight1.Exponent = 0.1f;
-	g_PointLightOmniShadowMaps.emplace_back(1024, 1024);
+	g_World.Create(PointLightComponent{ pointLight1, g_OmniShadowPool.AddLight() });
 
-	PointLight& pointLight2 = g_PointLights.emplace_back();
+	PointLight pointLight2;
 	pointLight2.Color = glm::vec3(0.0f, 0.0f, 1.0f);
 	pointLight2.Position = glm::vec3(2.0f, 2.0f, 0.0f);
 	pointLight2.AmbientIntensity = 0.0f;
@@ -323,14 +799,12 @@ int main()
 	pointLight2.Constant = 0.3f;
 	pointLight2.Linear = 0.2f;
 	pointLight2.Exponent = 0.1f;
-	g_PointLightOmniShadowMaps.emplace_back(1024, 1024);
+	g_World.Create(PointLightComponent{ pointLight2, g_OmniShadowPool.AddLight() });
 
-	UniformBuffer pointLightUB(sizeof(PointLight) * g_PointLights.size(), POINT_LIGHT_ARRAY_BINDING);
-	pointLightUB.SetData(g_PointLights.data());
+	// Light data is uploaded by the main pass every frame, so these only have to be sized here
+	g_PointLightUB = new UniformBuffer(sizeof(PointLight) * g_World.Count<PointLightComponent>(), POINT_LIGHT_ARRAY_BINDING);
 
-	g_Shader.UploadUniformInt("u_PointLightCount", (int)g_PointLights.size());
-
-	SpotLight& spotLight1 = g_SpotLights.emplace_back();
+	SpotLight spotLight1;
 	spotLight1.Color = glm::vec3(1.0f);
 	spotLight1.AmbientIntensity = 0.0f;
 	spotLight1.DiffuseIntensity = 0.2f;
@@ -340,9 +814,9 @@ int main()
 	spotLight1.Linear = 0.0f;
 	spotLight1.Exponent = 0.0f;
 	spotLight1.Edge = SpotLightEdge(20.0f);
-	g_SpotLightOmniShadowMaps.emplace_back(1024, 1024);
+	g_World.Create(SpotLightComponent{ spotLight1, g_OmniShadowPool.AddLight() }, CameraAttachmentComponent{ -0.3f });
 
-	SpotLight& spotLight2 = g_SpotLights.emplace_back();
+	SpotLight spotLight2;
 	spotLight2.Color = glm::vec3(1.0f);
 	spotLight2.AmbientIntensity = 0.0f;
 	spotLight2.DiffuseIntensity = 1.0f;
@@ -352,9 +826,9 @@ int main()
 	spotLight2.Linear = 0.0f;
 	spotLight2.Exponent = 0.0f;
 	spotLight2.Edge = SpotLightEdge(20.0f);
-	g_SpotLightOmniShadowMaps.emplace_back(1024, 1024);
+	g_World.Create(SpotLightComponent{ spotLight2, g_OmniShadowPool.AddLight() });
 
-	SpotLight& spotLight3 = g_SpotLights.emplace_back();
+	SpotLight spotLight3;
 	spotLight3.Color = glm::vec3(1.0f, 0.0f, 0.0f);
 	spotLight3.AmbientIntensity = 0.0f;
 	spotLight3.DiffuseIntensity = 1.0f;
@@ -364,12 +838,10 @@ int main()
 	spotLight3.Linear = 0.0f;
 	spotLight3.Exponent = 0.0f;
 	spotLight3.Edge = SpotLightEdge(40.0f);
-	g_SpotLightOmniShadowMaps.emplace_back(1024, 1024);
-
-	g_SpotLightUB = new UniformBuffer(sizeof(SpotLight) * g_SpotLights.size(), SPOT_LIGHT_ARRAY_BINDING);
-	g_SpotLightUB->SetData(g_SpotLights.data());
+	g_World.Create(SpotLightComponent{ spotLight3, g_OmniShadowPool.AddLight() });
 
-	g_Shader.UploadUniformInt("u_SpotLightCount", (int)g_SpotLights.size());
+	g_SpotLightUB = new UniformBuffer(sizeof(SpotLight) * g_World.Count<SpotLightComponent>(), SPOT_LIGHT_ARRAY_BINDING);
+	g_OmniShadowPool.CreateMaps();
 
 	CameraSpecification cameraSpec;
 	cameraSpec.Position = glm::vec3(0.0f, 0.0f, 5.0f);
@@ -380,14 +852,21 @@ int main()
 	cameraSpec.TurnSpeed = 10.0f;
 
 	Camera camera(cameraSpec);
-	g_Shader.UploadUniformMat4("u_Projection", g_CameraProjection);
+	g_Shader->UploadUniformMat4("u_Projection", g_CameraProjection);
 
 	static glm::mat4 lightProjection = glm::ortho(-20.0f, 20.0f, -20.0f, 20.0f, 0.1f, 100.0f);
 	const glm::mat4 lightTransform = CalculateLightTransform(dirLight, lightProjection);
-	g_Shader.UploadUniformMat4("u_LightSpaceTransform", lightTransform);
+	g_DirectionalLightTransform = lightTransform;
+	g_Shader->UploadUniformMat4("u_LightSpaceTransform", lightTransform);
 
-	g_DirectionalShadowShader.Bind();
-	g_DirectionalShadowShader.UploadUniformMat4("u_LightSpaceTransform", lightTransform);
+	g_DirectionalShadowShader->Bind();
+	g_DirectionalShadowShader->UploadUniformMat4("u_LightSpaceTransform", lightTransform);
+
+	g_DepthPrepassShader->Bind();
+	g_DepthPrepassShader->UploadUniformMat4("u_Projection", g_CameraProjection);
+
+	g_ShadowMaskShader->Bind();
+	g_ShadowMaskShader->UploadUniformMat4("u_LightSpaceTransform", lightTransform);
 
 	std::vector<std::string> skyboxFaces {
 		"./assets/textures/Skybox/cupertin-lake_rt.tga",
@@ -399,32 +878,128 @@ int main()
 	};
 
 	Skybox skybox(skyboxFaces);
+	DynamicResolution::Init(WINDOW_WIDTH, WINDOW_HEIGHT, bench.Resolution);
+	g_ShadowMaskEnabled = bench.ShadowMask;
+	if (g_ShadowMaskEnabled)
+		ShadowMask::Init(DynamicResolution::GetTarget().GetWidth(), DynamicResolution::GetTarget().GetHeight());
+
+	const bool capture = !bench.Capture.OutputDirectory.empty() || !bench.Capture.GoldenDirectory.empty();
+	g_CaptureSceneTarget = bench.Headless;
+	if (capture)
+		FrameCapture::Init(bench.Capture, std::max<uint32_t>(WINDOW_WIDTH, DynamicResolution::GetTarget().GetWidth()), std::max<uint32_t>(WINDOW_HEIGHT, DynamicResolution::GetTarget().GetHeight()));
+
+	GpuMemory::PrintReport();
+
+	RenderStats benchTotals;
+	SteadyStateAllocations allocations;
+	FramePacketQueue packetQueue;
+
+	RenderThread renderThread(*g_Window, packetQueue, [&](const FramePacket& packet)
+	{
+		RenderStateCache::ResetStats();
+		GlInstrumentation::BeginFrame();
+		const uint64_t allocationsBefore = AllocationCounter::GetThreadCount();
+		RenderFrame(packet, shadowMap, skybox);
+
+		if (packet.FrameIndex >= ALLOCATION_WARMUP_FRAMES)
+			allocations.Render += AllocationCounter::GetThreadCount() - allocationsBefore;
+
+		const RenderStats& stats = RenderStateCache::GetStats();
+		GlInstrumentation::EndFrame(stats);
+		benchTotals.DrawCalls += stats.DrawCalls;
+		benchTotals.StateChangesIssued += stats.StateChangesIssued;
+		benchTotals.StateChangesSkipped += stats.StateChangesSkipped;
+	});
+	renderThread.Start();
 
 	static float lastFrameTime = 0.0f;
+	uint64_t frameIndex = 0;
+	double simulationMs = 0.0;
 
 	while (!g_Window->ShouldClose())
 	{
-		float time = g_Window->GetCurrentTime();
-		float deltaTime = time - lastFrameTime;
-		lastFrameTime = time;
+		g_Window->PollEvents();
 
-		camera.OnUpdate(deltaTime);
+		// Blocks while the render thread is still busy with the two previous frames
+		FramePacket* packet = packetQueue.BeginWrite();
+		if (!packet)
+			break;
 
-		DirectionalShadowMapPass(shadowMap);
-		for (size_t i = 0; i < g_PointLights.size(); i++)
-			OmniShadowMapPass(g_PointLights[i], g_PointLightOmniShadowMaps[i]);
-		for (size_t i = 0; i < g_SpotLights.size(); i++)
-			OmniShadowMapPass(g_SpotLights[i], g_SpotLightOmniShadowMaps[i]);
-		RenderPass(camera, shadowMap, skybox);
+		float time = g_Window->GetCurrentTime();
+		const float deltaTime = Input::Update(time - lastFrameTime);
+		lastFrameTime = time;
 
-		g_Window->OnUpdate();
+		packet->FrameIndex = frameIndex++;
+		packet->SimulationStart = std::chrono::steady_clock::now();
+		if (packet->FrameIndex == ALLOCATION_WARMUP_FRAMES)
+			allocations.TotalBefore = AllocationCounter::GetTotalCount();
+		const uint64_t allocationsBefore = AllocationCounter::GetThreadCount();
+
+		{
+			ProfileScope scope("Simulate scene");
+			camera.OnUpdate(deltaTime);
+			SimulateScene(*packet, camera, deltaTime);
+		}
+		simulationMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - packet->SimulationStart).count();
+
+		if (packet->FrameIndex >= ALLOCATION_WARMUP_FRAMES)
+		{
+			allocations.Simulation += AllocationCounter::GetThreadCount() - allocationsBefore;
+			allocations.Frames++;
+		}
+
+		packetQueue.EndWrite();
+		FrameArena::Get().Reset();
+
+		if ((bench.Enabled && frameIndex == bench.FrameCount) || Input::IsReplayFinished())
+			g_Window->Close();
 	}
 
-	delete g_xWingModel;
-	delete g_BlackHawkModel;
-	delete g_MaterialUB;
+	renderThread.Stop();
+	if (allocations.Frames > 0)
+		allocations.Total = AllocationCounter::GetTotalCount() - allocations.TotalBefore;
+	// Whatever the frames logged comes before the reports
+	Log::Flush();
+	// Finishes the captures still in flight, while the context is still there
+	FrameCapture::Shutdown();
+	if (Input::IsReplaying())
+		std::cout << "Replayed " << Input::GetFrameCount() << " frames of '" << bench.ReplayPath << "' at a " << REPLAY_TIMESTEP * 1000.0f << " ms timestep\n";
+	Input::Stop();
+
+	if (bench.Enabled)
+		PrintBenchReport(renderThread.GetStats(), benchTotals, simulationMs, allocations);
+	if (!bench.TracePath.empty())
+		Profiler::WriteChromeTrace(bench.TracePath);
+	if (capture)
+		FrameCapture::PrintReport();
+
+	// Dropping the last handles frees the GL objects, which needs the context still alive
+	g_Textures.clear();
+	g_xWingModel.Reset();
+	g_BlackHawkModel.Reset();
+	g_Shader.Reset();
+	g_DirectionalShadowShader.Reset();
+	g_OmniDirectionalShadowShader.Reset();
+	g_DepthPrepassShader.Reset();
+	g_ShadowMaskShader.Reset();
+	AssetRegistry::Shutdown();
+
+	delete g_MaterialSB;
+	delete g_TransformSB;
+	delete g_PointLightUB;
 	delete g_SpotLightUB;
+	TextureArrayManager::Shutdown();
+	ShadowMask::Shutdown();
+	DynamicResolution::Shutdown();
+	// Also whatever main still owns, their destructors find stale handles afterwards
+	GpuResources::Shutdown();
+	Profiler::Shutdown();
 	delete g_Window;
 
-	return 0;
+	JobSystem::Shutdown();
+	Log::Shutdown();
+
+	// Image regression runs fail on any frame that does not match its golden image, benches on any
+	// steady-state heap allocation
+	return FrameCapture::GetFailedCount() || (bench.Enabled && (allocations.Total > 0 || GlInstrumentation::GetCacheMismatches() > 0)) ? 1 : 0;
 }
\ No newline at end of file
@@ -1,45 +1,23 @@
 #include "Mesh.h"
 
 #include <glad/glad.h>
+#include <glm/glm.hpp>
 
-Mesh::Mesh(float* vertices, uint32_t* indices, uint32_t numberOfVertices, uint32_t numberOfIndices)
-{
-	m_IndexCount = (int32_t)numberOfIndices;
-
-	glGenVertexArrays(1, &m_VertexArrayId);
-	glBindVertexArray(m_VertexArrayId);
-
-	glGenBuffers(1, &m_VertexBufferId);
-	glBindBuffer(GL_ARRAY_BUFFER, m_VertexBufferId);
-	glBufferData(GL_ARRAY_BUFFER, (int64_t)sizeof(float) * numberOfVertices, vertices, GL_STATIC_DRAW);
+#include "RenderStateCache.h"
 
-	glGenBuffers(1, &m_IndexBufferId);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_IndexBufferId);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, (int64_t)sizeof(uint32_t) * numberOfIndices, indices, GL_STATIC_DRAW);
-
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 8, nullptr);
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 8, (const void*)(sizeof(float) * 3));
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 8, (const void*)(sizeof(float) * 5));
-	glEnableVertexAttribArray(2);
-
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+Mesh::Mesh(const float* vertices, const uint32_t* indices, uint32_t numberOfVertices, uint32_t numberOfIndices)
+{
+	m_BoundingSphere = CalculateBoundingSphere(vertices, numberOfVertices);
+	Upload(vertices, indices, numberOfVertices, numberOfIndices);
 }
 
 Mesh::Mesh(Mesh&& other) noexcept
+	: m_VertexArray(other.m_VertexArray), m_VertexBuffer(other.m_VertexBuffer), m_IndexBuffer(other.m_IndexBuffer),
+	m_IndexCount(other.m_IndexCount), m_BufferBytes(other.m_BufferBytes), m_BoundingSphere(other.m_BoundingSphere)
 {
-	m_VertexArrayId = other.m_VertexArrayId;
-	other.m_VertexArrayId = 0;
-
-	m_VertexBufferId = other.m_VertexBufferId;
-	other.m_VertexBufferId = 0;
-
-	m_IndexBufferId = other.m_IndexBufferId;
-	other.m_IndexBufferId = 0;
-
-	m_IndexCount = other.m_IndexCount;
+	other.m_VertexArray = {};
+	other.m_VertexBuffer = {};
+	other.m_IndexBuffer = {};
 	other.m_IndexCount = 0;
 }
 
@@ -48,33 +26,63 @@ Mesh::~Mesh()
 	ClearMesh();
 }
 
+void Mesh::Upload(const float* vertices, const uint32_t* indices, uint32_t numberOfVertices, uint32_t numberOfIndices)
+{
+	ClearMesh();
+
+	m_IndexCount = (int32_t)numberOfIndices;
+	m_BufferBytes = sizeof(float) * (uint64_t)numberOfVertices + sizeof(uint32_t) * (uint64_t)numberOfIndices;
+
+	// Immutable storage filled straight from the caller's memory. Dynamic so a recycled buffer can be filled again.
+	m_VertexBuffer = GpuResources::CreateBuffer({ sizeof(float) * (uint64_t)numberOfVertices, GL_DYNAMIC_STORAGE_BIT }, vertices, GpuMemoryCategory::Meshes);
+	m_IndexBuffer = GpuResources::CreateBuffer({ sizeof(uint32_t) * (uint64_t)numberOfIndices, GL_DYNAMIC_STORAGE_BIT }, indices, GpuMemoryCategory::Meshes);
+
+	m_VertexArray = GpuResources::CreateVertexArray();
+	const uint32_t vertexArray = GpuResources::GetId(m_VertexArray);
+	glVertexArrayVertexBuffer(vertexArray, 0, GpuResources::GetId(m_VertexBuffer), 0, sizeof(float) * 8);
+	glVertexArrayElementBuffer(vertexArray, GpuResources::GetId(m_IndexBuffer));
+
+	constexpr uint32_t components[] = { 3, 2, 3 };
+	uint32_t offset = 0;
+	for (uint32_t attribute = 0; attribute < 3; attribute++)
+	{
+		glEnableVertexArrayAttrib(vertexArray, attribute);
+		glVertexArrayAttribFormat(vertexArray, attribute, (int)components[attribute], GL_FLOAT, GL_FALSE, offset);
+		glVertexArrayAttribBinding(vertexArray, attribute, 0);
+		offset += sizeof(float) * components[attribute];
+	}
+}
+
 void Mesh::RenderMesh() const
 {
-	glBindVertexArray(m_VertexArrayId);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_IndexBufferId);
+	RenderStateCache::BindVertexArray(GpuResources::GetId(m_VertexArray));
 	glDrawElements(GL_TRIANGLES, m_IndexCount, GL_UNSIGNED_INT, nullptr);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	RenderStateCache::RecordDrawCall();
 }
 
 void Mesh::ClearMesh()
 {
-	if (m_VertexArrayId != 0)
-	{
-		glDeleteVertexArrays(1, &m_VertexArrayId);
-		m_VertexArrayId = 0;
-	}
+	// Evicted meshes are uploaded again, the old buffers stay alive until the frames using them are done
+	GpuResources::Destroy(m_VertexArray);
+	GpuResources::Destroy(m_VertexBuffer);
+	GpuResources::Destroy(m_IndexBuffer);
+	m_IndexCount = 0;
+}
 
-	if (m_VertexBufferId != 0)
-	{
-		glDeleteBuffers(1, &m_VertexBufferId);
-		m_VertexBufferId = 0;
-	}
+glm::vec4 Mesh::CalculateBoundingSphere(const float* vertices, uint32_t numberOfVertices)
+{
+	if (numberOfVertices < 8)
+		return glm::vec4(0.0f);
 
-	if (m_IndexBufferId != 0)
+	// Sphere around the AABB, not the tightest fit but good enough for culling
+	glm::vec3 min(vertices[0], vertices[1], vertices[2]);
+	glm::vec3 max = min;
+	for (uint32_t i = 0; i + 2 < numberOfVertices; i += 8)
 	{
-		glDeleteBuffers(1, &m_IndexBufferId);
-		m_IndexBufferId = 0;
+		const glm::vec3 position(vertices[i], vertices[i + 1], vertices[i + 2]);
+		min = glm::min(min, position);
+		max = glm::max(max, position);
 	}
 
-	m_IndexCount = 0;
+	return { (min + max) * 0.5f, glm::length(max - min) * 0.5f };
 }
@@ -1,21 +1,41 @@
 #pragma once
 
 #include <cstdint>
+#include <glm/vec4.hpp>
+
+#include "GpuResources.h"
 
 class Mesh
 {
 public:
-	Mesh(float* vertices, uint32_t* indices, uint32_t numberOfVertices, uint32_t numberOfIndices);
-	Mesh(const Mesh& other) = default;
+	Mesh(const float* vertices, const uint32_t* indices, uint32_t numberOfVertices, uint32_t numberOfIndices);
+	Mesh(const Mesh&) = delete;
 	Mesh(Mesh&& other) noexcept;
 	~Mesh();
 
 	void RenderMesh() const;
+	// Creates the buffers again after ClearMesh. The data is copied by GL right away, it can come from a mapped file.
+	void Upload(const float* vertices, const uint32_t* indices, uint32_t numberOfVertices, uint32_t numberOfIndices);
+	// Frees the buffers, the bounding sphere stays valid for culling
 	void ClearMesh();
 
+	bool IsResident() const { return (bool)m_VertexArray; }
+
+	uint32_t GetVertexArrayId() const { return GpuResources::GetId(m_VertexArray); }
+	int32_t GetIndexCount() const { return m_IndexCount; }
+	// Size of the vertex and index buffers
+	uint64_t GetBufferBytes() const { return m_BufferBytes; }
+
+	// Local space bounding sphere, xyz is the center and w the radius
+	const glm::vec4& GetBoundingSphere() const { return m_BoundingSphere; }
+
+	static glm::vec4 CalculateBoundingSphere(const float* vertices, uint32_t numberOfVertices);
+
 private:
-	uint32_t m_VertexArrayId = 0;
-	uint32_t m_VertexBufferId = 0;
-	uint32_t m_IndexBufferId = 0;
+	GpuVertexArrayHandle m_VertexArray;
+	GpuBufferHandle m_VertexBuffer;
+	GpuBufferHandle m_IndexBuffer;
 	int32_t m_IndexCount = 0;
+	uint64_t m_BufferBytes = 0;
+	glm::vec4 m_BoundingSphere{ 0.0f };
 };
@@ -0,0 +1,167 @@
+#include "MeshFile.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "Utils.h"
+
+static constexpr uint32_t s_Magic = 0x4D4C474F; // "OGLM"
+
+static size_t GetPadding(size_t size)
+{
+	return (4 - size % 4) % 4;
+}
+
+class MeshFileReader
+{
+public:
+	explicit MeshFileReader(std::span<const std::byte> data)
+		: m_Data(data) {}
+
+	bool Read(void* destination, size_t size)
+	{
+		const std::byte* source = Take(size);
+		if (!source)
+			return false;
+
+		std::memcpy(destination, source, size);
+		return true;
+	}
+
+	bool Read(uint32_t& value) { return Read(&value, sizeof(value)); }
+
+	// Arrays stay where they are, which needs them aligned in memory
+	template<typename T>
+	bool View(std::span<const T>& view, uint32_t count)
+	{
+		const std::byte* source = Take(sizeof(T) * (size_t)count);
+		if (!source || reinterpret_cast<uintptr_t>(source) % alignof(T) != 0)
+			return false;
+
+		view = std::span<const T>(reinterpret_cast<const T*>(source), count);
+		return true;
+	}
+
+	bool Skip(size_t size) { return Take(size) != nullptr; }
+
+private:
+	const std::byte* Take(size_t size)
+	{
+		if (size > m_Data.size() - m_Offset)
+			return nullptr;
+
+		const std::byte* data = m_Data.data() + m_Offset;
+		m_Offset += size;
+		return data;
+	}
+
+private:
+	std::span<const std::byte> m_Data;
+	size_t m_Offset = 0;
+};
+
+bool MeshFile::Read(const std::filesystem::path& path, MeshFile& file)
+{
+	const std::vector<uint8_t> data = Utils::ReadFileToBytes(path);
+	MeshFileView view;
+	if (!Parse(std::as_bytes(std::span(data)), path.string(), view))
+		return false;
+
+	file.Textures = std::move(view.Textures);
+	file.Submeshes.resize(view.Submeshes.size());
+	for (size_t i = 0; i < view.Submeshes.size(); i++)
+	{
+		const MeshFileSubmeshView& source = view.Submeshes[i];
+		file.Submeshes[i].Material = source.Material;
+		file.Submeshes[i].Vertices.assign(source.Vertices.begin(), source.Vertices.end());
+		file.Submeshes[i].Indices.assign(source.Indices.begin(), source.Indices.end());
+	}
+
+	return true;
+}
+
+bool MeshFile::Parse(std::span<const std::byte> data, const std::string& name, MeshFileView& view)
+{
+	MeshFileReader reader(data);
+
+	uint32_t magic = 0, version = 0, textureCount = 0, submeshCount = 0;
+	if (!reader.Read(magic) || !reader.Read(version) || magic != s_Magic || version != Version)
+	{
+		std::cerr << "'" << name << "' is not a version " << Version << " mesh file\n";
+		return false;
+	}
+
+	bool valid = reader.Read(textureCount);
+	view.Textures.resize(valid ? textureCount : 0);
+	for (std::string& texture : view.Textures)
+	{
+		uint32_t length = 0;
+		valid = valid && reader.Read(length);
+		texture.resize(valid ? length : 0);
+		valid = valid && reader.Read(texture.data(), length) && reader.Skip(GetPadding(length));
+	}
+
+	valid = valid && reader.Read(submeshCount);
+	view.Submeshes.resize(valid ? submeshCount : 0);
+	for (MeshFileSubmeshView& submesh : view.Submeshes)
+	{
+		uint32_t vertexCount = 0, indexCount = 0;
+		valid = valid && reader.Read(submesh.Material) && reader.Read(vertexCount) && reader.Read(indexCount)
+			&& reader.View(submesh.Vertices, vertexCount) && reader.View(submesh.Indices, indexCount);
+		if (!valid)
+			break;
+	}
+
+	if (!valid)
+		std::cerr << "Mesh file '" << name << "' is truncated or misaligned\n";
+
+	return valid;
+}
+
+MeshFileView MeshFile::GetView(const MeshFile& file)
+{
+	MeshFileView view;
+	view.Textures = file.Textures;
+	for (const MeshFileSubmesh& submesh : file.Submeshes)
+		view.Submeshes.push_back({ submesh.Material, submesh.Vertices, submesh.Indices });
+
+	return view;
+}
+
+bool MeshFile::Write(const std::filesystem::path& path, const MeshFile& file)
+{
+	std::ofstream out(path, std::ios::out | std::ios::binary);
+	if (!out)
+	{
+		std::cerr << "Could not open '" << path.string() << "' for writing\n";
+		return false;
+	}
+
+	auto write = [&out](const void* data, size_t size) { out.write(static_cast<const char*>(data), (std::streamsize)size); };
+	auto writeUInt = [&write](uint32_t value) { write(&value, sizeof(value)); };
+
+	writeUInt(s_Magic);
+	writeUInt(Version);
+
+	writeUInt((uint32_t)file.Textures.size());
+	for (const std::string& texture : file.Textures)
+	{
+		constexpr uint8_t padding[4] = {};
+		writeUInt((uint32_t)texture.size());
+		write(texture.data(), texture.size());
+		write(padding, GetPadding(texture.size()));
+	}
+
+	writeUInt((uint32_t)file.Submeshes.size());
+	for (const MeshFileSubmesh& submesh : file.Submeshes)
+	{
+		writeUInt(submesh.Material);
+		writeUInt((uint32_t)submesh.Vertices.size());
+		writeUInt((uint32_t)submesh.Indices.size());
+		write(submesh.Vertices.data(), submesh.Vertices.size() * sizeof(float));
+		write(submesh.Indices.data(), submesh.Indices.size() * sizeof(uint32_t));
+	}
+
+	return (bool)out;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
+
+// Interleaved position, texture coordinates and normal, the layout Mesh expects
+struct MeshFileSubmesh
+{
+	uint32_t Material = 0;
+	std::vector<float> Vertices;
+	std::vector<uint32_t> Indices;
+};
+
+// Points into the data the file was parsed from
+struct MeshFileSubmeshView
+{
+	uint32_t Material = 0;
+	std::span<const float> Vertices;
+	std::span<const uint32_t> Indices;
+};
+
+struct MeshFileView
+{
+	std::vector<std::string> Textures;
+	std::vector<MeshFileSubmeshView> Submeshes;
+};
+
+// Binary model format written by the asset cooker. Loading it is a handful of reads straight into
+// the vectors the meshes are built from, instead of a text parse and Assimp's post processing.
+// Texture paths are padded to 4 bytes, so once the file is in memory at a 4 byte aligned address
+// (a mapped asset pack for one) the vertex and index arrays can be used where they are.
+struct MeshFile
+{
+	static constexpr const char* Extension = ".mesh";
+	static constexpr uint32_t Version = 2;
+
+	// Diffuse texture path of every material, empty when the material has none
+	std::vector<std::string> Textures;
+	std::vector<MeshFileSubmesh> Submeshes;
+
+	static bool Read(const std::filesystem::path& path, MeshFile& file);
+	static bool Write(const std::filesystem::path& path, const MeshFile& file);
+
+	// Without copying anything, the data has to outlive the view. The name is for error messages.
+	static bool Parse(std::span<const std::byte> data, const std::string& name, MeshFileView& view);
+	// Views of the vectors of a file that is already loaded
+	static MeshFileView GetView(const MeshFile& file);
+};
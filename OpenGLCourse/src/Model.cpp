@@ -1,107 +1,156 @@
 #include "Model.h"
 
-#include <iostream>
+#include <cfloat>
+#include <filesystem>
+#include <cstdio>
 
-Model::Model(const std::string& filepath)
+#include "Log.h"
+#include "ModelImporter.h"
+#include "Profiler.h"
+#include "Utils.h"
+
+Model::Model(const std::string& filepath, std::span<const std::byte> packed)
+	: m_Path(filepath), m_Packed(packed)
 {
-	Assimp::Importer importer;
-	const aiScene* scene = importer.ReadFile(filepath, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenSmoothNormals | aiProcess_JoinIdenticalVertices);
-	if (!scene)
+	std::vector<uint8_t> data;
+	MeshFile imported;
+	MeshFileView file;
+	if (!ReadMeshes(data, imported, file))
+		return;
+
+	m_Meshes.reserve(file.Submeshes.size());
+	for (const MeshFileSubmeshView& submesh : file.Submeshes)
 	{
-		std::cerr << "Assimp failed to import model '" << filepath << "'. " << importer.GetErrorString() << '\n';
+		m_Meshes.emplace_back(submesh.Vertices.data(), submesh.Indices.data(), (uint32_t)submesh.Vertices.size(), (uint32_t)submesh.Indices.size());
+		m_MeshToTex.push_back(submesh.Material);
+	}
+
+	LoadMaterials(file.Textures);
+
+	if (m_Meshes.empty())
 		return;
+
+	glm::vec3 min(FLT_MAX), max(-FLT_MAX);
+	for (const Mesh& mesh : m_Meshes)
+	{
+		const glm::vec4& sphere = mesh.GetBoundingSphere();
+		min = glm::min(min, glm::vec3(sphere) - sphere.w);
+		max = glm::max(max, glm::vec3(sphere) + sphere.w);
 	}
 
-	LoadNode(scene->mRootNode, scene);
-	LoadMaterials(scene);
+	m_BoundingSphere = glm::vec4((min + max) * 0.5f, glm::length(max - min) * 0.5f);
+	m_LastUsedFrame = GpuMemory::GetFrame();
+	GpuMemory::Register(this);
 }
 
 Model::~Model()
 {
-	for (const auto& texture : m_Textures)
-		delete texture;
+	GpuMemory::Unregister(this);
 }
 
-void Model::Render() const
+void Model::Submit(RenderQueue& queue, const Shader& shader, uint32_t transformIndex, const glm::vec3& position, uint8_t materialId, uint8_t faceMask) const
 {
+	m_LastUsedFrame = GpuMemory::GetFrame();
+	if (m_Evicted)
+		return;
+
 	for (size_t i = 0; i < m_Meshes.size(); i++)
 	{
-		uint32_t materialIndex = m_MeshToTex[i];
-		if (materialIndex < m_Textures.size() && m_Textures[materialIndex])
-			m_Textures[materialIndex]->Bind();
+		const TextureSlot texture = m_MeshToTex[i] < m_Textures.size() && m_Textures[m_MeshToTex[i]] ? *m_Textures[m_MeshToTex[i]] : TextureSlot();
+		queue.Submit(shader, m_Meshes[i], texture, materialId, transformIndex, position, faceMask);
+	}
+}
 
-		m_Meshes[i].RenderMesh();
+void Model::RequestTextureResidency(float screenSize) const
+{
+	for (const TextureHandle& texture : m_Textures)
+	{
+		if (texture)
+			TextureArrayManager::RequestLevel(*texture, screenSize);
 	}
 }
 
-void Model::LoadNode(aiNode* node, const aiScene* scene)
+uint64_t Model::GetBufferBytes() const
 {
-	for (size_t i = 0; i < node->mNumMeshes; i++)
-		LoadMesh(scene->mMeshes[node->mMeshes[i]]);
+	uint64_t bytes = 0;
+	for (const Mesh& mesh : m_Meshes)
+		bytes += mesh.GetBufferBytes();
 
-	for (size_t i = 0; i < node->mNumChildren; i++)
-		LoadNode(node->mChildren[i], scene);
+	return bytes;
 }
 
-void Model::LoadMesh(aiMesh* mesh)
+bool Model::Evict()
 {
-	std::vector<float> vertices;
-	std::vector<uint32_t> indices;
+	if (m_Evicted || m_Meshes.empty())
+		return false;
 
-	for (size_t i = 0; i < mesh->mNumVertices; i++)
-	{
-		vertices.insert(vertices.end(), { mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z });
+	for (Mesh& mesh : m_Meshes)
+		mesh.ClearMesh();
 
-		if (mesh->mTextureCoords[0])
-			vertices.insert(vertices.end(), { mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y });
-		else
-			vertices.insert(vertices.end(), { 0.0f, 0.0f });
+	m_Evicted = true;
+	return true;
+}
 
-		vertices.insert(vertices.end(), { -mesh->mNormals[i].x, -mesh->mNormals[i].y, -mesh->mNormals[i].z });
+uint64_t Model::GetRestoreBytes() const
+{
+	// Only once a draw asked for it again
+	return m_Evicted && m_LastUsedFrame == GpuMemory::GetFrame() ? GetBufferBytes() : 0;
+}
+
+void Model::Restore()
+{
+	std::vector<uint8_t> data;
+	MeshFile imported;
+	MeshFileView file;
+	if (!ReadMeshes(data, imported, file) || file.Submeshes.size() != m_Meshes.size())
+	{
+		Log::Error("Failed to reload model '{}'", m_Path);
+		return;
 	}
 
-	for (size_t i = 0; i < mesh->mNumFaces; i++)
+	for (size_t i = 0; i < m_Meshes.size(); i++)
 	{
-		aiFace face = mesh->mFaces[i];
-		for (size_t j = 0; j < face.mNumIndices; j++)
-			indices.push_back(face.mIndices[j]);
+		const MeshFileSubmeshView& submesh = file.Submeshes[i];
+		m_Meshes[i].Upload(submesh.Vertices.data(), submesh.Indices.data(), (uint32_t)submesh.Vertices.size(), (uint32_t)submesh.Indices.size());
 	}
 
-	m_Meshes.emplace_back(vertices.data(), indices.data(), vertices.size(), indices.size());
-	m_MeshToTex.push_back(mesh->mMaterialIndex);
+	m_Evicted = false;
 }
 
-void Model::LoadMaterials(const aiScene* scene)
+bool Model::ReadMeshes(std::vector<uint8_t>& data, MeshFile& imported, MeshFileView& view) const
 {
-	m_Textures.resize(scene->mNumMaterials);
+	if (!m_Packed.empty())
+		return MeshFile::Parse(m_Packed, m_Path, view);
 
-	for (size_t i = 0; i < scene->mNumMaterials; i++)
+	if (std::filesystem::path(m_Path).extension() == MeshFile::Extension)
 	{
-		aiMaterial* material = scene->mMaterials[i];
-		m_Textures[i] = nullptr;
+		data = Utils::ReadFileToBytes(m_Path);
+		return MeshFile::Parse(std::as_bytes(std::span(data)), m_Path, view);
+	}
 
-		if (material->GetTextureCount(aiTextureType_DIFFUSE))
+	ProfileScope scope("Import model");
+	if (!ModelImporter::Import(m_Path, imported))
+		return false;
+
+	view = MeshFile::GetView(imported);
+	return true;
+}
+
+void Model::LoadMaterials(const std::vector<std::string>& texturePaths)
+{
+	m_Textures.resize(texturePaths.size());
+
+	for (size_t i = 0; i < texturePaths.size(); i++)
+	{
+		if (!texturePaths[i].empty())
 		{
-			aiString path;
-			if (material->GetTexture(aiTextureType_DIFFUSE, 0, &path) == AI_SUCCESS)
-			{
-				std::string pathStr(path.data);
-				size_t idx = pathStr.rfind('\\');
-				std::string filename = pathStr.substr(idx + 1);
-
-				std::string texPath = std::string("./assets/textures/") + filename;
-				m_Textures[i] = new Texture2D(texPath);
-
-				if (!m_Textures[i]->IsLoaded())
-				{
-					printf("Texture '%s' for model was not found.", texPath.c_str());
-					delete m_Textures[i];
-					m_Textures[i] = nullptr;
-				}
-			}
+			m_Textures[i] = AssetRegistry::LoadTexture(texturePaths[i]);
+
+			if (!m_Textures[i])
+				printf("Texture '%s' for model was not found.", texturePaths[i].c_str());
 		}
 
 		if (!m_Textures[i])
-			m_Textures[i] = new Texture2D("./assets/textures/plain.png");
+			m_Textures[i] = AssetRegistry::LoadTexture("./assets/textures/plain.png");
 	}
 }
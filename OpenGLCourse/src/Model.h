@@ -1,31 +1,55 @@
 #pragma once
 
+#include <span>
 #include <vector>
 #include <string>
 
-#include <assimp/Importer.hpp>
-#include <assimp/scene.h>
-#include <assimp/postprocess.h>
-
 #include "Mesh.h"
-#include "Texture2D.h"
+#include "MeshFile.h"
+#include "GpuMemory.h"
+#include "RenderQueue.h"
+#include "AssetRegistry.h"
 
-class Model
+// Registered with GpuMemory, when it is evicted its meshes are freed and read back from the file once it is drawn again
+class Model : public GpuEvictable
 {
 public:
-	Model(const std::string& filepath);
-	~Model();
+	// Cooked .mesh files are read directly, anything else goes through the importer. A packed .mesh file
+	// is used where it is instead, it has to stay valid for as long as the model since evicting reads it again.
+	Model(const std::string& filepath, std::span<const std::byte> packed = {});
+	Model(const Model&) = delete;
+	~Model() override;
+
+	// Every submesh samples the texture arrays, so the whole model draws without a texture bind.
+	// Nothing is drawn while the model is evicted, the submit only asks for it to come back.
+	void Submit(RenderQueue& queue, const Shader& shader, uint32_t transformIndex, const glm::vec3& position, uint8_t materialId, uint8_t faceMask = RenderQueue::AllFaces) const;
+
+	const glm::vec4& GetBoundingSphere() const { return m_BoundingSphere; }
+	// Asks the texture streamer for the levels every submesh texture needs at this size
+	void RequestTextureResidency(float screenSize) const;
+
+	// Vertex and index buffers of every submesh, textures are owned by the registry
+	uint64_t GetBufferBytes() const;
 
-	void Render() const;
+	uint64_t GetLastUsedFrame() const override { return m_LastUsedFrame; }
+	bool Evict() override;
+	uint64_t GetRestoreBytes() const override;
+	bool IsRestoreRequired() const override { return true; }
+	void Restore() override;
 
 private:
-	void LoadNode(aiNode* node, const aiScene* scene);
-	void LoadMesh(aiMesh* mesh);
-	void LoadMaterials(const aiScene* scene);
+	// The view points into data, imported or the packed file
+	bool ReadMeshes(std::vector<uint8_t>& data, MeshFile& imported, MeshFileView& view) const;
+	void LoadMaterials(const std::vector<std::string>& texturePaths);
 
 private:
+	std::string m_Path;
+	std::span<const std::byte> m_Packed;
+	bool m_Evicted = false;
+	mutable uint64_t m_LastUsedFrame = 0;
 	std::vector<Mesh> m_Meshes;
-	std::vector<Texture2D*> m_Textures;
+	std::vector<TextureHandle> m_Textures;
 	std::vector<uint32_t> m_MeshToTex;
+	glm::vec4 m_BoundingSphere{ 0.0f };
 };
 
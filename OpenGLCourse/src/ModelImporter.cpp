@@ -0,0 +1,91 @@
+#include "ModelImporter.h"
+
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+
+#include "ObjImporter.h"
+
+void ModelImporter::ImportMesh(const aiMesh* mesh, MeshFile& file)
+{
+	MeshFileSubmesh& submesh = file.Submeshes.emplace_back();
+	submesh.Material = mesh->mMaterialIndex;
+
+	std::vector<float>& vertices = submesh.Vertices;
+	vertices.reserve((size_t)mesh->mNumVertices * 8);
+	for (size_t i = 0; i < mesh->mNumVertices; i++)
+	{
+		vertices.insert(vertices.end(), { mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z });
+
+		if (mesh->mTextureCoords[0])
+			vertices.insert(vertices.end(), { mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y });
+		else
+			vertices.insert(vertices.end(), { 0.0f, 0.0f });
+
+		vertices.insert(vertices.end(), { -mesh->mNormals[i].x, -mesh->mNormals[i].y, -mesh->mNormals[i].z });
+	}
+
+	for (size_t i = 0; i < mesh->mNumFaces; i++)
+	{
+		const aiFace& face = mesh->mFaces[i];
+		for (size_t j = 0; j < face.mNumIndices; j++)
+			submesh.Indices.push_back(face.mIndices[j]);
+	}
+}
+
+static void ImportNode(const aiNode* node, const aiScene* scene, MeshFile& file)
+{
+	for (size_t i = 0; i < node->mNumMeshes; i++)
+		ModelImporter::ImportMesh(scene->mMeshes[node->mMeshes[i]], file);
+
+	for (size_t i = 0; i < node->mNumChildren; i++)
+		ImportNode(node->mChildren[i], scene, file);
+}
+
+static void ImportMaterials(const aiScene* scene, MeshFile& file)
+{
+	file.Textures.resize(scene->mNumMaterials);
+
+	for (size_t i = 0; i < scene->mNumMaterials; i++)
+	{
+		const aiMaterial* material = scene->mMaterials[i];
+
+		aiString path;
+		if (material->GetTextureCount(aiTextureType_DIFFUSE) && material->GetTexture(aiTextureType_DIFFUSE, 0, &path) == AI_SUCCESS)
+		{
+			// The exporters wrote absolute Windows paths, only the file name is any use
+			const std::string pathStr(path.data);
+			const size_t idx = pathStr.rfind('\\');
+			file.Textures[i] = std::string("./assets/textures/") + pathStr.substr(idx + 1);
+		}
+	}
+}
+
+bool ModelImporter::Import(const std::filesystem::path& path, MeshFile& file)
+{
+	std::string extension = path.extension().string();
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+	if (extension == ".obj")
+		return ObjImporter::Import(path, file);
+
+	return ImportWithAssimp(path, file);
+}
+
+bool ModelImporter::ImportWithAssimp(const std::filesystem::path& path, MeshFile& file)
+{
+	Assimp::Importer importer;
+	const aiScene* scene = importer.ReadFile(path.string(), aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenSmoothNormals | aiProcess_JoinIdenticalVertices);
+	if (!scene)
+	{
+		std::cerr << "Assimp failed to import model '" << path.string() << "'. " << importer.GetErrorString() << '\n';
+		return false;
+	}
+
+	ImportNode(scene->mRootNode, scene, file);
+	ImportMaterials(scene, file);
+	return true;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <filesystem>
+
+#include "MeshFile.h"
+
+struct aiMesh;
+
+// Reads source model formats into the same data the cooked mesh files hold. OBJ goes through the
+// native ObjImporter, everything else through Assimp.
+class ModelImporter
+{
+public:
+	ModelImporter() = delete;
+	~ModelImporter() = delete;
+
+	static bool Import(const std::filesystem::path& path, MeshFile& file);
+	// Also for OBJ, what the native importer is checked against
+	static bool ImportWithAssimp(const std::filesystem::path& path, MeshFile& file);
+	// Appends the mesh as one submesh, repacked into the interleaved layout. Public for the benchmarks.
+	static void ImportMesh(const aiMesh* mesh, MeshFile& file);
+};
@@ -0,0 +1,675 @@
+#include "ObjImporter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "JobSystem.h"
+#include "Utils.h"
+
+static constexpr int32_t s_Missing = INT32_MIN;
+static constexpr uint32_t s_NoMaterial = UINT32_MAX;
+// Enough jobs to keep every worker busy, more only add scheduling overhead
+static constexpr uint32_t s_MaxJobs = 256;
+
+static constexpr uint8_t s_RelativePosition = 1;
+static constexpr uint8_t s_RelativeTexCoord = 2;
+static constexpr uint8_t s_RelativeNormal = 4;
+
+// One face corner, 0 based. Negative indices in the file count back from the last attribute, those are
+// stored relative to the start of the chunk and flagged until the chunks are stitched together.
+struct ObjCorner
+{
+	int32_t Position = s_Missing;
+	int32_t TexCoord = s_Missing;
+	int32_t Normal = s_Missing;
+	uint8_t Relative = 0;
+
+	bool operator==(const ObjCorner& other) const { return Position == other.Position && TexCoord == other.TexCoord && Normal == other.Normal; }
+};
+
+// Triangles from FirstTriangle on use the material called Name
+struct ObjMaterialRun
+{
+	uint32_t FirstTriangle = 0;
+	std::string_view Name;
+};
+
+struct ObjChunk
+{
+	const char* Begin = nullptr;
+	const char* End = nullptr;
+
+	std::vector<float> Positions;
+	std::vector<float> TexCoords;
+	std::vector<float> Normals;
+	// Three per triangle, faces are fanned out while parsing
+	std::vector<ObjCorner> Corners;
+	std::vector<ObjMaterialRun> Runs;
+	std::vector<std::string_view> Libraries;
+
+	// Where the attributes and triangles of this chunk start in the whole file
+	uint32_t PositionBase = 0;
+	uint32_t TexCoordBase = 0;
+	uint32_t NormalBase = 0;
+	uint32_t TriangleBase = 0;
+
+	const char* Error = nullptr;
+	bool MissingNormals = false;
+};
+
+// Triangles [First, First + Count) of a chunk
+struct ObjTriangleRange
+{
+	const ObjChunk* Chunk = nullptr;
+	uint32_t First = 0;
+	uint32_t Count = 0;
+};
+
+struct ObjAttributes
+{
+	std::vector<float> Positions;
+	std::vector<float> TexCoords;
+	std::vector<float> Normals;
+	// Only filled when some corners have no normal
+	std::vector<glm::vec3> SmoothNormals;
+};
+
+template<typename F>
+static void ParallelFor(uint32_t count, uint32_t grainSize, const F& function)
+{
+	if (!JobSystem::IsInitialized())
+	{
+		function(0, count);
+		return;
+	}
+
+	JobCounter counter;
+	JobSystem::ParallelFor(count, std::max(grainSize, count / s_MaxJobs + 1), function, &counter);
+	JobSystem::WaitFor(counter);
+}
+
+static bool IsSpace(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+static bool IsDigit(char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+static const char* SkipSpaces(const char* p, const char* end)
+{
+	while (p < end && IsSpace(*p))
+		p++;
+
+	return p;
+}
+
+static std::string_view Trim(const char* p, const char* end)
+{
+	p = SkipSpaces(p, end);
+	while (end > p && IsSpace(end[-1]))
+		end--;
+
+	return std::string_view(p, (size_t)(end - p));
+}
+
+// True when the line starts with keyword followed by whitespace
+static bool IsKeyword(const char* p, const char* end, std::string_view keyword)
+{
+	return (size_t)(end - p) > keyword.size() && std::memcmp(p, keyword.data(), keyword.size()) == 0 && IsSpace(p[keyword.size()]);
+}
+
+// Decimal floats with an optional exponent, what every exporter writes. Up to 19 significant digits are
+// kept and scaled once in double precision, which rounds to the same float as strtof for all but the
+// rarest halfway cases.
+static const char* ParseFloat(const char* p, const char* end, float& value)
+{
+	static constexpr double powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+	static constexpr uint64_t maxMantissa = 1000000000000000000ull;
+
+	p = SkipSpaces(p, end);
+	const bool negative = p < end && *p == '-';
+	if (p < end && (*p == '-' || *p == '+'))
+		p++;
+
+	uint64_t mantissa = 0;
+	int32_t exponent = 0;
+	uint32_t digits = 0;
+	for (; p < end && IsDigit(*p); p++, digits++)
+	{
+		if (mantissa < maxMantissa)
+			mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+		else
+			exponent++;
+	}
+
+	if (p < end && *p == '.')
+	{
+		for (p++; p < end && IsDigit(*p); p++, digits++)
+		{
+			if (mantissa < maxMantissa)
+			{
+				mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+				exponent--;
+			}
+		}
+	}
+
+	if (digits == 0)
+		return nullptr;
+
+	if (p < end && (*p == 'e' || *p == 'E'))
+	{
+		const char* q = p + 1;
+		const bool negativeExponent = q < end && *q == '-';
+		if (q < end && (*q == '-' || *q == '+'))
+			q++;
+
+		if (q < end && IsDigit(*q))
+		{
+			int32_t written = 0;
+			for (; q < end && IsDigit(*q); q++)
+				written = std::min(written * 10 + (*q - '0'), 100000);
+
+			exponent += negativeExponent ? -written : written;
+			p = q;
+		}
+	}
+
+	double result = (double)mantissa;
+	if (exponent < 0)
+		result = exponent >= -22 ? result / powers[-exponent] : result * std::pow(10.0, exponent);
+	else if (exponent > 0)
+		result = exponent <= 22 ? result * powers[exponent] : result * std::pow(10.0, exponent);
+
+	value = (float)(negative ? -result : result);
+	return p;
+}
+
+// Reads count floats, the ones after required default to 0 when the line ends early
+static const char* ParseFloats(const char* p, const char* end, std::vector<float>& values, uint32_t required, uint32_t count)
+{
+	for (uint32_t i = 0; i < count; i++)
+	{
+		float value = 0.0f;
+		const char* next = ParseFloat(p, end, value);
+		if (!next && i < required)
+			return nullptr;
+
+		values.push_back(value);
+		p = next ? next : p;
+	}
+
+	return p;
+}
+
+static const char* ParseIndex(const char* p, const char* end, uint32_t count, int32_t& index, uint8_t& relative, uint8_t relativeFlag)
+{
+	const bool negative = p < end && *p == '-';
+	if (negative)
+		p++;
+
+	int64_t value = 0;
+	const char* start = p;
+	for (; p < end && IsDigit(*p); p++)
+		value = std::min<int64_t>(value * 10 + (*p - '0'), INT32_MAX);
+
+	if (p == start || value == 0)
+		return nullptr;
+
+	if (negative)
+	{
+		index = (int32_t)((int64_t)count - value);
+		relative |= relativeFlag;
+	}
+	else
+	{
+		index = (int32_t)(value - 1);
+	}
+
+	return p;
+}
+
+static bool ParseFace(ObjChunk& chunk, const char* p, const char* end, std::vector<ObjCorner>& face)
+{
+	face.clear();
+	const uint32_t positionCount = (uint32_t)(chunk.Positions.size() / 3);
+	const uint32_t texCoordCount = (uint32_t)(chunk.TexCoords.size() / 2);
+	const uint32_t normalCount = (uint32_t)(chunk.Normals.size() / 3);
+
+	while (true)
+	{
+		p = SkipSpaces(p, end);
+		if (p == end || *p == '#')
+			break;
+
+		// v, v/vt, v//vn or v/vt/vn
+		ObjCorner& corner = face.emplace_back();
+		p = ParseIndex(p, end, positionCount, corner.Position, corner.Relative, s_RelativePosition);
+		if (p && p < end && *p == '/')
+		{
+			p++;
+			if (p < end && *p != '/')
+				p = ParseIndex(p, end, texCoordCount, corner.TexCoord, corner.Relative, s_RelativeTexCoord);
+
+			if (p && p < end && *p == '/')
+				p = ParseIndex(p + 1, end, normalCount, corner.Normal, corner.Relative, s_RelativeNormal);
+		}
+
+		if (!p || (p < end && !IsSpace(*p)))
+			return false;
+
+		chunk.MissingNormals |= corner.Normal == s_Missing;
+	}
+
+	// Points and lines have no surface, polygons are fanned from their first corner like Assimp does
+	for (size_t i = 2; i < face.size(); i++)
+		chunk.Corners.insert(chunk.Corners.end(), { face[0], face[i - 1], face[i] });
+
+	return true;
+}
+
+static bool ParseLine(ObjChunk& chunk, const char* p, const char* end, std::vector<ObjCorner>& face)
+{
+	if (end - p < 2)
+		return true;
+
+	switch (*p)
+	{
+		case 'v':
+			if (IsSpace(p[1]))
+				return ParseFloats(p + 1, end, chunk.Positions, 3, 3) != nullptr;
+			if (p[1] == 't' && IsKeyword(p, end, "vt"))
+				return ParseFloats(p + 2, end, chunk.TexCoords, 1, 2) != nullptr;
+			if (p[1] == 'n' && IsKeyword(p, end, "vn"))
+				return ParseFloats(p + 2, end, chunk.Normals, 3, 3) != nullptr;
+			return true;
+		case 'f':
+			return !IsSpace(p[1]) || ParseFace(chunk, p + 1, end, face);
+		case 'u':
+			if (IsKeyword(p, end, "usemtl"))
+				chunk.Runs.push_back({ (uint32_t)(chunk.Corners.size() / 3), Trim(p + 6, end) });
+			return true;
+		case 'm':
+			if (IsKeyword(p, end, "mtllib"))
+				chunk.Libraries.push_back(Trim(p + 6, end));
+			return true;
+		default: return true;
+	}
+}
+
+static void ParseChunk(ObjChunk& chunk)
+{
+	std::vector<ObjCorner> face;
+	const char* p = chunk.Begin;
+	while (p < chunk.End)
+	{
+		const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', (size_t)(chunk.End - p)));
+		lineEnd = lineEnd ? lineEnd : chunk.End;
+
+		if (!ParseLine(chunk, SkipSpaces(p, lineEnd), lineEnd, face))
+		{
+			chunk.Error = p;
+			return;
+		}
+
+		p = lineEnd + 1;
+	}
+}
+
+static std::vector<ObjChunk> SplitChunks(const std::string& text)
+{
+	const size_t chunkSize = std::max(ObjImporter::ChunkSize, text.size() / ObjImporter::MaxChunks + 1);
+	const char* end = text.data() + text.size();
+
+	std::vector<ObjChunk> chunks;
+	const char* begin = text.data();
+	while (begin < end)
+	{
+		const char* split = begin + std::min(chunkSize, (size_t)(end - begin));
+		const char* lineEnd = split < end ? static_cast<const char*>(std::memchr(split, '\n', (size_t)(end - split))) : nullptr;
+		split = lineEnd ? lineEnd + 1 : end;
+
+		ObjChunk& chunk = chunks.emplace_back();
+		chunk.Begin = begin;
+		chunk.End = split;
+		begin = split;
+	}
+
+	return chunks;
+}
+
+// Turns the chunk relative indices into file ones and checks that they all point at something
+static bool ResolveIndices(ObjChunk& chunk, uint32_t positionCount, uint32_t texCoordCount, uint32_t normalCount)
+{
+	auto resolve = [](int32_t& index, bool relative, uint32_t base, uint32_t count, bool required)
+	{
+		if (index == s_Missing)
+			return !required;
+
+		index += relative ? (int32_t)base : 0;
+		return index >= 0 && (uint32_t)index < count;
+	};
+
+	for (ObjCorner& corner : chunk.Corners)
+	{
+		const bool valid = resolve(corner.Position, corner.Relative & s_RelativePosition, chunk.PositionBase, positionCount, true)
+			&& resolve(corner.TexCoord, corner.Relative & s_RelativeTexCoord, chunk.TexCoordBase, texCoordCount, false)
+			&& resolve(corner.Normal, corner.Relative & s_RelativeNormal, chunk.NormalBase, normalCount, false);
+		if (!valid)
+			return false;
+
+		corner.Relative = 0;
+	}
+
+	return true;
+}
+
+static void ReadMaterialLibrary(const std::filesystem::path& path, std::unordered_map<std::string, uint32_t>& materials, std::vector<std::string>& textures)
+{
+	const std::string text = Utils::ReadFileToString(path);
+	if (text.empty())
+	{
+		std::cerr << "Could not read material library '" << path.string() << "'\n";
+		return;
+	}
+
+	uint32_t material = s_NoMaterial;
+	const char* p = text.data();
+	const char* end = text.data() + text.size();
+	while (p < end)
+	{
+		const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', (size_t)(end - p)));
+		lineEnd = lineEnd ? lineEnd : end;
+		const char* line = SkipSpaces(p, lineEnd);
+		p = lineEnd + 1;
+
+		if (IsKeyword(line, lineEnd, "newmtl"))
+		{
+			const auto [it, inserted] = materials.emplace(std::string(Trim(line + 6, lineEnd)), (uint32_t)textures.size());
+			if (inserted)
+				textures.emplace_back();
+
+			material = it->second;
+		}
+		else if (material != s_NoMaterial && IsKeyword(line, lineEnd, "map_Kd"))
+		{
+			// Paths may have spaces but options come first, the file name is whatever follows the last separator
+			std::string_view texture = Trim(line + 6, lineEnd);
+			if (texture.starts_with('-'))
+				texture = texture.substr(std::min(texture.size(), texture.find_last_of(" \t") + 1));
+
+			// The exporters wrote absolute Windows paths, only the file name is any use
+			const size_t separator = texture.find_last_of("\\/");
+			if (separator != std::string_view::npos)
+				texture = texture.substr(separator + 1);
+
+			if (!texture.empty())
+				textures[material] = std::string("./assets/textures/") + std::string(texture);
+		}
+	}
+}
+
+static glm::vec3 ReadVec3(const std::vector<float>& values, int32_t index)
+{
+	return glm::vec3(values[(size_t)index * 3], values[(size_t)index * 3 + 1], values[(size_t)index * 3 + 2]);
+}
+
+// Area weighted average of the faces around every position, the same as Assimp does without a smoothing angle
+static void GenerateSmoothNormals(const std::vector<ObjChunk>& chunks, uint32_t triangleCount, ObjAttributes& attributes)
+{
+	const uint32_t positionCount = (uint32_t)(attributes.Positions.size() / 3);
+
+	std::vector<glm::vec3> faceNormals(triangleCount);
+	ParallelFor((uint32_t)chunks.size(), 1, [&](uint32_t begin, uint32_t end)
+	{
+		for (uint32_t index = begin; index < end; index++)
+		{
+			const ObjChunk& chunk = chunks[index];
+			for (size_t i = 0; i < chunk.Corners.size(); i += 3)
+			{
+				const glm::vec3 a = ReadVec3(attributes.Positions, chunk.Corners[i].Position);
+				const glm::vec3 b = ReadVec3(attributes.Positions, chunk.Corners[i + 1].Position);
+				const glm::vec3 c = ReadVec3(attributes.Positions, chunk.Corners[i + 2].Position);
+				faceNormals[chunk.TriangleBase + i / 3] = glm::cross(b - a, c - a);
+			}
+		}
+	});
+
+	// Triangles around every position, so each one can be summed up without atomics
+	std::vector<uint32_t> offsets(positionCount + 1, 0);
+	for (const ObjChunk& chunk : chunks)
+	{
+		for (const ObjCorner& corner : chunk.Corners)
+			offsets[corner.Position + 1]++;
+	}
+
+	for (uint32_t i = 0; i < positionCount; i++)
+		offsets[i + 1] += offsets[i];
+
+	std::vector<uint32_t> triangles(offsets[positionCount]);
+	std::vector<uint32_t> cursors(offsets.begin(), offsets.end() - 1);
+	for (const ObjChunk& chunk : chunks)
+	{
+		for (size_t i = 0; i < chunk.Corners.size(); i++)
+			triangles[cursors[chunk.Corners[i].Position]++] = chunk.TriangleBase + (uint32_t)(i / 3);
+	}
+
+	attributes.SmoothNormals.resize(positionCount);
+	ParallelFor(positionCount, 4096, [&](uint32_t begin, uint32_t end)
+	{
+		for (uint32_t p = begin; p < end; p++)
+		{
+			glm::vec3 sum(0.0f);
+			for (uint32_t i = offsets[p]; i < offsets[p + 1]; i++)
+				sum += faceNormals[triangles[i]];
+
+			const float length = glm::length(sum);
+			attributes.SmoothNormals[p] = length > 0.0f ? sum / length : glm::vec3(0.0f, 1.0f, 0.0f);
+		}
+	});
+}
+
+static uint32_t HashCorner(const ObjCorner& corner)
+{
+	uint32_t hash = (uint32_t)corner.Position * 0x9E3779B1u;
+	hash ^= (uint32_t)corner.TexCoord * 0x85EBCA77u + (hash << 6) + (hash >> 2);
+	hash ^= (uint32_t)corner.Normal * 0xC2B2AE3Du + (hash << 6) + (hash >> 2);
+	return hash ^ (hash >> 15);
+}
+
+// Every distinct position/texcoord/normal triple becomes one vertex, found through an open addressing table
+static void WeldSubmesh(const std::vector<ObjTriangleRange>& ranges, const ObjAttributes& attributes, MeshFileSubmesh& submesh)
+{
+	size_t cornerCount = 0;
+	for (const ObjTriangleRange& range : ranges)
+		cornerCount += (size_t)range.Count * 3;
+
+	const size_t capacity = std::bit_ceil(std::max<size_t>(cornerCount * 2, 16));
+	const size_t mask = capacity - 1;
+	std::vector<ObjCorner> keys(capacity);
+	std::vector<uint32_t> slots(capacity, UINT32_MAX);
+
+	submesh.Indices.reserve(cornerCount);
+	submesh.Vertices.reserve(cornerCount * 8 / 2);
+	uint32_t vertexCount = 0;
+	for (const ObjTriangleRange& range : ranges)
+	{
+		const ObjCorner* corners = range.Chunk->Corners.data() + (size_t)range.First * 3;
+		for (size_t i = 0; i < (size_t)range.Count * 3; i++)
+		{
+			const ObjCorner& corner = corners[i];
+			size_t slot = HashCorner(corner) & mask;
+			while (slots[slot] != UINT32_MAX && !(keys[slot] == corner))
+				slot = (slot + 1) & mask;
+
+			if (slots[slot] == UINT32_MAX)
+			{
+				keys[slot] = corner;
+				slots[slot] = vertexCount++;
+
+				const glm::vec3 position = ReadVec3(attributes.Positions, corner.Position);
+				const glm::vec3 normal = corner.Normal != s_Missing ? ReadVec3(attributes.Normals, corner.Normal) : attributes.SmoothNormals[corner.Position];
+				submesh.Vertices.insert(submesh.Vertices.end(), { position.x, position.y, position.z });
+
+				// Flipped like aiProcess_FlipUVs, and the normals negated like ModelImporter does
+				if (corner.TexCoord != s_Missing)
+					submesh.Vertices.insert(submesh.Vertices.end(), { attributes.TexCoords[(size_t)corner.TexCoord * 2], 1.0f - attributes.TexCoords[(size_t)corner.TexCoord * 2 + 1] });
+				else
+					submesh.Vertices.insert(submesh.Vertices.end(), { 0.0f, 0.0f });
+
+				submesh.Vertices.insert(submesh.Vertices.end(), { -normal.x, -normal.y, -normal.z });
+			}
+
+			submesh.Indices.push_back(slots[slot]);
+		}
+	}
+}
+
+bool ObjImporter::Import(const std::filesystem::path& path, MeshFile& file)
+{
+	const std::string text = Utils::ReadFileToString(path);
+	if (text.empty())
+	{
+		std::cerr << "Could not read OBJ file '" << path.string() << "'\n";
+		return false;
+	}
+
+	std::vector<ObjChunk> chunks = SplitChunks(text);
+	ParallelFor((uint32_t)chunks.size(), 1, [&](uint32_t begin, uint32_t end)
+	{
+		for (uint32_t i = begin; i < end; i++)
+			ParseChunk(chunks[i]);
+	});
+
+	uint32_t positionCount = 0, texCoordCount = 0, normalCount = 0, triangleCount = 0;
+	bool missingNormals = false;
+	for (ObjChunk& chunk : chunks)
+	{
+		if (chunk.Error)
+		{
+			const size_t line = std::count(text.data(), chunk.Error, '\n') + 1;
+			std::cerr << "Malformed line " << line << " in OBJ file '" << path.string() << "'\n";
+			return false;
+		}
+
+		chunk.PositionBase = positionCount;
+		chunk.TexCoordBase = texCoordCount;
+		chunk.NormalBase = normalCount;
+		chunk.TriangleBase = triangleCount;
+		positionCount += (uint32_t)(chunk.Positions.size() / 3);
+		texCoordCount += (uint32_t)(chunk.TexCoords.size() / 2);
+		normalCount += (uint32_t)(chunk.Normals.size() / 3);
+		triangleCount += (uint32_t)(chunk.Corners.size() / 3);
+		missingNormals |= chunk.MissingNormals;
+	}
+
+	// Indices are resolved and the attributes of every chunk copied into one array each
+	ObjAttributes attributes;
+	attributes.Positions.resize((size_t)positionCount * 3);
+	attributes.TexCoords.resize((size_t)texCoordCount * 2);
+	attributes.Normals.resize((size_t)normalCount * 3);
+	std::atomic<bool> indicesValid = true;
+	ParallelFor((uint32_t)chunks.size(), 1, [&](uint32_t begin, uint32_t end)
+	{
+		for (uint32_t i = begin; i < end; i++)
+		{
+			ObjChunk& chunk = chunks[i];
+			if (!ResolveIndices(chunk, positionCount, texCoordCount, normalCount))
+				indicesValid = false;
+
+			std::copy(chunk.Positions.begin(), chunk.Positions.end(), attributes.Positions.begin() + (size_t)chunk.PositionBase * 3);
+			std::copy(chunk.TexCoords.begin(), chunk.TexCoords.end(), attributes.TexCoords.begin() + (size_t)chunk.TexCoordBase * 2);
+			std::copy(chunk.Normals.begin(), chunk.Normals.end(), attributes.Normals.begin() + (size_t)chunk.NormalBase * 3);
+		}
+	});
+
+	if (!indicesValid)
+	{
+		std::cerr << "OBJ file '" << path.string() << "' has faces that point past its vertices\n";
+		return false;
+	}
+
+	std::unordered_map<std::string, uint32_t> materials;
+	for (const ObjChunk& chunk : chunks)
+	{
+		for (const std::string_view library : chunk.Libraries)
+			ReadMaterialLibrary(path.parent_path() / library, materials, file.Textures);
+	}
+
+	// Faces before the first usemtl or with an unknown material get an untextured one, like Assimp's default
+	uint32_t defaultMaterial = s_NoMaterial;
+	auto findMaterial = [&](std::string_view name)
+	{
+		const auto it = materials.find(std::string(name));
+		if (it != materials.end())
+			return it->second;
+
+		if (defaultMaterial == s_NoMaterial)
+		{
+			defaultMaterial = (uint32_t)file.Textures.size();
+			file.Textures.emplace_back();
+		}
+
+		return defaultMaterial;
+	};
+
+	// A material stays in use across chunks until the next usemtl
+	std::vector<std::vector<ObjTriangleRange>> ranges;
+	uint32_t material = s_NoMaterial;
+	for (const ObjChunk& chunk : chunks)
+	{
+		const uint32_t chunkTriangles = (uint32_t)(chunk.Corners.size() / 3);
+		uint32_t first = 0;
+		for (size_t run = 0; run <= chunk.Runs.size(); run++)
+		{
+			const uint32_t last = run < chunk.Runs.size() ? chunk.Runs[run].FirstTriangle : chunkTriangles;
+			if (last > first)
+			{
+				material = material == s_NoMaterial ? findMaterial({}) : material;
+				ranges.resize(std::max<size_t>(ranges.size(), material + 1));
+				ranges[material].push_back({ &chunk, first, last - first });
+			}
+
+			if (run < chunk.Runs.size())
+				material = findMaterial(chunk.Runs[run].Name);
+
+			first = last;
+		}
+	}
+
+	if (missingNormals)
+		GenerateSmoothNormals(chunks, triangleCount, attributes);
+
+	std::vector<MeshFileSubmesh> submeshes(ranges.size());
+	ParallelFor((uint32_t)ranges.size(), 1, [&](uint32_t begin, uint32_t end)
+	{
+		for (uint32_t i = begin; i < end; i++)
+		{
+			submeshes[i].Material = i;
+			if (!ranges[i].empty())
+				WeldSubmesh(ranges[i], attributes, submeshes[i]);
+		}
+	});
+
+	for (MeshFileSubmesh& submesh : submeshes)
+	{
+		if (!submesh.Indices.empty())
+			file.Submeshes.push_back(std::move(submesh));
+	}
+
+	return true;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <filesystem>
+
+#include "MeshFile.h"
+
+// Native Wavefront OBJ/MTL reader. The file is split into line aligned chunks that are parsed on the
+// job system, vertices are welded per material and missing normals are generated smooth. The result
+// matches what ModelImporter gets out of Assimp: one submesh per material, flipped V and the same
+// normal convention.
+class ObjImporter
+{
+public:
+	ObjImporter() = delete;
+	~ObjImporter() = delete;
+
+	static bool Import(const std::filesystem::path& path, MeshFile& file);
+
+	// Chunks never go below this, small files are parsed by a single job
+	static constexpr size_t ChunkSize = 256 * 1024;
+	static constexpr uint32_t MaxChunks = 256;
+};
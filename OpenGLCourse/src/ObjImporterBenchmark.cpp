@@ -0,0 +1,167 @@
+#include "ObjImporterBenchmark.h"
+
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <string>
+
+#include <glm/glm.hpp>
+
+#include "JobSystem.h"
+#include "ModelImporter.h"
+#include "ObjImporter.h"
+
+static constexpr const char* s_ModelPath = "./assets/models/x-wing.obj";
+static constexpr uint32_t s_Iterations = 5;
+// Relative, the two float parsers may round the last digit differently
+static constexpr double s_Tolerance = 1e-4;
+
+// What has to match regardless of how the importers split meshes or weld vertices
+struct ObjSummary
+{
+	uint64_t Triangles = 0;
+	uint64_t Vertices = 0;
+	double Area = 0.0;
+	glm::dvec3 Normal{ 0.0 };
+	glm::dvec2 TexCoords{ 0.0 };
+};
+
+static double MeasureMs(const auto& function)
+{
+	const auto start = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < s_Iterations; i++)
+		function();
+
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / s_Iterations;
+}
+
+// By texture, the material indices of the two importers do not line up
+static std::map<std::string, ObjSummary> Summarize(const MeshFile& file, glm::vec3& boundsMin, glm::vec3& boundsMax)
+{
+	std::map<std::string, ObjSummary> summaries;
+	boundsMin = glm::vec3(INFINITY);
+	boundsMax = glm::vec3(-INFINITY);
+
+	for (const MeshFileSubmesh& submesh : file.Submeshes)
+	{
+		ObjSummary& summary = summaries[submesh.Material < file.Textures.size() ? file.Textures[submesh.Material] : std::string()];
+		summary.Triangles += submesh.Indices.size() / 3;
+		summary.Vertices += submesh.Vertices.size() / 8;
+
+		auto vertex = [&](uint32_t index) { return &submesh.Vertices[(size_t)index * 8]; };
+		for (size_t i = 0; i + 2 < submesh.Indices.size(); i += 3)
+		{
+			const float* a = vertex(submesh.Indices[i]);
+			const float* b = vertex(submesh.Indices[i + 1]);
+			const float* c = vertex(submesh.Indices[i + 2]);
+			const glm::dvec3 pa(a[0], a[1], a[2]), pb(b[0], b[1], b[2]), pc(c[0], c[1], c[2]);
+			summary.Area += glm::length(glm::cross(pb - pa, pc - pa)) * 0.5;
+
+			for (const float* v : { a, b, c })
+			{
+				summary.TexCoords += glm::dvec2(v[3], v[4]);
+				summary.Normal += glm::dvec3(v[5], v[6], v[7]);
+				boundsMin = glm::min(boundsMin, glm::vec3(v[0], v[1], v[2]));
+				boundsMax = glm::max(boundsMax, glm::vec3(v[0], v[1], v[2]));
+			}
+		}
+	}
+
+	return summaries;
+}
+
+static bool IsClose(double a, double b, double scale)
+{
+	return std::abs(a - b) <= s_Tolerance * std::max(scale, 1.0);
+}
+
+static bool Compare(const MeshFile& native, const MeshFile& assimp)
+{
+	glm::vec3 nativeMin, nativeMax, assimpMin, assimpMax;
+	const std::map<std::string, ObjSummary> nativeSummaries = Summarize(native, nativeMin, nativeMax);
+	const std::map<std::string, ObjSummary> assimpSummaries = Summarize(assimp, assimpMin, assimpMax);
+
+	bool matches = true;
+	for (int i = 0; i < 3; i++)
+	{
+		matches &= IsClose(nativeMin[i], assimpMin[i], std::abs(assimpMin[i]));
+		matches &= IsClose(nativeMax[i], assimpMax[i], std::abs(assimpMax[i]));
+	}
+
+	if (!matches)
+		std::cout << "\tBounds differ\n";
+
+	uint64_t nativeVertices = 0, assimpVertices = 0;
+	for (const auto& [texture, expected] : assimpSummaries)
+	{
+		const auto it = nativeSummaries.find(texture);
+		const ObjSummary actual = it != nativeSummaries.end() ? it->second : ObjSummary();
+		const double corners = (double)expected.Triangles * 3.0;
+		const bool same = actual.Triangles == expected.Triangles && IsClose(actual.Area, expected.Area, expected.Area)
+			&& IsClose(actual.TexCoords.x, expected.TexCoords.x, corners) && IsClose(actual.TexCoords.y, expected.TexCoords.y, corners)
+			&& glm::length(actual.Normal - expected.Normal) <= s_Tolerance * std::max(corners, 1.0);
+		if (!same)
+		{
+			std::cout << "\tMaterial '" << texture << "' differs: " << actual.Triangles << " triangles with " << actual.Area << " area, Assimp has "
+				<< expected.Triangles << " with " << expected.Area << '\n';
+			matches = false;
+		}
+
+		assimpVertices += expected.Vertices;
+	}
+
+	for (const auto& [texture, summary] : nativeSummaries)
+	{
+		nativeVertices += summary.Vertices;
+		if (!assimpSummaries.contains(texture))
+		{
+			std::cout << "\tMaterial '" << texture << "' is not in the Assimp import\n";
+			matches = false;
+		}
+	}
+
+	// Assimp welds per group and material, the native importer per material only, so it can only end up with fewer
+	std::cout << "\t" << nativeVertices << " vertices in " << native.Submeshes.size() << " submeshes, Assimp has " << assimpVertices << " in "
+		<< assimp.Submeshes.size() << '\n';
+	return matches;
+}
+
+bool RunObjImporterBenchmark()
+{
+	std::error_code error;
+	const uintmax_t size = std::filesystem::file_size(s_ModelPath, error);
+	if (error)
+	{
+		std::cerr << "OBJ importer benchmark: can't read '" << s_ModelPath << "': " << error.message() << '\n';
+		return false;
+	}
+
+	JobSystem::Init();
+
+	const double megabytes = (double)size / (1024.0 * 1024.0);
+	std::cout << "OBJ importer benchmark (" << s_ModelPath << ", " << megabytes << " MB, " << JobSystem::GetWorkerCount() << " workers)\n";
+
+	MeshFile native, assimp;
+	if (!ObjImporter::Import(s_ModelPath, native) || !ModelImporter::ImportWithAssimp(s_ModelPath, assimp))
+	{
+		std::cerr << "OBJ importer benchmark: failed to import '" << s_ModelPath << "'\n";
+		JobSystem::Shutdown();
+		return false;
+	}
+
+	const bool matches = Compare(native, assimp);
+	if (matches)
+		std::cout << "\tMatches Assimp\n";
+	else
+		std::cerr << "OBJ importer benchmark: the native import does not match Assimp\n";
+
+	const double nativeMs = MeasureMs([] { MeshFile file; ObjImporter::Import(s_ModelPath, file); });
+	const double assimpMs = MeasureMs([] { MeshFile file; ModelImporter::ImportWithAssimp(s_ModelPath, file); });
+	std::cout << "\tNative: " << nativeMs << " ms, " << megabytes / (nativeMs / 1000.0) << " MB/s\n";
+	std::cout << "\tAssimp: " << assimpMs << " ms, " << megabytes / (assimpMs / 1000.0) << " MB/s (x" << assimpMs / nativeMs << ")\n";
+
+	JobSystem::Shutdown();
+	return matches;
+}
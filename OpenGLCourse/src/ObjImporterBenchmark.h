@@ -0,0 +1,5 @@
+#pragma once
+
+// Imports x-wing.obj natively and through Assimp, checks that both agree and prints their throughput.
+// False when the model can't be read or the two imports differ.
+bool RunObjImporterBenchmark();
@@ -2,6 +2,8 @@
 
 #include <cstdint>
 
+#include "GpuResources.h"
+
 class OmniShadowMap
 {
 public:
@@ -17,7 +19,8 @@ public:
 	uint32_t GetHeight() const { return m_Height; }
 
 private:
-	uint32_t m_FramebufferId = 0, m_ShadowMapId = 0;
+	GpuFramebufferHandle m_Framebuffer;
+	GpuTextureHandle m_ShadowMap;
 	uint32_t m_Width, m_Height;
 };
 
@@ -0,0 +1,148 @@
+#include "OmniShadowPool.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "DrawListBuilder.h"
+#include "FrameArena.h"
+
+// A light is out of reach once it adds less than 1/64 of its diffuse intensity
+static constexpr float s_AttenuationCutoff = 64.0f;
+// Texels per face for every pixel the sphere of influence covers across, a face sees a quarter turn of it
+static constexpr float s_TexelsPerPixel = 0.5f;
+// A light only moves up a tier once it wants 20% more than that tier, and down once it wants 20% less than its own
+static constexpr float s_UpgradeMargin = 1.2f;
+static constexpr float s_DowngradeMargin = 0.8f;
+
+struct TierRequest
+{
+	uint32_t Light = 0;
+	float Size = 0.0f;
+	uint32_t Tier = 0;
+	uint32_t PreviousTier = 0;
+};
+
+// Distance at which the light stops mattering, the shadow far plane at most
+static float CalculateRange(const PointLight& light, float farPlane)
+{
+	// Attenuation is Exponent * d^2 + Linear * d + Constant, solved for the cutoff
+	const float c = light.Constant - light.DiffuseIntensity * s_AttenuationCutoff;
+	if (c >= 0.0f)
+		return 0.0f;
+
+	if (light.Exponent > 0.0f)
+		return std::min((-light.Linear + std::sqrt(light.Linear * light.Linear - 4.0f * light.Exponent * c)) / (2.0f * light.Exponent), farPlane);
+	if (light.Linear > 0.0f)
+		return std::min(-c / light.Linear, farPlane);
+
+	return farPlane;
+}
+
+uint32_t OmniShadowPool::AddLight()
+{
+	// Lights start small and grow into their tier over the first frames
+	m_LightTiers.push_back(OmniShadowTierCount - 1);
+	return (uint32_t)m_LightTiers.size() - 1;
+}
+
+void OmniShadowPool::CreateMaps()
+{
+	const uint32_t lightCount = (uint32_t)m_LightTiers.size();
+
+	uint32_t total = 0;
+	for (uint32_t tier = 0; tier < OmniShadowTierCount; tier++)
+	{
+		m_TierFirst[tier] = total;
+		m_TierCount[tier] = std::min(OmniShadowTiers[tier].Count, lightCount);
+		total += m_TierCount[tier];
+	}
+
+	m_Maps.reserve(total);
+	for (uint32_t tier = 0; tier < OmniShadowTierCount; tier++)
+	{
+		for (uint32_t i = 0; i < m_TierCount[tier]; i++)
+			m_Maps.emplace_back(OmniShadowTiers[tier].Size, OmniShadowTiers[tier].Size);
+	}
+}
+
+void OmniShadowPool::Assign(FramePacket& packet, std::span<const uint32_t> lights, float farPlane)
+{
+	const Frustum frustum = Frustum::FromMatrix(packet.Projection * packet.View);
+	// Size of one world unit at a distance of one, in pixels
+	const float pixelsPerUnit = packet.Projection[1][1] * 0.5f * (float)packet.ViewportHeight;
+
+	FrameVector<TierRequest> requests;
+	requests.reserve(lights.size());
+	for (uint32_t i = 0; i < (uint32_t)lights.size(); i++)
+	{
+		const PointLight& light = i < packet.PointLights.size() ? packet.PointLights[i] : packet.SpotLights[i - packet.PointLights.size()];
+		const float range = CalculateRange(light, farPlane);
+		const float distance = glm::length(light.Position - packet.EyePosition);
+
+		// Around the camera the shadows can fill the screen, out of view they cannot be seen at all
+		float size = 0.0f;
+		if (distance <= range)
+			size = (float)OmniShadowTiers[0].Size * s_UpgradeMargin;
+		else if (range > 0.0f && frustum.Intersects(glm::vec4(light.Position, range)))
+			size = 2.0f * range * pixelsPerUnit / distance * s_TexelsPerPixel;
+
+		const uint32_t previousTier = m_LightTiers[lights[i]];
+		uint32_t tier = previousTier;
+		while (tier > 0 && size >= (float)OmniShadowTiers[tier - 1].Size * s_UpgradeMargin)
+			tier--;
+		while (tier + 1 < OmniShadowTierCount && size < (float)OmniShadowTiers[tier].Size * s_DowngradeMargin)
+			tier++;
+
+		requests.push_back({ i, size, tier, previousTier });
+	}
+
+	// The lights that want the most pick first, the rest fall back to smaller tiers once one runs out.
+	// On a tie the light that already had the larger map keeps it, so equal lights do not trade maps every frame.
+	std::sort(requests.begin(), requests.end(), [](const TierRequest& a, const TierRequest& b)
+	{
+		if (a.Size != b.Size)
+			return a.Size > b.Size;
+		if (a.PreviousTier != b.PreviousTier)
+			return a.PreviousTier < b.PreviousTier;
+		return a.Light < b.Light;
+	});
+
+	uint32_t used[OmniShadowTierCount] = {};
+	packet.OmniShadowMaps.resize(lights.size());
+	for (const TierRequest& request : requests)
+	{
+		uint32_t tier = request.Tier;
+		while (tier + 1 < OmniShadowTierCount && used[tier] >= m_TierCount[tier])
+			tier++;
+
+		packet.OmniShadowMaps[request.Light] = m_TierFirst[tier] + used[tier]++;
+
+		uint32_t& lightTier = m_LightTiers[lights[request.Light]];
+		if (lightTier != tier)
+			m_Stats.TierSwitches++;
+		lightTier = tier;
+
+		const uint64_t faceSize = OmniShadowTiers[tier].Size;
+		const uint64_t largestSize = OmniShadowTiers[0].Size;
+		m_Stats.TierFrames[tier]++;
+		m_Stats.TexelsRendered += faceSize * faceSize * 6;
+		m_Stats.TexelsAtLargestTier += largestSize * largestSize * 6;
+	}
+}
+
+void OmniShadowPool::PrintReport() const
+{
+	uint64_t lightFrames = 0;
+	for (uint64_t frames : m_Stats.TierFrames)
+		lightFrames += frames;
+
+	const double texelShare = m_Stats.TexelsAtLargestTier > 0 ? 100.0 * (double)m_Stats.TexelsRendered / (double)m_Stats.TexelsAtLargestTier : 0.0;
+	std::cout << "Omni shadow maps: " << m_Maps.size() << " maps for " << m_LightTiers.size() << " lights, " << texelShare
+		<< "% of the texels of rendering every light at " << OmniShadowTiers[0].Size << ", " << m_Stats.TierSwitches << " tier switches\n";
+
+	for (uint32_t tier = 0; tier < OmniShadowTierCount; tier++)
+	{
+		const double share = lightFrames > 0 ? 100.0 * (double)m_Stats.TierFrames[tier] / (double)lightFrames : 0.0;
+		std::cout << '\t' << OmniShadowTiers[tier].Size << ": " << m_TierCount[tier] << " maps, used " << share << "% of the time\n";
+	}
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <vector>
+
+#include "FramePacket.h"
+#include "OmniShadowMap.h"
+
+struct ShadowTier
+{
+	// Per cube face
+	uint32_t Size = 0;
+	// Maps of this size, lights that do not get one fall back to the next smaller tier
+	uint32_t Count = 0;
+};
+
+// Largest first, the smallest tier has a map for every light
+inline constexpr ShadowTier OmniShadowTiers[] = { { 1024, 2 }, { 512, 4 }, { 256, 8 }, { 128, UINT32_MAX } };
+inline constexpr uint32_t OmniShadowTierCount = (uint32_t)std::size(OmniShadowTiers);
+
+struct OmniShadowPoolStats
+{
+	// Light frames spent in each tier
+	uint64_t TierFrames[OmniShadowTierCount] = {};
+	uint64_t TierSwitches = 0;
+	// Compared to every light at the largest tier
+	uint64_t TexelsRendered = 0;
+	uint64_t TexelsAtLargestTier = 0;
+};
+
+// Omni shadow maps in a few fixed resolution tiers, created once and shared by every light. Each frame
+// a light picks the tier that matches how large its sphere of influence appears on screen, with some
+// hysteresis so a light close to a threshold does not switch back and forth. Changing the size of a
+// light only changes which map it renders into, nothing is reallocated.
+class OmniShadowPool
+{
+public:
+	OmniShadowPool() = default;
+	~OmniShadowPool() = default;
+
+	// Id of the light for Assign, every light has to be added before CreateMaps
+	uint32_t AddLight();
+	// Needs the context
+	void CreateMaps();
+
+	// Simulation thread. Lights are the ids of the packet lights in their order, point lights first.
+	// Fills packet.OmniShadowMaps with the map each one renders into this frame.
+	void Assign(FramePacket& packet, std::span<const uint32_t> lights, float farPlane);
+
+	// Render thread
+	const OmniShadowMap& GetMap(uint32_t index) const { return m_Maps[index]; }
+
+	// Written by Assign
+	const OmniShadowPoolStats& GetStats() const { return m_Stats; }
+	void PrintReport() const;
+
+private:
+	std::vector<OmniShadowMap> m_Maps;
+	// First map of every tier in m_Maps and how many it has
+	uint32_t m_TierFirst[OmniShadowTierCount] = {};
+	uint32_t m_TierCount[OmniShadowTierCount] = {};
+	// Tier each light used last frame, the reference for the hysteresis
+	std::vector<uint32_t> m_LightTiers;
+
+	OmniShadowPoolStats m_Stats;
+};
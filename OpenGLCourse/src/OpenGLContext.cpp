@@ -1,23 +1,31 @@
 #include "OpenGLContext.h"
 
+#include <cstring>
 #include <iostream>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#include "GlInstrumentation.h"
+#include "Log.h"
+
 static bool s_Initialized = false;
 
 static void OpenGLMessageCallback(uint32_t source, uint32_t type, uint32_t id, uint32_t severity, int32_t length, const char* message, const void* userParam)
 {
+	// Called on a driver thread once debug output is asynchronous, the message is copied before returning
+	const std::string_view text(message, length >= 0 ? (size_t)length : strlen(message));
 	switch (severity)
 	{
 		case GL_DEBUG_SEVERITY_HIGH:
+			Log::Error("{}", text);
+			return;
 		case GL_DEBUG_SEVERITY_MEDIUM:
-			std::cerr << message << '\n';
+			Log::Warning("{}", text);
 			return;
 		case GL_DEBUG_SEVERITY_LOW:
 		case GL_DEBUG_SEVERITY_NOTIFICATION:
-			std::cout << message << '\n';
+			Log::Info("{}", text);
 			return;
 	}
 }
@@ -39,6 +47,8 @@ bool OpenGLContext::Init(GLFWwindow* window)
 		return false;
 	}
 
+	GlInstrumentation::Install();
+
 	std::cout << "OpenGL Info:\n";
 	std::cout << "\tVendor: " << glGetString(GL_VENDOR) << "\n";
 	std::cout << "\tRenderer: " << glGetString(GL_RENDERER) << "\n";
@@ -47,7 +57,11 @@ bool OpenGLContext::Init(GLFWwindow* window)
 	glEnable(GL_DEPTH_TEST);
 
 	glEnable(GL_DEBUG_OUTPUT);
+#ifdef APP_DEBUG
+	// Messages arrive on the thread and inside the call that caused them, so a breakpoint in the callback
+	// shows the culprit. Elsewhere the driver may report them later, without stalling the pipeline.
 	glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+#endif
 	glDebugMessageCallback(OpenGLMessageCallback, nullptr);
 	glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE);
 
@@ -55,6 +69,11 @@ bool OpenGLContext::Init(GLFWwindow* window)
 	return true;
 }
 
+void OpenGLContext::SetDebugNotifications(bool enabled)
+{
+	glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, enabled ? GL_TRUE : GL_FALSE);
+}
+
 void OpenGLContext::SetClearColor(const glm::vec4& color)
 {
 	glClearColor(color.r, color.g, color.b, color.a);
@@ -74,3 +93,8 @@ void OpenGLContext::SetViewport(uint32_t width, uint32_t height)
 {
 	glViewport(0, 0, (int)width, (int)height);
 }
+
+void OpenGLContext::SetDepthLessEqual(bool enabled)
+{
+	glDepthFunc(enabled ? GL_LEQUAL : GL_LESS);
+}
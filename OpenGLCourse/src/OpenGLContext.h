@@ -8,8 +8,12 @@ class OpenGLContext
 {
 public:
 	static bool Init(GLFWwindow* window);
+	// Driver notifications are off by default, they can come every frame
+	static void SetDebugNotifications(bool enabled);
 	static void SetClearColor(const glm::vec4& color);
 	static void Clear();
 	static void ClearDepthOnly();
 	static void SetViewport(uint32_t width, uint32_t height);
+	// Lets fragments at exactly the stored depth pass, for drawing over a depth prepass
+	static void SetDepthLessEqual(bool enabled);
 };
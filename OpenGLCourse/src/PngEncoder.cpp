@@ -0,0 +1,127 @@
+#include "PngEncoder.h"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <iostream>
+
+// Largest stored deflate block
+static constexpr size_t s_MaxBlockSize = 65535;
+// Bytes the Adler-32 sums can take before they have to be reduced, the NMAX of zlib
+static constexpr size_t s_AdlerRun = 5552;
+
+static const std::array<uint32_t, 256> s_CrcTable = []()
+{
+	std::array<uint32_t, 256> table = {};
+	for (uint32_t i = 0; i < 256; i++)
+	{
+		uint32_t crc = i;
+		for (uint32_t bit = 0; bit < 8; bit++)
+			crc = crc & 1 ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+		table[i] = crc;
+	}
+	return table;
+}();
+
+static uint32_t UpdateCrc(uint32_t crc, const uint8_t* data, size_t size)
+{
+	for (size_t i = 0; i < size; i++)
+		crc = s_CrcTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	return crc;
+}
+
+static uint32_t Adler32(const uint8_t* data, size_t size)
+{
+	uint32_t a = 1, b = 0;
+	while (size > 0)
+	{
+		const size_t run = std::min(size, s_AdlerRun);
+		for (size_t i = 0; i < run; i++)
+		{
+			a += data[i];
+			b += a;
+		}
+
+		a %= 65521;
+		b %= 65521;
+		data += run;
+		size -= run;
+	}
+
+	return (b << 16) | a;
+}
+
+static void WriteBigEndian(std::vector<uint8_t>& out, uint32_t value)
+{
+	out.insert(out.end(), { (uint8_t)(value >> 24), (uint8_t)(value >> 16), (uint8_t)(value >> 8), (uint8_t)value });
+}
+
+// Length, type, data and the CRC of type and data
+static void WriteChunk(std::vector<uint8_t>& out, const char* type, const uint8_t* data, size_t size)
+{
+	WriteBigEndian(out, (uint32_t)size);
+	const size_t start = out.size();
+	out.insert(out.end(), type, type + 4);
+	out.insert(out.end(), data, data + size);
+	WriteBigEndian(out, UpdateCrc(0xFFFFFFFFu, out.data() + start, out.size() - start) ^ 0xFFFFFFFFu);
+}
+
+std::vector<uint8_t> PngEncoder::Encode(const uint8_t* rgba, uint32_t width, uint32_t height, size_t stride)
+{
+	// Every row starts with its filter type, 0 for none
+	const size_t rowSize = 1 + (size_t)width * 3;
+	std::vector<uint8_t> raw(rowSize * height);
+	for (uint32_t y = 0; y < height; y++)
+	{
+		const uint8_t* source = rgba + y * stride;
+		uint8_t* row = &raw[y * rowSize];
+		row[0] = 0;
+		for (uint32_t x = 0; x < width; x++)
+		{
+			row[1 + x * 3] = source[x * 4];
+			row[2 + x * 3] = source[x * 4 + 1];
+			row[3 + x * 3] = source[x * 4 + 2];
+		}
+	}
+
+	// zlib header for deflate with a 32K window and no preset dictionary
+	std::vector<uint8_t> zlib = { 0x78, 0x01 };
+	zlib.reserve(raw.size() + raw.size() / s_MaxBlockSize * 5 + 16);
+	for (size_t offset = 0;; offset += s_MaxBlockSize)
+	{
+		const size_t size = std::min(raw.size() - offset, s_MaxBlockSize);
+		const bool last = offset + size == raw.size();
+		zlib.insert(zlib.end(), { (uint8_t)(last ? 1 : 0), (uint8_t)size, (uint8_t)(size >> 8), (uint8_t)~size, (uint8_t)(~size >> 8) });
+		zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + size);
+		if (last)
+			break;
+	}
+	WriteBigEndian(zlib, Adler32(raw.data(), raw.size()));
+
+	std::vector<uint8_t> png = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	png.reserve(zlib.size() + 64);
+
+	// Width, height, 8 bits, truecolor, deflate, adaptive filtering, not interlaced
+	std::vector<uint8_t> header;
+	WriteBigEndian(header, width);
+	WriteBigEndian(header, height);
+	header.insert(header.end(), { 8, 2, 0, 0, 0 });
+
+	WriteChunk(png, "IHDR", header.data(), header.size());
+	WriteChunk(png, "IDAT", zlib.data(), zlib.size());
+	WriteChunk(png, "IEND", nullptr, 0);
+	return png;
+}
+
+bool PngEncoder::Write(const std::filesystem::path& path, const uint8_t* rgba, uint32_t width, uint32_t height, size_t stride)
+{
+	const std::vector<uint8_t> png = Encode(rgba, width, height, stride);
+	std::ofstream out(path, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!out.write(reinterpret_cast<const char*>(png.data()), (std::streamsize)png.size()))
+	{
+		std::cerr << "Could not write image '" << path.string() << "'\n";
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+// Writes 8 bit RGB PNGs from RGBA pixels, alpha is dropped. The deflate stream only has stored
+// blocks: files are as large as the pixels, but encoding is a copy and a checksum, fast enough to
+// keep up with frame captures.
+class PngEncoder
+{
+public:
+	PngEncoder() = delete;
+	~PngEncoder() = delete;
+
+	// Rows top to bottom, stride is the distance between rows in bytes
+	static std::vector<uint8_t> Encode(const uint8_t* rgba, uint32_t width, uint32_t height, size_t stride);
+	static bool Write(const std::filesystem::path& path, const uint8_t* rgba, uint32_t width, uint32_t height, size_t stride);
+};
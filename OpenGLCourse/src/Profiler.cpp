@@ -0,0 +1,310 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+#include <glad/glad.h>
+
+// Thread 0 stands for the GPU in the trace
+static constexpr uint32_t s_GpuThread = 0;
+static constexpr uint32_t s_MaxThreads = 64;
+
+struct ProfileEvent
+{
+	const char* Name = nullptr;
+	int32_t Index = -1;
+	uint32_t Thread = 0;
+	int64_t StartNs = 0;
+	int64_t EndNs = 0;
+};
+
+struct ScopeStats
+{
+	const char* Name = nullptr;
+	int32_t Index = -1;
+	bool Gpu = false;
+	// Ring of the latest durations
+	float SamplesMs[Profiler::StatsWindow] = {};
+	uint64_t Count = 0;
+};
+
+struct GpuFrame
+{
+	// Start and end timestamp of every scope
+	uint32_t Queries[Profiler::MaxGpuScopesPerFrame * 2] = {};
+	const char* Names[Profiler::MaxGpuScopesPerFrame] = {};
+	int32_t Indices[Profiler::MaxGpuScopesPerFrame] = {};
+	uint32_t Count = 0;
+	// Scopes can end in any order, GL finishes queries in the order they were issued
+	uint32_t LastQuery = 0;
+	bool Pending = false;
+};
+
+static std::mutex s_Mutex;
+static std::vector<ProfileEvent> s_Events;
+static uint64_t s_EventCount = 0;
+static ScopeStats s_Stats[Profiler::MaxScopes];
+static uint32_t s_StatsCount = 0;
+static uint64_t s_DroppedScopes = 0;
+
+static const char* s_ThreadNames[s_MaxThreads] = { "GPU" };
+static std::atomic<uint32_t> s_NextThread = 1;
+static int64_t s_StartNs = 0;
+
+static GpuFrame s_GpuFrames[Profiler::GpuFrameLatency];
+static GpuFrame* s_CurrentGpuFrame = nullptr;
+static bool s_GpuReady = false;
+// Added to GPU timestamps to move them onto the CPU clock
+static int64_t s_GpuOffsetNs = 0;
+static uint64_t s_SkippedGpuFrames = 0;
+
+static uint32_t GetThreadIndex()
+{
+	thread_local const uint32_t index = std::min(s_NextThread.fetch_add(1, std::memory_order_relaxed), s_MaxThreads - 1);
+	return index;
+}
+
+// Callers hold s_Mutex
+static void Record(const char* name, int32_t index, uint32_t thread, int64_t startNs, int64_t endNs)
+{
+	if (s_Events.empty())
+		return;
+
+	s_Events[s_EventCount++ % s_Events.size()] = { name, index, thread, startNs, endNs };
+
+	const bool gpu = thread == s_GpuThread;
+	ScopeStats* stats = nullptr;
+	for (uint32_t i = 0; i < s_StatsCount && !stats; i++)
+	{
+		ScopeStats& candidate = s_Stats[i];
+		if (candidate.Index == index && candidate.Gpu == gpu && (candidate.Name == name || strcmp(candidate.Name, name) == 0))
+			stats = &candidate;
+	}
+
+	if (!stats)
+	{
+		if (s_StatsCount == Profiler::MaxScopes)
+		{
+			s_DroppedScopes++;
+			return;
+		}
+
+		stats = &s_Stats[s_StatsCount++];
+		stats->Name = name;
+		stats->Index = index;
+		stats->Gpu = gpu;
+	}
+
+	stats->SamplesMs[stats->Count++ % Profiler::StatsWindow] = (float)((double)(endNs - startNs) / 1e6);
+}
+
+static void CollectGpuFrame(GpuFrame& frame)
+{
+	std::scoped_lock lock(s_Mutex);
+	for (uint32_t i = 0; i < frame.Count; i++)
+	{
+		uint64_t start = 0, end = 0;
+		glGetQueryObjectui64v(frame.Queries[i * 2], GL_QUERY_RESULT, &start);
+		glGetQueryObjectui64v(frame.Queries[i * 2 + 1], GL_QUERY_RESULT, &end);
+		Record(frame.Names[i], frame.Indices[i], s_GpuThread, (int64_t)start + s_GpuOffsetNs, (int64_t)end + s_GpuOffsetNs);
+	}
+
+	frame.Count = 0;
+	frame.Pending = false;
+}
+
+void Profiler::Init()
+{
+	s_Events.resize(MaxEvents);
+	s_StartNs = Now();
+}
+
+void Profiler::InitGpu()
+{
+	for (GpuFrame& frame : s_GpuFrames)
+		glCreateQueries(GL_TIMESTAMP, MaxGpuScopesPerFrame * 2, frame.Queries);
+
+	// One sync point at startup, later timestamps are only read back once they are ready
+	int64_t gpuNow = 0;
+	glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+	s_GpuOffsetNs = Now() - gpuNow;
+	s_GpuReady = true;
+}
+
+void Profiler::Shutdown()
+{
+	if (s_GpuReady)
+	{
+		for (GpuFrame& frame : s_GpuFrames)
+		{
+			glDeleteQueries(MaxGpuScopesPerFrame * 2, frame.Queries);
+			frame = GpuFrame();
+		}
+	}
+
+	s_GpuReady = false;
+	s_CurrentGpuFrame = nullptr;
+}
+
+void Profiler::SetThreadName(const char* name)
+{
+	s_ThreadNames[GetThreadIndex()] = name;
+}
+
+void Profiler::BeginFrame(uint64_t frameIndex)
+{
+	if (!s_GpuReady)
+		return;
+
+	// Oldest first, the first frame still running ends the search
+	for (uint32_t i = 0; i < GpuFrameLatency; i++)
+	{
+		GpuFrame& frame = s_GpuFrames[(frameIndex + i) % GpuFrameLatency];
+		if (!frame.Pending)
+			continue;
+
+		int32_t available = 0;
+		glGetQueryObjectiv(frame.LastQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available)
+			break;
+
+		CollectGpuFrame(frame);
+	}
+
+	// The GPU is more than GpuFrameLatency frames behind, this frame goes untimed rather than waiting
+	GpuFrame& frame = s_GpuFrames[frameIndex % GpuFrameLatency];
+	s_CurrentGpuFrame = frame.Pending ? nullptr : &frame;
+	if (frame.Pending)
+		s_SkippedGpuFrames++;
+}
+
+void Profiler::EndFrame()
+{
+	if (s_CurrentGpuFrame && s_CurrentGpuFrame->Count > 0)
+		s_CurrentGpuFrame->Pending = true;
+	s_CurrentGpuFrame = nullptr;
+}
+
+void Profiler::RecordCpu(const char* name, int32_t index, int64_t startNs, int64_t endNs)
+{
+	const uint32_t thread = GetThreadIndex();
+	std::scoped_lock lock(s_Mutex);
+	Record(name, index, thread, startNs, endNs);
+}
+
+uint32_t Profiler::BeginGpu(const char* name, int32_t index)
+{
+	GpuFrame* frame = s_CurrentGpuFrame;
+	if (!frame || frame->Count == MaxGpuScopesPerFrame)
+		return InvalidGpuScope;
+
+	const uint32_t scope = frame->Count++;
+	frame->Names[scope] = name;
+	frame->Indices[scope] = index;
+	frame->LastQuery = frame->Queries[scope * 2];
+	glQueryCounter(frame->LastQuery, GL_TIMESTAMP);
+	return scope;
+}
+
+void Profiler::EndGpu(uint32_t scope)
+{
+	GpuFrame* frame = s_CurrentGpuFrame;
+	if (!frame || scope == InvalidGpuScope)
+		return;
+
+	frame->LastQuery = frame->Queries[scope * 2 + 1];
+	glQueryCounter(frame->LastQuery, GL_TIMESTAMP);
+}
+
+int64_t Profiler::Now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void WriteName(FILE* file, const char* name, int32_t index)
+{
+	for (const char* c = name; *c; c++)
+	{
+		if (*c == '"' || *c == '\\')
+			fputc('\\', file);
+		fputc(*c, file);
+	}
+
+	if (index >= 0)
+		fprintf(file, " %d", index);
+}
+
+bool Profiler::WriteChromeTrace(const std::filesystem::path& path)
+{
+	FILE* file = fopen(path.string().c_str(), "w");
+	if (!file)
+	{
+		std::cerr << "Failed to write trace: '" << path.string() << "'\n";
+		return false;
+	}
+
+	std::scoped_lock lock(s_Mutex);
+	fprintf(file, "{\"traceEvents\":[\n");
+
+	const uint32_t threads = std::min(s_NextThread.load(), s_MaxThreads);
+	for (uint32_t thread = 0; thread < threads; thread++)
+	{
+		fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"", thread);
+		WriteName(file, s_ThreadNames[thread] ? s_ThreadNames[thread] : "Thread", s_ThreadNames[thread] ? -1 : (int32_t)thread);
+		fprintf(file, "\"}},\n");
+	}
+
+	// Oldest first, once the ring wrapped that is the slot written next
+	const uint64_t count = std::min<uint64_t>(s_EventCount, s_Events.size());
+	for (uint64_t i = 0; i < count; i++)
+	{
+		const ProfileEvent& event = s_Events[(s_EventCount - count + i) % s_Events.size()];
+		fprintf(file, "{\"name\":\"");
+		WriteName(file, event.Name, event.Index);
+		fprintf(file, "\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}%s\n", event.Thread == s_GpuThread ? "gpu" : "cpu",
+			(double)(event.StartNs - s_StartNs) / 1e3, (double)(event.EndNs - event.StartNs) / 1e3, event.Thread, i + 1 < count ? "," : "");
+	}
+
+	fprintf(file, "]}\n");
+	const bool written = ferror(file) == 0;
+	fclose(file);
+
+	std::cout << "Wrote " << count << " profiler events to '" << path.string() << "'\n";
+	return written;
+}
+
+void Profiler::PrintReport()
+{
+	std::scoped_lock lock(s_Mutex);
+	std::cout << "Profiler, over the last " << StatsWindow << " samples of every scope:\n";
+
+	for (uint32_t i = 0; i < s_StatsCount; i++)
+	{
+		const ScopeStats& stats = s_Stats[i];
+		const uint32_t samples = (uint32_t)std::min<uint64_t>(stats.Count, StatsWindow);
+
+		double total = 0.0;
+		float max = 0.0f;
+		for (uint32_t sample = 0; sample < samples; sample++)
+		{
+			total += stats.SamplesMs[sample];
+			max = std::max(max, stats.SamplesMs[sample]);
+		}
+
+		std::cout << '\t' << (stats.Gpu ? "GPU " : "CPU ") << stats.Name;
+		if (stats.Index >= 0)
+			std::cout << ' ' << stats.Index;
+		std::cout << ": " << total / (double)std::max(samples, 1u) << " ms average, " << max << " ms max, " << stats.Count << " samples in total\n";
+	}
+
+	if (s_SkippedGpuFrames > 0)
+		std::cout << '\t' << s_SkippedGpuFrames << " frames not timed on the GPU, it was " << GpuFrameLatency << " frames behind\n";
+	if (s_DroppedScopes > 0)
+		std::cout << '\t' << s_DroppedScopes << " samples dropped, more than " << MaxScopes << " different scopes\n";
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+#include "GlInstrumentation.h"
+
+// CPU scopes from any thread and GPU scopes from the render thread, kept as rolling statistics per scope
+// and as a ring of the latest events that can be written out as a Chrome trace (chrome://tracing or
+// Perfetto). GPU scopes are GL_TIMESTAMP queries, each frame has its own set of them and reads them
+// back a few frames later once they are available, so nothing ever waits on the GPU.
+class Profiler
+{
+public:
+	Profiler() = delete;
+	~Profiler() = delete;
+
+	// Before any scope, InitGpu needs the context and is needed by GPU scopes only
+	static void Init();
+	static void InitGpu();
+	// Needs the context when InitGpu ran
+	static void Shutdown();
+
+	// Shown in the trace for every event of the calling thread, has to outlive the profiler
+	static void SetThreadName(const char* name);
+
+	// Render thread, around every GPU scope of a frame. Collects whatever earlier frames have ready.
+	static void BeginFrame(uint64_t frameIndex);
+	static void EndFrame();
+
+	// Names have to outlive the profiler, string literals in practice. The index tells scopes with the
+	// same name apart, like one per light, -1 for none.
+	static void RecordCpu(const char* name, int32_t index, int64_t startNs, int64_t endNs);
+	static uint32_t BeginGpu(const char* name, int32_t index);
+	static void EndGpu(uint32_t scope);
+
+	// Nanoseconds on the clock every event uses
+	static int64_t Now();
+
+	static bool WriteChromeTrace(const std::filesystem::path& path);
+	static void PrintReport();
+
+	// Frames a GPU scope has to finish in before its frame is skipped
+	static constexpr uint32_t GpuFrameLatency = 4;
+	static constexpr uint32_t MaxGpuScopesPerFrame = 64;
+	// Latest events kept for the trace
+	static constexpr uint32_t MaxEvents = 1 << 18;
+	static constexpr uint32_t MaxScopes = 128;
+	// Samples the statistics of a scope are taken over
+	static constexpr uint32_t StatsWindow = 120;
+	static constexpr uint32_t InvalidGpuScope = UINT32_MAX;
+};
+
+// Times its lifetime on the CPU
+class ProfileScope
+{
+public:
+	ProfileScope(const char* name, int32_t index = -1)
+		: m_Name(name), m_Index(index), m_Start(Profiler::Now())
+	{
+	}
+
+	ProfileScope(const ProfileScope&) = delete;
+
+	~ProfileScope()
+	{
+		Profiler::RecordCpu(m_Name, m_Index, m_Start, Profiler::Now());
+	}
+
+private:
+	const char* m_Name;
+	int32_t m_Index;
+	int64_t m_Start;
+};
+
+// Render thread. Times the GL commands issued during its lifetime on the GPU, and issuing them on the CPU.
+// Also the pass GlInstrumentation counts those commands for.
+class GpuProfileScope
+{
+public:
+	GpuProfileScope(const char* name, int32_t index = -1)
+		: m_Cpu(name, index), m_Scope(Profiler::BeginGpu(name, index))
+	{
+		GlInstrumentation::PushPass(name, index);
+	}
+
+	GpuProfileScope(const GpuProfileScope&) = delete;
+
+	~GpuProfileScope()
+	{
+		GlInstrumentation::PopPass();
+		Profiler::EndGpu(m_Scope);
+	}
+
+private:
+	ProfileScope m_Cpu;
+	uint32_t m_Scope;
+};
@@ -0,0 +1,142 @@
+#include "RenderQueue.h"
+
+#include "Mesh.h"
+#include "Shader.h"
+
+static constexpr const char* s_TransformIndexUniform = "u_TransformIndex";
+static constexpr const char* s_FaceMaskUniform = "u_FaceMask";
+static constexpr const char* s_DrawDataUniform = "u_DrawData";
+
+void RenderQueue::Begin(RenderPassType pass, const glm::vec3& viewPosition, float farPlane)
+{
+	m_Pass = pass;
+	m_ViewPosition = viewPosition;
+	m_FarPlane = farPlane;
+	m_Packets.clear();
+}
+
+void RenderQueue::Submit(const Shader& shader, const Mesh& mesh, TextureSlot texture, uint8_t materialId, uint32_t transformIndex, const glm::vec3& position, uint8_t faceMask)
+{
+	const float depth = glm::length(position - m_ViewPosition) / m_FarPlane;
+
+	// Keeps depth only draws of the same mesh together no matter what they would sample
+	if (m_Pass != RenderPassType::Main)
+	{
+		texture = TextureSlot();
+		materialId = 0;
+	}
+
+	DrawPacket& packet = m_Packets.emplace_back();
+	packet.SortKey = BuildSortKey(m_Pass, shader.GetId(), materialId, texture, mesh.GetVertexArrayId(), depth);
+	packet.Shader = &shader;
+	packet.Mesh = &mesh;
+	packet.DrawData = glm::ivec4(materialId, texture.IsValid() ? texture.Array : 0, texture.Layer, TextureArrayManager::GetResidentLevel(texture));
+	packet.TransformIndex = transformIndex;
+	packet.FaceMask = faceMask;
+}
+
+void RenderQueue::Flush()
+{
+	const size_t count = m_Packets.size();
+	m_Keys.resize(count);
+	m_Indices.resize(count);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		m_Keys[i] = m_Packets[i].SortKey;
+		m_Indices[i] = (uint32_t)i;
+	}
+
+	RadixSort(m_Keys, m_Indices, m_ScratchKeys, m_ScratchIndices);
+
+	// Uniforms are program state, so the draw data only has to be uploaded when it changes
+	const ::Shader* lastShader = nullptr;
+	glm::ivec4 lastDrawData(-1);
+
+	// Packets are sorted by shader, so the per draw locations are looked up once per shader
+	const ::Shader* locationShader = nullptr;
+	int32_t transformIndexLocation = -1;
+	int32_t faceMaskLocation = -1;
+	int32_t drawDataLocation = -1;
+
+	for (const uint32_t index : m_Indices)
+	{
+		const DrawPacket& packet = m_Packets[index];
+
+		if (packet.Shader != locationShader)
+		{
+			locationShader = packet.Shader;
+			transformIndexLocation = packet.Shader->GetUniformLocation(s_TransformIndexUniform);
+			faceMaskLocation = packet.Shader->GetUniformLocation(s_FaceMaskUniform);
+			drawDataLocation = packet.Shader->GetUniformLocation(s_DrawDataUniform);
+		}
+
+		packet.Shader->Bind();
+		packet.Shader->UploadUniformInt(transformIndexLocation, (int)packet.TransformIndex);
+
+		if (m_Pass == RenderPassType::OmniShadow)
+			packet.Shader->UploadUniformInt(faceMaskLocation, packet.FaceMask);
+
+		if (m_Pass == RenderPassType::Main && (packet.Shader != lastShader || packet.DrawData != lastDrawData))
+		{
+			packet.Shader->UploadUniformInt4(drawDataLocation, packet.DrawData);
+			lastShader = packet.Shader;
+			lastDrawData = packet.DrawData;
+		}
+
+		packet.Mesh->RenderMesh();
+	}
+
+	m_Packets.clear();
+}
+
+uint64_t RenderQueue::BuildSortKey(RenderPassType pass, uint32_t shaderId, uint8_t materialId, TextureSlot texture, uint32_t meshId, float depth)
+{
+	// Ids wider than their field only lose grouping, never correctness
+	const uint64_t quantizedDepth = (uint64_t)(glm::clamp(depth, 0.0f, 1.0f) * 65535.0f);
+
+	return ((uint64_t)pass & 0xF) << 60
+		| ((uint64_t)shaderId & 0xFF) << 52
+		| ((uint64_t)materialId) << 44
+		| ((uint64_t)texture.Array & 0xF) << 40
+		| ((uint64_t)texture.Layer & 0xFF) << 32
+		| ((uint64_t)meshId & 0xFFFF) << 16
+		| quantizedDepth;
+}
+
+void RenderQueue::RadixSort(std::vector<uint64_t>& keys, std::vector<uint32_t>& indices, std::vector<uint64_t>& scratchKeys, std::vector<uint32_t>& scratchIndices)
+{
+	const size_t count = keys.size();
+	scratchKeys.resize(count);
+	scratchIndices.resize(count);
+
+	// LSD radix sort, one byte per pass
+	for (uint32_t shift = 0; shift < 64; shift += 8)
+	{
+		size_t histogram[256] = { 0 };
+		for (const uint64_t key : keys)
+			histogram[(key >> shift) & 0xFF]++;
+
+		// Every key has the same byte here so this pass would not move anything
+		if (histogram[(keys.empty() ? 0 : keys[0] >> shift) & 0xFF] == count)
+			continue;
+
+		size_t offset = 0;
+		for (size_t& bucket : histogram)
+		{
+			const size_t bucketCount = bucket;
+			bucket = offset;
+			offset += bucketCount;
+		}
+
+		for (size_t i = 0; i < count; i++)
+		{
+			const size_t destination = histogram[(keys[i] >> shift) & 0xFF]++;
+			scratchKeys[destination] = keys[i];
+			scratchIndices[destination] = indices[i];
+		}
+
+		keys.swap(scratchKeys);
+		indices.swap(scratchIndices);
+	}
+}
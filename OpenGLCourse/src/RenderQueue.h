@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "TextureArrayManager.h"
+
+class Mesh;
+class Shader;
+
+enum class RenderPassType : uint8_t
+{
+	DirectionalShadow = 0,
+	OmniShadow = 1,
+	DepthPrepass = 2,
+	Main = 3
+};
+
+struct DrawPacket
+{
+	uint64_t SortKey = 0;
+	const ::Shader* Shader = nullptr;
+	const ::Mesh* Mesh = nullptr;
+	// Material index, texture array, layer and finest resident level, only used by the main pass
+	glm::ivec4 DrawData{ 0 };
+	uint32_t TransformIndex = 0;
+	uint8_t FaceMask = 0;
+};
+
+// Records the draws of a pass, orders them by state and submits them through the RenderStateCache.
+// Key layout from the most significant bit:
+// pass (4) | shader (8) | material (8) | texture array (4) | layer (8) | mesh (16) | depth (16)
+// Textures and materials are indexed from per draw data, so only the shader and mesh cause binds.
+class RenderQueue
+{
+public:
+	RenderQueue() = default;
+	~RenderQueue() = default;
+
+	void Begin(RenderPassType pass, const glm::vec3& viewPosition, float farPlane);
+	static constexpr uint8_t AllFaces = 0x3F;
+
+	// faceMask selects the cube faces an omni shadow draw is rendered to, other passes ignore it.
+	// Depth only passes ignore the texture and material.
+	// The transform index selects the world matrix in the transform buffer, position is only used for depth
+	void Submit(const Shader& shader, const Mesh& mesh, TextureSlot texture, uint8_t materialId, uint32_t transformIndex, const glm::vec3& position, uint8_t faceMask = AllFaces);
+	void Flush();
+
+	size_t GetPacketCount() const { return m_Packets.size(); }
+
+	static uint64_t BuildSortKey(RenderPassType pass, uint32_t shaderId, uint8_t materialId, TextureSlot texture, uint32_t meshId, float depth);
+	static void RadixSort(std::vector<uint64_t>& keys, std::vector<uint32_t>& indices, std::vector<uint64_t>& scratchKeys, std::vector<uint32_t>& scratchIndices);
+
+private:
+	RenderPassType m_Pass = RenderPassType::Main;
+	glm::vec3 m_ViewPosition{ 0.0f };
+	float m_FarPlane = 1.0f;
+
+	std::vector<DrawPacket> m_Packets;
+
+	// Kept around between frames so steady state flushing does not allocate
+	std::vector<uint64_t> m_Keys, m_ScratchKeys;
+	std::vector<uint32_t> m_Indices, m_ScratchIndices;
+};
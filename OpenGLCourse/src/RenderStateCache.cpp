@@ -0,0 +1,68 @@
+#include "RenderStateCache.h"
+
+#include <glad/glad.h>
+
+static constexpr uint32_t s_Unknown = UINT32_MAX;
+
+static uint32_t s_Program = s_Unknown;
+static uint32_t s_VertexArray = s_Unknown;
+static uint32_t s_Framebuffer = s_Unknown;
+static uint32_t s_Textures[RenderStateCache::MaxTextureUnits] = {
+	s_Unknown, s_Unknown, s_Unknown, s_Unknown, s_Unknown, s_Unknown, s_Unknown, s_Unknown,
+	s_Unknown, s_Unknown, s_Unknown, s_Unknown, s_Unknown, s_Unknown, s_Unknown, s_Unknown,
+	s_Unknown, s_Unknown, s_Unknown, s_Unknown, s_Unknown, s_Unknown, s_Unknown, s_Unknown,
+	s_Unknown, s_Unknown, s_Unknown, s_Unknown, s_Unknown, s_Unknown, s_Unknown, s_Unknown,
+};
+
+static bool UpdateCached(uint32_t& cached, uint32_t value, RenderStats& stats)
+{
+	if (cached == value)
+	{
+		stats.StateChangesSkipped++;
+		return false;
+	}
+
+	cached = value;
+	stats.StateChangesIssued++;
+	return true;
+}
+
+void RenderStateCache::UseProgram(uint32_t programId)
+{
+	if (UpdateCached(s_Program, programId, s_Stats))
+		glUseProgram(programId);
+}
+
+void RenderStateCache::BindVertexArray(uint32_t vertexArrayId)
+{
+	if (UpdateCached(s_VertexArray, vertexArrayId, s_Stats))
+		glBindVertexArray(vertexArrayId);
+}
+
+void RenderStateCache::BindTexture(uint32_t unit, uint32_t textureId)
+{
+	if (unit >= MaxTextureUnits)
+	{
+		glBindTextureUnit(unit, textureId);
+		s_Stats.StateChangesIssued++;
+		return;
+	}
+
+	if (UpdateCached(s_Textures[unit], textureId, s_Stats))
+		glBindTextureUnit(unit, textureId);
+}
+
+void RenderStateCache::BindFramebuffer(uint32_t framebufferId)
+{
+	if (UpdateCached(s_Framebuffer, framebufferId, s_Stats))
+		glBindFramebuffer(GL_FRAMEBUFFER, framebufferId);
+}
+
+void RenderStateCache::Invalidate()
+{
+	s_Program = s_Unknown;
+	s_VertexArray = s_Unknown;
+	s_Framebuffer = s_Unknown;
+	for (auto& texture : s_Textures)
+		texture = s_Unknown;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+
+struct RenderStats
+{
+	uint64_t StateChangesIssued = 0;
+	uint64_t StateChangesSkipped = 0;
+	uint64_t DrawCalls = 0;
+};
+
+// Shadows the GL binding state so redundant binds never reach the driver.
+// Every bind in the renderer has to go through here, otherwise the cache goes stale.
+class RenderStateCache
+{
+public:
+	RenderStateCache() = delete;
+	~RenderStateCache() = delete;
+
+	static void UseProgram(uint32_t programId);
+	static void BindVertexArray(uint32_t vertexArrayId);
+	static void BindTexture(uint32_t unit, uint32_t textureId);
+	static void BindFramebuffer(uint32_t framebufferId);
+
+	static void RecordDrawCall() { s_Stats.DrawCalls++; }
+
+	// Forgets everything that is cached, used after code that touches GL state directly.
+	static void Invalidate();
+
+	static const RenderStats& GetStats() { return s_Stats; }
+	static void ResetStats() { s_Stats = RenderStats(); }
+
+	static constexpr uint32_t MaxTextureUnits = 32;
+
+private:
+	inline static RenderStats s_Stats;
+};
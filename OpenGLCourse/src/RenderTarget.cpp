@@ -0,0 +1,101 @@
+#include "RenderTarget.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <glad/glad.h>
+
+#include "RenderStateCache.h"
+
+// Drivers store the 8 bit color and every depth format used here in 32 bits
+static uint64_t GetTextureBytes(uint32_t width, uint32_t height, uint32_t format)
+{
+	switch (format)
+	{
+		case GL_RGBA16F: return (uint64_t)width * height * 8;
+		case GL_RGBA32F: return (uint64_t)width * height * 16;
+	}
+
+	return (uint64_t)width * height * 4;
+}
+
+RenderTarget::RenderTarget(uint32_t width, uint32_t height, uint32_t colorFormat, uint32_t depthFormat)
+	: RenderTarget(width, height, std::span<const uint32_t>(&colorFormat, 1), depthFormat)
+{
+}
+
+RenderTarget::RenderTarget(uint32_t width, uint32_t height, std::span<const uint32_t> colorFormats, uint32_t depthFormat)
+	: m_Width(width), m_Height(height)
+{
+	m_Framebuffer = GpuResources::CreateFramebuffer();
+	const uint32_t framebuffer = GpuResources::GetId(m_Framebuffer);
+
+	if (colorFormats.size() > MaxColorAttachments)
+		printf("Render target has %zu color formats, only the first %u are attached\n", colorFormats.size(), MaxColorAttachments);
+
+	uint32_t drawBuffers[MaxColorAttachments] = {};
+	m_ColorCount = (uint32_t)std::min<size_t>(colorFormats.size(), MaxColorAttachments);
+	for (uint32_t i = 0; i < m_ColorCount; i++)
+	{
+		m_Colors[i] = GpuResources::CreateTexture({ GL_TEXTURE_2D, colorFormats[i], width, height, 0, 1 }, GetTextureBytes(width, height, colorFormats[i]), GpuMemoryCategory::RenderTargets);
+		const uint32_t color = GpuResources::GetId(m_Colors[i]);
+		glTextureParameteri(color, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTextureParameteri(color, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTextureParameteri(color, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTextureParameteri(color, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glNamedFramebufferTexture(framebuffer, GL_COLOR_ATTACHMENT0 + i, color, 0);
+		drawBuffers[i] = GL_COLOR_ATTACHMENT0 + i;
+	}
+
+	glNamedFramebufferDrawBuffers(framebuffer, (int)m_ColorCount, drawBuffers);
+
+	if (depthFormat != 0)
+	{
+		m_Depth = GpuResources::CreateTexture({ GL_TEXTURE_2D, depthFormat, width, height, 0, 1 }, GetTextureBytes(width, height, depthFormat), GpuMemoryCategory::RenderTargets);
+		const uint32_t depth = GpuResources::GetId(m_Depth);
+		// Depth is read texel by texel, filtering it would blend across edges
+		glTextureParameteri(depth, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTextureParameteri(depth, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTextureParameteri(depth, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTextureParameteri(depth, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glNamedFramebufferTexture(framebuffer, GL_DEPTH_ATTACHMENT, depth, 0);
+	}
+
+	const auto status = glCheckNamedFramebufferStatus(framebuffer, GL_FRAMEBUFFER);
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+		printf("Framebuffer error: %i\n", status);
+}
+
+RenderTarget::~RenderTarget()
+{
+	GpuResources::Destroy(m_Framebuffer);
+	for (GpuTextureHandle& color : m_Colors)
+		GpuResources::Destroy(color);
+	GpuResources::Destroy(m_Depth);
+}
+
+void RenderTarget::BeginWrite() const
+{
+	RenderStateCache::BindFramebuffer(GpuResources::GetId(m_Framebuffer));
+}
+
+void RenderTarget::EndWrite() const
+{
+	RenderStateCache::BindFramebuffer(0);
+}
+
+void RenderTarget::ReadColor(uint32_t unit, uint32_t attachment) const
+{
+	RenderStateCache::BindTexture(unit, GpuResources::GetId(m_Colors[attachment]));
+}
+
+void RenderTarget::ReadDepth(uint32_t unit) const
+{
+	RenderStateCache::BindTexture(unit, GpuResources::GetId(m_Depth));
+}
+
+void RenderTarget::BlitToBackbuffer(uint32_t width, uint32_t height, uint32_t backbufferWidth, uint32_t backbufferHeight) const
+{
+	// Named blits need no binding, the cached state stays valid
+	glBlitNamedFramebuffer(GpuResources::GetId(m_Framebuffer), 0, 0, 0, (int)width, (int)height, 0, 0, (int)backbufferWidth, (int)backbufferHeight,
+		GL_COLOR_BUFFER_BIT, width == backbufferWidth && height == backbufferHeight ? GL_NEAREST : GL_LINEAR);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include "GpuResources.h"
+
+// Offscreen framebuffer with one or more color textures and optionally a depth texture of the same size
+class RenderTarget
+{
+public:
+	// A depth format of 0 leaves the target without depth
+	RenderTarget(uint32_t width, uint32_t height, uint32_t colorFormat, uint32_t depthFormat = 0);
+	// Color attachment i is written by fragment shader output location i
+	RenderTarget(uint32_t width, uint32_t height, std::span<const uint32_t> colorFormats, uint32_t depthFormat = 0);
+	RenderTarget(const RenderTarget&) = delete;
+	~RenderTarget();
+
+	void BeginWrite() const;
+	void EndWrite() const;
+	void ReadColor(uint32_t unit, uint32_t attachment = 0) const;
+	void ReadDepth(uint32_t unit) const;
+
+	// Scales the top left width x height of the first color attachment onto the default framebuffer
+	void BlitToBackbuffer(uint32_t width, uint32_t height, uint32_t backbufferWidth, uint32_t backbufferHeight) const;
+
+	uint32_t GetWidth() const { return m_Width; }
+	uint32_t GetHeight() const { return m_Height; }
+	uint32_t GetFramebufferId() const { return GpuResources::GetId(m_Framebuffer); }
+
+private:
+	static constexpr uint32_t MaxColorAttachments = 4;
+
+	GpuFramebufferHandle m_Framebuffer;
+	GpuTextureHandle m_Colors[MaxColorAttachments];
+	uint32_t m_ColorCount = 0;
+	GpuTextureHandle m_Depth;
+	uint32_t m_Width = 0, m_Height = 0;
+};
@@ -0,0 +1,66 @@
+#include "RenderThread.h"
+
+#include <algorithm>
+
+#include "FrameArena.h"
+#include "Profiler.h"
+#include "Window.h"
+
+RenderThread::RenderThread(Window& window, FramePacketQueue& queue, RenderFunction renderFunction)
+	: m_Window(window), m_Queue(queue), m_RenderFunction(std::move(renderFunction))
+{
+}
+
+RenderThread::~RenderThread()
+{
+	Stop();
+}
+
+void RenderThread::Start()
+{
+	if (m_Thread.joinable())
+		return;
+
+	// A context can only be current on one thread at a time
+	m_Window.DetachContext();
+	m_Thread = std::thread(&RenderThread::Run, this);
+}
+
+void RenderThread::Stop()
+{
+	if (!m_Thread.joinable())
+		return;
+
+	m_Queue.Close();
+	m_Thread.join();
+	m_Window.MakeContextCurrent();
+}
+
+void RenderThread::Run()
+{
+	Profiler::SetThreadName("Render");
+	m_Window.MakeContextCurrent();
+
+	while (const FramePacket* packet = m_Queue.BeginRead())
+	{
+		m_RenderFunction(*packet);
+		{
+			ProfileScope scope("Swap buffers");
+			m_Window.SwapBuffers();
+		}
+
+		const auto presentTime = std::chrono::steady_clock::now();
+		const double latency = std::chrono::duration<double, std::milli>(presentTime - packet->SimulationStart).count();
+		m_Queue.EndRead();
+
+		if (m_Stats.FramesPresented++ == 0)
+			m_Stats.FirstPresent = presentTime;
+		m_Stats.LastPresent = presentTime;
+		m_Stats.TotalLatencyMs += latency;
+		m_Stats.MaxLatencyMs = std::max(m_Stats.MaxLatencyMs, latency);
+
+		FrameArena::Get().Reset();
+	}
+
+	m_Window.DetachContext();
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <functional>
+#include <thread>
+
+#include "FramePacket.h"
+
+class Window;
+
+struct RenderThreadStats
+{
+	uint64_t FramesPresented = 0;
+	double TotalLatencyMs = 0.0;
+	double MaxLatencyMs = 0.0;
+	std::chrono::steady_clock::time_point FirstPresent;
+	std::chrono::steady_clock::time_point LastPresent;
+};
+
+// Owns the GL context while running. Consumes frame packets from the queue, hands each one to the
+// render function and presents it. Resources must be created before Start or after Stop.
+class RenderThread
+{
+public:
+	using RenderFunction = std::function<void(const FramePacket&)>;
+
+	RenderThread(Window& window, FramePacketQueue& queue, RenderFunction renderFunction);
+	~RenderThread();
+
+	void Start();
+	// Renders whatever is still queued, then gives the context back to the calling thread
+	void Stop();
+
+	// Latency is measured from the start of the simulation of a frame until it is presented.
+	// Only safe to read while the thread is stopped.
+	const RenderThreadStats& GetStats() const { return m_Stats; }
+
+private:
+	void Run();
+
+private:
+	Window& m_Window;
+	FramePacketQueue& m_Queue;
+	RenderFunction m_RenderFunction;
+	std::thread m_Thread;
+
+	RenderThreadStats m_Stats;
+};
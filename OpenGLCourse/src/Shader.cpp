@@ -1,10 +1,13 @@
 #include "Shader.h"
 
+#include <algorithm>
 #include <glad/glad.h>
 #include <iostream>
 #include <glm/gtc/type_ptr.hpp>
 
-#include "Utils.h"
+#include "Log.h"
+#include "RenderStateCache.h"
+#include "ShaderPreprocessor.h"
 
 static void DetachAndDeleteShaders(uint32_t programId, uint32_t vertexId, uint32_t geomId, uint32_t fragId)
 {
@@ -39,6 +42,11 @@ static const char* ShaderStageToString(GLenum stage)
 	}
 }
 
+Shader::~Shader()
+{
+	GpuResources::Destroy(m_Program);
+}
+
 void Shader::CreateFromString(const std::string& vertexString)
 {
 	CompileShader(vertexString, "", "");
@@ -56,64 +64,107 @@ void Shader::CreateFromString(const std::string& vertexString, const std::string
 
 void Shader::CreateFromFile(const std::filesystem::path& vertexPath)
 {
-	const std::string vertexSource(Utils::ReadFileToString(vertexPath));
+	std::string vertexSource;
+	ShaderPreprocessor::Process(vertexPath, vertexSource);
 	CompileShader(vertexSource, "", "");
 }
 
 void Shader::CreateFromFile(const std::filesystem::path& vertexPath, const std::filesystem::path& fragmentPath)
 {
-	const std::string vertexSource(Utils::ReadFileToString(vertexPath));
-	const std::string fragmentSource(Utils::ReadFileToString(fragmentPath));
+	std::string vertexSource, fragmentSource;
+	ShaderPreprocessor::Process(vertexPath, vertexSource);
+	ShaderPreprocessor::Process(fragmentPath, fragmentSource);
 	CompileShader(vertexSource, "", fragmentSource);
 }
 
 void Shader::CreateFromFile(const std::filesystem::path& vertexPath, const std::filesystem::path& geometryPath, const std::filesystem::path& fragmentPath)
 {
-	const std::string vertexSource(Utils::ReadFileToString(vertexPath));
-	const std::string geometrySource(Utils::ReadFileToString(geometryPath));
-	const std::string fragmentSource(Utils::ReadFileToString(fragmentPath));
+	std::string vertexSource, geometrySource, fragmentSource;
+	ShaderPreprocessor::Process(vertexPath, vertexSource);
+	ShaderPreprocessor::Process(geometryPath, geometrySource);
+	ShaderPreprocessor::Process(fragmentPath, fragmentSource);
 	CompileShader(vertexSource, geometrySource, fragmentSource);
 }
 
 void Shader::Bind() const
 {
-	glUseProgram(m_ShaderId);
+	RenderStateCache::UseProgram(GetId());
 }
 
 void Shader::Validate() const
 {
+#if defined(APP_DEBUG)
+	// glValidateProgram is a full round trip to the driver, one check per program is enough
+	if (m_Validated)
+		return;
+
 	int32_t result;
-	glValidateProgram(m_ShaderId);
-	glGetProgramiv(m_ShaderId, GL_VALIDATE_STATUS, &result);
+	glValidateProgram(GetId());
+	glGetProgramiv(GetId(), GL_VALIDATE_STATUS, &result);
 
 	if (!result)
-		std::cerr << "Error validating shader program.\n";
+		Log::Error("Error validating shader program {}.", GetId());
+
+	m_Validated = true;
+#endif
 }
 
-void Shader::UploadUniformInt(const std::string& name, int value) const
+void Shader::UploadUniformInt(int32_t location, int value) const
 {
-	auto location = glGetUniformLocation(m_ShaderId, name.c_str());
 	glUniform1i(location, value);
 }
 
-void Shader::UploadUniformFloat(const std::string& name, float value) const
+void Shader::UploadUniformInt4(int32_t location, const glm::ivec4& vec) const
+{
+	glUniform4i(location, vec.x, vec.y, vec.z, vec.w);
+}
+
+void Shader::UploadUniformInt(const char* name, int value) const
+{
+	UploadUniformInt(m_Uniforms.Find(name), value);
+}
+
+void Shader::UploadUniformInt2(const char* name, const glm::ivec2& vec) const
 {
-	auto location = glGetUniformLocation(m_ShaderId, name.c_str());
+	const int32_t location = m_Uniforms.Find(name);
+	glUniform2i(location, vec.x, vec.y);
+}
+
+void Shader::UploadUniformInt3(const char* name, const glm::ivec3& vec) const
+{
+	const int32_t location = m_Uniforms.Find(name);
+	glUniform3i(location, vec.x, vec.y, vec.z);
+}
+
+void Shader::UploadUniformInt4(const char* name, const glm::ivec4& vec) const
+{
+	UploadUniformInt4(m_Uniforms.Find(name), vec);
+}
+
+void Shader::UploadUniformFloat(const char* name, float value) const
+{
+	const int32_t location = m_Uniforms.Find(name);
 	glUniform1f(location, value);
 }
 
-void Shader::UploadUniformFloat3(const std::string& name, const glm::vec3& vec) const
+void Shader::UploadUniformFloat3(const char* name, const glm::vec3& vec) const
 {
-	auto location = glGetUniformLocation(m_ShaderId, name.c_str());
+	const int32_t location = m_Uniforms.Find(name);
 	glUniform3f(location, vec.x, vec.y, vec.z);
 }
 
-void Shader::UploadUniformMat4(const std::string& name, const glm::mat4& matrix) const
+void Shader::UploadUniformMat4(const char* name, const glm::mat4& matrix) const
 {
-	auto location = glGetUniformLocation(m_ShaderId, name.c_str());
+	const int32_t location = m_Uniforms.Find(name);
 	glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(matrix));
 }
 
+void Shader::UploadUniformMat4Array(const char* name, const glm::mat4* matrices, uint32_t count) const
+{
+	const int32_t location = m_Uniforms.Find(name);
+	glUniformMatrix4fv(location, (GLsizei)count, GL_FALSE, glm::value_ptr(matrices[0]));
+}
+
 uint32_t Shader::AddShader(uint32_t program, const std::string& shaderCode, uint32_t shaderType)
 {
 	const uint32_t shader = glCreateShader(shaderType);
@@ -139,7 +190,8 @@ uint32_t Shader::AddShader(uint32_t program, const std::string& shaderCode, uint
 
 void Shader::CompileShader(const std::string& vertexString, const std::string& geometryString, const std::string& fragmentString)
 {
-	const uint32_t program = glCreateProgram();
+	GpuProgramHandle handle = GpuResources::CreateProgram();
+	const uint32_t program = GpuResources::GetId(handle);
 	const uint32_t vertexId = AddShader(program, vertexString, GL_VERTEX_SHADER);
 	const uint32_t geomId = geometryString.empty() ? 0 : AddShader(program, geometryString, GL_GEOMETRY_SHADER);
 	const uint32_t fragId = fragmentString.empty() ? 0 : AddShader(program, fragmentString, GL_FRAGMENT_SHADER);
@@ -153,10 +205,51 @@ void Shader::CompileShader(const std::string& vertexString, const std::string& g
 	{
 		std::cerr << "Error linking shader program.\n";
 		DetachAndDeleteShaders(program, vertexId, geomId, fragId);
-		glDeleteProgram(program);
+		GpuResources::Destroy(handle);
 		return;
 	}
 
-	m_ShaderId = program;
+	GpuResources::Destroy(m_Program);
+	m_Program = handle;
 	DetachAndDeleteShaders(program, vertexId, geomId, fragId);
+	ReadUniformLocations(program);
+}
+
+void Shader::ReadUniformLocations(uint32_t program)
+{
+	m_Uniforms.Clear();
+
+	int32_t count = 0;
+	int32_t maxLength = 0;
+	glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+	glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+	std::string name((size_t)std::max(maxLength, 1), '\0');
+	for (int32_t i = 0; i < count; i++)
+	{
+		int32_t length = 0;
+		int32_t size = 0;
+		GLenum type;
+		glGetActiveUniform(program, (uint32_t)i, (GLsizei)name.size(), &length, &size, &type, name.data());
+
+		const std::string_view activeName(name.data(), (size_t)length);
+		const int32_t location = glGetUniformLocation(program, name.c_str());
+		// Members of uniform blocks have no location
+		if (location < 0)
+			continue;
+
+		m_Uniforms.Add(activeName, location);
+
+		// Arrays are listed once as name[0], but can be set through the bare name and every element
+		if (activeName.ends_with("[0]"))
+		{
+			const std::string base(activeName.substr(0, activeName.size() - 3));
+			m_Uniforms.Add(base, location);
+			for (int32_t element = 1; element < size; element++)
+			{
+				const std::string elementName = base + "[" + std::to_string(element) + "]";
+				m_Uniforms.Add(elementName, glGetUniformLocation(program, elementName.c_str()));
+			}
+		}
+	}
 }
\ No newline at end of file
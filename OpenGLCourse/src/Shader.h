@@ -5,11 +5,17 @@
 #include <filesystem>
 #include <glm/fwd.hpp>
 
+#include "GpuResources.h"
+#include "UniformLocations.h"
+
 class Shader
 {
 public:
 	Shader() = default;
-	~Shader() = default;
+	~Shader();
+
+	Shader(const Shader&) = delete;
+	Shader& operator=(const Shader&) = delete;
 
 	void CreateFromString(const std::string& vertexString);
 	void CreateFromString(const std::string& vertexString, const std::string& geometryString, const std::string& fragmentString);
@@ -21,15 +27,30 @@ public:
 	void Bind() const;
 	void Validate() const;
 
-	void UploadUniformInt(const std::string& name, int value) const;
-	void UploadUniformFloat(const std::string& name, float value) const;
-	void UploadUniformFloat3(const std::string& name, const glm::vec3& vec) const;
-	void UploadUniformMat4(const std::string& name, const glm::mat4& matrix) const;
+	// -1 for names the program does not use. Per draw uniforms are looked up once and uploaded by location.
+	int32_t GetUniformLocation(const char* name) const { return m_Uniforms.Find(name); }
+	void UploadUniformInt(int32_t location, int value) const;
+	void UploadUniformInt4(int32_t location, const glm::ivec4& vec) const;
+
+	// Plain C strings, so literals do not turn into a std::string on every call
+	void UploadUniformInt(const char* name, int value) const;
+	void UploadUniformInt2(const char* name, const glm::ivec2& vec) const;
+	void UploadUniformInt3(const char* name, const glm::ivec3& vec) const;
+	void UploadUniformInt4(const char* name, const glm::ivec4& vec) const;
+	void UploadUniformFloat(const char* name, float value) const;
+	void UploadUniformFloat3(const char* name, const glm::vec3& vec) const;
+	void UploadUniformMat4(const char* name, const glm::mat4& matrix) const;
+	void UploadUniformMat4Array(const char* name, const glm::mat4* matrices, uint32_t count) const;
+
+	uint32_t GetId() const { return GpuResources::GetId(m_Program); }
 
 private:
 	static uint32_t AddShader(uint32_t program, const std::string& shaderCode, uint32_t shaderType);
 	void CompileShader(const std::string& vertexString, const std::string& geometryString, const std::string& fragmentString);
+	void ReadUniformLocations(uint32_t program);
 
 private:
-	uint32_t m_ShaderId = 0;
+	GpuProgramHandle m_Program;
+	UniformLocations m_Uniforms;
+	mutable bool m_Validated = false;
 };
@@ -0,0 +1,105 @@
+#include "ShaderPreprocessor.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "Utils.h"
+
+// Comments become spaces or newlines so the line numbers of compile errors stay put
+static std::string StripComments(const std::string& source)
+{
+	std::string result;
+	result.reserve(source.size());
+
+	for (size_t i = 0; i < source.size(); i++)
+	{
+		if (source.compare(i, 2, "//") == 0)
+		{
+			while (i < source.size() && source[i] != '\n')
+				i++;
+
+			if (i < source.size())
+				result += '\n';
+		}
+		else if (source.compare(i, 2, "/*") == 0)
+		{
+			const size_t end = source.find("*/", i + 2);
+			const size_t last = end == std::string::npos ? source.size() : end + 2;
+			result.append((size_t)std::count(source.begin() + i, source.begin() + last, '\n'), '\n');
+			result += ' ';
+			i = last - 1;
+		}
+		else if (source[i] != '\r')
+		{
+			result += source[i];
+		}
+	}
+
+	return result;
+}
+
+static bool ProcessFile(const std::filesystem::path& path, std::string& output, std::vector<std::filesystem::path>& stack, std::vector<std::filesystem::path>* includes)
+{
+	const std::filesystem::path normalized = path.lexically_normal();
+	if (std::find(stack.begin(), stack.end(), normalized) != stack.end())
+	{
+		std::cerr << "Shader '" << normalized.string() << "' includes itself\n";
+		return false;
+	}
+
+	std::error_code error;
+	if (!std::filesystem::exists(normalized, error))
+	{
+		std::cerr << "Could not open shader file '" << normalized.string() << "'\n";
+		return false;
+	}
+
+	stack.push_back(normalized);
+	if (includes && stack.size() > 1)
+		includes->push_back(normalized);
+
+	const std::string source = StripComments(Utils::ReadFileToString(normalized));
+
+	bool valid = true;
+	size_t lineStart = 0;
+	while (valid && lineStart < source.size())
+	{
+		size_t lineEnd = source.find('\n', lineStart);
+		if (lineEnd == std::string::npos)
+			lineEnd = source.size();
+
+		const std::string_view line(source.data() + lineStart, lineEnd - lineStart);
+		const size_t directive = line.find_first_not_of(" \t");
+		if (directive != std::string_view::npos && line.compare(directive, 8, "#include") == 0)
+		{
+			const size_t open = line.find('"', directive);
+			const size_t close = open == std::string_view::npos ? open : line.find('"', open + 1);
+			if (close == std::string_view::npos)
+			{
+				std::cerr << "Malformed #include in '" << normalized.string() << "'\n";
+				valid = false;
+			}
+			else
+			{
+				valid = ProcessFile(normalized.parent_path() / line.substr(open + 1, close - open - 1), output, stack, includes);
+			}
+		}
+		else
+		{
+			output.append(line);
+			output += '\n';
+		}
+
+		lineStart = lineEnd + 1;
+	}
+
+	stack.pop_back();
+	return valid;
+}
+
+bool ShaderPreprocessor::Process(const std::filesystem::path& path, std::string& source, std::vector<std::filesystem::path>* includes)
+{
+	source.clear();
+	std::vector<std::filesystem::path> stack;
+	return ProcessFile(path, source, stack, includes);
+}
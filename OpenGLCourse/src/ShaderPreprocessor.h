@@ -0,0 +1,17 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Expands #include "file" (relative to the including file) and strips comments. The cooker runs it
+// offline, cooked shaders then go through it again at load time without anything left to do.
+class ShaderPreprocessor
+{
+public:
+	ShaderPreprocessor() = delete;
+	~ShaderPreprocessor() = delete;
+
+	// Every file that was pulled in ends up in includes, for dependency tracking
+	static bool Process(const std::filesystem::path& path, std::string& source, std::vector<std::filesystem::path>* includes = nullptr);
+};
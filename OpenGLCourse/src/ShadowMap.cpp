@@ -3,54 +3,54 @@
 #include <cstdio>
 #include <glad/glad.h>
 
+#include "RenderStateCache.h"
+
 ShadowMap::ShadowMap(uint32_t width, uint32_t height)
 	: m_Width(width), m_Height(height)
 {
-	glGenFramebuffers(1, &m_FramebufferId);
+	m_Framebuffer = GpuResources::CreateFramebuffer();
+	const uint32_t framebuffer = GpuResources::GetId(m_Framebuffer);
 
-	glGenTextures(1, &m_ShadowMapId);
-	glBindTexture(GL_TEXTURE_2D, m_ShadowMapId);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, (int)m_Width, (int)m_Height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+	// GL_DEPTH_COMPONENT24 is stored in 32 bits
+	const GpuTextureDesc desc = { GL_TEXTURE_2D, GL_DEPTH_COMPONENT24, m_Width, m_Height, 0, 1 };
+	m_ShadowMap = GpuResources::CreateTexture(desc, (uint64_t)m_Width * m_Height * 4, GpuMemoryCategory::ShadowMaps);
+	const uint32_t shadowMap = GpuResources::GetId(m_ShadowMap);
 
-	glTextureParameteri(m_ShadowMapId, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTextureParameteri(m_ShadowMapId, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTextureParameteri(m_ShadowMapId, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-	glTextureParameteri(m_ShadowMapId, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+	glTextureParameteri(shadowMap, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTextureParameteri(shadowMap, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTextureParameteri(shadowMap, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+	glTextureParameteri(shadowMap, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
 
 	constexpr float borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
-	glTextureParameterfv(m_ShadowMapId, GL_TEXTURE_BORDER_COLOR, borderColor);
+	glTextureParameterfv(shadowMap, GL_TEXTURE_BORDER_COLOR, borderColor);
 
-	glBindFramebuffer(GL_FRAMEBUFFER, m_FramebufferId);
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_ShadowMapId, 0);
+	glNamedFramebufferTexture(framebuffer, GL_DEPTH_ATTACHMENT, shadowMap, 0);
 
-	glDrawBuffer(GL_NONE);
-	glReadBuffer(GL_NONE);
+	glNamedFramebufferDrawBuffer(framebuffer, GL_NONE);
+	glNamedFramebufferReadBuffer(framebuffer, GL_NONE);
 
-	const auto status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	const auto status = glCheckNamedFramebufferStatus(framebuffer, GL_FRAMEBUFFER);
 	if (status != GL_FRAMEBUFFER_COMPLETE)
 		printf("Framebuffer error: %i\n", status);
 }
 
 ShadowMap::~ShadowMap()
 {
-	if (m_FramebufferId)
-		glDeleteFramebuffers(1, &m_FramebufferId);
-	if (m_ShadowMapId)
-		glDeleteTextures(1, &m_ShadowMapId);
+	GpuResources::Destroy(m_Framebuffer);
+	GpuResources::Destroy(m_ShadowMap);
 }
 
 void ShadowMap::BeginWrite() const
 {
-	glBindFramebuffer(GL_FRAMEBUFFER, m_FramebufferId);
+	RenderStateCache::BindFramebuffer(GpuResources::GetId(m_Framebuffer));
 }
 
 void ShadowMap::EndWrite() const
 {
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	RenderStateCache::BindFramebuffer(0);
 }
 
 void ShadowMap::Read(uint32_t offset) const
 {
-	glActiveTexture(GL_TEXTURE0 + offset);
-	glBindTexture(GL_TEXTURE_2D, m_ShadowMapId);
+	RenderStateCache::BindTexture(offset, GpuResources::GetId(m_ShadowMap));
 }
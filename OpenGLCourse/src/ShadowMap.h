@@ -1,6 +1,8 @@
 #pragma once
 #include <cstdint>
 
+#include "GpuResources.h"
+
 class ShadowMap
 {
 public:
@@ -15,7 +17,8 @@ public:
 	uint32_t GetHeight() const { return m_Height; }
 
 private:
-	uint32_t m_FramebufferId = 0, m_ShadowMapId = 0;
+	GpuFramebufferHandle m_Framebuffer;
+	GpuTextureHandle m_ShadowMap;
 	uint32_t m_Width, m_Height;
 };
 
@@ -0,0 +1,61 @@
+#include "ShadowMask.h"
+
+#include <algorithm>
+#include <memory>
+
+#include <glad/glad.h>
+
+#include "GpuResources.h"
+#include "OpenGLContext.h"
+#include "RenderStateCache.h"
+#include "RenderTarget.h"
+#include "Shader.h"
+
+// Visibility only needs 8 bits, the distance to the eye needs a float to tell surfaces apart
+static constexpr uint32_t s_Formats[] = { GL_RGBA8, GL_RGBA16F };
+
+static std::unique_ptr<RenderTarget> s_Target;
+// The fullscreen triangle is generated from gl_VertexID, no vertex data is needed
+static GpuVertexArrayHandle s_EmptyVertexArray;
+static uint32_t s_Width = 0, s_Height = 0;
+
+void ShadowMask::Init(uint32_t maxWidth, uint32_t maxHeight)
+{
+	s_Target = std::make_unique<RenderTarget>((maxWidth + 1) / 2, (maxHeight + 1) / 2, s_Formats);
+	s_EmptyVertexArray = GpuResources::CreateVertexArray();
+}
+
+void ShadowMask::Shutdown()
+{
+	GpuResources::Destroy(s_EmptyVertexArray);
+	s_Target.reset();
+}
+
+void ShadowMask::Render(const Shader& shader, const RenderTarget& scene, uint32_t width, uint32_t height, uint32_t depthUnit, const glm::mat4& viewProjection)
+{
+	s_Width = std::min((width + 1) / 2, s_Target->GetWidth());
+	s_Height = std::min((height + 1) / 2, s_Target->GetHeight());
+
+	s_Target->BeginWrite();
+	OpenGLContext::SetViewport(s_Width, s_Height);
+
+	shader.Bind();
+	scene.ReadDepth(depthUnit);
+	shader.UploadUniformInt("u_SceneDepth", (int)depthUnit);
+	shader.UploadUniformInt2("u_SceneSize", glm::ivec2(width, height));
+	shader.UploadUniformMat4("u_InverseViewProjection", glm::inverse(viewProjection));
+	shader.Validate();
+
+	RenderStateCache::BindVertexArray(GpuResources::GetId(s_EmptyVertexArray));
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	RenderStateCache::RecordDrawCall();
+}
+
+void ShadowMask::Read(const Shader& shader, uint32_t firstUnit)
+{
+	s_Target->ReadColor(firstUnit, 0);
+	s_Target->ReadColor(firstUnit + 1, 1);
+	shader.UploadUniformInt("u_ShadowMask[0]", (int)firstUnit);
+	shader.UploadUniformInt("u_ShadowMask[1]", (int)firstUnit + 1);
+	shader.UploadUniformInt2("u_ShadowMaskSize", glm::ivec2(s_Width, s_Height));
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+class RenderTarget;
+class Shader;
+
+// Shadow visibility of every shadowed light evaluated once per pixel of a half resolution mask,
+// from the depth of a prepass. The main pass then reads one value per light instead of running the
+// shadow map filters per fragment. Channel 0 is the directional light, channel 1 + i shadow map i of
+// the packet, the last channel holds the distance to the eye the upsample compares depths with.
+class ShadowMask
+{
+public:
+	ShadowMask() = delete;
+	~ShadowMask() = delete;
+
+	// Large enough for a scene of maxWidth x maxHeight, needs the context
+	static void Init(uint32_t maxWidth, uint32_t maxHeight);
+	static void Shutdown();
+
+	// Draws the mask for the width x height corner of the scene target with the given shader, which has
+	// its lights and shadow maps set up already. Leaves the mask target bound.
+	static void Render(const Shader& shader, const RenderTarget& scene, uint32_t width, uint32_t height, uint32_t depthUnit, const glm::mat4& viewProjection);
+	// Binds the mask for a shader that upsamples it, taking two texture units from firstUnit
+	static void Read(const Shader& shader, uint32_t firstUnit);
+
+	// Light channels, the directional light and one per omni shadow map
+	static constexpr uint32_t MaxLights = 7;
+};
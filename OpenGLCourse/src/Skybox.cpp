@@ -5,6 +5,8 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
+#include "RenderStateCache.h"
+
 static uint32_t s_SkyboxIndices[] = {
 	// Front
 	0, 1, 2,
@@ -42,13 +44,10 @@ Skybox::Skybox(const std::vector<std::string>& faceLocations)
 {
 	m_Shader.CreateFromFile("./assets/shaders/Skybox.vert", "./assets/shaders/Skybox.frag");
 
-	glGenTextures(1, &m_TextureId);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, m_TextureId);
-
 	for (size_t i = 0; i < 6; i++)
 	{
 		int width, height, channels;
-		stbi_uc* data = stbi_load(faceLocations[i].c_str(), &width, &height, &channels, 0);
+		stbi_uc* data = stbi_load(faceLocations[i].c_str(), &width, &height, &channels, 3);
 
 		if (!data)
 		{
@@ -56,24 +55,31 @@ Skybox::Skybox(const std::vector<std::string>& faceLocations)
 			return;
 		}
 
-		glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
+		// All the faces share the size of the first one
+		if (i == 0)
+		{
+			// Drivers pad GL_RGB8 texels to 32 bits
+			const GpuTextureDesc desc = { GL_TEXTURE_CUBE_MAP, GL_RGB8, (uint32_t)width, (uint32_t)height, 0, 1 };
+			m_Texture = GpuResources::CreateTexture(desc, (uint64_t)width * height * 4 * 6, GpuMemoryCategory::Textures);
+		}
+
+		glTextureSubImage3D(GpuResources::GetId(m_Texture), 0, 0, 0, (int)i, width, height, 1, GL_RGB, GL_UNSIGNED_BYTE, data);
 		stbi_image_free(data);
 	}
 
-	glTextureParameteri(m_TextureId, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTextureParameteri(m_TextureId, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTextureParameteri(m_TextureId, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTextureParameteri(m_TextureId, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glTextureParameteri(m_TextureId, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+	const uint32_t texture = GpuResources::GetId(m_Texture);
+	glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTextureParameteri(texture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTextureParameteri(texture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTextureParameteri(texture, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
 
 	m_Mesh = new Mesh(s_SkyboxVertices, s_SkyboxIndices, std::size(s_SkyboxVertices), std::size(s_SkyboxIndices));
 }
 
 Skybox::~Skybox()
 {
-	if (m_TextureId)
-		glDeleteTextures(1, &m_TextureId);
-
+	GpuResources::Destroy(m_Texture);
 	delete m_Mesh;
 }
 
@@ -86,8 +92,7 @@ void Skybox::Draw(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix
 	m_Shader.UploadUniformMat4("u_View", glm::mat4(noTranslationView));
 	m_Shader.UploadUniformMat4("u_Projection", projectionMatrix);
 
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, m_TextureId);
+	RenderStateCache::BindTexture(0, GpuResources::GetId(m_Texture));
 
 	m_Shader.Validate();
 	m_Mesh->RenderMesh();
@@ -2,6 +2,7 @@
 
 #include <vector>
 
+#include "GpuResources.h"
 #include "Mesh.h"
 #include "Shader.h"
 
@@ -14,9 +15,9 @@ public:
 	void Draw(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix) const;
 
 private:
-	Mesh* m_Mesh;
+	Mesh* m_Mesh = nullptr;
 	Shader m_Shader;
 
-	uint32_t m_TextureId = 0;
+	GpuTextureHandle m_Texture;
 };
 
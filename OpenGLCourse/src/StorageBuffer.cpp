@@ -0,0 +1,35 @@
+#include "StorageBuffer.h"
+
+#include <algorithm>
+
+#include <glad/glad.h>
+
+
+StorageBuffer::StorageBuffer(size_t size, uint32_t binding)
+	: m_Size(size), m_Binding(binding)
+{
+	m_Buffer = GpuResources::CreateBuffer({ size, GL_DYNAMIC_STORAGE_BIT }, nullptr, GpuMemoryCategory::Buffers);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, GpuResources::GetId(m_Buffer));
+}
+
+StorageBuffer::~StorageBuffer()
+{
+	GpuResources::Destroy(m_Buffer);
+}
+
+void StorageBuffer::SetData(const void* data, size_t size, size_t offset) const
+{
+	glNamedBufferSubData(GpuResources::GetId(m_Buffer), (GLintptr)offset, (GLsizeiptr)size, data);
+}
+
+void StorageBuffer::Resize(size_t size)
+{
+	GpuBufferHandle buffer = GpuResources::CreateBuffer({ size, GL_DYNAMIC_STORAGE_BIT }, nullptr, GpuMemoryCategory::Buffers);
+	glCopyNamedBufferSubData(GpuResources::GetId(m_Buffer), GpuResources::GetId(buffer), 0, 0, (GLsizeiptr)std::min(m_Size, size));
+	// Frames in flight keep reading the old buffer until they are done
+	GpuResources::Destroy(m_Buffer);
+
+	m_Buffer = buffer;
+	m_Size = size;
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, m_Binding, GpuResources::GetId(m_Buffer));
+}
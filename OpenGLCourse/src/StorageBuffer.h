@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "GpuResources.h"
+
+class StorageBuffer
+{
+public:
+	StorageBuffer() = default;
+	StorageBuffer(size_t size, uint32_t binding);
+	~StorageBuffer();
+
+	void SetData(const void* data, size_t size, size_t offset = 0) const;
+	// Grows the buffer and keeps its current contents
+	void Resize(size_t size);
+
+	size_t GetSize() const { return m_Size; }
+
+private:
+	size_t m_Size = 0;
+	GpuBufferHandle m_Buffer;
+	uint32_t m_Binding = 0;
+};
@@ -0,0 +1,90 @@
+#include "TextureArray.h"
+
+#include <algorithm>
+#include <bit>
+
+#include <glad/glad.h>
+
+#include "RenderStateCache.h"
+
+TextureArray::TextureArray(uint32_t width, uint32_t height, uint32_t layerCount, BlockFormat format)
+	: m_Width(width), m_Height(height), m_LayerCount(layerCount), m_Format(format)
+{
+	m_LevelCount = CompressedImage::GetFullLevelCount(width, height);
+
+	const GpuTextureDesc desc = { GL_TEXTURE_2D_ARRAY, CompressedImage::GetGLFormat(format), m_Width, m_Height, m_LayerCount, m_LevelCount };
+	m_Texture = GpuResources::CreateTexture(desc, GetBytes(), GpuMemoryCategory::Textures);
+
+	const uint32_t texture = GpuResources::GetId(m_Texture);
+	glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTextureParameteri(texture, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTextureParameteri(texture, GL_TEXTURE_WRAP_T, GL_REPEAT);
+}
+
+TextureArray::TextureArray(TextureArray&& other) noexcept
+{
+	m_Texture = other.m_Texture;
+	other.m_Texture = {};
+	m_Width = other.m_Width;
+	m_Height = other.m_Height;
+	m_LayerCount = other.m_LayerCount;
+	m_LevelCount = other.m_LevelCount;
+	m_Format = other.m_Format;
+}
+
+TextureArray::~TextureArray()
+{
+	// Arrays are replaced while the frames in flight still sample the old one
+	GpuResources::Destroy(m_Texture);
+}
+
+void TextureArray::SetLevel(uint32_t layer, uint32_t level, const void* data, size_t size) const
+{
+	const int width = (int)std::max(m_Width >> level, 1u);
+	const int height = (int)std::max(m_Height >> level, 1u);
+
+	const uint32_t texture = GpuResources::GetId(m_Texture);
+	if (m_Format == BlockFormat::None)
+		glTextureSubImage3D(texture, (int)level, 0, 0, (int)layer, width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE, data);
+	else
+		glCompressedTextureSubImage3D(texture, (int)level, 0, 0, (int)layer, width, height, 1, CompressedImage::GetGLFormat(m_Format), (int)size, data);
+}
+
+size_t TextureArray::GetLevelSize(uint32_t level) const
+{
+	return CompressedImage::GetLevelSize(m_Format, std::max(m_Width >> level, 1u), std::max(m_Height >> level, 1u));
+}
+
+uint64_t TextureArray::GetBytes() const
+{
+	uint64_t bytes = 0;
+	for (uint32_t level = 0; level < m_LevelCount; level++)
+		bytes += GetLevelSize(level);
+
+	return bytes * m_LayerCount;
+}
+
+void TextureArray::CopyLayers(const TextureArray& source, uint32_t layerCount) const
+{
+	// Level 0 of the larger array lines up with a finer level of the smaller one
+	const int shift = std::bit_width(m_Width) - std::bit_width(source.m_Width);
+	const uint32_t sourceTexture = GpuResources::GetId(source.m_Texture);
+	const uint32_t texture = GpuResources::GetId(m_Texture);
+	for (uint32_t level = 0; level < m_LevelCount; level++)
+	{
+		const int sourceLevel = (int)level - shift;
+		if (sourceLevel < 0 || sourceLevel >= (int)source.m_LevelCount)
+			continue;
+
+		const int width = (int)std::max(m_Width >> level, 1u);
+		const int height = (int)std::max(m_Height >> level, 1u);
+		glCopyImageSubData(sourceTexture, GL_TEXTURE_2D_ARRAY, sourceLevel, 0, 0, 0,
+			texture, GL_TEXTURE_2D_ARRAY, (int)level, 0, 0, 0, width, height, (int)layerCount);
+	}
+}
+
+void TextureArray::Bind(uint32_t unit) const
+{
+	RenderStateCache::BindTexture(unit, GpuResources::GetId(m_Texture));
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "CompressedImage.h"
+#include "GpuResources.h"
+
+// Immutable GL_TEXTURE_2D_ARRAY with a full mip chain, RGBA8 or block compressed. All layers share the size and format.
+class TextureArray
+{
+public:
+	TextureArray(uint32_t width, uint32_t height, uint32_t layerCount, BlockFormat format = BlockFormat::None);
+	TextureArray(TextureArray&& other) noexcept;
+	TextureArray(const TextureArray&) = delete;
+	~TextureArray();
+
+	// Data is tightly packed RGBA8 or the blocks of the level. With a pixel unpack buffer bound it is an offset into it.
+	void SetLevel(uint32_t layer, uint32_t level, const void* data, size_t size) const;
+	// Copies the first layers of an array with the same format, every level both have in the same size.
+	// That way an array can grow in layers or trade its finest levels without going through the CPU.
+	void CopyLayers(const TextureArray& source, uint32_t layerCount) const;
+
+	size_t GetLevelSize(uint32_t level) const;
+	// Every level of every layer
+	uint64_t GetBytes() const;
+
+	void Bind(uint32_t unit) const;
+
+	uint32_t GetWidth() const { return m_Width; }
+	uint32_t GetHeight() const { return m_Height; }
+	uint32_t GetLayerCount() const { return m_LayerCount; }
+	uint32_t GetLevelCount() const { return m_LevelCount; }
+	BlockFormat GetFormat() const { return m_Format; }
+	uint32_t GetTextureId() const { return GpuResources::GetId(m_Texture); }
+
+private:
+	GpuTextureHandle m_Texture;
+	uint32_t m_Width = 0, m_Height = 0;
+	uint32_t m_LayerCount = 0, m_LevelCount = 0;
+	BlockFormat m_Format = BlockFormat::None;
+};
@@ -0,0 +1,573 @@
+#include "TextureArrayManager.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include <stb_image.h>
+
+#include "CompressedImage.h"
+#include "FrameArena.h"
+#include "GpuMemory.h"
+#include "JobSystem.h"
+#include "Log.h"
+#include "Profiler.h"
+#include "TextureArray.h"
+#include "TextureCompressor.h"
+#include "UploadRing.h"
+
+struct TextureLayer
+{
+	std::string Name;
+	// The encoded file until the next build decodes it, in Encoded or in memory the caller keeps valid
+	std::vector<uint8_t> Encoded;
+	std::span<const uint8_t> Source;
+	// Every level back to back, largest first, in Mips or for BC files right where they are in the source.
+	// Kept after streaming so evicted levels can come back.
+	std::vector<uint8_t> Mips;
+	std::span<const uint8_t> MipChain;
+	double DecodeMs = 0.0;
+	// Finest level uploaded so far, and the finest the visible objects asked for this frame
+	uint8_t ResidentLevel = 0;
+	uint8_t RequestedLevel = 0;
+	bool Used = false;
+};
+
+// The array only holds the levels from BaseLevel down. It grows a level at a time while the visible
+// objects need finer ones and gives its finest level back when GpuMemory runs out of budget.
+struct TextureGroup : GpuEvictable
+{
+	uint32_t Size = 0;
+	BlockFormat Format = BlockFormat::None;
+	std::vector<TextureLayer> Layers;
+	std::vector<uint32_t> FreeLayers;
+	uint32_t UsedCount = 0;
+	std::unique_ptr<TextureArray> Array;
+
+	uint32_t BaseLevel = 0;
+	// Finest level any layer asked for this frame, and the last frame one asked for the finest level held
+	uint32_t NeededLevel = UINT32_MAX;
+	uint64_t LastUsedFrame = 0;
+
+	uint64_t GetLastUsedFrame() const override { return LastUsedFrame; }
+	bool Evict() override;
+	uint64_t GetRestoreBytes() const override;
+	bool IsRestoreRequired() const override { return false; }
+	void Restore() override;
+
+	// Swaps the array for one holding the levels from baseLevel down, copying what both have on the GPU
+	void SetBaseLevel(uint32_t baseLevel);
+};
+
+struct PendingLayer
+{
+	uint32_t Group = 0;
+	uint32_t Layer = 0;
+	std::vector<uint8_t> Pixels;
+	// Pixels, or the levels of a BC file that already come in the right order
+	std::span<const uint8_t> Chain;
+};
+
+struct StreamCandidate
+{
+	uint32_t Group = 0;
+	uint32_t Layer = 0;
+	uint32_t Missing = 0;
+};
+
+static std::vector<TextureGroup> s_Groups;
+static std::unique_ptr<UploadRing> s_UploadRing;
+static TextureStreamStats s_StreamStats;
+
+static uint32_t GetLevelCount(const TextureGroup& group)
+{
+	return CompressedImage::GetFullLevelCount(group.Size, group.Size);
+}
+
+static size_t GetLevelSize(const TextureGroup& group, uint32_t level)
+{
+	const uint32_t size = std::max(group.Size >> level, 1u);
+	return CompressedImage::GetLevelSize(group.Format, size, size);
+}
+
+static size_t GetLevelOffset(const TextureGroup& group, uint32_t level)
+{
+	size_t offset = 0;
+	for (uint32_t i = 0; i < level; i++)
+		offset += GetLevelSize(group, i);
+
+	return offset;
+}
+
+// The levels small enough to upload right away, so every texture can be drawn from the first frame
+static uint32_t GetTailLevel(const TextureGroup& group)
+{
+	const uint32_t levelCount = GetLevelCount(group);
+	const uint32_t tailLevels = (uint32_t)std::bit_width(TextureArrayManager::ResidentTailSize);
+	return levelCount > tailLevels ? levelCount - tailLevels : 0;
+}
+
+bool TextureGroup::Evict()
+{
+	if (!Array || BaseLevel >= GetTailLevel(*this))
+		return false;
+
+	SetBaseLevel(BaseLevel + 1);
+	return true;
+}
+
+uint64_t TextureGroup::GetRestoreBytes() const
+{
+	if (!Array || NeededLevel >= BaseLevel)
+		return 0;
+
+	return GetLevelSize(*this, BaseLevel - 1) * Array->GetLayerCount();
+}
+
+void TextureGroup::Restore()
+{
+	SetBaseLevel(BaseLevel - 1);
+}
+
+void TextureGroup::SetBaseLevel(uint32_t baseLevel)
+{
+	const uint32_t size = Size >> baseLevel;
+	auto array = std::make_unique<TextureArray>(size, size, Array->GetLayerCount(), Format);
+	array->CopyLayers(*Array, Array->GetLayerCount());
+	Array = std::move(array);
+	BaseLevel = baseLevel;
+
+	// Whatever was finer is gone and has to be streamed in again
+	for (TextureLayer& layer : Layers)
+		layer.ResidentLevel = (uint8_t)std::max<uint32_t>(layer.ResidentLevel, baseLevel);
+}
+
+// Reads the size and format of the encoded file without decoding it
+static bool ReadHeader(const std::string& name, std::span<const uint8_t> encoded, uint32_t& sizeClass, BlockFormat& format)
+{
+	if (CompressedImage::IsContainer(encoded.data(), encoded.size()))
+	{
+		CompressedImage image;
+		if (!CompressedImage::Parse(encoded.data(), encoded.size(), image))
+		{
+			std::cerr << "Failed to load texture: '" << name << "'\n";
+			return false;
+		}
+
+		if (image.Width != image.Height || !std::has_single_bit(image.Width) || image.Width < TextureArrayManager::MinSize || image.Width > TextureArrayManager::MaxSize)
+		{
+			std::cerr << "Compressed texture '" << name << "' is " << image.Width << 'x' << image.Height << ", it has to be square and a power of two from "
+				<< TextureArrayManager::MinSize << " to " << TextureArrayManager::MaxSize << '\n';
+			return false;
+		}
+
+		if (image.Levels.size() < CompressedImage::GetFullLevelCount(image.Width, image.Height))
+		{
+			std::cerr << "Compressed texture '" << name << "' does not have a full mip chain\n";
+			return false;
+		}
+
+		sizeClass = image.Width;
+		format = image.Format;
+		return true;
+	}
+
+	int width, height, channels;
+	if (!stbi_info_from_memory(encoded.data(), (int)encoded.size(), &width, &height, &channels))
+	{
+		std::cerr << "Failed to load texture: '" << name << "'\n";
+		return false;
+	}
+
+	sizeClass = TextureArrayManager::CalculateSizeClass(width, height);
+	format = BlockFormat::None;
+	return true;
+}
+
+TextureSlot TextureArrayManager::Request(const std::string& name, std::vector<uint8_t> encoded)
+{
+	// Moving the vector keeps its buffer, so the view stays valid
+	const std::span<const uint8_t> source(encoded);
+	return AddLayer(name, std::move(encoded), source);
+}
+
+TextureSlot TextureArrayManager::Request(const std::string& name, std::span<const std::byte> encoded)
+{
+	return AddLayer(name, {}, std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(encoded.data()), encoded.size()));
+}
+
+TextureSlot TextureArrayManager::AddLayer(const std::string& name, std::vector<uint8_t> encoded, std::span<const uint8_t> source)
+{
+	uint32_t sizeClass;
+	BlockFormat format;
+	if (!ReadHeader(name, source, sizeClass, format))
+		return {};
+
+	auto group = std::find_if(s_Groups.begin(), s_Groups.end(), [=](const TextureGroup& g) { return g.Size == sizeClass && g.Format == format && !g.Layers.empty(); });
+	if (group == s_Groups.end())
+	{
+		// Groups that emptied out keep their index and can take a new size and format
+		group = std::find_if(s_Groups.begin(), s_Groups.end(), [](const TextureGroup& g) { return g.Layers.empty(); });
+		if (group == s_Groups.end())
+		{
+			if (s_Groups.size() == MaxArrays)
+			{
+				std::cerr << "Texture '" << name << "' needs a texture array of its own but all " << MaxArrays << " are taken\n";
+				return {};
+			}
+
+			// Groups are registered with GpuMemory by address, so the vector must never reallocate
+			s_Groups.reserve(MaxArrays);
+			group = s_Groups.emplace(s_Groups.end());
+			GpuMemory::Register(&*group);
+		}
+
+		group->Size = sizeClass;
+		group->Format = format;
+	}
+
+	uint32_t layer;
+	if (!group->FreeLayers.empty())
+	{
+		layer = group->FreeLayers.back();
+		group->FreeLayers.pop_back();
+	}
+	else
+	{
+		layer = (uint32_t)group->Layers.size();
+		group->Layers.emplace_back();
+	}
+
+	TextureLayer& textureLayer = group->Layers[layer];
+	textureLayer.Name = name;
+	textureLayer.Encoded = std::move(encoded);
+	textureLayer.Source = source;
+	textureLayer.DecodeMs = 0.0;
+	textureLayer.Used = true;
+	group->UsedCount++;
+
+	TextureSlot slot;
+	slot.Array = (uint16_t)(group - s_Groups.begin());
+	slot.Layer = (uint16_t)layer;
+	return slot;
+}
+
+void TextureArrayManager::Release(TextureSlot slot)
+{
+	if (!slot.IsValid() || slot.Array >= s_Groups.size())
+		return;
+
+	TextureGroup& group = s_Groups[slot.Array];
+	TextureLayer& layer = group.Layers[slot.Layer];
+	if (!layer.Used)
+		return;
+
+	layer = TextureLayer();
+	group.FreeLayers.push_back(slot.Layer);
+
+	// The group keeps its index so the slots of other groups stay valid
+	if (--group.UsedCount == 0)
+	{
+		group.Array.reset();
+		group.Layers.clear();
+		group.FreeLayers.clear();
+	}
+}
+
+void TextureArrayManager::Build()
+{
+	ProfileScope scope("Build texture arrays");
+	std::vector<PendingLayer> pending;
+	for (uint32_t group = 0; group < (uint32_t)s_Groups.size(); group++)
+	{
+		for (uint32_t layer = 0; layer < (uint32_t)s_Groups[group].Layers.size(); layer++)
+		{
+			if (s_Groups[group].Layers[layer].Source.empty())
+				continue;
+
+			PendingLayer& entry = pending.emplace_back();
+			entry.Group = group;
+			entry.Layer = layer;
+		}
+	}
+
+	if (pending.empty())
+		return;
+
+	// Decoding and resampling is by far the slowest part, the GL side only has to copy.
+	// Compressed files come with their mips, there is nothing to decode.
+	JobCounter counter;
+	JobSystem::ParallelFor((uint32_t)pending.size(), 1, [&](uint32_t begin, uint32_t end)
+	{
+		for (uint32_t i = begin; i < end; i++)
+		{
+			PendingLayer& layer = pending[i];
+			const TextureGroup& group = s_Groups[layer.Group];
+			TextureLayer& source = s_Groups[layer.Group].Layers[layer.Layer];
+			const auto start = std::chrono::steady_clock::now();
+
+			if (group.Format != BlockFormat::None)
+			{
+				CompressedImage image;
+				CompressedImage::Parse(source.Source.data(), source.Source.size(), image);
+
+				// DDS and KTX2 files written largest level first can be uploaded and streamed from where they are
+				bool inOrder = true;
+				for (uint32_t level = 0; level < GetLevelCount(group); level++)
+					inOrder = inOrder && image.Levels[level].Offset == image.Levels[0].Offset + GetLevelOffset(group, level);
+
+				if (inOrder)
+				{
+					layer.Chain = source.Source.subspan(image.Levels[0].Offset, GetLevelOffset(group, GetLevelCount(group)));
+				}
+				else
+				{
+					for (uint32_t level = 0; level < GetLevelCount(group); level++)
+					{
+						const CompressedLevel& mip = image.Levels[level];
+						layer.Pixels.insert(layer.Pixels.end(), source.Source.begin() + mip.Offset, source.Source.begin() + mip.Offset + mip.Size);
+					}
+				}
+
+				source.DecodeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+				continue;
+			}
+
+			int width, height, channels;
+			stbi_uc* data = stbi_load_from_memory(source.Source.data(), (int)source.Source.size(), &width, &height, &channels, 4);
+			if (!data)
+			{
+				Log::Error("Failed to load texture: '{}'", source.Name);
+				layer.Pixels.assign(GetLevelOffset(group, GetLevelCount(group)), 0xFF);
+				continue;
+			}
+
+			std::vector<uint8_t> level = (uint32_t)width == group.Size && (uint32_t)height == group.Size
+				? std::vector<uint8_t>(data, data + (size_t)width * height * 4)
+				: TextureCompressor::Resample(data, (uint32_t)width, (uint32_t)height, group.Size, group.Size);
+			stbi_image_free(data);
+
+			// The mips are built here rather than on the GPU so they can be streamed in later
+			layer.Pixels.reserve(GetLevelOffset(group, GetLevelCount(group)));
+			for (uint32_t mip = 0; mip < GetLevelCount(group); mip++)
+			{
+				layer.Pixels.insert(layer.Pixels.end(), level.begin(), level.end());
+				if (mip + 1 < GetLevelCount(group))
+				{
+					const uint32_t size = std::max(group.Size >> mip, 1u);
+					level = TextureCompressor::Downsample(level.data(), size, size);
+				}
+			}
+
+			source.DecodeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		}
+	}, &counter);
+	JobSystem::WaitFor(counter);
+
+	for (PendingLayer& layer : pending)
+	{
+		if (layer.Chain.empty())
+			layer.Chain = layer.Pixels;
+	}
+
+	// Arrays are immutable, a group that grew gets a new one with the old layers copied over on the GPU.
+	// New groups start out holding only the mip tail.
+	for (TextureGroup& group : s_Groups)
+	{
+		const uint32_t layerCount = (uint32_t)group.Layers.size();
+		if (layerCount == 0 || (group.Array && group.Array->GetLayerCount() == layerCount))
+			continue;
+
+		if (!group.Array)
+			group.BaseLevel = GetTailLevel(group);
+
+		const uint32_t size = group.Size >> group.BaseLevel;
+		auto array = std::make_unique<TextureArray>(size, size, layerCount, group.Format);
+		if (group.Array)
+			array->CopyLayers(*group.Array, group.Array->GetLayerCount());
+
+		group.Array = std::move(array);
+	}
+
+	// Only the mip tail goes up now, the rest is streamed in as the visible objects need it
+	for (PendingLayer& layer : pending)
+	{
+		const TextureGroup& group = s_Groups[layer.Group];
+		TextureLayer& textureLayer = s_Groups[layer.Group].Layers[layer.Layer];
+		const uint32_t tail = GetTailLevel(group);
+
+		for (uint32_t level = tail; level < GetLevelCount(group); level++)
+			group.Array->SetLevel(layer.Layer, level - group.BaseLevel, layer.Chain.data() + GetLevelOffset(group, level), GetLevelSize(group, level));
+
+		textureLayer.Source = {};
+		textureLayer.ResidentLevel = (uint8_t)tail;
+		textureLayer.RequestedLevel = (uint8_t)tail;
+
+		// A chain that points into the source keeps its Encoded vector alive, when it has one
+		const bool decoded = layer.Chain.data() == layer.Pixels.data();
+		if (tail > 0 && decoded)
+		{
+			textureLayer.Mips = std::move(layer.Pixels);
+			textureLayer.MipChain = textureLayer.Mips;
+		}
+		else if (tail > 0)
+		{
+			textureLayer.MipChain = layer.Chain;
+		}
+
+		if (tail == 0 || decoded)
+			textureLayer.Encoded = std::vector<uint8_t>();
+	}
+
+	if (!s_UploadRing)
+		s_UploadRing = std::make_unique<UploadRing>(StreamRingSize);
+}
+
+void TextureArrayManager::RequestLevel(TextureSlot slot, float screenSize)
+{
+	if (!slot.IsValid() || slot.Array >= s_Groups.size() || slot.Layer >= s_Groups[slot.Array].Layers.size())
+		return;
+
+	// One texel per pixel when the texture is stretched once over the object
+	TextureGroup& group = s_Groups[slot.Array];
+	const float texelsPerPixel = (float)group.Size / std::max(screenSize, 1.0f);
+	const uint32_t level = (uint32_t)std::clamp(std::floor(std::log2(std::max(texelsPerPixel, 1.0f))), 0.0f, (float)(GetLevelCount(group) - 1));
+
+	TextureLayer& layer = group.Layers[slot.Layer];
+	layer.RequestedLevel = (uint8_t)std::min<uint32_t>(layer.RequestedLevel, level);
+
+	group.NeededLevel = std::min(group.NeededLevel, level);
+	if (level <= group.BaseLevel)
+		group.LastUsedFrame = GpuMemory::GetFrame();
+}
+
+uint32_t TextureArrayManager::GetResidentLevel(TextureSlot slot)
+{
+	if (!slot.IsValid() || slot.Array >= s_Groups.size() || slot.Layer >= s_Groups[slot.Array].Layers.size())
+		return 0;
+
+	const TextureGroup& group = s_Groups[slot.Array];
+	return group.Layers[slot.Layer].ResidentLevel - group.BaseLevel;
+}
+
+void TextureArrayManager::Stream(uint64_t byteBudget)
+{
+	if (!s_UploadRing)
+		return;
+
+	FrameVector<StreamCandidate> candidates;
+	for (uint32_t group = 0; group < (uint32_t)s_Groups.size(); group++)
+	{
+		for (uint32_t layer = 0; layer < (uint32_t)s_Groups[group].Layers.size(); layer++)
+		{
+			TextureLayer& textureLayer = s_Groups[group].Layers[layer];
+			if (!textureLayer.MipChain.empty() && textureLayer.RequestedLevel < textureLayer.ResidentLevel && textureLayer.ResidentLevel > s_Groups[group].BaseLevel)
+				candidates.push_back({ group, layer, (uint32_t)(textureLayer.ResidentLevel - textureLayer.RequestedLevel) });
+		}
+	}
+
+	// Textures that are furthest from what they should look like first, one level at a time for each
+	// so a single big texture can not hold everything else back
+	std::sort(candidates.begin(), candidates.end(), [](const StreamCandidate& a, const StreamCandidate& b) { return a.Missing > b.Missing; });
+
+	uint64_t streamed = 0;
+	bool uploaded = !candidates.empty();
+	s_UploadRing->Bind();
+	while (uploaded && streamed < byteBudget)
+	{
+		uploaded = false;
+		for (const StreamCandidate& candidate : candidates)
+		{
+			const TextureGroup& group = s_Groups[candidate.Group];
+			TextureLayer& layer = s_Groups[candidate.Group].Layers[candidate.Layer];
+			if (layer.RequestedLevel >= layer.ResidentLevel || layer.ResidentLevel <= group.BaseLevel || layer.MipChain.empty())
+				continue;
+
+			// The first upload of a frame always goes, otherwise a level bigger than the budget would never make it
+			const uint32_t level = layer.ResidentLevel - 1u;
+			const size_t size = GetLevelSize(group, level);
+			size_t offset;
+			if ((streamed > 0 && streamed + size > byteBudget) || !s_UploadRing->Allocate(size, offset))
+				continue;
+
+			std::memcpy(s_UploadRing->GetPointer(offset), layer.MipChain.data() + GetLevelOffset(group, level), size);
+			group.Array->SetLevel(candidate.Layer, level - group.BaseLevel, reinterpret_cast<const void*>(offset), size);
+
+			layer.ResidentLevel = (uint8_t)level;
+
+			streamed += size;
+			s_StreamStats.BytesStreamed += size;
+			s_StreamStats.LevelsStreamed++;
+			uploaded = true;
+		}
+	}
+	s_UploadRing->Unbind();
+	s_UploadRing->EndFrame();
+
+	// Requests only last a frame, the next one asks again for whatever is still visible
+	uint32_t pendingLevels = 0;
+	for (TextureGroup& group : s_Groups)
+	{
+		const uint8_t tail = (uint8_t)GetTailLevel(group);
+		group.NeededLevel = UINT32_MAX;
+		for (TextureLayer& layer : group.Layers)
+		{
+			layer.RequestedLevel = tail;
+			if (!layer.MipChain.empty())
+				pendingLevels += layer.ResidentLevel;
+		}
+	}
+
+	s_StreamStats.PendingLevels = pendingLevels;
+}
+
+const TextureStreamStats& TextureArrayManager::GetStreamStats()
+{
+	return s_StreamStats;
+}
+
+void TextureArrayManager::Shutdown()
+{
+	for (TextureGroup& group : s_Groups)
+		GpuMemory::Unregister(&group);
+
+	s_Groups.clear();
+	s_UploadRing.reset();
+}
+
+void TextureArrayManager::Bind(uint32_t firstUnit)
+{
+	for (uint32_t i = 0; i < (uint32_t)s_Groups.size(); i++)
+	{
+		if (s_Groups[i].Array)
+			s_Groups[i].Array->Bind(firstUnit + i);
+	}
+}
+
+uint32_t TextureArrayManager::GetArrayCount()
+{
+	return (uint32_t)s_Groups.size();
+}
+
+uint64_t TextureArrayManager::GetLayerBytes(TextureSlot slot)
+{
+	if (!slot.IsValid() || slot.Array >= s_Groups.size())
+		return 0;
+
+	const TextureGroup& group = s_Groups[slot.Array];
+	return GetLevelOffset(group, GetLevelCount(group));
+}
+
+double TextureArrayManager::GetDecodeMs(TextureSlot slot)
+{
+	if (!slot.IsValid() || slot.Array >= s_Groups.size() || slot.Layer >= s_Groups[slot.Array].Layers.size())
+		return 0.0;
+
+	return s_Groups[slot.Array].Layers[slot.Layer].DecodeMs;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// Where a texture lives once it has been packed into an array
+struct TextureSlot
+{
+	static constexpr uint16_t InvalidArray = UINT16_MAX;
+
+	uint16_t Array = InvalidArray;
+	uint16_t Layer = 0;
+
+	bool IsValid() const { return Array != InvalidArray; }
+};
+
+struct TextureStreamStats
+{
+	uint64_t BytesStreamed = 0;
+	uint64_t LevelsStreamed = 0;
+	// Levels that are not resident yet, as of the last Stream
+	uint32_t PendingLevels = 0;
+};
+
+// Packs every texture of the scene into a few GL_TEXTURE_2D_ARRAYs, one per power of two size class and format.
+// Images that do not match their class are resampled to it, so a shader picks any texture with an
+// (array, layer) pair and all arrays stay bound for the whole frame. DDS and KTX2 files holding BC
+// data are uploaded as they are, they have to be square, sized to a class and carry every mip level.
+// Build only uploads the small mips of every texture, the finer ones are streamed in by Stream through a
+// ring of pixel unpack buffers once objects using the texture get big enough on screen. Each array only
+// holds the levels some texture in it needs, GpuMemory takes its finest level back once it goes unused.
+class TextureArrayManager
+{
+public:
+	TextureArrayManager() = delete;
+	~TextureArrayManager() = delete;
+
+	// Only reads the header of the encoded file, decoding waits for Build. The name is for error messages.
+	// Deduplication is up to the caller, every request gets its own layer.
+	static TextureSlot Request(const std::string& name, std::vector<uint8_t> encoded);
+	// Same without the copy, for files in a mapped asset pack. The data has to stay valid until Shutdown,
+	// BC files are uploaded and streamed straight out of it.
+	static TextureSlot Request(const std::string& name, std::span<const std::byte> encoded);
+	// Frees the layer for the next request of the same size class, an array goes once all its layers are free
+	static void Release(TextureSlot slot);
+	// Decodes everything requested since the last build on the job system and uploads the mip tails
+	static void Build();
+	static void Shutdown();
+
+	// Memory one layer takes with its mip chain, and how long decoding and resampling or parsing it took
+	static uint64_t GetLayerBytes(TextureSlot slot);
+	static double GetDecodeMs(TextureSlot slot);
+
+	// Asks for the level a texture covering screenSize pixels needs this frame. Render thread only, like Stream.
+	static void RequestLevel(TextureSlot slot, float screenSize);
+	// Finest level that can be sampled, counted from the finest level the array holds. The shader clamps its LOD to it.
+	static uint32_t GetResidentLevel(TextureSlot slot);
+	// Uploads up to byteBudget of the levels requested this frame and forgets the requests
+	static void Stream(uint64_t byteBudget);
+	static const TextureStreamStats& GetStreamStats();
+
+	static void Bind(uint32_t firstUnit);
+	static uint32_t GetArrayCount();
+
+	// Nearest power of two of the larger side in log space, clamped to the supported classes.
+	// Inline so the asset cooker can size textures without pulling in the GL side.
+	static uint32_t CalculateSizeClass(int width, int height)
+	{
+		// So a 1250x836 texture ends up at 1024 rather than 2048
+		const uint32_t size = (uint32_t)std::max(width, height);
+		uint32_t sizeClass = std::bit_floor(size);
+		if (size - sizeClass > sizeClass * 2 - size)
+			sizeClass *= 2;
+
+		return std::clamp(sizeClass, MinSize, MaxSize);
+	}
+
+	// Size classes from 64 up to 2048. MaxArrays has to match MAX_TEXTURE_ARRAYS in the shaders. The main
+	// pass samples these 7 arrays, the directional shadow map, 6 omni shadow cube maps and the 2 shadow
+	// mask textures, exactly the 16 samplers a fragment shader is guaranteed.
+	static constexpr uint32_t MinSize = 64;
+	static constexpr uint32_t MaxSize = 2048;
+	static constexpr uint32_t MaxArrays = 7;
+
+	// Levels this size and smaller are uploaded by Build
+	static constexpr uint32_t ResidentTailSize = 64;
+	// Has to hold the largest level, 2048x2048 RGBA8
+	static constexpr size_t StreamRingSize = 32 * 1024 * 1024;
+
+private:
+	static TextureSlot AddLayer(const std::string& name, std::vector<uint8_t> encoded, std::span<const uint8_t> source);
+};
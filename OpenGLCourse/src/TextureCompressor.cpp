@@ -0,0 +1,335 @@
+#include "TextureCompressor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include <stb_image.h>
+
+#include "TextureArrayManager.h"
+
+static constexpr uint32_t s_DdsFlags = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000; // caps, height, width, pixel format, mip count, linear size
+static constexpr uint32_t s_DdsPixelFormatFourCC = 0x4;
+static constexpr uint32_t s_DdsCaps = 0x1000 | 0x400000 | 0x8; // texture, mipmap, complex
+
+static uint16_t PackRgb565(const uint8_t* color)
+{
+	return (uint16_t)(((color[0] * 31 + 127) / 255) << 11 | ((color[1] * 63 + 127) / 255) << 5 | ((color[2] * 31 + 127) / 255));
+}
+
+static void UnpackRgb565(uint16_t packed, int* color)
+{
+	const int r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+	color[0] = (r << 3) | (r >> 2);
+	color[1] = (g << 2) | (g >> 4);
+	color[2] = (b << 3) | (b >> 2);
+}
+
+static void WriteUInt16(uint8_t* destination, uint16_t value)
+{
+	destination[0] = (uint8_t)value;
+	destination[1] = (uint8_t)(value >> 8);
+}
+
+static void EncodeColorBlock(const uint8_t block[16][4], uint8_t* destination)
+{
+	uint8_t min[3] = { 255, 255, 255 }, max[3] = { 0, 0, 0 };
+	int mean[3] = { 0, 0, 0 };
+	for (int i = 0; i < 16; i++)
+	{
+		for (int c = 0; c < 3; c++)
+		{
+			min[c] = std::min(min[c], block[i][c]);
+			max[c] = std::max(max[c], block[i][c]);
+			mean[c] += block[i][c];
+		}
+	}
+
+	// The box diagonal runs from min to max on every channel, flip the channels that fall while green rises
+	int covariance[3] = { 0, 0, 0 };
+	for (int i = 0; i < 16; i++)
+	{
+		const int green = block[i][1] * 16 - mean[1];
+		for (int c = 0; c < 3; c++)
+			covariance[c] += (block[i][c] * 16 - mean[c]) * green;
+	}
+
+	for (int c = 0; c < 3; c += 2)
+	{
+		if (covariance[c] < 0)
+			std::swap(min[c], max[c]);
+	}
+
+	// Inset the box a little, the extremes are usually outliers
+	for (int c = 0; c < 3; c++)
+	{
+		const int inset = (max[c] - min[c]) / 16;
+		max[c] = (uint8_t)(max[c] - inset);
+		min[c] = (uint8_t)(min[c] + inset);
+	}
+
+	uint16_t color0 = PackRgb565(max);
+	uint16_t color1 = PackRgb565(min);
+	if (color0 < color1)
+		std::swap(color0, color1);
+
+	WriteUInt16(destination, color0);
+	WriteUInt16(destination + 2, color1);
+
+	uint32_t indices = 0;
+	if (color0 != color1)
+	{
+		// Four color mode because color0 > color1: c0, c1, 2/3 c0 + 1/3 c1, 1/3 c0 + 2/3 c1
+		int palette[4][3];
+		UnpackRgb565(color0, palette[0]);
+		UnpackRgb565(color1, palette[1]);
+		for (int c = 0; c < 3; c++)
+		{
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+
+		for (int i = 0; i < 16; i++)
+		{
+			uint32_t best = 0;
+			int bestDistance = INT32_MAX;
+			for (uint32_t p = 0; p < 4; p++)
+			{
+				int distance = 0;
+				for (int c = 0; c < 3; c++)
+					distance += (block[i][c] - palette[p][c]) * (block[i][c] - palette[p][c]);
+
+				if (distance < bestDistance)
+				{
+					bestDistance = distance;
+					best = p;
+				}
+			}
+
+			indices |= best << (i * 2);
+		}
+	}
+
+	std::memcpy(destination + 4, &indices, sizeof(indices));
+}
+
+static void EncodeChannelBlock(const uint8_t block[16][4], int channel, uint8_t* destination)
+{
+	uint8_t min = 255, max = 0;
+	for (int i = 0; i < 16; i++)
+	{
+		min = std::min(min, block[i][channel]);
+		max = std::max(max, block[i][channel]);
+	}
+
+	// Eight value mode because a0 > a1: a0, a1 and six steps between them
+	destination[0] = max;
+	destination[1] = min;
+
+	uint64_t indices = 0;
+	if (max != min)
+	{
+		for (int i = 0; i < 16; i++)
+		{
+			const int step = (int)std::lround((float)(max - block[i][channel]) * 7.0f / (float)(max - min));
+			const uint64_t index = step == 0 ? 0 : step == 7 ? 1 : (uint64_t)step + 1;
+			indices |= index << (i * 3);
+		}
+	}
+
+	for (int i = 0; i < 6; i++)
+		destination[2 + i] = (uint8_t)(indices >> (i * 8));
+}
+
+void TextureCompressor::EncodeLevel(const uint8_t* rgba, uint32_t width, uint32_t height, BlockFormat format, uint8_t* destination)
+{
+	const uint32_t blockBytes = CompressedImage::GetBlockBytes(format);
+
+	for (uint32_t blockY = 0; blockY < height; blockY += 4)
+	{
+		for (uint32_t blockX = 0; blockX < width; blockX += 4)
+		{
+			// Blocks hanging over the edge repeat the last row and column
+			uint8_t block[16][4];
+			for (uint32_t y = 0; y < 4; y++)
+			{
+				for (uint32_t x = 0; x < 4; x++)
+				{
+					const uint32_t sourceX = std::min(blockX + x, width - 1);
+					const uint32_t sourceY = std::min(blockY + y, height - 1);
+					std::memcpy(block[y * 4 + x], rgba + ((size_t)sourceY * width + sourceX) * 4, 4);
+				}
+			}
+
+			switch (format)
+			{
+				case BlockFormat::BC1:
+					EncodeColorBlock(block, destination);
+					break;
+				case BlockFormat::BC3:
+					EncodeChannelBlock(block, 3, destination);
+					EncodeColorBlock(block, destination + 8);
+					break;
+				case BlockFormat::BC5:
+					EncodeChannelBlock(block, 0, destination);
+					EncodeChannelBlock(block, 1, destination + 8);
+					break;
+				default:
+					break;
+			}
+
+			destination += blockBytes;
+		}
+	}
+}
+
+std::vector<uint8_t> TextureCompressor::EncodeDds(const uint8_t* rgba, uint32_t width, uint32_t height, BlockFormat format)
+{
+	if (format != BlockFormat::BC1 && format != BlockFormat::BC3 && format != BlockFormat::BC5)
+	{
+		std::cerr << "Only BC1, BC3 and BC5 can be encoded\n";
+		return {};
+	}
+
+	const uint32_t levelCount = CompressedImage::GetFullLevelCount(width, height);
+
+	size_t size = 4 + 124;
+	for (uint32_t level = 0; level < levelCount; level++)
+		size += CompressedImage::GetLevelSize(format, std::max(width >> level, 1u), std::max(height >> level, 1u));
+
+	std::vector<uint8_t> dds(size, 0);
+	auto write = [&dds](size_t offset, uint32_t value) { std::memcpy(dds.data() + offset, &value, sizeof(value)); };
+
+	const char* fourCC = format == BlockFormat::BC1 ? "DXT1" : format == BlockFormat::BC3 ? "DXT5" : "ATI2";
+	std::memcpy(dds.data(), "DDS ", 4);
+	write(4, 124);
+	write(8, s_DdsFlags);
+	write(12, height);
+	write(16, width);
+	write(20, (uint32_t)CompressedImage::GetLevelSize(format, width, height));
+	write(28, levelCount);
+	write(76, 32);
+	write(80, s_DdsPixelFormatFourCC);
+	std::memcpy(dds.data() + 84, fourCC, 4);
+	write(108, s_DdsCaps);
+
+	std::vector<uint8_t> level(rgba, rgba + (size_t)width * height * 4);
+	size_t offset = 4 + 124;
+	for (uint32_t i = 0; i < levelCount; i++)
+	{
+		const uint32_t levelWidth = std::max(width >> i, 1u);
+		const uint32_t levelHeight = std::max(height >> i, 1u);
+		EncodeLevel(level.data(), levelWidth, levelHeight, format, dds.data() + offset);
+		offset += CompressedImage::GetLevelSize(format, levelWidth, levelHeight);
+
+		if (i + 1 < levelCount)
+			level = Downsample(level.data(), levelWidth, levelHeight);
+	}
+
+	return dds;
+}
+
+std::vector<uint8_t> TextureCompressor::Resample(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t newWidth, uint32_t newHeight)
+{
+	std::vector<uint8_t> result((size_t)newWidth * newHeight * 4);
+
+	const float scaleX = (float)width / (float)newWidth;
+	const float scaleY = (float)height / (float)newHeight;
+
+	for (uint32_t y = 0; y < newHeight; y++)
+	{
+		const float sourceY = std::clamp(((float)y + 0.5f) * scaleY - 0.5f, 0.0f, (float)(height - 1));
+		const uint32_t y0 = (uint32_t)sourceY;
+		const uint32_t y1 = std::min(y0 + 1, height - 1);
+		const float fy = sourceY - (float)y0;
+
+		for (uint32_t x = 0; x < newWidth; x++)
+		{
+			const float sourceX = std::clamp(((float)x + 0.5f) * scaleX - 0.5f, 0.0f, (float)(width - 1));
+			const uint32_t x0 = (uint32_t)sourceX;
+			const uint32_t x1 = std::min(x0 + 1, width - 1);
+			const float fx = sourceX - (float)x0;
+
+			for (int channel = 0; channel < 4; channel++)
+			{
+				const float top = rgba[((size_t)y0 * width + x0) * 4 + channel] * (1.0f - fx) + rgba[((size_t)y0 * width + x1) * 4 + channel] * fx;
+				const float bottom = rgba[((size_t)y1 * width + x0) * 4 + channel] * (1.0f - fx) + rgba[((size_t)y1 * width + x1) * 4 + channel] * fx;
+				result[((size_t)y * newWidth + x) * 4 + channel] = (uint8_t)std::lround(top * (1.0f - fy) + bottom * fy);
+			}
+		}
+	}
+
+	return result;
+}
+
+std::vector<uint8_t> TextureCompressor::Downsample(const uint8_t* rgba, uint32_t width, uint32_t height)
+{
+	const uint32_t newWidth = std::max(width / 2, 1u);
+	const uint32_t newHeight = std::max(height / 2, 1u);
+	std::vector<uint8_t> result((size_t)newWidth * newHeight * 4);
+
+	for (uint32_t y = 0; y < newHeight; y++)
+	{
+		const uint32_t y0 = std::min(y * 2, height - 1), y1 = std::min(y * 2 + 1, height - 1);
+		for (uint32_t x = 0; x < newWidth; x++)
+		{
+			const uint32_t x0 = std::min(x * 2, width - 1), x1 = std::min(x * 2 + 1, width - 1);
+			for (int channel = 0; channel < 4; channel++)
+			{
+				const uint32_t sum = rgba[((size_t)y0 * width + x0) * 4 + channel] + rgba[((size_t)y0 * width + x1) * 4 + channel]
+					+ rgba[((size_t)y1 * width + x0) * 4 + channel] + rgba[((size_t)y1 * width + x1) * 4 + channel];
+				result[((size_t)y * newWidth + x) * 4 + channel] = (uint8_t)((sum + 2) / 4);
+			}
+		}
+	}
+
+	return result;
+}
+
+bool TextureCompressor::IsOpaque(const uint8_t* rgba, size_t pixelCount)
+{
+	for (size_t i = 0; i < pixelCount; i++)
+	{
+		if (rgba[i * 4 + 3] != 255)
+			return false;
+	}
+
+	return true;
+}
+
+bool TextureCompressor::CompressFile(const std::filesystem::path& source, const std::filesystem::path& destination, BlockFormat format)
+{
+	int width, height, channels;
+	stbi_uc* data = stbi_load(source.string().c_str(), &width, &height, &channels, 4);
+	if (!data)
+	{
+		std::cerr << "Failed to load texture: '" << source.string() << "'\n";
+		return false;
+	}
+
+	// Compressed layers can not be resampled at load time, so they are written at their array size
+	const uint32_t size = TextureArrayManager::CalculateSizeClass(width, height);
+	std::vector<uint8_t> pixels = (uint32_t)width == size && (uint32_t)height == size
+		? std::vector<uint8_t>(data, data + (size_t)width * height * 4)
+		: Resample(data, (uint32_t)width, (uint32_t)height, size, size);
+	stbi_image_free(data);
+
+	if (format == BlockFormat::None)
+		format = IsOpaque(pixels.data(), (size_t)size * size) ? BlockFormat::BC1 : BlockFormat::BC3;
+
+	const std::vector<uint8_t> dds = EncodeDds(pixels.data(), size, size, format);
+	if (dds.empty())
+		return false;
+
+	std::ofstream out(destination, std::ios::out | std::ios::binary);
+	if (!out)
+	{
+		std::cerr << "Could not open '" << destination.string() << "' for writing\n";
+		return false;
+	}
+
+	out.write(reinterpret_cast<const char*>(dds.data()), (std::streamsize)dds.size());
+	return (bool)out;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include "CompressedImage.h"
+
+// CPU encoder for converting source images into DDS files with a full mip chain. BC1/BC3 use a
+// bounding box fit of the block colors and BC5 stores two BC4 channels; BC7 can be loaded but not
+// encoded here, its mode search is too slow to be worth doing without a dedicated library.
+class TextureCompressor
+{
+public:
+	TextureCompressor() = delete;
+	~TextureCompressor() = delete;
+
+	// Decodes the source, resamples it to its texture array size class and writes it as DDS.
+	// BlockFormat::None picks BC1 for opaque images and BC3 for everything else.
+	static bool CompressFile(const std::filesystem::path& source, const std::filesystem::path& destination, BlockFormat format = BlockFormat::None);
+
+	// Rgba is tightly packed RGBA8
+	static std::vector<uint8_t> EncodeDds(const uint8_t* rgba, uint32_t width, uint32_t height, BlockFormat format);
+	static void EncodeLevel(const uint8_t* rgba, uint32_t width, uint32_t height, BlockFormat format, uint8_t* destination);
+
+	static std::vector<uint8_t> Resample(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t newWidth, uint32_t newHeight);
+	// Box filters to half the size, odd edges repeat their last texel
+	static std::vector<uint8_t> Downsample(const uint8_t* rgba, uint32_t width, uint32_t height);
+	static bool IsOpaque(const uint8_t* rgba, size_t pixelCount);
+};
@@ -0,0 +1,80 @@
+#include "TransformHierarchy.h"
+
+#include <glm/gtc/matrix_inverse.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "JobSystem.h"
+
+static constexpr uint32_t s_NormalGrainSize = 1024;
+
+uint32_t TransformHierarchy::Create(uint32_t parent, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+{
+	const uint32_t node = (uint32_t)m_Parents.size();
+
+	m_Parents.push_back(parent < node ? parent : NoParent);
+	m_Positions.push_back(position);
+	m_Rotations.push_back(rotation);
+	m_Scales.push_back(scale);
+	m_Dirty.push_back(1);
+	m_Transforms.emplace_back();
+
+	return node;
+}
+
+void TransformHierarchy::SetPosition(uint32_t node, const glm::vec3& position)
+{
+	m_Positions[node] = position;
+	m_Dirty[node] = 1;
+}
+
+void TransformHierarchy::SetRotation(uint32_t node, const glm::quat& rotation)
+{
+	m_Rotations[node] = rotation;
+	m_Dirty[node] = 1;
+}
+
+void TransformHierarchy::SetScale(uint32_t node, const glm::vec3& scale)
+{
+	m_Scales[node] = scale;
+	m_Dirty[node] = 1;
+}
+
+void TransformHierarchy::Update()
+{
+	m_UpdatedNodes.clear();
+
+	// Parents always come first, so their world matrix and dirty flag are final by the time a child is reached
+	const uint32_t count = GetCount();
+	for (uint32_t node = 0; node < count; node++)
+	{
+		const uint32_t parent = m_Parents[node];
+		if (parent != NoParent && m_Dirty[parent])
+			m_Dirty[node] = 1;
+
+		if (!m_Dirty[node])
+			continue;
+
+		const glm::mat4 local = glm::translate(glm::mat4(1.0f), m_Positions[node])
+			* glm::mat4_cast(m_Rotations[node])
+			* glm::scale(glm::mat4(1.0f), m_Scales[node]);
+
+		m_Transforms[node].Model = parent == NoParent ? local : m_Transforms[parent].Model * local;
+		m_UpdatedNodes.push_back(node);
+	}
+
+	if (m_UpdatedNodes.empty())
+		return;
+
+	// The inverse is the expensive part and has no ordering constraints, unlike the propagation above
+	JobCounter counter;
+	JobSystem::ParallelFor((uint32_t)m_UpdatedNodes.size(), s_NormalGrainSize, [this](uint32_t begin, uint32_t end)
+	{
+		for (uint32_t i = begin; i < end; i++)
+		{
+			const uint32_t node = m_UpdatedNodes[i];
+			m_Transforms[node].Normal = glm::mat4(glm::inverseTranspose(glm::mat3(m_Transforms[node].Model)));
+			m_Dirty[node] = 0;
+		}
+	}, &counter);
+	JobSystem::WaitFor(counter);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// Layout of one element of the transform storage buffer, matches Transforms.glsl
+struct ObjectTransform
+{
+	glm::mat4 Model{ 1.0f };
+	// Inverse transpose of the model matrix, only the upper 3x3 is used
+	glm::mat4 Normal{ 1.0f };
+};
+
+// Local transforms stored as separate arrays in parent before child order, so the world matrices
+// are resolved with a single forward pass. Only nodes that changed, or whose parent did, are
+// recomputed, and the nodes touched by the last update form one range for a partial GPU upload.
+class TransformHierarchy
+{
+public:
+	TransformHierarchy() = default;
+	~TransformHierarchy() = default;
+
+	static constexpr uint32_t NoParent = UINT32_MAX;
+
+	// The parent has to exist already, which is what keeps the arrays in parent before child order
+	uint32_t Create(uint32_t parent = NoParent, const glm::vec3& position = glm::vec3(0.0f), const glm::quat& rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f), const glm::vec3& scale = glm::vec3(1.0f));
+
+	void SetPosition(uint32_t node, const glm::vec3& position);
+	void SetRotation(uint32_t node, const glm::quat& rotation);
+	void SetScale(uint32_t node, const glm::vec3& scale);
+
+	const glm::vec3& GetPosition(uint32_t node) const { return m_Positions[node]; }
+	const glm::quat& GetRotation(uint32_t node) const { return m_Rotations[node]; }
+	const glm::vec3& GetScale(uint32_t node) const { return m_Scales[node]; }
+	uint32_t GetParent(uint32_t node) const { return m_Parents[node]; }
+
+	// Propagates dirty subtrees and recomputes their normal matrices on the job system
+	void Update();
+
+	const glm::mat4& GetWorldMatrix(uint32_t node) const { return m_Transforms[node].Model; }
+	const std::vector<ObjectTransform>& GetTransforms() const { return m_Transforms; }
+	uint32_t GetCount() const { return (uint32_t)m_Parents.size(); }
+
+	// Nodes recomputed by the last update, [begin, end) is empty when nothing changed
+	uint32_t GetUpdatedCount() const { return (uint32_t)m_UpdatedNodes.size(); }
+	uint32_t GetUpdatedBegin() const { return m_UpdatedNodes.empty() ? 0 : m_UpdatedNodes.front(); }
+	uint32_t GetUpdatedEnd() const { return m_UpdatedNodes.empty() ? 0 : m_UpdatedNodes.back() + 1; }
+
+private:
+	std::vector<uint32_t> m_Parents;
+	std::vector<glm::vec3> m_Positions;
+	std::vector<glm::quat> m_Rotations;
+	std::vector<glm::vec3> m_Scales;
+	std::vector<uint8_t> m_Dirty;
+
+	std::vector<ObjectTransform> m_Transforms;
+	std::vector<uint32_t> m_UpdatedNodes;
+};
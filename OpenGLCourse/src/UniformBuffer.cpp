@@ -3,20 +3,20 @@
 #include <cstdio>
 #include <glad/glad.h>
 
+
 UniformBuffer::UniformBuffer(size_t size, uint32_t binding)
 	: m_Size(size)
 {
-	glCreateBuffers(1, &m_RendererId);
-	glNamedBufferData(m_RendererId, size, nullptr, GL_DYNAMIC_DRAW);
-	glBindBufferBase(GL_UNIFORM_BUFFER, binding, m_RendererId);
+	m_Buffer = GpuResources::CreateBuffer({ size, GL_DYNAMIC_STORAGE_BIT }, nullptr, GpuMemoryCategory::Buffers);
+	glBindBufferBase(GL_UNIFORM_BUFFER, binding, GpuResources::GetId(m_Buffer));
 }
 
 UniformBuffer::~UniformBuffer()
 {
-	glDeleteBuffers(1, &m_RendererId);
+	GpuResources::Destroy(m_Buffer);
 }
 
 void UniformBuffer::SetData(const void* data, uint32_t offset) const
 {
-	glNamedBufferSubData(m_RendererId, offset, (GLsizeiptr)m_Size, data);
+	glNamedBufferSubData(GpuResources::GetId(m_Buffer), offset, (GLsizeiptr)m_Size, data);
 }
@@ -2,6 +2,8 @@
 
 #include <cstdint>
 
+#include "GpuResources.h"
+
 class UniformBuffer
 {
 public:
@@ -13,5 +15,5 @@ public:
 
 private:
 	size_t m_Size = 0;
-	uint32_t m_RendererId = 0;
+	GpuBufferHandle m_Buffer;
 };
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Uniform locations of a linked program by name. Filled once after linking, so uploads look names
+// up on the CPU instead of asking the driver every time. Needs no context itself.
+class UniformLocations
+{
+public:
+	void Clear() { m_Locations.clear(); }
+	void Add(std::string_view name, int32_t location) { m_Locations.emplace(name, location); }
+
+	// -1 for names the program does not use, which glUniform* ignores like glGetUniformLocation's
+	int32_t Find(std::string_view name) const
+	{
+		const auto it = m_Locations.find(name);
+		return it != m_Locations.end() ? it->second : -1;
+	}
+
+	size_t GetCount() const { return m_Locations.size(); }
+
+private:
+	// Lets string views and literals be looked up without building a std::string
+	struct NameHash
+	{
+		using is_transparent = void;
+		size_t operator()(std::string_view name) const { return std::hash<std::string_view>()(name); }
+	};
+
+	std::unordered_map<std::string, int32_t, NameHash, std::equal_to<>> m_Locations;
+};
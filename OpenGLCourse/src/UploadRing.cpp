@@ -0,0 +1,92 @@
+#include "UploadRing.h"
+
+#include <glad/glad.h>
+
+// Enough for compressed blocks and any GL_UNPACK_ALIGNMENT
+static constexpr size_t s_Alignment = 16;
+
+UploadRing::UploadRing(size_t capacity)
+	: m_Capacity(capacity)
+{
+	constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+	m_Buffer = GpuResources::CreateBuffer({ capacity, flags }, nullptr, GpuMemoryCategory::Buffers);
+	m_Mapped = static_cast<uint8_t*>(glMapNamedBufferRange(GpuResources::GetId(m_Buffer), 0, (GLsizeiptr)capacity, flags));
+}
+
+UploadRing::~UploadRing()
+{
+	for (const InFlight& frame : m_InFlight)
+		glDeleteSync(static_cast<GLsync>(frame.Fence));
+
+	// A buffer is only recycled unmapped
+	if (m_Mapped)
+		glUnmapNamedBuffer(GpuResources::GetId(m_Buffer));
+
+	GpuResources::Destroy(m_Buffer);
+}
+
+void UploadRing::Retire()
+{
+	size_t retired = 0;
+	for (; retired < m_InFlight.size(); retired++)
+	{
+		const InFlight& frame = m_InFlight[retired];
+		const GLenum status = glClientWaitSync(static_cast<GLsync>(frame.Fence), 0, 0);
+		if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+			break;
+
+		glDeleteSync(static_cast<GLsync>(frame.Fence));
+		m_Used -= frame.Bytes;
+	}
+
+	m_InFlight.erase(m_InFlight.begin(), m_InFlight.begin() + retired);
+}
+
+bool UploadRing::Allocate(size_t size, size_t& offset)
+{
+	size = (size + s_Alignment - 1) & ~(s_Alignment - 1);
+	if (!m_Mapped || size > m_Capacity)
+		return false;
+
+	Retire();
+
+	// Allocations never wrap, the end of the ring is skipped and counted as used instead
+	offset = m_Head;
+	size_t skipped = 0;
+	if (offset + size > m_Capacity)
+	{
+		skipped = m_Capacity - offset;
+		offset = 0;
+	}
+
+	if (m_Used + skipped + size > m_Capacity)
+		return false;
+
+	m_Head = offset + size == m_Capacity ? 0 : offset + size;
+	m_Used += skipped + size;
+	m_FrameBytes += skipped + size;
+	return true;
+}
+
+void UploadRing::EndFrame()
+{
+	if (m_FrameBytes == 0)
+		return;
+
+	InFlight frame;
+	frame.Bytes = m_FrameBytes;
+	frame.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	m_InFlight.push_back(frame);
+	m_FrameBytes = 0;
+}
+
+void UploadRing::Bind() const
+{
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, GpuResources::GetId(m_Buffer));
+}
+
+void UploadRing::Unbind() const
+{
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
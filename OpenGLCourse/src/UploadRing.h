@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "GpuResources.h"
+
+// Persistently mapped GL_PIXEL_UNPACK_BUFFER used as a ring. Everything allocated during a frame is
+// fenced by EndFrame and its space only handed out again once the GPU has passed the fence, so
+// writing into the ring never waits on the driver.
+class UploadRing
+{
+public:
+	UploadRing(size_t capacity);
+	~UploadRing();
+
+	UploadRing(const UploadRing&) = delete;
+	UploadRing& operator=(const UploadRing&) = delete;
+
+	// False when the space is still in flight, try again next frame
+	bool Allocate(size_t size, size_t& offset);
+	uint8_t* GetPointer(size_t offset) const { return m_Mapped + offset; }
+	void EndFrame();
+
+	// While bound, texture uploads read from the ring and take offsets instead of pointers
+	void Bind() const;
+	void Unbind() const;
+
+	size_t GetCapacity() const { return m_Capacity; }
+
+private:
+	void Retire();
+
+private:
+	struct InFlight
+	{
+		size_t Bytes = 0;
+		// GLsync, kept opaque so the header does not need glad
+		void* Fence = nullptr;
+	};
+
+	GpuBufferHandle m_Buffer;
+	uint8_t* m_Mapped = nullptr;
+	size_t m_Capacity = 0;
+
+	size_t m_Head = 0;
+	size_t m_Used = 0;
+	size_t m_FrameBytes = 0;
+	// Oldest first. Only a few frames are ever in flight, a vector never allocates again once it has seen them.
+	std::vector<InFlight> m_InFlight;
+};
@@ -1,5 +1,6 @@
 #include "Utils.h"
 
+#include <cstring>
 #include <fstream>
 #include <iostream>
 
@@ -31,3 +32,47 @@ std::string Utils::ReadFileToString(const std::filesystem::path& filepath)
 
 	return result;
 }
+
+std::vector<uint8_t> Utils::ReadFileToBytes(const std::filesystem::path& filepath)
+{
+	std::vector<uint8_t> result;
+	std::ifstream in(filepath, std::ios::in | std::ios::binary | std::ios::ate);
+	if (!in)
+		return result;
+
+	const std::streamoff size = in.tellg();
+	if (size <= 0)
+		return result;
+
+	result.resize((size_t)size);
+	in.seekg(0, std::ios::beg);
+	in.read(reinterpret_cast<char*>(result.data()), size);
+	return result;
+}
+
+uint64_t Utils::Hash(const void* data, size_t size)
+{
+	// FNV style mixing 8 bytes at a time, with a final avalanche so similar files spread out
+	constexpr uint64_t prime = 0x100000001B3ull;
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	uint64_t hash = 0xCBF29CE484222325ull ^ size;
+
+	size_t i = 0;
+	for (; i + 8 <= size; i += 8)
+	{
+		uint64_t word;
+		std::memcpy(&word, bytes + i, sizeof(word));
+		hash = (hash ^ word) * prime;
+		hash ^= hash >> 29;
+	}
+
+	for (; i < size; i++)
+		hash = (hash ^ bytes[i]) * prime;
+
+	hash ^= hash >> 33;
+	hash *= 0xFF51AFD7ED558CCDull;
+	hash ^= hash >> 33;
+	hash *= 0xC4CEB93FE1A85EC9ull;
+	hash ^= hash >> 33;
+	return hash;
+}
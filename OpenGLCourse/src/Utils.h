@@ -1,10 +1,16 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <filesystem>
+#include <vector>
 
 class Utils
 {
 public:
 	static std::string ReadFileToString(const std::filesystem::path& filepath);
+	// Empty when the file can not be read
+	static std::vector<uint8_t> ReadFileToBytes(const std::filesystem::path& filepath);
+	// 64 bit hash of a block of memory, for content keys and not for anything security related
+	static uint64_t Hash(const void* data, size_t size);
 };
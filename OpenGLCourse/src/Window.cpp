@@ -48,7 +48,7 @@ bool Window::Init()
 		return false;
 	}
 
-	glfwSwapInterval(1);
+	glfwSwapInterval(m_WindowProps.VSync ? 1 : 0);
 	// SetEvents();
 
 	return true;
@@ -65,6 +65,26 @@ void Window::OnUpdate() const
 	glfwSwapBuffers(m_Window);
 }
 
+void Window::PollEvents() const
+{
+	glfwPollEvents();
+}
+
+void Window::SwapBuffers() const
+{
+	glfwSwapBuffers(m_Window);
+}
+
+void Window::MakeContextCurrent() const
+{
+	glfwMakeContextCurrent(m_Window);
+}
+
+void Window::DetachContext() const
+{
+	glfwMakeContextCurrent(nullptr);
+}
+
 void Window::Close()
 {
 	glfwSetWindowShouldClose(m_Window, true);
@@ -111,7 +131,8 @@ void Window::CreateGlfwWindow()
 		monitorY + (int32_t)((videoMode->height - m_WindowProps.Height) / 2));
 
 	// Finally show the window and increase the window count
-	glfwShowWindow(m_Window);
+	if (m_WindowProps.Visible)
+		glfwShowWindow(m_Window);
 	s_GLFWWindowCount++;
 }
 
@@ -10,6 +10,9 @@ struct WindowProps
 {
 	std::string Title;
 	uint32_t Width, Height;
+	bool VSync = true;
+	// Hidden windows still get a context, for runs without anyone watching
+	bool Visible = true;
 
 	WindowProps(const std::string& title = "Hazel Engine",
 		uint32_t width = 1280,
@@ -30,8 +33,13 @@ public:
 	bool Init();
 	bool ShouldClose() const;
 	void OnUpdate() const;
+	void PollEvents() const;
+	void SwapBuffers() const;
 	void Close();
 
+	void MakeContextCurrent() const;
+	void DetachContext() const;
+
 	void SetEventCallback(const EventCallbackFunction& callback) { m_EventCallback = callback; }
 
 	float GetCurrentTime() const;
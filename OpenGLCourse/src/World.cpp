@@ -0,0 +1,235 @@
+#include "World.h"
+
+#include <bit>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+
+// Ids are handed out once per type from the static in ComponentId, so reads after that need no lock
+static std::mutex s_RegistryMutex;
+static ComponentRegistry::Info s_ComponentInfos[ComponentRegistry::MaxComponentTypes];
+static uint32_t s_ComponentCount = 0;
+
+uint32_t ComponentRegistry::Register(uint32_t size, uint32_t alignment)
+{
+	std::scoped_lock lock(s_RegistryMutex);
+
+	if (s_ComponentCount >= MaxComponentTypes)
+	{
+		std::cerr << "Too many component types, the limit is " << MaxComponentTypes << '\n';
+		std::abort();
+	}
+
+	s_ComponentInfos[s_ComponentCount] = { size, alignment };
+	return s_ComponentCount++;
+}
+
+const ComponentRegistry::Info& ComponentRegistry::Get(uint32_t id)
+{
+	return s_ComponentInfos[id];
+}
+
+static uint32_t AlignUp(uint32_t value, uint32_t alignment)
+{
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+World::World()
+{
+	// Entities without components live here
+	FindOrCreateArchetype(0);
+}
+
+Entity World::Create()
+{
+	return AllocateEntity(0);
+}
+
+void World::Destroy(Entity entity)
+{
+	if (!IsAlive(entity))
+		return;
+
+	Record& record = m_Records[entity.Index];
+	FreeRow(*m_Archetypes[record.Archetype], record.Chunk, record.Row);
+
+	record.Generation++;
+	m_FreeRecords.push_back(entity.Index);
+	m_AliveCount--;
+}
+
+bool World::IsAlive(Entity entity) const
+{
+	return entity.Index < m_Records.size() && m_Records[entity.Index].Generation == entity.Generation;
+}
+
+void World::QueryChunks(ComponentMask mask, std::vector<ChunkView>& chunks) const
+{
+	chunks.clear();
+	for (const auto& archetype : m_Archetypes)
+	{
+		if ((archetype->Mask & mask) != mask)
+			continue;
+
+		for (const Chunk& chunk : archetype->Chunks)
+			chunks.emplace_back(*archetype, chunk);
+	}
+}
+
+uint32_t World::FindOrCreateArchetype(ComponentMask mask)
+{
+	if (const auto it = m_ArchetypeLookup.find(mask); it != m_ArchetypeLookup.end())
+		return it->second;
+
+	auto archetype = std::make_unique<Archetype>();
+	archetype->Mask = mask;
+	for (uint32_t& offset : archetype->Offsets)
+		offset = Archetype::NoOffset;
+
+	uint32_t rowSize = sizeof(Entity);
+	for (ComponentMask bits = mask; bits; bits &= bits - 1)
+	{
+		const uint32_t id = (uint32_t)std::countr_zero(bits);
+		archetype->Components.push_back(id);
+		rowSize += ComponentRegistry::Get(id).Size;
+	}
+
+	// Start from the unpadded estimate and shrink until the aligned arrays fit in one chunk
+	auto layoutSize = [&](uint32_t capacity)
+	{
+		uint32_t offset = sizeof(Entity) * capacity;
+		for (const uint32_t id : archetype->Components)
+		{
+			const ComponentRegistry::Info& info = ComponentRegistry::Get(id);
+			offset = AlignUp(offset, info.Alignment) + info.Size * capacity;
+		}
+		return offset;
+	};
+
+	uint32_t capacity = (uint32_t)Chunk::Size / rowSize;
+	while (capacity > 1 && layoutSize(capacity) > Chunk::Size)
+		capacity--;
+
+	archetype->Capacity = capacity;
+
+	uint32_t offset = sizeof(Entity) * capacity;
+	for (const uint32_t id : archetype->Components)
+	{
+		const ComponentRegistry::Info& info = ComponentRegistry::Get(id);
+		offset = AlignUp(offset, info.Alignment);
+		archetype->Offsets[id] = offset;
+		offset += info.Size * capacity;
+	}
+
+	const uint32_t index = (uint32_t)m_Archetypes.size();
+	m_Archetypes.push_back(std::move(archetype));
+	m_ArchetypeLookup[mask] = index;
+	return index;
+}
+
+Entity World::AllocateEntity(uint32_t archetype)
+{
+	uint32_t index;
+	if (!m_FreeRecords.empty())
+	{
+		index = m_FreeRecords.back();
+		m_FreeRecords.pop_back();
+	}
+	else
+	{
+		index = (uint32_t)m_Records.size();
+		m_Records.emplace_back();
+	}
+
+	Record& record = m_Records[index];
+	record.Archetype = archetype;
+
+	Archetype& target = *m_Archetypes[archetype];
+	AllocateRow(target, record.Chunk, record.Row);
+
+	const Entity entity{ index, record.Generation };
+	reinterpret_cast<Entity*>(target.Chunks[record.Chunk].Data.get())[record.Row] = entity;
+
+	m_AliveCount++;
+	return entity;
+}
+
+void World::AllocateRow(Archetype& archetype, uint32_t& chunk, uint32_t& row)
+{
+	if (archetype.Chunks.empty() || archetype.Chunks.back().Count == archetype.Capacity)
+	{
+		Chunk& newChunk = archetype.Chunks.emplace_back();
+		newChunk.Data = std::make_unique<std::byte[]>(Chunk::Size);
+	}
+
+	chunk = (uint32_t)archetype.Chunks.size() - 1;
+	row = archetype.Chunks.back().Count++;
+	archetype.EntityCount++;
+}
+
+void World::FreeRow(Archetype& archetype, uint32_t chunk, uint32_t row)
+{
+	Chunk& last = archetype.Chunks.back();
+	const uint32_t lastChunk = (uint32_t)archetype.Chunks.size() - 1;
+	const uint32_t lastRow = last.Count - 1;
+
+	if (chunk != lastChunk || row != lastRow)
+	{
+		std::byte* destination = archetype.Chunks[chunk].Data.get();
+		const std::byte* source = last.Data.get();
+
+		for (const uint32_t id : archetype.Components)
+		{
+			const uint32_t size = ComponentRegistry::Get(id).Size;
+			memcpy(destination + archetype.Offsets[id] + size * row, source + archetype.Offsets[id] + size * lastRow, size);
+		}
+
+		const Entity moved = reinterpret_cast<const Entity*>(source)[lastRow];
+		reinterpret_cast<Entity*>(destination)[row] = moved;
+		m_Records[moved.Index].Chunk = chunk;
+		m_Records[moved.Index].Row = row;
+	}
+
+	if (--last.Count == 0)
+		archetype.Chunks.pop_back();
+
+	archetype.EntityCount--;
+}
+
+void World::MoveToArchetype(Entity entity, ComponentMask mask)
+{
+	if (!IsAlive(entity))
+		return;
+
+	const uint32_t sourceIndex = m_Records[entity.Index].Archetype;
+	if (m_Archetypes[sourceIndex]->Mask == mask)
+		return;
+
+	const uint32_t targetIndex = FindOrCreateArchetype(mask);
+	Archetype& source = *m_Archetypes[sourceIndex];
+	Archetype& target = *m_Archetypes[targetIndex];
+
+	Record& record = m_Records[entity.Index];
+	uint32_t chunk, row;
+	AllocateRow(target, chunk, row);
+
+	std::byte* destination = target.Chunks[chunk].Data.get();
+	const std::byte* origin = source.Chunks[record.Chunk].Data.get();
+	reinterpret_cast<Entity*>(destination)[row] = entity;
+
+	// Components the target does not have are dropped, new ones are left for the caller to fill
+	for (const uint32_t id : target.Components)
+	{
+		const uint32_t size = ComponentRegistry::Get(id).Size;
+		if (source.Offsets[id] != Archetype::NoOffset)
+			memcpy(destination + target.Offsets[id] + size * row, origin + source.Offsets[id] + size * record.Row, size);
+		else
+			memset(destination + target.Offsets[id] + size * row, 0, size);
+	}
+
+	FreeRow(source, record.Chunk, record.Row);
+
+	record.Archetype = targetIndex;
+	record.Chunk = chunk;
+	record.Row = row;
+}
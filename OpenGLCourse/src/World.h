@@ -0,0 +1,274 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "JobSystem.h"
+
+struct Entity
+{
+	static constexpr uint32_t InvalidIndex = UINT32_MAX;
+
+	uint32_t Index = InvalidIndex;
+	uint32_t Generation = 0;
+
+	bool IsValid() const { return Index != InvalidIndex; }
+	bool operator==(const Entity& other) const = default;
+};
+
+using ComponentMask = uint64_t;
+
+// Components are plain data, they are moved between chunks with memcpy and never destructed
+class ComponentRegistry
+{
+public:
+	ComponentRegistry() = delete;
+	~ComponentRegistry() = delete;
+
+	static constexpr uint32_t MaxComponentTypes = 64;
+
+	struct Info
+	{
+		uint32_t Size = 0;
+		uint32_t Alignment = 0;
+	};
+
+	static uint32_t Register(uint32_t size, uint32_t alignment);
+	static const Info& Get(uint32_t id);
+};
+
+template<typename T>
+uint32_t ComponentId()
+{
+	static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>, "Components have to be plain data");
+	static_assert(alignof(T) <= alignof(std::max_align_t), "Chunks are only aligned to max_align_t");
+
+	static const uint32_t id = ComponentRegistry::Register((uint32_t)sizeof(T), (uint32_t)alignof(T));
+	return id;
+}
+
+template<typename... Ts>
+ComponentMask MaskOf()
+{
+	return (ComponentMask(0) | ... | (ComponentMask(1) << ComponentId<Ts>()));
+}
+
+// Fixed size block holding the entities of one archetype, every component in its own contiguous array
+struct Chunk
+{
+	static constexpr size_t Size = 16 * 1024;
+
+	std::unique_ptr<std::byte[]> Data;
+	uint32_t Count = 0;
+};
+
+struct Archetype
+{
+	static constexpr uint32_t NoOffset = UINT32_MAX;
+
+	ComponentMask Mask = 0;
+	std::vector<uint32_t> Components;
+	// Byte offset of each component array inside a chunk, indexed by component id
+	uint32_t Offsets[ComponentRegistry::MaxComponentTypes];
+	uint32_t Capacity = 0;
+	uint32_t EntityCount = 0;
+	std::vector<Chunk> Chunks;
+};
+
+// What a query hands out: the rows of one chunk
+class ChunkView
+{
+public:
+	ChunkView(const Archetype& archetype, const Chunk& chunk)
+		: m_Archetype(&archetype), m_Chunk(&chunk) {}
+
+	uint32_t GetCount() const { return m_Chunk->Count; }
+	const Entity* GetEntities() const { return reinterpret_cast<const Entity*>(m_Chunk->Data.get()); }
+
+	template<typename T>
+	bool Has() const { return (m_Archetype->Mask & MaskOf<T>()) != 0; }
+
+	// nullptr when the archetype does not have the component
+	template<typename T>
+	T* Get() const
+	{
+		const uint32_t offset = m_Archetype->Offsets[ComponentId<T>()];
+		return offset == Archetype::NoOffset ? nullptr : reinterpret_cast<T*>(m_Chunk->Data.get() + offset);
+	}
+
+private:
+	const Archetype* m_Archetype;
+	const Chunk* m_Chunk;
+};
+
+// Archetype based entity storage. Entities with the same set of components share chunks, so a
+// query walks a handful of dense arrays instead of chasing one pointer per object. Structural
+// changes (create, destroy, add, remove) must not happen while a query is running.
+class World
+{
+public:
+	World();
+	~World() = default;
+
+	World(const World&) = delete;
+	World& operator=(const World&) = delete;
+
+	Entity Create();
+
+	// Places the entity straight into its final archetype
+	template<typename... Ts>
+	Entity Create(const Ts&... components)
+	{
+		const Entity entity = AllocateEntity(FindOrCreateArchetype(MaskOf<Ts...>()));
+		(Set(entity, components), ...);
+		return entity;
+	}
+
+	void Destroy(Entity entity);
+	bool IsAlive(Entity entity) const;
+
+	// nullptr when the entity is not alive
+	template<typename T>
+	T* Add(Entity entity, const T& component = T())
+	{
+		if (!IsAlive(entity))
+			return nullptr;
+
+		const uint32_t id = ComponentId<T>();
+		MoveToArchetype(entity, m_Archetypes[m_Records[entity.Index].Archetype]->Mask | (ComponentMask(1) << id));
+		T* destination = Get<T>(entity);
+		*destination = component;
+		return destination;
+	}
+
+	template<typename T>
+	void Remove(Entity entity)
+	{
+		if (!IsAlive(entity))
+			return;
+
+		MoveToArchetype(entity, m_Archetypes[m_Records[entity.Index].Archetype]->Mask & ~(ComponentMask(1) << ComponentId<T>()));
+	}
+
+	template<typename T>
+	bool Has(Entity entity) const
+	{
+		return IsAlive(entity) && (m_Archetypes[m_Records[entity.Index].Archetype]->Mask & MaskOf<T>()) != 0;
+	}
+
+	// nullptr when the entity does not have the component
+	template<typename T>
+	T* Get(Entity entity) const
+	{
+		if (!IsAlive(entity))
+			return nullptr;
+
+		const Record& record = m_Records[entity.Index];
+		const Archetype& archetype = *m_Archetypes[record.Archetype];
+		const uint32_t offset = archetype.Offsets[ComponentId<T>()];
+		if (offset == Archetype::NoOffset)
+			return nullptr;
+
+		return reinterpret_cast<T*>(archetype.Chunks[record.Chunk].Data.get() + offset) + record.Row;
+	}
+
+	template<typename T>
+	void Set(Entity entity, const T& component)
+	{
+		if (T* destination = Get<T>(entity))
+			*destination = component;
+	}
+
+	// Every non empty chunk whose archetype has at least the given components
+	template<typename... Ts>
+	void QueryChunks(std::vector<ChunkView>& chunks) const { QueryChunks(MaskOf<Ts...>(), chunks); }
+	void QueryChunks(ComponentMask mask, std::vector<ChunkView>& chunks) const;
+
+	template<typename... Ts>
+	uint32_t Count() const
+	{
+		const ComponentMask mask = MaskOf<Ts...>();
+		uint32_t count = 0;
+		for (const auto& archetype : m_Archetypes)
+		{
+			if ((archetype->Mask & mask) == mask)
+				count += archetype->EntityCount;
+		}
+
+		return count;
+	}
+
+	// fn(Entity, Ts&...) for every matching entity, in chunk order
+	template<typename... Ts, typename Fn>
+	void Each(Fn&& fn) const
+	{
+		const ComponentMask mask = MaskOf<Ts...>();
+		for (const auto& archetype : m_Archetypes)
+		{
+			if ((archetype->Mask & mask) != mask)
+				continue;
+
+			for (const Chunk& chunk : archetype->Chunks)
+				EachInChunk<Ts...>(ChunkView(*archetype, chunk), fn);
+		}
+	}
+
+	// Same as Each with one job per chunk, fn must not touch anything other chunks write to
+	template<typename... Ts, typename Fn>
+	void ParallelEach(Fn&& fn) const
+	{
+		std::vector<ChunkView> chunks;
+		QueryChunks<Ts...>(chunks);
+
+		JobCounter counter;
+		JobSystem::ParallelFor((uint32_t)chunks.size(), 1, [&](uint32_t begin, uint32_t end)
+		{
+			for (uint32_t i = begin; i < end; i++)
+				EachInChunk<Ts...>(chunks[i], fn);
+		}, &counter);
+		JobSystem::WaitFor(counter);
+	}
+
+	uint32_t GetEntityCount() const { return m_AliveCount; }
+	uint32_t GetArchetypeCount() const { return (uint32_t)m_Archetypes.size(); }
+
+private:
+	struct Record
+	{
+		uint32_t Archetype = 0;
+		uint32_t Chunk = 0;
+		uint32_t Row = 0;
+		uint32_t Generation = 0;
+	};
+
+	template<typename... Ts, typename Fn>
+	static void EachInChunk(const ChunkView& chunk, Fn& fn)
+	{
+		const Entity* entities = chunk.GetEntities();
+		auto arrays = std::make_tuple(chunk.Get<Ts>()...);
+		for (uint32_t row = 0; row < chunk.GetCount(); row++)
+			std::apply([&](auto*... components) { fn(entities[row], components[row]...); }, arrays);
+	}
+
+	uint32_t FindOrCreateArchetype(ComponentMask mask);
+	Entity AllocateEntity(uint32_t archetype);
+	// Stores the entity in a new row of the archetype and returns where it landed
+	void AllocateRow(Archetype& archetype, uint32_t& chunk, uint32_t& row);
+	// Fills the hole with the last row of the archetype so the chunks stay dense
+	void FreeRow(Archetype& archetype, uint32_t chunk, uint32_t row);
+	void MoveToArchetype(Entity entity, ComponentMask mask);
+
+private:
+	std::vector<std::unique_ptr<Archetype>> m_Archetypes;
+	std::unordered_map<ComponentMask, uint32_t> m_ArchetypeLookup;
+
+	std::vector<Record> m_Records;
+	std::vector<uint32_t> m_FreeRecords;
+	uint32_t m_AliveCount = 0;
+};
@@ -0,0 +1,48 @@
+project "StressTests"
+	kind "ConsoleApp"
+	language "C++"
+	cppdialect "C++20"
+	staticruntime "off"
+
+	-- Concurrency tests of the engine's threading code. They only prove much under ThreadSanitizer,
+	-- which needs gcc or clang: premake5 gmake2 --cc=clang, then make config=debug StressTests.
+	files
+	{
+		"src/**.h",
+		"src/**.cpp",
+		"%{wks.location}/OpenGLCourse/src/FrameArena.h",
+		"%{wks.location}/OpenGLCourse/src/FrameArena.cpp",
+		"%{wks.location}/OpenGLCourse/src/JobSystem.h",
+		"%{wks.location}/OpenGLCourse/src/JobSystem.cpp"
+	}
+
+	includedirs
+	{
+		"src",
+		"%{wks.location}/OpenGLCourse/src"
+	}
+
+	targetdir ("../bin/" .. outputdir .. "/%{prj.name}")
+	objdir ("../bin-int/" .. outputdir .. "/%{prj.name}")
+
+	filter "system:windows"
+		systemversion "latest"
+		defines { "APP_PLATFORM_WINDOWS" }
+
+	filter "system:linux"
+		links { "pthread" }
+
+	filter "toolset:gcc or toolset:clang"
+		buildoptions { "-fsanitize=thread" }
+		linkoptions { "-fsanitize=thread" }
+
+	filter "configurations:Debug"
+		defines { "APP_DEBUG" }
+		runtime "Debug"
+		symbols "On"
+
+	filter "configurations:Release or Dist"
+		defines { "APP_RELEASE" }
+		runtime "Release"
+		optimize "On"
+		symbols "On"
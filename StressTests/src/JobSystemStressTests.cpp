@@ -0,0 +1,206 @@
+#include "JobSystemStressTests.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "JobSystem.h"
+
+// Returns an empty string when the test passed, otherwise what went wrong
+using StressTestFunction = std::string(*)();
+
+struct StressTest
+{
+	const char* Name;
+	StressTestFunction Function;
+};
+
+// Every index of a loop with more jobs than the job ring holds has to be visited exactly once
+static std::string CheckVisitedOnce(const std::unique_ptr<std::atomic<uint32_t>[]>& visits, uint32_t count)
+{
+	uint32_t missed = 0;
+	uint32_t repeated = 0;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		const uint32_t visitCount = visits[i].load(std::memory_order_relaxed);
+		missed += visitCount == 0;
+		repeated += visitCount > 1;
+	}
+
+	if (missed == 0 && repeated == 0)
+		return {};
+
+	return std::to_string(missed) + " of " + std::to_string(count) + " indices not visited, " + std::to_string(repeated) + " visited more than once";
+}
+
+static std::string ParallelForOverflowsRing()
+{
+	const uint32_t count = JobSystem::JobRingSize * 5 + 17;
+	auto visits = std::make_unique<std::atomic<uint32_t>[]>(count);
+
+	JobCounter counter;
+	JobSystem::ParallelFor(count, 1, [&visits](uint32_t begin, uint32_t end)
+	{
+		for (uint32_t i = begin; i < end; i++)
+			visits[i].fetch_add(1, std::memory_order_relaxed);
+	}, &counter);
+	JobSystem::WaitFor(counter);
+
+	return CheckVisitedOnce(visits, count);
+}
+
+// Jobs that queue and wait for jobs of their own, from the worker rings
+static std::string NestedParallelFor()
+{
+	const uint32_t outerCount = 64;
+	const uint32_t innerCount = JobSystem::JobRingSize + 100;
+	const uint32_t count = outerCount * innerCount;
+	auto visits = std::make_unique<std::atomic<uint32_t>[]>(count);
+
+	JobCounter counter;
+	JobSystem::ParallelFor(outerCount, 1, [&visits, innerCount](uint32_t begin, uint32_t end)
+	{
+		for (uint32_t outer = begin; outer < end; outer++)
+		{
+			JobCounter innerCounter;
+			JobSystem::ParallelFor(innerCount, 7, [&visits, outer, innerCount](uint32_t innerBegin, uint32_t innerEnd)
+			{
+				for (uint32_t i = innerBegin; i < innerEnd; i++)
+					visits[outer * innerCount + i].fetch_add(1, std::memory_order_relaxed);
+			}, &innerCounter);
+			JobSystem::WaitFor(innerCounter);
+		}
+	}, &counter);
+	JobSystem::WaitFor(counter);
+
+	return CheckVisitedOnce(visits, count);
+}
+
+// Each stage may only start once the one before it has finished completely
+static std::string RunAfterChain()
+{
+	constexpr uint32_t stageCount = 6;
+	const uint32_t jobsPerStage = JobSystem::JobRingSize / 2 + 31;
+
+	JobCounter counters[stageCount];
+	std::atomic<uint32_t> finished[stageCount] = {};
+	std::atomic<uint32_t> outOfOrder = 0;
+
+	for (uint32_t stage = 0; stage < stageCount; stage++)
+	{
+		for (uint32_t i = 0; i < jobsPerStage; i++)
+		{
+			auto function = [&finished, &outOfOrder, stage, jobsPerStage]()
+			{
+				if (stage > 0 && finished[stage - 1].load(std::memory_order_acquire) != jobsPerStage)
+					outOfOrder.fetch_add(1, std::memory_order_relaxed);
+				finished[stage].fetch_add(1, std::memory_order_release);
+			};
+
+			if (stage == 0)
+				JobSystem::Run(function, &counters[stage]);
+			else
+				JobSystem::RunAfter(counters[stage - 1], function, &counters[stage]);
+		}
+	}
+
+	JobSystem::WaitFor(counters[stageCount - 1]);
+
+	if (outOfOrder.load() > 0)
+		return std::to_string(outOfOrder.load()) + " jobs ran before the stage they depend on had finished";
+
+	for (uint32_t stage = 0; stage < stageCount; stage++)
+	{
+		if (finished[stage].load() != jobsPerStage)
+			return "stage " + std::to_string(stage) + " ran " + std::to_string(finished[stage].load()) + " of " + std::to_string(jobsPerStage) + " jobs";
+	}
+
+	return {};
+}
+
+// Threads that register later, like the render thread, submitting alongside the main thread
+static std::string ExternalThreads()
+{
+	constexpr uint32_t threadCount = 3;
+	const uint32_t countPerThread = JobSystem::JobRingSize * 2 + 5;
+	const uint32_t count = (threadCount + 1) * countPerThread;
+	auto visits = std::make_unique<std::atomic<uint32_t>[]>(count);
+
+	auto submit = [&visits, countPerThread](uint32_t thread)
+	{
+		JobCounter counter;
+		JobSystem::ParallelFor(countPerThread, 3, [&visits, thread, countPerThread](uint32_t begin, uint32_t end)
+		{
+			for (uint32_t i = begin; i < end; i++)
+				visits[thread * countPerThread + i].fetch_add(1, std::memory_order_relaxed);
+		}, &counter);
+		JobSystem::WaitFor(counter);
+	};
+
+	std::vector<std::thread> threads;
+	for (uint32_t i = 0; i < threadCount; i++)
+	{
+		threads.emplace_back([&submit, i]()
+		{
+			JobSystem::RegisterThread();
+			submit(i + 1);
+		});
+	}
+
+	submit(0);
+	for (std::thread& thread : threads)
+		thread.join();
+
+	return CheckVisitedOnce(visits, count);
+}
+
+static const StressTest s_Tests[] =
+{
+	{ "ParallelForOverflowsRing", ParallelForOverflowsRing },
+	{ "NestedParallelFor", NestedParallelFor },
+	{ "RunAfterChain", RunAfterChain },
+	{ "ExternalThreads", ExternalThreads },
+};
+
+uint32_t RunJobSystemStressTests(uint32_t iterations, const char* filter)
+{
+	// A single worker makes the ring wrap while the jobs are still queued, many make them race. Small
+	// machines get more workers than cores on purpose, the sanitizer still sees every interleaving it can.
+	const uint32_t workerCounts[] = { 1, std::max(std::thread::hardware_concurrency(), 4u) };
+
+	uint32_t failed = 0;
+	for (const StressTest& test : s_Tests)
+	{
+		if (filter[0] && !strstr(test.Name, filter))
+			continue;
+
+		for (const uint32_t workerCount : workerCounts)
+		{
+			std::string error;
+			for (uint32_t i = 0; i < iterations && error.empty(); i++)
+			{
+				// Threads stay registered until shutdown, so every run starts over with room for those of ExternalThreads
+				JobSystem::Init(workerCount, 4);
+				error = test.Function();
+				JobSystem::Shutdown();
+			}
+
+			if (error.empty())
+			{
+				std::cout << "[  OK  ] JobSystem." << test.Name << " (" << workerCount << " workers)\n";
+			}
+			else
+			{
+				std::cerr << "[FAILED] JobSystem." << test.Name << " (" << workerCount << " workers): " << error << '\n';
+				failed++;
+			}
+		}
+	}
+
+	return failed;
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+#include <cstdint>
+
+// Runs every job system test that matches filter, an empty one matches all. Returns the number that failed.
+uint32_t RunJobSystemStressTests(uint32_t iterations, const char* filter);
@@ -0,0 +1,30 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "JobSystemStressTests.h"
+
+// Usage: StressTests [--iterations <count>] [--filter <text>]
+// Exits with 1 if any test failed, ThreadSanitizer reports races on its own and exits with 66
+int main(int argc, char** argv)
+{
+	uint32_t iterations = 20;
+	const char* filter = "";
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+			iterations = (uint32_t)atoi(argv[++i]);
+		else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+			filter = argv[++i];
+		else
+			std::cerr << "Unknown argument '" << argv[i] << "'\n";
+	}
+
+	const uint32_t failed = RunJobSystemStressTests(iterations, filter);
+	if (failed)
+		std::cerr << failed << " stress test(s) failed\n";
+	else
+		std::cout << "All stress tests passed\n";
+
+	return failed ? 1 : 0;
+}
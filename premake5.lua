@@ -14,6 +14,12 @@ workspace "OpenGLCourse"
 		"MultiProcessorCompile"
 	}
 
+newoption
+{
+	trigger = "gl-instrumentation",
+	description = "Count every GL call of the app per pass, see GlInstrumentation.h"
+}
+
 outputdir = "%{cfg.buildcfg}-%{cfg.system}-%{cfg.architecture}"
 
 group "Dependencies"
@@ -22,4 +28,7 @@ group "Dependencies"
 	include "vendor/ImGui"
 group ""
 
-include "OpenGLCourse"
\ No newline at end of file
+include "OpenGLCourse"
+include "AssetCooker"
+include "Benchmarks"
+include "StressTests"
\ No newline at end of file